@@ -0,0 +1,301 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown, 
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse, 
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the 
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Adjacency.cc
+//
+
+#include <algorithm>
+
+#include "Adjacency.h"
+#include "Checkpoint.h"
+
+// order of edges in the compressed rows
+static bool compare_edge(const Adjacency::edge_t & e1, const Adjacency::edge_t & e2) {
+  return (e1.from == e2.from) ? (e1.to < e2.to) : (e1.from < e2.from);
+}
+
+Adjacency::Adjacency() {
+  this->nodes = 0;
+  this->offset.assign(1, 0);
+  this->changed_edges = 0;
+  this->number_of_edges = 0;
+}
+
+void Adjacency::build(std::vector<edge_t> & edges) {
+  this->changed.clear();
+  this->changed_edges = 0;
+
+  // meta agents stay in the delta log
+  std::vector<edge_t> meta_edges;
+  int max_node = -1;
+  int n = 0;
+  for(int i = 0; i < edges.size(); ++i) {
+    if(edges[i].from < 0) {
+      meta_edges.push_back(edges[i]);
+      continue;
+    }
+    edges[n++] = edges[i];
+    if(edges[i].from > max_node) {
+      max_node = edges[i].from;
+    }
+  }
+  edges.resize(n);
+  std::stable_sort(edges.begin(), edges.end(), compare_edge);
+
+  this->nodes = max_node + 1;
+  this->offset.assign(this->nodes + 1, 0);
+  this->neighbor.clear();
+  this->weight.clear();
+  this->timestamp.clear();
+  this->neighbor.reserve(edges.size());
+  this->weight.reserve(edges.size());
+  this->timestamp.reserve(edges.size());
+  for(int i = 0; i < edges.size(); ++i) {
+    if(i > 0 && edges[i].from == edges[i - 1].from && edges[i].to == edges[i - 1].to) {
+      continue;
+    }
+    this->offset[edges[i].from + 1]++;
+    this->neighbor.push_back(edges[i].to);
+    this->weight.push_back(edges[i].weight);
+    this->timestamp.push_back(edges[i].timestamp);
+  }
+  for(int node = 0; node < this->nodes; ++node) {
+    this->offset[node + 1] += this->offset[node];
+  }
+  this->number_of_edges = this->neighbor.size();
+
+  for(int i = 0; i < meta_edges.size(); ++i) {
+    add_edge(meta_edges[i].from, meta_edges[i].to, meta_edges[i].weight, meta_edges[i].timestamp);
+  }
+}
+
+int Adjacency::find(int node, int other) {
+  const int* first;
+  const int* last;
+  row_t* row = get_changed_row(node);
+  if(row != NULL) {
+    first = row->neighbor.data();
+    last = first + row->neighbor.size();
+  } else if(0 <= node && node < this->nodes) {
+    first = this->neighbor.data() + this->offset[node];
+    last = this->neighbor.data() + this->offset[node + 1];
+  } else {
+    return -1;
+  }
+  const int* pos = std::lower_bound(first, last, other);
+  if(pos == last || *pos != other) {
+    return -1;
+  }
+  return pos - first;
+}
+
+int Adjacency::get_neighbor_with_max_weight(int node) {
+  int size = get_degree(node);
+  int pos = -1;
+  for(int k = 0; k < size; ++k) {
+    if(pos < 0 || get_weight_at(node, pos) < get_weight_at(node, k)) {
+      pos = k;
+    }
+  }
+  return (pos < 0) ? -99999999 : get_neighbor(node, pos);
+}
+
+int Adjacency::get_neighbor_with_min_weight(int node) {
+  int size = get_degree(node);
+  int pos = -1;
+  for(int k = 0; k < size; ++k) {
+    if(pos < 0 || get_weight_at(node, pos) > get_weight_at(node, k)) {
+      pos = k;
+    }
+  }
+  return (pos < 0) ? -99999999 : get_neighbor(node, pos);
+}
+
+int Adjacency::get_last_neighbor(int node) {
+  int size = get_degree(node);
+  int pos = -1;
+  for(int k = 0; k < size; ++k) {
+    if(pos < 0 || get_timestamp_at(node, pos) < get_timestamp_at(node, k)) {
+      pos = k;
+    }
+  }
+  return (pos < 0) ? -99999999 : get_neighbor(node, pos);
+}
+
+Adjacency::row_t* Adjacency::change_row(int node) {
+  row_t* row = get_changed_row(node);
+  if(row != NULL) {
+    return row;
+  }
+  row = &this->changed[node];
+  if(0 <= node && node < this->nodes) {
+    long long int first = this->offset[node];
+    long long int last = this->offset[node + 1];
+    row->neighbor.assign(this->neighbor.begin() + first, this->neighbor.begin() + last);
+    row->weight.assign(this->weight.begin() + first, this->weight.begin() + last);
+    row->timestamp.assign(this->timestamp.begin() + first, this->timestamp.begin() + last);
+    this->changed_edges += last - first;
+  }
+  return row;
+}
+
+bool Adjacency::add_edge(int node, int other, double weight, int timestamp) {
+  if(find(node, other) >= 0) {
+    return false;
+  }
+  row_t* row = change_row(node);
+  int k = std::lower_bound(row->neighbor.begin(), row->neighbor.end(), other) - row->neighbor.begin();
+  row->neighbor.insert(row->neighbor.begin() + k, other);
+  row->weight.insert(row->weight.begin() + k, weight);
+  row->timestamp.insert(row->timestamp.begin() + k, timestamp);
+  this->changed_edges++;
+  this->number_of_edges++;
+  return true;
+}
+
+bool Adjacency::delete_edge(int node, int other) {
+  int k = find(node, other);
+  if(k < 0) {
+    return false;
+  }
+  row_t* row = change_row(node);
+  row->neighbor.erase(row->neighbor.begin() + k);
+  row->weight.erase(row->weight.begin() + k);
+  row->timestamp.erase(row->timestamp.begin() + k);
+  this->changed_edges--;
+  this->number_of_edges--;
+  return true;
+}
+
+void Adjacency::set_weight(int node, int other, double weight) {
+  int k = find(node, other);
+  if(k < 0) {
+    return;
+  }
+  row_t* row = get_changed_row(node);
+  if(row != NULL) {
+    row->weight[k] = weight;
+  } else {
+    this->weight[this->offset[node] + k] = weight;
+  }
+}
+
+void Adjacency::clear(int node) {
+  if(get_degree(node) == 0) {
+    return;
+  }
+  row_t* row = change_row(node);
+  this->changed_edges -= row->neighbor.size();
+  this->number_of_edges -= row->neighbor.size();
+  row->neighbor.clear();
+  row->weight.clear();
+  row->timestamp.clear();
+}
+
+void Adjacency::compact() {
+  if(this->changed.empty()) {
+    return;
+  }
+
+  int new_nodes = this->nodes;
+  for(std::unordered_map<int, row_t>::iterator itr = this->changed.begin(); itr != this->changed.end(); ++itr) {
+    if(itr->first >= new_nodes) {
+      new_nodes = itr->first + 1;
+    }
+  }
+
+  std::vector<long long int> new_offset(new_nodes + 1, 0);
+  std::vector<int> new_neighbor;
+  std::vector<double> new_weight;
+  std::vector<int> new_timestamp;
+  new_neighbor.reserve(this->number_of_edges);
+  new_weight.reserve(this->number_of_edges);
+  new_timestamp.reserve(this->number_of_edges);
+  for(int node = 0; node < new_nodes; ++node) {
+    row_t* row = get_changed_row(node);
+    if(row != NULL) {
+      new_neighbor.insert(new_neighbor.end(), row->neighbor.begin(), row->neighbor.end());
+      new_weight.insert(new_weight.end(), row->weight.begin(), row->weight.end());
+      new_timestamp.insert(new_timestamp.end(), row->timestamp.begin(), row->timestamp.end());
+    } else if(node < this->nodes) {
+      long long int first = this->offset[node];
+      long long int last = this->offset[node + 1];
+      new_neighbor.insert(new_neighbor.end(), this->neighbor.begin() + first, this->neighbor.begin() + last);
+      new_weight.insert(new_weight.end(), this->weight.begin() + first, this->weight.begin() + last);
+      new_timestamp.insert(new_timestamp.end(), this->timestamp.begin() + first, this->timestamp.begin() + last);
+    }
+    new_offset[node + 1] = new_neighbor.size();
+  }
+
+  // keep the rows of meta agents in the delta log
+  std::unordered_map<int, row_t> meta_rows;
+  this->changed_edges = 0;
+  for(std::unordered_map<int, row_t>::iterator itr = this->changed.begin(); itr != this->changed.end(); ++itr) {
+    if(itr->first < 0) {
+      this->changed_edges += itr->second.neighbor.size();
+      meta_rows[itr->first] = itr->second;
+    }
+  }
+  this->changed.swap(meta_rows);
+
+  this->nodes = new_nodes;
+  this->offset.swap(new_offset);
+  this->neighbor.swap(new_neighbor);
+  this->weight.swap(new_weight);
+  this->timestamp.swap(new_timestamp);
+}
+
+void Adjacency::save_checkpoint(Checkpoint* checkpoint) {
+  compact();
+  checkpoint->put_int(this->nodes);
+  checkpoint->put_vector(this->offset);
+  checkpoint->put_vector(this->neighbor);
+  checkpoint->put_vector(this->weight);
+  checkpoint->put_vector(this->timestamp);
+  checkpoint->put_int(this->changed.size());
+  for(std::unordered_map<int, row_t>::iterator itr = this->changed.begin(); itr != this->changed.end(); ++itr) {
+    checkpoint->put_int(itr->first);
+    checkpoint->put_vector(itr->second.neighbor);
+    checkpoint->put_vector(itr->second.weight);
+    checkpoint->put_vector(itr->second.timestamp);
+  }
+}
+
+void Adjacency::restore_checkpoint(Checkpoint* checkpoint) {
+  this->nodes = checkpoint->get_int();
+  checkpoint->get_vector(this->offset);
+  checkpoint->get_vector(this->neighbor);
+  checkpoint->get_vector(this->weight);
+  checkpoint->get_vector(this->timestamp);
+  this->number_of_edges = this->neighbor.size();
+  this->changed.clear();
+  this->changed_edges = 0;
+  int rows = checkpoint->get_int();
+  for(int i = 0; i < rows; ++i) {
+    row_t & row = this->changed[checkpoint->get_int()];
+    checkpoint->get_vector(row.neighbor);
+    checkpoint->get_vector(row.weight);
+    checkpoint->get_vector(row.timestamp);
+    this->changed_edges += row.neighbor.size();
+    this->number_of_edges += row.neighbor.size();
+  }
+}
@@ -0,0 +1,148 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown, 
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse, 
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the 
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Adjacency.h
+//
+
+#ifndef _FRED_ADJACENCY_H
+#define _FRED_ADJACENCY_H
+
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class Checkpoint;
+
+/**
+ * The edges of one direction of a network, in compressed sparse row
+ * form.  Nodes and neighbors are person ids.  The edges of node n are
+ * neighbor[offset[n]] .. neighbor[offset[n+1]-1], sorted by neighbor id,
+ * with parallel weight and timestamp arrays, so finding an edge is a
+ * binary search and the edges of a node are contiguous in memory.
+ *
+ * Edges added or deleted during the run go to a delta log: the first
+ * change to a node copies its row out of the compressed arrays into a
+ * per-node row that is edited in place.  compact() folds the changed
+ * rows back into the compressed arrays; it should not be called while
+ * the edges of a node are being iterated.  Meta agents (negative ids)
+ * always live in the delta log.
+ */
+class Adjacency {
+public:
+
+  typedef struct {
+    int from;
+    int to;
+    double weight;
+    int timestamp;
+  } edge_t;
+
+  Adjacency();
+
+  // replace all edges; duplicate edges keep the first weight and timestamp
+  void build(std::vector<edge_t> & edges);
+
+  int get_degree(int node) {
+    row_t* row = get_changed_row(node);
+    if(row != NULL) {
+      return row->neighbor.size();
+    }
+    if(0 <= node && node < this->nodes) {
+      return this->offset[node + 1] - this->offset[node];
+    }
+    return 0;
+  }
+
+  // the k-th edge of node, in neighbor id order
+  int get_neighbor(int node, int k) {
+    row_t* row = get_changed_row(node);
+    return row ? row->neighbor[k] : this->neighbor[this->offset[node] + k];
+  }
+  double get_weight_at(int node, int k) {
+    row_t* row = get_changed_row(node);
+    return row ? row->weight[k] : this->weight[this->offset[node] + k];
+  }
+  int get_timestamp_at(int node, int k) {
+    row_t* row = get_changed_row(node);
+    return row ? row->timestamp[k] : this->timestamp[this->offset[node] + k];
+  }
+
+  // position of the edge node -> other among the edges of node, or -1
+  int find(int node, int other);
+
+  // the neighbor with the largest or smallest weight, or the most
+  // recent edge, or -99999999 if node has no edges
+  int get_neighbor_with_max_weight(int node);
+  int get_neighbor_with_min_weight(int node);
+  int get_last_neighbor(int node);
+
+  bool add_edge(int node, int other, double weight, int timestamp);
+  bool delete_edge(int node, int other);
+  void set_weight(int node, int other, double weight);
+  void clear(int node);
+
+  long long int get_number_of_edges() {
+    return this->number_of_edges;
+  }
+
+  // compact when the delta log holds more than the given fraction of the edges
+  bool needs_compaction(double fraction) {
+    return this->changed_edges > 1024 && this->changed_edges > fraction * this->number_of_edges;
+  }
+  void compact();
+
+  void save_checkpoint(Checkpoint* checkpoint);
+  void restore_checkpoint(Checkpoint* checkpoint);
+
+private:
+
+  typedef struct {
+    std::vector<int> neighbor;
+    std::vector<double> weight;
+    std::vector<int> timestamp;
+  } row_t;
+
+  row_t* get_changed_row(int node) {
+    if(this->changed.empty()) {
+      return NULL;
+    }
+    std::unordered_map<int, row_t>::iterator itr = this->changed.find(node);
+    return (itr == this->changed.end()) ? NULL : &itr->second;
+  }
+  row_t* change_row(int node);
+
+  // compressed rows
+  int nodes;
+  std::vector<long long int> offset;
+  std::vector<int> neighbor;
+  std::vector<double> weight;
+  std::vector<int> timestamp;
+
+  // delta log
+  std::unordered_map<int, row_t> changed;
+  long long int changed_edges;
+
+  long long int number_of_edges;
+};
+
+#endif // _FRED_ADJACENCY_H
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Arena.h
+//
+
+#ifndef _FRED_ARENA_H
+#define _FRED_ARENA_H
+
+#include <new>
+#include <vector>
+
+using namespace std;
+
+/**
+ * An allocator for fixed-size rows of T, carved out of large blocks.
+ * Rows are laid out contiguously in the order they are allocated and
+ * are never moved, so pointers to them stay valid.  A released row goes
+ * on a free list and is handed out again by the next allocate().
+ *
+ * The arena returns raw storage: callers construct and destroy any
+ * objects in a row themselves.  Blocks are never returned to the
+ * system.
+ */
+template <typename T>
+class Arena {
+public:
+
+  Arena() {
+    this->row_size = 0;
+    this->rows_per_block = 0;
+    this->next_row = 0;
+    this->rows_in_use = 0;
+  }
+
+  // must be called before the first allocate()
+  void set_row_size(int size, int rows_per_block = 4096) {
+    this->row_size = size;
+    this->rows_per_block = rows_per_block;
+    this->next_row = rows_per_block;
+  }
+
+  int get_row_size() {
+    return this->row_size;
+  }
+
+  T* allocate() {
+    ++(this->rows_in_use);
+    if (this->free_list.empty() == false) {
+      T* row = this->free_list.back();
+      this->free_list.pop_back();
+      return row;
+    }
+    if (this->next_row == this->rows_per_block) {
+      void* block = ::operator new(sizeof(T) * this->row_size * this->rows_per_block);
+      this->blocks.push_back(static_cast<T*>(block));
+      this->next_row = 0;
+    }
+    T* row = this->blocks.back() + this->row_size * this->next_row;
+    ++(this->next_row);
+    return row;
+  }
+
+  void release(T* row) {
+    --(this->rows_in_use);
+    this->free_list.push_back(row);
+  }
+
+  int get_rows_in_use() {
+    return this->rows_in_use;
+  }
+
+  size_t get_bytes_allocated() {
+    return sizeof(T) * this->row_size * this->rows_per_block * this->blocks.size();
+  }
+
+private:
+  int row_size;
+  int rows_per_block;
+  int next_row;
+  int rows_in_use;
+  std::vector<T*> blocks;
+  std::vector<T*> free_list;
+};
+
+#endif // _FRED_ARENA_H
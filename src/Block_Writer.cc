@@ -0,0 +1,142 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Block_Writer.cc
+//
+
+#include "Block_Writer.h"
+
+// write() waits for the writer when this many blocks are waiting
+#define BLOCK_WRITER_MAX_QUEUED 8
+
+Block_Writer::Block_Writer() {
+  this->file = NULL;
+  this->stopping = false;
+  this->thread = NULL;
+}
+
+Block_Writer::~Block_Writer() {
+  close();
+  for(int i = 0; i < this->free_blocks.size(); ++i) {
+    delete this->free_blocks[i];
+  }
+  this->free_blocks.clear();
+}
+
+bool Block_Writer::open(const char* filename) {
+  close();
+  this->file = fopen(filename, "w");
+  if(this->file == NULL) {
+    return false;
+  }
+  this->stopping = false;
+  this->thread = new std::thread(&Block_Writer::run, this);
+  return true;
+}
+
+void Block_Writer::close() {
+  if(this->file == NULL) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = true;
+  }
+  this->changed.notify_all();
+  this->thread->join();
+  delete this->thread;
+  this->thread = NULL;
+  fclose(this->file);
+  this->file = NULL;
+}
+
+string* Block_Writer::get_block(size_t size) {
+  string* block = NULL;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if(this->free_blocks.size() > 0) {
+      block = this->free_blocks.back();
+      this->free_blocks.pop_back();
+    }
+  }
+  if(block == NULL) {
+    block = new string;
+  }
+  block->clear();
+  block->reserve(size);
+  return block;
+}
+
+void Block_Writer::write(string* block) {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while(this->queue.size() >= BLOCK_WRITER_MAX_QUEUED) {
+    this->changed.wait(lock);
+  }
+  this->queue.push_back(block);
+  lock.unlock();
+  this->changed.notify_all();
+}
+
+void Block_Writer::run() {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while(true) {
+    while(this->queue.empty() && this->stopping == false) {
+      this->changed.wait(lock);
+    }
+    if(this->queue.empty()) {
+      break;
+    }
+    string* block = this->queue.front();
+    this->queue.pop_front();
+    lock.unlock();
+    fwrite(block->data(), 1, block->size(), this->file);
+    lock.lock();
+    this->free_blocks.push_back(block);
+    this->changed.notify_all();
+  }
+  fflush(this->file);
+}
+
+void Block_Writer::put_varint(string* block, int64_t value) {
+  uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  while(zigzag >= 0x80) {
+    block->push_back(static_cast<char>((zigzag & 0x7f) | 0x80));
+    zigzag >>= 7;
+  }
+  block->push_back(static_cast<char>(zigzag));
+}
+
+bool Block_Writer::get_varint(const unsigned char* & p, const unsigned char* end, int64_t* value) {
+  uint64_t zigzag = 0;
+  for(int shift = 0; shift < 64; shift += 7) {
+    if(p == end) {
+      return false;
+    }
+    unsigned char byte = *p++;
+    zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if((byte & 0x80) == 0) {
+      *value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+      return true;
+    }
+  }
+  return false;
+}
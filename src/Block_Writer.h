@@ -0,0 +1,85 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Block_Writer.h
+//
+
+#ifndef _FRED_BLOCK_WRITER_H
+#define _FRED_BLOCK_WRITER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Writes blocks of bytes to a file on a background thread, in the order
+ * they are passed to write(), so that the threads filling the blocks do
+ * not wait for the disk.  Written blocks are kept for reuse.
+ */
+class Block_Writer {
+public:
+  Block_Writer();
+  ~Block_Writer();
+
+  // open the file and start the writer thread; returns false if the file can't be opened
+  bool open(const char* filename);
+
+  // write all queued blocks, stop the writer thread and close the file
+  void close();
+
+  bool is_open() {
+    return this->file != NULL;
+  }
+
+  // an empty block, with room for at least size bytes
+  string* get_block(size_t size);
+
+  // queue a block for writing; the writer owns it afterwards
+  void write(string* block);
+
+  // signed integers as zigzag varints: small values of either sign take
+  // one byte; get_varint returns false at the end of the data
+  static void put_varint(string* block, int64_t value);
+  static bool get_varint(const unsigned char* & p, const unsigned char* end, int64_t* value);
+
+private:
+  void run();
+
+  FILE* file;
+
+  // blocks waiting to be written, and blocks ready for reuse
+  std::deque<string*> queue;
+  std::vector<string*> free_blocks;
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool stopping;
+  std::thread* thread;
+};
+
+#endif // _FRED_BLOCK_WRITER_H
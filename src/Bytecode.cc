@@ -0,0 +1,887 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown, 
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse, 
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the 
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Bytecode.cc
+//
+
+#include "Bytecode.h"
+#include "Clause.h"
+#include "Date.h"
+#include "Expression.h"
+#include "Geo.h"
+#include "Global.h"
+#include "Person.h"
+#include "Place.h"
+#include "Random.h"
+#include "Rule.h"
+#include "Utils.h"
+
+static const char* op_name[] = {
+  "push", "factor0", "factor1", "factor2", "factor3", "factor", "expr", "pop",
+  "add", "sub", "mult", "div", "place_dist", "equal", "min", "max",
+  "uniform", "normal", "lognormal", "exponential", "geometric", "pow",
+  "log", "exp", "abs", "sin", "cos", "xy_dist",
+  "eq", "neq", "lt", "lte", "gt", "gte", "range", "date", "date_range",
+  "pred", "not", "test"
+};
+
+// opcodes for Expression::op_index, or -1 if there is none
+static const int expression_op[] = {
+  -1,
+  Bytecode_Op::ADD, Bytecode_Op::SUB, Bytecode_Op::MULT, Bytecode_Op::DIV,
+  Bytecode_Op::PLACE_DIST, Bytecode_Op::EQUAL, Bytecode_Op::MIN, Bytecode_Op::MAX,
+  Bytecode_Op::UNIFORM, Bytecode_Op::NORMAL, Bytecode_Op::LOGNORMAL,
+  Bytecode_Op::EXPONENTIAL, Bytecode_Op::GEOMETRIC, Bytecode_Op::POW,
+  Bytecode_Op::LOG, Bytecode_Op::EXP, Bytecode_Op::ABS, Bytecode_Op::SIN, Bytecode_Op::COS
+};
+
+// opcodes for Predicate::predicate_index
+static const int compare_op[] = {
+  -1,
+  Bytecode_Op::EQ, Bytecode_Op::NEQ, Bytecode_Op::LT,
+  Bytecode_Op::LTE, Bytecode_Op::GT, Bytecode_Op::GTE
+};
+
+static bool is_random_op(int op) {
+  switch (op) {
+  case Bytecode_Op::UNIFORM:
+  case Bytecode_Op::NORMAL:
+  case Bytecode_Op::LOGNORMAL:
+  case Bytecode_Op::EXPONENTIAL:
+  case Bytecode_Op::GEOMETRIC:
+    return true;
+  }
+  return false;
+}
+
+static bool is_unary_op(int op) {
+  switch (op) {
+  case Bytecode_Op::EXPONENTIAL:
+  case Bytecode_Op::GEOMETRIC:
+  case Bytecode_Op::LOG:
+  case Bytecode_Op::EXP:
+  case Bytecode_Op::ABS:
+  case Bytecode_Op::SIN:
+  case Bytecode_Op::COS:
+    return true;
+  }
+  return false;
+}
+
+
+Bytecode* Bytecode::compile_expression(Expression* expression) {
+  Bytecode* program = new Bytecode();
+  program->emit_expression(expression);
+  if (program->is_ok() == false ||
+      (program->code.size() == 1 && program->code[0].op == Bytecode_Op::EXPRESSION)) {
+    // nothing to gain over the tree
+    delete program;
+    return NULL;
+  }
+  return program;
+}
+
+
+Bytecode* Bytecode::compile_clause(Clause* clause) {
+  Bytecode* program = new Bytecode();
+  program->emit_clause(clause);
+  program->emit_const(1.0);
+  if (program->is_ok() == false) {
+    delete program;
+    return NULL;
+  }
+  return program;
+}
+
+
+Bytecode* Bytecode::compile_rule(Rule* rule) {
+  Bytecode* program = new Bytecode();
+  if (rule->get_action_id() == Rule_Action::SET) {
+    if (rule->get_expression() != NULL) {
+      program->emit_expression(rule->get_expression());
+    }
+    else {
+      program->emit_const(0.0);
+    }
+  }
+  else if (rule->is_next_rule()) {
+    if (rule->get_clause() != NULL) {
+      program->emit_clause(rule->get_clause());
+    }
+    if (rule->get_expression() != NULL) {
+      program->emit_expression(rule->get_expression());
+    }
+    else {
+      program->emit_const(1.0);
+    }
+  }
+  else {
+    program->emit_const(0.0);
+  }
+  if (program->is_ok() == false) {
+    delete program;
+    return NULL;
+  }
+  return program;
+}
+
+
+double Bytecode::get_value(Person* person, Person* other) {
+  double stack[MAX_STACK];
+  int top = -1;
+  double value1, value2, value3, sigma;
+  int today;
+  Place* place1;
+  Place* place2;
+  Person* subject;
+
+  const instruction_t* instr = this->code.data();
+  const instruction_t* last = instr + this->code.size();
+  for (; instr < last; ++instr) {
+    switch (instr->op) {
+
+    case Bytecode_Op::PUSH_CONST:
+      stack[++top] = instr->number;
+      break;
+
+    case Bytecode_Op::FACTOR_0:
+      stack[++top] = instr->f0();
+      break;
+
+    case Bytecode_Op::FACTOR_1:
+      subject = instr->use_other ? other : person;
+      stack[++top] = instr->f1(subject);
+      break;
+
+    case Bytecode_Op::FACTOR_2:
+      subject = instr->use_other ? other : person;
+      stack[++top] = instr->f2(subject, instr->arg2);
+      break;
+
+    case Bytecode_Op::FACTOR_3:
+      subject = instr->use_other ? other : person;
+      stack[++top] = instr->f3(subject, instr->arg2, instr->arg3);
+      break;
+
+    case Bytecode_Op::FACTOR:
+      subject = instr->use_other ? other : person;
+      stack[++top] = instr->factor->get_value(subject);
+      break;
+
+    case Bytecode_Op::EXPRESSION:
+      stack[++top] = instr->expression->evaluate(person, other);
+      break;
+
+    case Bytecode_Op::POP:
+      --top;
+      break;
+
+    case Bytecode_Op::ADD:
+      --top;
+      stack[top] = stack[top] + stack[top+1];
+      break;
+
+    case Bytecode_Op::SUB:
+      --top;
+      stack[top] = stack[top] - stack[top+1];
+      break;
+
+    case Bytecode_Op::MULT:
+      --top;
+      stack[top] = stack[top] * stack[top+1];
+      break;
+
+    case Bytecode_Op::DIV:
+      --top;
+      if (stack[top+1] == 0.0) {
+	stack[top] = 0.0;
+      }
+      else {
+	stack[top] = stack[top] / stack[top+1];
+      }
+      break;
+
+    case Bytecode_Op::PLACE_DIST:
+      --top;
+      // operands should evaluate to place ids
+      place1 = Place::get_place_from_sp_id((long long int)stack[top]);
+      place2 = Place::get_place_from_sp_id((long long int)stack[top+1]);
+      if (place1 && place2) {
+	stack[top] = Place::distance_between_places(place1, place2);
+      }
+      else {
+	stack[top] = 9999999.0;
+      }
+      break;
+
+    case Bytecode_Op::EQUAL:
+      --top;
+      stack[top] = (stack[top] == stack[top+1]);
+      break;
+
+    case Bytecode_Op::MIN:
+      --top;
+      stack[top] = std::min(stack[top], stack[top+1]);
+      break;
+
+    case Bytecode_Op::MAX:
+      --top;
+      stack[top] = std::max(stack[top], stack[top+1]);
+      break;
+
+    case Bytecode_Op::UNIFORM:
+      --top;
+      stack[top] = Random::draw_random(stack[top], stack[top+1]);
+      break;
+
+    case Bytecode_Op::NORMAL:
+      --top;
+      stack[top] = Random::draw_normal(stack[top], stack[top+1]);
+      break;
+
+    case Bytecode_Op::LOGNORMAL:
+      --top;
+      sigma = log(stack[top+1]);
+      if (sigma != 0.0) {
+	stack[top] = Random::draw_lognormal(log(stack[top]), sigma);
+      }
+      break;
+
+    case Bytecode_Op::EXPONENTIAL:
+      stack[top] = Random::draw_exponential(stack[top]);
+      break;
+
+    case Bytecode_Op::GEOMETRIC:
+      if (stack[top] <= 0.0) {
+	stack[top] = 0;
+      }
+      else {
+	stack[top] = Random::draw_geometric(1.0/stack[top]);
+      }
+      break;
+
+    case Bytecode_Op::POW:
+      --top;
+      stack[top] = pow(stack[top], stack[top+1]);
+      break;
+
+    case Bytecode_Op::LOG:
+      if (stack[top] <= 0) {
+	stack[top] = -1.0e100;
+      }
+      else {
+	stack[top] = log(stack[top]);
+      }
+      break;
+
+    case Bytecode_Op::EXP:
+      stack[top] = exp(stack[top]);
+      break;
+
+    case Bytecode_Op::ABS:
+      stack[top] = fabs(stack[top]);
+      break;
+
+    case Bytecode_Op::SIN:
+      stack[top] = sin(stack[top]);
+      break;
+
+    case Bytecode_Op::COS:
+      stack[top] = cos(stack[top]);
+      break;
+
+    case Bytecode_Op::XY_DIST:
+      top -= 3;
+      stack[top] = Geo::xy_distance(stack[top], stack[top+1], stack[top+2], stack[top+3]);
+      break;
+
+    case Bytecode_Op::EQ:
+      --top;
+      stack[top] = (stack[top] == stack[top+1]);
+      break;
+
+    case Bytecode_Op::NEQ:
+      --top;
+      stack[top] = (stack[top] != stack[top+1]);
+      break;
+
+    case Bytecode_Op::LT:
+      --top;
+      stack[top] = (stack[top] < stack[top+1]);
+      break;
+
+    case Bytecode_Op::LTE:
+      --top;
+      stack[top] = (stack[top] <= stack[top+1]);
+      break;
+
+    case Bytecode_Op::GT:
+      --top;
+      stack[top] = (stack[top] > stack[top+1]);
+      break;
+
+    case Bytecode_Op::GTE:
+      --top;
+      stack[top] = (stack[top] >= stack[top+1]);
+      break;
+
+    case Bytecode_Op::RANGE:
+      top -= 2;
+      value1 = stack[top];
+      value2 = stack[top+1];
+      value3 = stack[top+2];
+      stack[top] = (value2 <= value1 && value1 <= value3);
+      break;
+
+    case Bytecode_Op::DATE:
+      stack[top] = ((int) stack[top] == Date::get_date_code());
+      break;
+
+    case Bytecode_Op::DATE_RANGE: {
+      --top;
+      int date1 = stack[top];
+      int date2 = stack[top+1];
+      today = Date::get_date_code();
+      if (date1 <= date2) {
+	stack[top] = (date1 <= today && today <= date2);
+      }
+      else {
+	stack[top] = (date1 <= today || today <= date2);
+      }
+      break;
+    }
+
+    case Bytecode_Op::PREDICATE:
+      stack[++top] = instr->pred(person, instr->arg2, instr->arg3);
+      break;
+
+    case Bytecode_Op::NOT:
+      stack[top] = (stack[top] == 0.0);
+      break;
+
+    case Bytecode_Op::TEST:
+      // a clause is false as soon as any predicate is false
+      if (stack[top--] == 0.0) {
+	return 0.0;
+      }
+      break;
+    }
+  }
+  return stack[top];
+}
+
+
+void Bytecode::get_values(Person** people, int n, double* values) {
+
+  if (this->local == false) {
+    for (int i = 0; i < n; i++) {
+      values[i] = get_value(people[i], NULL);
+    }
+    return;
+  }
+
+  double stack[MAX_STACK][BATCH_SIZE];
+  bool alive[BATCH_SIZE];
+
+  for (int first = 0; first < n; first += BATCH_SIZE) {
+    Person** batch = people + first;
+    int m = std::min(BATCH_SIZE, n - first);
+    int top = -1;
+    for (int i = 0; i < m; i++) {
+      alive[i] = true;
+    }
+
+    const instruction_t* instr = this->code.data();
+    const instruction_t* last = instr + this->code.size();
+    for (; instr < last; ++instr) {
+      double* x = stack[top > 0 ? top : 0];
+      double* y = stack[top > 0 ? top-1 : 0];
+      switch (instr->op) {
+
+      case Bytecode_Op::PUSH_CONST:
+	x = stack[++top];
+	for (int i = 0; i < m; i++) {
+	  x[i] = instr->number;
+	}
+	break;
+
+      case Bytecode_Op::FACTOR_0: {
+	// the same for everyone in the batch
+	double value = instr->f0();
+	x = stack[++top];
+	for (int i = 0; i < m; i++) {
+	  x[i] = value;
+	}
+	break;
+      }
+
+      case Bytecode_Op::FACTOR_1:
+	x = stack[++top];
+	for (int i = 0; i < m; i++) {
+	  x[i] = instr->f1(batch[i]);
+	}
+	break;
+
+      case Bytecode_Op::FACTOR_2:
+	x = stack[++top];
+	for (int i = 0; i < m; i++) {
+	  x[i] = instr->f2(batch[i], instr->arg2);
+	}
+	break;
+
+      case Bytecode_Op::FACTOR_3:
+	x = stack[++top];
+	for (int i = 0; i < m; i++) {
+	  x[i] = instr->f3(batch[i], instr->arg2, instr->arg3);
+	}
+	break;
+
+      case Bytecode_Op::PREDICATE:
+	x = stack[++top];
+	for (int i = 0; i < m; i++) {
+	  x[i] = instr->pred(batch[i], instr->arg2, instr->arg3);
+	}
+	break;
+
+      case Bytecode_Op::POP:
+	--top;
+	break;
+
+      // binary operators leave their result in y, the lower operand
+
+      case Bytecode_Op::ADD:
+	for (int i = 0; i < m; i++) {
+	  y[i] = y[i] + x[i];
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::SUB:
+	for (int i = 0; i < m; i++) {
+	  y[i] = y[i] - x[i];
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::MULT:
+	for (int i = 0; i < m; i++) {
+	  y[i] = y[i] * x[i];
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::DIV:
+	for (int i = 0; i < m; i++) {
+	  y[i] = (x[i] == 0.0) ? 0.0 : y[i] / x[i];
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::PLACE_DIST:
+	for (int i = 0; i < m; i++) {
+	  Place* place1 = Place::get_place_from_sp_id((long long int)y[i]);
+	  Place* place2 = Place::get_place_from_sp_id((long long int)x[i]);
+	  if (place1 && place2) {
+	    y[i] = Place::distance_between_places(place1, place2);
+	  }
+	  else {
+	    y[i] = 9999999.0;
+	  }
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::EQUAL:
+      case Bytecode_Op::EQ:
+	for (int i = 0; i < m; i++) {
+	  y[i] = (y[i] == x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::MIN:
+	for (int i = 0; i < m; i++) {
+	  y[i] = std::min(y[i], x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::MAX:
+	for (int i = 0; i < m; i++) {
+	  y[i] = std::max(y[i], x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::POW:
+	for (int i = 0; i < m; i++) {
+	  y[i] = pow(y[i], x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::LOG:
+	for (int i = 0; i < m; i++) {
+	  x[i] = (x[i] <= 0) ? -1.0e100 : log(x[i]);
+	}
+	break;
+
+      case Bytecode_Op::EXP:
+	for (int i = 0; i < m; i++) {
+	  x[i] = exp(x[i]);
+	}
+	break;
+
+      case Bytecode_Op::ABS:
+	for (int i = 0; i < m; i++) {
+	  x[i] = fabs(x[i]);
+	}
+	break;
+
+      case Bytecode_Op::SIN:
+	for (int i = 0; i < m; i++) {
+	  x[i] = sin(x[i]);
+	}
+	break;
+
+      case Bytecode_Op::COS:
+	for (int i = 0; i < m; i++) {
+	  x[i] = cos(x[i]);
+	}
+	break;
+
+      case Bytecode_Op::XY_DIST:
+	top -= 3;
+	for (int i = 0; i < m; i++) {
+	  stack[top][i] = Geo::xy_distance(stack[top][i], stack[top+1][i], stack[top+2][i], stack[top+3][i]);
+	}
+	break;
+
+      case Bytecode_Op::NEQ:
+	for (int i = 0; i < m; i++) {
+	  y[i] = (y[i] != x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::LT:
+	for (int i = 0; i < m; i++) {
+	  y[i] = (y[i] < x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::LTE:
+	for (int i = 0; i < m; i++) {
+	  y[i] = (y[i] <= x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::GT:
+	for (int i = 0; i < m; i++) {
+	  y[i] = (y[i] > x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::GTE:
+	for (int i = 0; i < m; i++) {
+	  y[i] = (y[i] >= x[i]);
+	}
+	--top;
+	break;
+
+      case Bytecode_Op::RANGE:
+	top -= 2;
+	for (int i = 0; i < m; i++) {
+	  double value1 = stack[top][i];
+	  stack[top][i] = (stack[top+1][i] <= value1 && value1 <= stack[top+2][i]);
+	}
+	break;
+
+      case Bytecode_Op::DATE: {
+	int today = Date::get_date_code();
+	for (int i = 0; i < m; i++) {
+	  x[i] = ((int) x[i] == today);
+	}
+	break;
+      }
+
+      case Bytecode_Op::DATE_RANGE: {
+	int today = Date::get_date_code();
+	for (int i = 0; i < m; i++) {
+	  int date1 = y[i];
+	  int date2 = x[i];
+	  if (date1 <= date2) {
+	    y[i] = (date1 <= today && today <= date2);
+	  }
+	  else {
+	    y[i] = (date1 <= today || today <= date2);
+	  }
+	}
+	--top;
+	break;
+      }
+
+      case Bytecode_Op::NOT:
+	for (int i = 0; i < m; i++) {
+	  x[i] = (x[i] == 0.0);
+	}
+	break;
+
+      case Bytecode_Op::TEST:
+	// instead of returning early, mark the people whose clause failed
+	for (int i = 0; i < m; i++) {
+	  alive[i] = alive[i] && (x[i] != 0.0);
+	}
+	--top;
+	break;
+
+      default:
+	// not reached for local programs
+	Utils::fred_abort("Bytecode::get_values: unexpected op %s\n", op_name[instr->op]);
+      }
+    }
+
+    for (int i = 0; i < m; i++) {
+      values[first+i] = alive[i] ? stack[top][i] : 0.0;
+    }
+  }
+}
+
+
+void Bytecode::print() {
+  printf("BYTECODE size %d stack %d:", (int) this->code.size(), this->max_depth);
+  for (int i = 0; i < this->code.size(); i++) {
+    instruction_t & instr = this->code[i];
+    printf(" %s", op_name[instr.op]);
+    if (instr.op == Bytecode_Op::PUSH_CONST) {
+      printf("(%g)", instr.number);
+    }
+    if (instr.op == Bytecode_Op::EXPRESSION) {
+      printf("(%s)", instr.expression->get_name().c_str());
+    }
+  }
+  printf("\n");
+}
+
+
+void Bytecode::emit(instruction_t & instr, int pops, int pushes) {
+  this->code.push_back(instr);
+  this->depth += pushes - pops;
+  if (this->depth > this->max_depth) {
+    this->max_depth = this->depth;
+  }
+}
+
+
+void Bytecode::emit_op(int op, int pops, int pushes) {
+  if (op == Bytecode_Op::EXPRESSION || op == Bytecode_Op::FACTOR || is_random_op(op)) {
+    this->local = false;
+  }
+  instruction_t instr;
+  instr.op = op;
+  instr.use_other = false;
+  instr.arg2 = 0;
+  instr.arg3 = 0;
+  instr.number = 0.0;
+  instr.expression = NULL;
+  emit(instr, pops, pushes);
+}
+
+
+void Bytecode::emit_const(double value) {
+  emit_op(Bytecode_Op::PUSH_CONST, 0, 1);
+  this->code.back().number = value;
+}
+
+
+void Bytecode::emit_expression(Expression* expression) {
+
+  // nodes without an opcode are evaluated by the tree walker
+  bool opaque = expression->is_value || expression->is_select || expression->is_list_expr;
+  int op = -1;
+  if (opaque == false && expression->is_distance == false && expression->number_of_expressions > 0) {
+    int index = expression->op_index;
+    if (index < 0 || (int) (sizeof(expression_op) / sizeof(int)) <= index) {
+      opaque = true;
+    }
+    else {
+      op = expression_op[index];
+    }
+  }
+  if (opaque) {
+    emit_op(Bytecode_Op::EXPRESSION, 0, 1);
+    this->code.back().expression = expression;
+    expression->compile_children();
+    return;
+  }
+
+  if (expression->is_distance) {
+    emit_expression(expression->expr1);
+    emit_expression(expression->expr2);
+    emit_expression(expression->expr3);
+    emit_expression(expression->expr4);
+    emit_op(Bytecode_Op::XY_DIST, 4, 1);
+    return;
+  }
+
+  if (expression->number_of_expressions == 0) {
+    if (expression->factor != NULL) {
+      emit_factor(expression->factor, expression->use_other);
+    }
+    else {
+      emit_const(expression->number);
+    }
+    return;
+  }
+
+  // operands are evaluated left to right, as in the tree, so random
+  // draws happen in the same order
+  emit_expression(expression->expr1);
+  if (expression->number_of_expressions == 2) {
+    emit_expression(expression->expr2);
+  }
+  if (op < 0) {
+    // identity
+    if (expression->number_of_expressions == 2) {
+      emit_op(Bytecode_Op::POP, 1, 0);
+    }
+  }
+  else if (is_unary_op(op)) {
+    if (expression->number_of_expressions == 2) {
+      emit_op(Bytecode_Op::POP, 1, 0);
+    }
+    emit_op(op, 1, 1);
+  }
+  else {
+    if (expression->number_of_expressions == 1) {
+      // missing second operand has value 0
+      emit_const(0.0);
+    }
+    emit_op(op, 2, 1);
+  }
+}
+
+
+void Bytecode::emit_factor(Factor* factor, bool use_other) {
+  if (factor->is_local() == false || use_other) {
+    this->local = false;
+  }
+  if (factor->is_constant) {
+    emit_const(factor->number);
+    return;
+  }
+  int op = Bytecode_Op::FACTOR;
+  switch (factor->number_of_args) {
+  case 0:
+    if (factor->f0 != NULL) {
+      op = Bytecode_Op::FACTOR_0;
+    }
+    break;
+  case 1:
+    if (factor->f1 != NULL) {
+      op = Bytecode_Op::FACTOR_1;
+    }
+    break;
+  case 2:
+    if (factor->f2 != NULL) {
+      op = Bytecode_Op::FACTOR_2;
+    }
+    break;
+  case 3:
+    if (factor->f3 != NULL) {
+      op = Bytecode_Op::FACTOR_3;
+    }
+    break;
+  }
+  emit_op(op, 0, 1);
+  instruction_t & instr = this->code.back();
+  instr.use_other = use_other;
+  instr.arg2 = factor->arg2;
+  instr.arg3 = factor->arg3;
+  switch (op) {
+  case Bytecode_Op::FACTOR_0:
+    instr.f0 = factor->f0;
+    break;
+  case Bytecode_Op::FACTOR_1:
+    instr.f1 = factor->f1;
+    break;
+  case Bytecode_Op::FACTOR_2:
+    instr.f2 = factor->f2;
+    break;
+  case Bytecode_Op::FACTOR_3:
+    instr.f3 = factor->f3;
+    break;
+  default:
+    instr.factor = factor;
+  }
+}
+
+
+void Bytecode::emit_predicate(Predicate* predicate) {
+  if (predicate->func != NULL) {
+    if (predicate->is_local() == false) {
+      this->local = false;
+    }
+    emit_op(Bytecode_Op::PREDICATE, 0, 1);
+    instruction_t & instr = this->code.back();
+    instr.pred = predicate->func;
+    instr.arg2 = predicate->condition_id;
+    instr.arg3 = predicate->group_type_id;
+  }
+  else if (0 < predicate->predicate_index) {
+    emit_expression(predicate->expression1);
+    emit_expression(predicate->expression2);
+    emit_op(compare_op[predicate->predicate_index], 2, 1);
+  }
+  else if (predicate->predicate_str == "range") {
+    emit_expression(predicate->expression1);
+    emit_expression(predicate->expression2);
+    emit_expression(predicate->expression3);
+    emit_op(Bytecode_Op::RANGE, 3, 1);
+  }
+  else if (predicate->predicate_str == "date") {
+    emit_expression(predicate->expression1);
+    emit_op(Bytecode_Op::DATE, 1, 1);
+  }
+  else if (predicate->predicate_str == "date_range") {
+    emit_expression(predicate->expression1);
+    emit_expression(predicate->expression2);
+    emit_op(Bytecode_Op::DATE_RANGE, 2, 1);
+  }
+  else {
+    emit_const(0.0);
+  }
+  if (predicate->negate) {
+    emit_op(Bytecode_Op::NOT, 1, 1);
+  }
+}
+
+
+void Bytecode::emit_clause(Clause* clause) {
+  for (int i = 0; i < clause->predicates.size(); i++) {
+    emit_predicate(clause->predicates[i]);
+    emit_op(Bytecode_Op::TEST, 1, 0);
+  }
+}
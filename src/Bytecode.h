@@ -0,0 +1,171 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown, 
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse, 
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the 
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Bytecode.h
+//
+
+#ifndef _FRED_BYTECODE_H
+#define _FRED_BYTECODE_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "Factor.h"
+#include "Predicate.h"
+
+class Clause;
+class Expression;
+class Person;
+class Rule;
+
+namespace Bytecode_Op {
+  enum e { PUSH_CONST,
+	   FACTOR_0,
+	   FACTOR_1,
+	   FACTOR_2,
+	   FACTOR_3,
+	   FACTOR,
+	   EXPRESSION,
+	   POP,
+	   ADD,
+	   SUB,
+	   MULT,
+	   DIV,
+	   PLACE_DIST,
+	   EQUAL,
+	   MIN,
+	   MAX,
+	   UNIFORM,
+	   NORMAL,
+	   LOGNORMAL,
+	   EXPONENTIAL,
+	   GEOMETRIC,
+	   POW,
+	   LOG,
+	   EXP,
+	   ABS,
+	   SIN,
+	   COS,
+	   XY_DIST,
+	   EQ,
+	   NEQ,
+	   LT,
+	   LTE,
+	   GT,
+	   GTE,
+	   RANGE,
+	   DATE,
+	   DATE_RANGE,
+	   PREDICATE,
+	   NOT,
+	   TEST };
+};
+
+/**
+ * A flat stack-machine program compiled from the tree of Expression,
+ * Predicate and Clause objects of a rule.  Factors and built-in
+ * predicates are resolved to direct function calls and comparisons to
+ * opcodes, so evaluation is a single loop over an instruction array
+ * instead of a recursive walk of the tree.
+ *
+ * Nodes that have no opcode (list expressions, select, value) are
+ * called through Expression::evaluate(), so a compiled program always
+ * returns the same value as the tree it was compiled from, including
+ * the order of any random draws.
+ *
+ * A program is local if it makes no random draws and reads only the
+ * clock and attributes that other agents cannot change.  A local
+ * program can be run over a whole batch of people at once, one
+ * instruction at a time across the batch, with the same result as
+ * evaluating each person in turn.
+ */
+class Bytecode {
+public:
+
+  static Bytecode* compile_expression(Expression* expression);
+  static Bytecode* compile_clause(Clause* clause);
+  static Bytecode* compile_rule(Rule* rule);
+
+  double get_value(Person* person, Person* other);
+  void get_values(Person** people, int n, double* values);
+
+  bool is_local() {
+    return this->local;
+  }
+
+  int get_size() {
+    return (int) this->code.size();
+  }
+
+  void print();
+
+private:
+
+  typedef struct {
+    int op;
+    bool use_other;
+    int arg2;
+    int arg3;
+    double number;
+    union {
+      fptr_with_0_arg f0;
+      fptr_with_1_arg f1;
+      fptr_with_2_arg f2;
+      fptr_with_3_arg f3;
+      fptr pred;
+      Factor* factor;
+      Expression* expression;
+    };
+  } instruction_t;
+
+  // maximum depth of the evaluation stack
+  static const int MAX_STACK = 64;
+
+  // number of people evaluated together by get_values()
+  static const int BATCH_SIZE = 64;
+
+  Bytecode() {
+    this->code.clear();
+    this->depth = 0;
+    this->max_depth = 0;
+    this->local = true;
+  }
+
+  void emit(instruction_t & instr, int pops, int pushes);
+  void emit_op(int op, int pops, int pushes);
+  void emit_const(double value);
+  void emit_expression(Expression* expression);
+  void emit_factor(Factor* factor, bool use_other);
+  void emit_predicate(Predicate* predicate);
+  void emit_clause(Clause* clause);
+  bool is_ok() {
+    return this->max_depth <= MAX_STACK;
+  }
+
+  std::vector<instruction_t> code;
+  int depth;
+  int max_depth;
+  bool local;
+};
+
+#endif // _FRED_BYTECODE_H
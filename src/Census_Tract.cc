@@ -79,7 +79,7 @@ void Census_Tract::set_school_probabilities() {
   school_id_lookup.clear();
   for (int g = 0; g < Global::GRADES; g++) {
     schools_attended[g].clear();
-    school_probabilities[g].clear();
+    school_sampler[g].clear();
     school_counts[g].clear();
     total[g] = 0;
   }
@@ -117,16 +117,18 @@ void Census_Tract::set_school_probabilities() {
   // convert to probabilities
   for (int g = 0; g < Global::GRADES; g++) {
     if (total[g] > 0) {
+      std::vector<double> school_probabilities;
       for (attendance_map_itr_t itr = school_counts[g].begin(); itr != school_counts[g].end(); ++itr) {
 	int school_id = itr->first;
 	int count = itr->second;
 	Place* school = school_id_lookup[school_id];
 	schools_attended[g].push_back(school);
 	double prob = (double) count / (double) total[g];
-	school_probabilities[g].push_back(prob);
+	school_probabilities.push_back(prob);
 	FRED_VERBOSE(1,"school %s admin_code %lld grade %d attended by %d prob %f\n",
 		     school->get_label(), school->get_county_admin_code(), g, count, prob);
       }
+      school_sampler[g].setup(school_probabilities);
     }
   }
 }
@@ -154,17 +156,11 @@ Place* Census_Tract::select_new_school(int grade) {
 	       Global::Simulation_Day, get_admin_division_code(), grade, (int) (this->schools_attended[grade].size()));
 
  // pick from the attendance distribution
-  double r = Random::draw_random();
-  double sum = 0.0;
-  for (int i = 0; i < this->school_probabilities[grade].size(); ++i) {
-    sum += this->school_probabilities[grade][i];
-    if (r < sum) {
-      return this->schools_attended[grade][i];
-    }
+  if (this->school_sampler[grade].size() > 0) {
+    return this->schools_attended[grade][this->school_sampler[grade].draw()];
   }
-  FRED_VERBOSE(1,"WARNING: NO SCHOOL FOUND on day %d in admin_code = %lld grade = %d schools = %d r = %f sum = %f\n",
-	       Global::Simulation_Day, get_admin_division_code(), grade,
-	       (int) (this->school_probabilities[grade].size()), r, sum);
+  FRED_VERBOSE(1,"WARNING: NO SCHOOL FOUND on day %d in admin_code = %lld grade = %d\n",
+	       Global::Simulation_Day, get_admin_division_code(), grade);
 
   // fall back to selecting school from County
   return NULL;
@@ -181,7 +177,7 @@ void Census_Tract::set_workplace_probabilities() {
   typedef attendance_map_t::iterator attendance_map_itr_t;
 
   workplaces_attended.clear();
-  workplace_probabilities.clear();
+  workplace_sampler.clear();
 
   // get number of people in this county attending each workplace
   // at the start of the simulation
@@ -217,6 +213,7 @@ void Census_Tract::set_workplace_probabilities() {
   }
 
   // convert to probabilities
+  std::vector<double> workplace_probabilities;
   for (attendance_map_itr_t itr = workplace_counts.begin(); itr != workplace_counts.end(); ++itr) {
     int wid = itr->first;
     int count = itr->second;
@@ -227,17 +224,13 @@ void Census_Tract::set_workplace_probabilities() {
     FRED_VERBOSE(1,"workplace %s admin_code %lld  attended by %d prob %f\n",
 		 workplace->get_label(), workplace->get_census_tract_admin_code(), count, prob);
   }
+  workplace_sampler.setup(workplace_probabilities);
 
 }
 
 Place* Census_Tract::select_new_workplace() {
-  double r = Random::draw_random();
-  double sum = 0.0;
-  for (int i = 0; i < this->workplace_probabilities.size(); ++i) {
-    sum += this->workplace_probabilities[i];
-    if (r < sum) {
-      return this->workplaces_attended[i];
-    }
+  if (this->workplace_sampler.size() > 0) {
+    return this->workplaces_attended[this->workplace_sampler.draw()];
   }
   return NULL;
 }
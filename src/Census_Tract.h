@@ -33,6 +33,7 @@ using namespace std;
 
 #include "Global.h"
 #include "Admin_Division.h"
+#include "Random.h"
 
 // school attendance maps
 typedef std::unordered_map<int,int> attendance_map_t;
@@ -77,17 +78,19 @@ public:
 
 private:
 
-  // schools attended by people in this census_tract, with probabilities
+  // schools attended by people in this census_tract, with a sampler
+  // over their attendance probabilities
   std::vector<Place*> schools_attended[Global::GRADES];
-  std::vector<double> school_probabilities[Global::GRADES];
+  Alias_Table school_sampler[Global::GRADES];
 
   // list of schools attended by people in this county
   attendance_map_t school_counts[Global::GRADES];
   school_id_map_t school_id_lookup;
 
-  // workplaces attended by people in this census_tract, with probabilities
+  // workplaces attended by people in this census_tract, with a sampler
+  // over their attendance probabilities
   std::vector<Place*> workplaces_attended;
-  std::vector<double> workplace_probabilities;
+  Alias_Table workplace_sampler;
 
   static std::vector<Census_Tract*> census_tracts;
   static std::unordered_map<long long int,Census_Tract*> lookup_map;
@@ -0,0 +1,389 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Checkpoint.cc
+//
+
+#include <limits.h>
+#include <string.h>
+
+#include "Checkpoint.h"
+#include "Condition.h"
+#include "Date.h"
+#include "Demographics.h"
+#include "Epidemic.h"
+#include "Group.h"
+#include "Network.h"
+#include "Network_Type.h"
+#include "Person.h"
+#include "Place.h"
+#include "Place_Type.h"
+#include "Property.h"
+#include "Random.h"
+#include "Travel.h"
+#include "Utils.h"
+
+// daily reports kept by Fred.cc
+extern std::vector<int> daily_popsize;
+extern double_vector_t* daily_globals;
+
+#define CHECKPOINT_MAGIC "FREDCKPT"
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_BUFFER_SIZE (1 << 22)
+
+// person id written for a NULL person (meta agents have negative ids)
+#define CHECKPOINT_NO_PERSON INT_MIN
+
+int Checkpoint::checkpoint_day = -1;
+char Checkpoint::restore_file[FRED_STRING_SIZE];
+int Checkpoint::first_day = 0;
+
+void Checkpoint::get_properties() {
+  Property::get_property("checkpoint_day", &Checkpoint::checkpoint_day);
+  Property::get_property("restore_checkpoint_file", Checkpoint::restore_file);
+  if(Checkpoint::checkpoint_day >= 0 || strcmp(Checkpoint::restore_file, "none") != 0) {
+    if(Global::Enable_Population_Dynamics) {
+      Utils::fred_abort("checkpoints are not supported with population dynamics\n");
+    }
+  }
+}
+
+Checkpoint::Checkpoint(const char* _filename, bool writing) {
+  this->filename = _filename;
+  this->fp = fopen(_filename, writing ? "wb" : "rb");
+  if(this->fp == NULL) {
+    Utils::fred_abort("Checkpoint: can't open file %s\n", _filename);
+  }
+  this->buffer = new char [CHECKPOINT_BUFFER_SIZE];
+  setvbuf(this->fp, this->buffer, _IOFBF, CHECKPOINT_BUFFER_SIZE);
+}
+
+Checkpoint::~Checkpoint() {
+  if(fclose(this->fp) != 0) {
+    mismatch("close failed");
+  }
+  delete[] this->buffer;
+}
+
+void Checkpoint::mismatch(const char* what) {
+  Utils::fred_abort("Checkpoint %s: %s\n", this->filename.c_str(), what);
+}
+
+void Checkpoint::put_string(const std::string & value) {
+  put_int(value.size());
+  put_data(value.data(), value.size());
+}
+
+std::string Checkpoint::get_string() {
+  int size = get_int();
+  if(size < 0) {
+    mismatch("bad string length");
+  }
+  std::string value(size, '\0');
+  if(size > 0) {
+    get_data(&value[0], size);
+  }
+  return value;
+}
+
+void Checkpoint::put_person(Person* person) {
+  put_int(person == NULL ? CHECKPOINT_NO_PERSON : person->get_id());
+}
+
+Person* Checkpoint::get_person() {
+  int id = get_int();
+  if(id == CHECKPOINT_NO_PERSON) {
+    return NULL;
+  }
+  Person* person = Person::get_person_with_id(id);
+  if(person == NULL) {
+    // someone who left the population before the checkpoint, but is
+    // still referred to (e.g. as the source of an infection)
+    std::unordered_map<int, Person*>::iterator found = this->removed_person.find(id);
+    if(found == this->removed_person.end()) {
+      mismatch("reference to an unknown person");
+    }
+    person = found->second;
+    person->pin();
+  }
+  return person;
+}
+
+void Checkpoint::add_removed_person(Person* person) {
+  this->removed_person[person->get_id()] = person;
+}
+
+void Checkpoint::put_people(const person_vector_t & people) {
+  put_int(people.size());
+  for(int i = 0; i < people.size(); ++i) {
+    put_person(people[i]);
+  }
+}
+
+void Checkpoint::get_people(person_vector_t & people) {
+  int size = get_int();
+  people.clear();
+  people.reserve(size);
+  for(int i = 0; i < size; ++i) {
+    people.push_back(get_person());
+  }
+}
+
+void Checkpoint::put_group(Group* group) {
+  if(group == NULL) {
+    put_int(-1);
+    return;
+  }
+  put_int(group->get_type_id());
+  put_int(group->get_index());
+}
+
+Group* Checkpoint::get_group() {
+  int type_id = get_int();
+  if(type_id == -1) {
+    return NULL;
+  }
+  int index = get_int();
+  Group* group = Group::get_group(type_id, index);
+  if(group == NULL) {
+    mismatch("reference to an unknown group");
+  }
+  return group;
+}
+
+void Checkpoint::put_section(const char* name) {
+  put_string(name);
+}
+
+void Checkpoint::check_section(const char* name) {
+  if(get_string() != name) {
+    char msg[FRED_STRING_SIZE];
+    snprintf(msg, FRED_STRING_SIZE, "section %s not found", name);
+    mismatch(msg);
+  }
+}
+
+/*
+ * The header describes the program and population that wrote the
+ * checkpoint; restoring checks that the current ones match.
+ */
+void Checkpoint::put_header(int day) {
+  put_data(CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC));
+  put_int(CHECKPOINT_VERSION);
+  put_int(day);
+  put_string(Date::get_date_string(0));
+
+  int conditions = Condition::get_number_of_conditions();
+  put_int(conditions);
+  for(int condition_id = 0; condition_id < conditions; ++condition_id) {
+    Condition* condition = Condition::get_condition(condition_id);
+    put_string(condition->get_name());
+    put_int(condition->get_number_of_states());
+  }
+
+  int group_types = Group_Type::get_number_of_group_types();
+  put_int(group_types);
+  for(int type_id = 0; type_id < group_types; ++type_id) {
+    put_string(Group_Type::get_group_type(type_id)->get_name());
+    if(Group::is_a_place(type_id)) {
+      put_int(Place_Type::get_place_type(type_id)->get_number_of_places());
+    }
+    else {
+      put_int(1);
+    }
+  }
+
+  Person::save_checkpoint_header(this);
+}
+
+int Checkpoint::check_header() {
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  memset(magic, 0, sizeof(magic));
+  get_data(magic, strlen(CHECKPOINT_MAGIC));
+  if(strcmp(magic, CHECKPOINT_MAGIC) != 0) {
+    mismatch("not a FRED checkpoint file");
+  }
+  if(get_int() != CHECKPOINT_VERSION) {
+    mismatch("unsupported checkpoint version");
+  }
+  int day = get_int();
+  if(get_string() != Date::get_date_string(0)) {
+    mismatch("start date does not match");
+  }
+
+  int conditions = get_int();
+  if(conditions != Condition::get_number_of_conditions()) {
+    mismatch("number of conditions does not match");
+  }
+  for(int condition_id = 0; condition_id < conditions; ++condition_id) {
+    Condition* condition = Condition::get_condition(condition_id);
+    if(get_string() != condition->get_name()) {
+      mismatch("conditions do not match");
+    }
+    if(get_int() != condition->get_number_of_states()) {
+      mismatch("condition states do not match");
+    }
+  }
+
+  int group_types = get_int();
+  if(group_types != Group_Type::get_number_of_group_types()) {
+    mismatch("number of group types does not match");
+  }
+  for(int type_id = 0; type_id < group_types; ++type_id) {
+    if(get_string() != Group_Type::get_group_type(type_id)->get_name()) {
+      mismatch("group types do not match");
+    }
+    int groups = get_int();
+    if(Group::is_a_place(type_id) && groups != Place_Type::get_place_type(type_id)->get_number_of_places()) {
+      mismatch("number of places does not match");
+    }
+  }
+
+  Person::check_checkpoint_header(this);
+  return day;
+}
+
+void Checkpoint::save(int day) {
+  if(day != Checkpoint::checkpoint_day) {
+    return;
+  }
+  char filename[FRED_STRING_SIZE];
+  snprintf(filename, FRED_STRING_SIZE, "%s/RUN%d/checkpoint-%d.bin",
+	   Global::Simulation_directory, Global::Simulation_run_number, day);
+  Checkpoint checkpoint(filename, true);
+
+  checkpoint.put_header(day);
+
+  checkpoint.put_section("random");
+  checkpoint.put_string(Random::get_state());
+
+  checkpoint.put_section("population");
+  Person::save_population_checkpoint(&checkpoint);
+
+  checkpoint.put_section("groups");
+  for(int type_id = 0; type_id < Group_Type::get_number_of_group_types(); ++type_id) {
+    if(Group::is_a_place(type_id)) {
+      Place_Type* place_type = Place_Type::get_place_type(type_id);
+      for(int i = 0; i < place_type->get_number_of_places(); ++i) {
+	place_type->get_place(i)->save_checkpoint(&checkpoint);
+      }
+    }
+    else if(Group::is_a_network(type_id)) {
+      Network_Type::get_network(type_id)->save_checkpoint(&checkpoint);
+    }
+  }
+  Network_Type::save_checkpoint(&checkpoint);
+
+  checkpoint.put_section("epidemics");
+  for(int condition_id = 0; condition_id < Condition::get_number_of_conditions(); ++condition_id) {
+    Condition::get_condition(condition_id)->get_epidemic()->save_checkpoint(&checkpoint, day);
+  }
+
+  checkpoint.put_section("travel");
+  Travel::save_checkpoint(&checkpoint, day);
+
+  checkpoint.put_section("demographics");
+  Demographics::save_checkpoint(&checkpoint);
+
+  checkpoint.put_section("reports");
+  checkpoint.put_vector(daily_popsize);
+  for(int i = 0; i < Person::get_number_of_global_vars(); ++i) {
+    checkpoint.put_vector(daily_globals[i]);
+  }
+
+  checkpoint.put_section("end");
+  FRED_VERBOSE(0, "checkpoint for day %d written to %s\n", day, filename);
+}
+
+/*
+ * Restoring replaces the state of the freshly initialized world with
+ * the saved state.  The simulation then continues with the day after
+ * the checkpoint.
+ */
+void Checkpoint::restore() {
+  if(strcmp(Checkpoint::restore_file, "none") == 0) {
+    return;
+  }
+  Checkpoint checkpoint(Checkpoint::restore_file, false);
+
+  int day = checkpoint.check_header();
+  if(day + 1 >= Global::Simulation_Days) {
+    checkpoint.mismatch("checkpoint is at or after the last day of the simulation");
+  }
+
+  checkpoint.check_section("random");
+  std::string random_state = checkpoint.get_string();
+
+  checkpoint.check_section("population");
+  Person::restore_population_checkpoint(&checkpoint);
+
+  checkpoint.check_section("groups");
+  for(int type_id = 0; type_id < Group_Type::get_number_of_group_types(); ++type_id) {
+    if(Group::is_a_place(type_id)) {
+      Place_Type* place_type = Place_Type::get_place_type(type_id);
+      for(int i = 0; i < place_type->get_number_of_places(); ++i) {
+	place_type->get_place(i)->restore_checkpoint(&checkpoint);
+      }
+    }
+    else if(Group::is_a_network(type_id)) {
+      Network_Type::get_network(type_id)->restore_checkpoint(&checkpoint);
+    }
+  }
+  Network_Type::restore_checkpoint(&checkpoint);
+
+  checkpoint.check_section("epidemics");
+  for(int condition_id = 0; condition_id < Condition::get_number_of_conditions(); ++condition_id) {
+    Condition::get_condition(condition_id)->get_epidemic()->restore_checkpoint(&checkpoint, day);
+  }
+
+  checkpoint.check_section("travel");
+  Travel::restore_checkpoint(&checkpoint);
+
+  checkpoint.check_section("demographics");
+  Demographics::restore_checkpoint(&checkpoint);
+
+  checkpoint.check_section("reports");
+  checkpoint.get_vector(daily_popsize);
+  for(int i = 0; i < Person::get_number_of_global_vars(); ++i) {
+    checkpoint.get_vector(daily_globals[i]);
+  }
+
+  checkpoint.check_section("end");
+
+  if(Random::set_state(random_state) == false) {
+    checkpoint.mismatch("random number generator state does not match");
+  }
+
+  // move the calendar to the day after the checkpoint
+  for(int d = 0; d <= day; ++d) {
+    Date::update();
+  }
+  Checkpoint::first_day = day + 1;
+
+  // runs forked from a restored checkpoint are separated by reseeding
+  // on the first day they simulate
+  if(Global::Simulation_run_number < Global::Simulation_last_run_number
+     && 0 <= Global::Reseed_day && Global::Reseed_day < Checkpoint::first_day) {
+    Global::Reseed_day = Checkpoint::first_day;
+  }
+  FRED_VERBOSE(0, "checkpoint %s restored, continuing with day %d\n", Checkpoint::restore_file, Checkpoint::first_day);
+}
@@ -0,0 +1,167 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Checkpoint.h
+//
+
+#ifndef _FRED_CHECKPOINT_H
+#define _FRED_CHECKPOINT_H
+
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Global.h"
+
+class Group;
+class Person;
+
+/**
+ * A binary snapshot of the dynamic state of a simulation at the end of
+ * a day, from which a later invocation of FRED can continue the run.
+ *
+ * The checkpoint holds only what changes while the simulation runs:
+ * the state of each person's conditions and variables, group
+ * memberships and network edges, the epidemic counters and event
+ * queues, pending travel returns and the random number generators.
+ * Everything else (the population, places and the program) is rebuilt
+ * by the normal initialization, so a checkpoint can only be restored
+ * with the same program and population that wrote it.  The header
+ * records enough about both to detect a mismatch.
+ *
+ * Values are written in native byte order; people are written by id
+ * and groups by (type id, index), so pointers are never stored.
+ *
+ * Checkpoints are controlled by two properties:
+ *
+ *   checkpoint_day = <day>     write RUNn/checkpoint-<day>.bin after <day>
+ *   restore_checkpoint_file = <file>   continue from the given checkpoint
+ */
+class Checkpoint {
+public:
+
+  static void get_properties();
+
+  // the first day to simulate: 0, or the day after a restored checkpoint
+  static int get_first_day() {
+    return Checkpoint::first_day;
+  }
+
+  // write a checkpoint at the end of the given day if one was requested
+  static void save(int day);
+
+  // restore the checkpoint file named in the properties, if any
+  static void restore();
+
+  void put_int(int value) {
+    put_data(&value, sizeof(value));
+  }
+  int get_int() {
+    int value;
+    get_data(&value, sizeof(value));
+    return value;
+  }
+  void put_double(double value) {
+    put_data(&value, sizeof(value));
+  }
+  double get_double() {
+    double value;
+    get_data(&value, sizeof(value));
+    return value;
+  }
+  void put_bool(bool value) {
+    put_data(&value, sizeof(value));
+  }
+  bool get_bool() {
+    bool value;
+    get_data(&value, sizeof(value));
+    return value;
+  }
+  void put_string(const std::string & value);
+  std::string get_string();
+
+  // vectors of plain values (ints, doubles)
+  template <typename T>
+  void put_vector(const std::vector<T> & value) {
+    put_int(value.size());
+    if(value.size() > 0) {
+      put_data(value.data(), value.size() * sizeof(T));
+    }
+  }
+  template <typename T>
+  void get_vector(std::vector<T> & value) {
+    value.resize(get_int());
+    if(value.size() > 0) {
+      get_data(value.data(), value.size() * sizeof(T));
+    }
+  }
+
+  // people are written by id (NULL as a missing id)
+  void put_person(Person* person);
+  Person* get_person();
+  void put_people(const person_vector_t & people);
+  void get_people(person_vector_t & people);
+
+  // people removed from the population on restore can still be referred to
+  void add_removed_person(Person* person);
+
+  // groups are written by group type and index within the type
+  void put_group(Group* group);
+  Group* get_group();
+
+  // section names, checked on restore to catch a misaligned stream
+  void put_section(const char* name);
+  void check_section(const char* name);
+
+  // abort, naming the checkpoint file
+  void mismatch(const char* what);
+
+private:
+  Checkpoint(const char* filename, bool writing);
+  ~Checkpoint();
+
+  void put_data(const void* data, size_t size) {
+    if(fwrite(data, 1, size, this->fp) != size) {
+      mismatch("write failed");
+    }
+  }
+  void get_data(void* data, size_t size) {
+    if(fread(data, 1, size, this->fp) != size) {
+      mismatch("unexpected end of file");
+    }
+  }
+
+  void put_header(int day);
+  int check_header();
+
+  FILE* fp;
+  char* buffer;
+  std::string filename;
+  std::unordered_map<int, Person*> removed_person;
+
+  static int checkpoint_day;
+  static char restore_file[];
+  static int first_day;
+};
+
+#endif // _FRED_CHECKPOINT_H
@@ -19,16 +19,19 @@
  */
 
 #include "Clause.h"
+#include "Bytecode.h"
 #include "Person.h"
 #include "Predicate.h"
 
 Clause::Clause() {
   this->name = "";
+  this->program = NULL;
 }
 
 Clause::Clause(string s) {
   this->name = s;
   this->predicates.clear();
+  this->program = NULL;
 }
 
 
@@ -98,7 +101,16 @@ bool Clause::parse() {
   return true;
 }
 
+void Clause::compile() {
+  if (this->program == NULL) {
+    this->program = Bytecode::compile_clause(this);
+  }
+}
+
 bool Clause::get_value(Person* person, Person* other) {
+  if (this->program != NULL) {
+    return this->program->get_value(person, other) != 0.0;
+  }
   // printf("RULE GET_VALUE for person %d\n", person->get_id());  fflush(stdout);
   for (int i = 0; i < this->predicates.size(); i++) {
     if (predicates[i]->get_value(person, other)==false) {
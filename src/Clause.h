@@ -23,17 +23,20 @@
 
 #include "Global.h"
 
+class Bytecode;
 class Person;
 class Predicate;
 
 
 class Clause {
+  friend class Bytecode;
 public:
 
   Clause();
   Clause(string s);
   string get_name();
   bool parse();
+  void compile();
   bool get_value(Person* person, Person* other = NULL);
   bool is_warning() {
     return this->warning;
@@ -43,6 +46,7 @@ private:
   std::string name;
   std::vector<Predicate*>predicates;
   bool warning;
+  Bytecode* program;
 
 };
 
@@ -235,6 +235,14 @@ bool Condition::is_absent(int state, int group_type_id) {
   return this->natural_history->is_absent(state, group_type_id);
 }
 
+const std::bitset<64> & Condition::get_absent_groups(int state) {
+  static const std::bitset<64> none;
+  if (state < 0) {
+    return none;
+  }
+  return this->natural_history->get_absent_groups(state);
+}
+
 bool Condition::is_closed(int state, int group_type_id) {
   return this->natural_history->is_closed(state, group_type_id);
 }
@@ -171,6 +171,7 @@ public:
 
   bool is_absent(int state, int group_type_id);
   bool is_closed(int state, int group_type_id);
+  const std::bitset<64> & get_absent_groups(int state);
 
   static void include_condition(string cond) {
     int size = Condition::condition_names.size();
@@ -1340,7 +1340,7 @@ void County::set_school_probabilities() {
 
   for(int g = 0; g < Global::GRADES; ++g) {
     this->schools_attended[g].clear();
-    this->school_probabilities[g].clear();
+    this->school_sampler[g].clear();
     school_counts[g].clear();
     total[g] = 0;
   }
@@ -1391,16 +1391,18 @@ void County::set_school_probabilities() {
   // convert to probabilities
   for(int g = 0; g < Global::GRADES; ++g) {
     if(total[g] > 0) {
+      std::vector<double> school_probabilities;
       for(attendance_map_itr_t itr = school_counts[g].begin(); itr != school_counts[g].end(); ++itr) {
         int sid = itr->first;
         int count = itr->second;
         Place* school = sid_to_school[sid];
         this->schools_attended[g].push_back(school);
         double prob = (double)count / (double)total[g];
-        this->school_probabilities[g].push_back(prob);
+        school_probabilities.push_back(prob);
         FRED_VERBOSE(1,"school %s admin_code %d grade %d attended by %d prob %f\n",
             school->get_label(), school->get_county_admin_code(), g, count, prob);
       }
+      this->school_sampler[g].setup(school_probabilities);
     }
   }
   
@@ -1435,16 +1437,11 @@ Place* County::select_new_school(int grade) {
       Global::Simulation_Day, (int)this->get_admin_division_code(), grade, (int)this->schools_attended[grade].size());
 
  // pick from the attendance distribution
-  double r = Random::draw_random();
-  double sum = 0.0;
-  for(int i = 0; i < this->school_probabilities[grade].size(); ++i) {
-    sum += this->school_probabilities[grade][i];
-    if(r < sum) {
-      return this->schools_attended[grade][i];
-    }
+  if(this->school_sampler[grade].size() > 0) {
+    return this->schools_attended[grade][this->school_sampler[grade].draw()];
   }
-  FRED_VERBOSE(0,"WARNING: NO SCHOOL FOUND on day %d in admin_code = %d grade = %d schools = %d r = %f sum = %f\n",
-      Global::Simulation_Day, (int)this->get_admin_division_code(), grade, (int)this->school_probabilities[grade].size(), r, sum);
+  FRED_VERBOSE(0,"WARNING: NO SCHOOL FOUND on day %d in admin_code = %d grade = %d\n",
+      Global::Simulation_Day, (int)this->get_admin_division_code(), grade);
   // assert(r < sum);
   // this person gets to skip school this year. try again next year.
   return NULL;
@@ -1479,17 +1476,12 @@ Place* County::select_new_school_in_county(int grade) {
       Global::Simulation_Day, (int)this->get_admin_division_code(), grade, (int)this->schools_attended[grade].size());
 
  // pick from the attendance distribution
-  double r = Random::draw_random();
-  double sum = 0.0;
-  for(int i = 0; i < this->school_probabilities[grade].size(); ++i) {
-    sum += this->school_probabilities[grade][i];
-    if(r < sum) {
-      FRED_VERBOSE(1, "select_new_school successful\n");
-      return this->schools_attended[grade][i];
-    }
+  if(this->school_sampler[grade].size() > 0) {
+    FRED_VERBOSE(1, "select_new_school successful\n");
+    return this->schools_attended[grade][this->school_sampler[grade].draw()];
   }
-  FRED_VERBOSE(0,"WARNING: NO SCHOOL FOUND on day %d in admin_code = %d grade = %d schools = %d r = %f sum = %f\n",
-      Global::Simulation_Day, (int)this->get_admin_division_code(), grade, (int)this->school_probabilities[grade].size(), r, sum);
+  FRED_VERBOSE(0,"WARNING: NO SCHOOL FOUND on day %d in admin_code = %d grade = %d\n",
+      Global::Simulation_Day, (int)this->get_admin_division_code(), grade);
   
   // This person gets to skip school this year. Try again next year.
   return NULL;
@@ -1523,7 +1515,7 @@ void County::set_workplace_probabilities() {
   typedef attendance_map_t::iterator attendance_map_itr_t;
 
   this->workplaces_attended.clear();
-  this->workplace_probabilities.clear();
+  this->workplace_sampler.clear();
 
   // get number of people in this county attending each workplace
   // at the start of the simulation
@@ -1558,27 +1550,23 @@ void County::set_workplace_probabilities() {
   }
 
   // convert to probabilities
+  std::vector<double> workplace_probabilities;
   for(attendance_map_itr_t itr = workplace_counts.begin(); itr != workplace_counts.end(); ++itr) {
     int wid = itr->first;
     int count = itr->second;
     Place* workplace = wid_to_workplace[wid];
     this->workplaces_attended.push_back(workplace);
     double prob = (double)count / (double)total;
-    this->workplace_probabilities.push_back(prob);
+    workplace_probabilities.push_back(prob);
   }
+  this->workplace_sampler.setup(workplace_probabilities);
 
 }
 
 Place* County::select_new_workplace() {
-  double r = Random::draw_random();
-  double sum = 0.0;
-  for(int i = 0; i < this->workplace_probabilities.size(); ++i) {
-    sum += this->workplace_probabilities[i];
-    if(r < sum) {
-      return this->workplaces_attended[i];
-    }
+  if(this->workplace_sampler.size() > 0) {
+    return this->workplaces_attended[this->workplace_sampler.draw()];
   }
-
   return NULL;
 }
 
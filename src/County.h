@@ -33,6 +33,7 @@
 
 #include "Demographics.h"
 #include "Admin_Division.h"
+#include "Random.h"
 
 class Household;
 class Person;
@@ -204,13 +205,15 @@ class County : public Admin_Division {
   std::vector<Household*> nursing_homes;
   int number_of_nursing_homes;
 
-  // schools attended by people in this county, with probabilities
+  // schools attended by people in this county, with a sampler over
+  // their attendance probabilities
   place_vector_t schools_attended[Global::GRADES];
-  std::vector<double> school_probabilities[Global::GRADES];
+  Alias_Table school_sampler[Global::GRADES];
 
-  // workplaces attended by people in this county, with probabilities
+  // workplaces attended by people in this county, with a sampler over
+  // their attendance probabilities
   place_vector_t workplaces_attended;
-  std::vector<double> workplace_probabilities;
+  Alias_Table workplace_sampler;
 
   std::vector<int> migration_households;  //vector of household IDs for migration
  
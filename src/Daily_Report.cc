@@ -0,0 +1,142 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Daily_Report.cc
+//
+
+#include <stdio.h>
+
+#include "Daily_Report.h"
+#include "Utils.h"
+
+Daily_Report::Daily_Report() {
+  this->columns.clear();
+}
+
+Daily_Report::~Daily_Report() {
+  clear();
+}
+
+void Daily_Report::clear() {
+  for(int i = 0; i < this->columns.size(); ++i) {
+    delete this->columns[i];
+  }
+  this->columns.clear();
+}
+
+void Daily_Report::add_column(string name, const int* values) {
+  column_t* column = new column_t;
+  column->name = name;
+  column->type = INT_COLUMN;
+  column->int_values.assign(values, values + Global::Simulation_Days);
+  this->columns.push_back(column);
+}
+
+void Daily_Report::add_column(string name, const std::vector<int> & values) {
+  column_t* column = new column_t;
+  column->name = name;
+  column->type = INT_COLUMN;
+  column->int_values = values;
+  this->columns.push_back(column);
+}
+
+void Daily_Report::add_column(string name, const std::vector<double> & values) {
+  column_t* column = new column_t;
+  column->name = name;
+  column->type = DOUBLE_COLUMN;
+  column->double_values = values;
+  this->columns.push_back(column);
+}
+
+void Daily_Report::add_column(string name, const std::vector<string> & values) {
+  column_t* column = new column_t;
+  column->name = name;
+  column->type = STRING_COLUMN;
+  column->string_values = values;
+  this->columns.push_back(column);
+}
+
+void Daily_Report::add_columns(Daily_Report* report) {
+  for(int i = 0; i < report->columns.size(); ++i) {
+    this->columns.push_back(new column_t(*report->columns[i]));
+  }
+}
+
+int Daily_Report::format_value(char* buffer, int size, column_t* column, int day) {
+  switch(column->type) {
+  case INT_COLUMN:
+    return snprintf(buffer, size, "%d", column->int_values[day]);
+  case DOUBLE_COLUMN:
+    return snprintf(buffer, size, "%f", column->double_values[day]);
+  default:
+    return snprintf(buffer, size, "%s", column->string_values[day].c_str());
+  }
+}
+
+void Daily_Report::write_daily_files(const char* dir) {
+  char outfile[FRED_STRING_SIZE];
+  char value[FRED_STRING_SIZE];
+  for(int i = 0; i < this->columns.size(); ++i) {
+    column_t* column = this->columns[i];
+    sprintf(outfile, "%s/%s.txt", dir, column->name.c_str());
+    FILE* fp = fopen(outfile, "w");
+    if(fp == NULL) {
+      Utils::fred_abort("Fred: can't open file %s\n", outfile);
+    }
+    for(int day = 0; day < Global::Simulation_Days; ++day) {
+      format_value(value, FRED_STRING_SIZE, column, day);
+      fprintf(fp, "%d %s\n", day, value);
+    }
+    fclose(fp);
+  }
+}
+
+void Daily_Report::write_csv(const char* filename, bool space_after_day) {
+  FILE* fp = fopen(filename, "w");
+  if(fp == NULL) {
+    Utils::fred_abort("Fred: can't open file %s\n", filename);
+  }
+  const char* day_sep = space_after_day ? " " : ",";
+  int number_of_columns = this->columns.size();
+
+  fputs("Day", fp);
+  for(int i = 0; i < number_of_columns; ++i) {
+    fputs(i == 0 ? day_sep : ",", fp);
+    fputs(this->columns[i]->name.c_str(), fp);
+  }
+  fputc('\n', fp);
+
+  // a report without columns has only the header line
+  if(number_of_columns > 0) {
+    char value[FRED_STRING_SIZE];
+    for(int day = 0; day < Global::Simulation_Days; ++day) {
+      fprintf(fp, "%d", day);
+      for(int i = 0; i < number_of_columns; ++i) {
+	fputs(i == 0 ? day_sep : ",", fp);
+	int len = format_value(value, FRED_STRING_SIZE, this->columns[i], day);
+	fwrite(value, 1, len < FRED_STRING_SIZE ? len : FRED_STRING_SIZE - 1, fp);
+      }
+      fputc('\n', fp);
+    }
+  }
+  fclose(fp);
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Daily_Report.h
+//
+
+#ifndef _FRED_DAILY_REPORT_H
+#define _FRED_DAILY_REPORT_H
+
+#include <string>
+#include <vector>
+
+#include "Global.h"
+
+using namespace std;
+
+/**
+ * A table of day-indexed columns, kept in memory until the end of the
+ * run and then written as a csv file in one pass.  Each column can also
+ * be written as a text file of "day value" lines in the DAILY directory.
+ */
+class Daily_Report {
+public:
+  Daily_Report();
+  ~Daily_Report();
+
+  // add a column with one value for each day of the run
+  void add_column(string name, const int* values);
+  void add_column(string name, const std::vector<int> & values);
+  void add_column(string name, const std::vector<double> & values);
+  void add_column(string name, const std::vector<string> & values);
+
+  // append the columns of another report
+  void add_columns(Daily_Report* report);
+
+  int get_number_of_columns() {
+    return this->columns.size();
+  }
+
+  void clear();
+
+  // write each column to dir/<name>.txt
+  void write_daily_files(const char* dir);
+
+  /**
+   * Write the header line and one line per day, with the fields
+   * separated by commas.  If space_after_day is set, the day is
+   * separated from the other fields by a space instead.
+   */
+  void write_csv(const char* filename, bool space_after_day);
+
+private:
+  enum column_type_t {
+    INT_COLUMN,
+    DOUBLE_COLUMN,
+    STRING_COLUMN
+  };
+
+  typedef struct {
+    string name;
+    column_type_t type;
+    std::vector<int> int_values;
+    std::vector<double> double_values;
+    std::vector<string> string_values;
+  } column_t;
+
+  int format_value(char* buffer, int size, column_t* column, int day);
+
+  std::vector<column_t*> columns;
+};
+
+#endif // _FRED_DAILY_REPORT_H
@@ -25,6 +25,7 @@
 #include <limits>
 
 #include "Demographics.h"
+#include "Checkpoint.h"
 #include "Property.h"
 #include "Person.h"
 #include "Global.h"
@@ -49,8 +50,19 @@ void Demographics::initialize_static_variables() {
   Property::get_property("enable_aging", &Demographics::enable_aging);
   Property::set_abort_on_failure();
 
+  open_output_files();
+}
+
+void Demographics::open_output_files() {
+
   // create file pointers if needed
   if(Global::Enable_Population_Dynamics || Demographics::enable_aging) {
+    if(Global::Birthfp != NULL) {
+      fclose(Global::Birthfp);
+    }
+    if(Global::Deathfp != NULL) {
+      fclose(Global::Deathfp);
+    }
     int run = Global::Simulation_run_number;
     char filename[FRED_STRING_SIZE];
     char directory[FRED_STRING_SIZE];
@@ -162,4 +174,20 @@ void Demographics::terminate(Person* self) {
   }
 }
 
+void Demographics::save_checkpoint(Checkpoint* checkpoint) {
+  checkpoint->put_int(Demographics::births_today);
+  checkpoint->put_int(Demographics::births_ytd);
+  checkpoint->put_int(Demographics::total_births);
+  checkpoint->put_int(Demographics::deaths_today);
+  checkpoint->put_int(Demographics::deaths_ytd);
+  checkpoint->put_int(Demographics::total_deaths);
+}
 
+void Demographics::restore_checkpoint(Checkpoint* checkpoint) {
+  Demographics::births_today = checkpoint->get_int();
+  Demographics::births_ytd = checkpoint->get_int();
+  Demographics::total_births = checkpoint->get_int();
+  Demographics::deaths_today = checkpoint->get_int();
+  Demographics::deaths_ytd = checkpoint->get_int();
+  Demographics::total_deaths = checkpoint->get_int();
+}
@@ -33,6 +33,7 @@
 
 using namespace std;
 
+class Checkpoint;
 class Person;
 
 class Demographics {
@@ -49,6 +50,7 @@ public:
   static const double STDDEV_PREG_DAYS;
 
   static void initialize_static_variables();
+  static void open_output_files();
   static void update(int day);
   static void report(int day); 
   static int find_admin_code(int n);
@@ -68,6 +70,8 @@ public:
     return Demographics::total_deaths;
   }
   static void terminate(Person* self);
+  static void save_checkpoint(Checkpoint* checkpoint);
+  static void restore_checkpoint(Checkpoint* checkpoint);
 
 private:
   static int births_today;
@@ -0,0 +1,203 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Dense_Set.h
+//
+
+#ifndef _FRED_DENSE_SET_H
+#define _FRED_DENSE_SET_H
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A set of Person or Place pointers, addressed by the integer id of
+ * each element.  Membership is kept in a flat array indexed by id, so
+ * insert(), erase() and contains() take constant time.  Elements are
+ * stored in a compact vector; erased elements are dropped and new ones
+ * merged into place the next time the set is iterated, so iteration is
+ * always in increasing id order (the same order as a std::set sorted by
+ * id).  Negative ids (used by meta agents) are supported.
+ *
+ * The set must not be modified while it is being iterated.
+ */
+template <typename T>
+class Dense_Set {
+
+  typedef struct {
+    int id;
+    T* item;
+  } entry_t;
+
+public:
+
+  class iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T* value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T** pointer;
+    typedef T*& reference;
+
+    iterator(entry_t* _ptr) : ptr(_ptr) {}
+    T*& operator*() const {
+      return ptr->item;
+    }
+    iterator & operator++() {
+      ++ptr;
+      return *this;
+    }
+    bool operator==(const iterator & other) const {
+      return ptr == other.ptr;
+    }
+    bool operator!=(const iterator & other) const {
+      return ptr != other.ptr;
+    }
+  private:
+    entry_t* ptr;
+  };
+
+  Dense_Set() {
+    this->number_erased = 0;
+    this->sorted_size = 0;
+  }
+
+  void insert(T* item) {
+    int id = item->get_id();
+    unsigned char & state = get_state(id);
+    if (state == PRESENT) {
+      return;
+    }
+    if (state == ERASED) {
+      // still in the element vector
+      state = PRESENT;
+      --(this->number_erased);
+      return;
+    }
+    state = PRESENT;
+    entry_t entry = { id, item };
+    this->elements.push_back(entry);
+  }
+
+  void erase(T* item) {
+    int id = item->get_id();
+    if (contains_id(id)) {
+      get_state(id) = ERASED;
+      ++(this->number_erased);
+    }
+  }
+
+  bool contains(T* item) const {
+    return contains_id(item->get_id());
+  }
+
+  int size() const {
+    return (int) this->elements.size() - this->number_erased;
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  void clear() {
+    for (int i = 0; i < this->elements.size(); ++i) {
+      get_state(this->elements[i].id) = ABSENT;
+    }
+    this->elements.clear();
+    this->number_erased = 0;
+    this->sorted_size = 0;
+  }
+
+  iterator begin() {
+    refresh();
+    return iterator(this->elements.data());
+  }
+
+  iterator end() {
+    refresh();
+    return iterator(this->elements.data() + this->elements.size());
+  }
+
+private:
+
+  enum { ABSENT = 0, PRESENT = 1, ERASED = 2 };
+
+  static bool compare_entry_id(const entry_t & x, const entry_t & y) {
+    return x.id < y.id;
+  }
+
+  bool contains_id(int id) const {
+    const std::vector<unsigned char> & states = id < 0 ? this->meta_state : this->state;
+    int pos = id < 0 ? -id - 1 : id;
+    return pos < states.size() && states[pos] == PRESENT;
+  }
+
+  unsigned char & get_state(int id) {
+    std::vector<unsigned char> & states = id < 0 ? this->meta_state : this->state;
+    int pos = id < 0 ? -id - 1 : id;
+    if (pos >= states.size()) {
+      states.resize(std::max(2 * states.size(), (size_t) pos + 1), ABSENT);
+    }
+    return states[pos];
+  }
+
+  // drop erased elements and merge newly inserted ones into id order
+  void refresh() {
+    if (this->number_erased > 0) {
+      int kept = 0;
+      int kept_sorted = 0;
+      for (int i = 0; i < this->elements.size(); ++i) {
+	unsigned char & state = get_state(this->elements[i].id);
+	if (state == ERASED) {
+	  state = ABSENT;
+	  continue;
+	}
+	if (i < this->sorted_size) {
+	  ++kept_sorted;
+	}
+	this->elements[kept++] = this->elements[i];
+      }
+      this->elements.resize(kept);
+      this->sorted_size = kept_sorted;
+      this->number_erased = 0;
+    }
+    if (this->sorted_size < this->elements.size()) {
+      typename std::vector<entry_t>::iterator middle = this->elements.begin() + this->sorted_size;
+      std::sort(middle, this->elements.end(), compare_entry_id);
+      std::inplace_merge(this->elements.begin(), middle, this->elements.end(), compare_entry_id);
+      this->sorted_size = this->elements.size();
+    }
+  }
+
+  std::vector<entry_t> elements;
+  int number_erased;
+  int sorted_size;
+
+  // membership state by id, and by (-id-1) for negative ids
+  std::vector<unsigned char> state;
+  std::vector<unsigned char> meta_state;
+};
+
+#endif // _FRED_DENSE_SET_H
@@ -30,9 +30,11 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <algorithm>
 
 using namespace std;
 
+#include "Checkpoint.h"
 #include "Condition.h"
 #include "Date.h"
 #include "Epidemic.h"
@@ -50,7 +52,9 @@ using namespace std;
 #include "Person.h"
 #include "Place.h"
 #include "Place_Type.h"
+#include "Proximity_Transmission.h"
 #include "Random.h"
+#include "Record_Log.h"
 #include "Rule.h"
 #include "Transmission.h"
 #include "Utils.h"
@@ -100,8 +104,8 @@ Epidemic::Epidemic(Condition* _condition) {
   this->new_exposed_people_list.clear();
   this->active_people_list.clear();
   this->transmissible_people_list.clear();
-  this->group_state_count.clear();
-  this->total_group_state_count.clear();
+  this->group_state_count = NULL;
+  this->total_group_state_count = NULL;
   this->susceptible_count = 0;
 
   this->vis_case_fatality_loc_list.clear();
@@ -109,8 +113,14 @@ Epidemic::Epidemic(Condition* _condition) {
 }
 
 Epidemic::~Epidemic() {
-  this->group_state_count.clear();
-  this->total_group_state_count.clear();
+  if (this->group_state_count != NULL) {
+    for (int state = 0; state < this->number_of_states; state++) {
+      delete[] this->group_state_count[state];
+      delete[] this->total_group_state_count[state];
+    }
+    delete[] this->group_state_count;
+    delete[] this->total_group_state_count;
+  }
 }
 
 //////////////////////////////////////////////////////
@@ -139,18 +149,6 @@ void Epidemic::setup() {
   this->number_of_states = this->natural_history->get_number_of_states();
   // FRED_VERBOSE(0, "Epidemic::setup states = %d\n", this->number_of_states);
 
-  //vectors of group state counts, size to number of states
-  this->group_state_count.reserve(this->number_of_states);
-  for (int i=0; i < this->number_of_states; i++) {
-    group_counter_t new_counter;
-    this->group_state_count.push_back(new_counter);
-  }
-  this->total_group_state_count.reserve(this->number_of_states);
-  for (int i=0; i < this->number_of_states; i++) {
-    group_counter_t new_counter;
-    this->total_group_state_count.push_back(new_counter);
-  }
-
   // initialize state counters
   this->incidence_count = new int [this->number_of_states];
   this->total_count = new int [this->number_of_states];
@@ -241,6 +239,15 @@ void Epidemic::prepare_to_track_counts() {
       this->track_counts_for_group_state[state][type] = false;
     }
   }
+
+  // the counters are sized in prepare(), once the rules have said
+  // which group types to track
+  this->group_state_count = new int_vector_t* [this->number_of_states];
+  this->total_group_state_count = new int_vector_t* [this->number_of_states];
+  for (int state = 0; state < this->number_of_states; state++) {
+    this->group_state_count[state] = new int_vector_t [number_of_group_types];
+    this->total_group_state_count[state] = new int_vector_t [number_of_group_types];
+  }
 }
 
 
@@ -262,6 +269,11 @@ void Epidemic::prepare() {
 	       this->name, 
 	       this->natural_history->get_state_name(state).c_str(),
 	       Group_Type::get_group_type_name(type).c_str());
+	int number_of_groups = Group::get_number_of_groups(type);
+	if (this->group_state_count[state][type].size() < number_of_groups) {
+	  this->group_state_count[state][type].resize(number_of_groups, 0);
+	  this->total_group_state_count[state][type].resize(number_of_groups, 0);
+	}
       }
     }
   }
@@ -366,9 +378,16 @@ void Epidemic::update(int day, int hour) {
   FRED_VERBOSE(1, "TRANSITION_EVENT_QUEUE day %d %s hour %d cond %s size %d\n",
 	       day, Date::get_date_string().c_str(), hour, this->name, size);
 
+  prepare_batch_transitions(step, size);
+  int nstates = this->natural_history->get_number_of_states();
   for(int i = 0; i < size; ++i) {
     Person* person = this->state_transition_event_queue.get_event(step, i);
-    update_state(person, day, hour, -1, 0);
+    double* transition_prob = NULL;
+    if (0 <= this->batch_state[i] && this->batch_people[i] == person &&
+	person->get_state(this->id) == this->batch_state[i]) {
+      transition_prob = &(this->batch_prob[i * nstates]);
+    }
+    update_state(person, day, hour, -1, 0, transition_prob);
   }
   this->state_transition_event_queue.clear_events(step);
 
@@ -537,6 +556,10 @@ void Epidemic::find_active_places_of_type(int day, int hour, int place_type_id)
 }
   
 void Epidemic::transmission_in_active_places(int day, int hour, int time_block) {
+  if (Global::Enable_Parallel_Transmission) {
+    parallel_transmission_in_active_places(day, hour, time_block);
+    return;
+  }
   // FRED_VERBOSE(0, "transmission_in_active_places day %d hour %d places %lu\n", day, hour, active_places_list.size());
   for(place_set_iterator itr = active_places_list.begin(); itr != this->active_places_list.end(); ++itr) {
     Place* place = *itr;
@@ -550,6 +573,80 @@ void Epidemic::transmission_in_active_places(int day, int hour, int time_block)
 }
 
 
+void Epidemic::parallel_transmission_in_active_places(int day, int hour, int time_block) {
+
+  // places are processed in id order, so results do not depend on
+  // the number of threads
+  place_vector_t places(this->active_places_list.begin(), this->active_places_list.end());
+  int number_of_places = places.size();
+  if (number_of_places == 0) {
+    return;
+  }
+
+  // the conditions this one passes on
+  std::vector<int> transmitted;
+  for (int state = 0; state < this->condition->get_number_of_states(); ++state) {
+    int condition_to_transmit = this->condition->get_condition_to_transmit(state);
+    if (std::find(transmitted.begin(), transmitted.end(), condition_to_transmit) == transmitted.end()) {
+      transmitted.push_back(condition_to_transmit);
+    }
+  }
+
+  // update_activities() may draw random numbers and change neighborhood
+  // memberships, so bring every potential host up to date serially
+  // before any place is processed in parallel.
+  person_vector_t members;
+  for (int i = 0; i < number_of_places; ++i) {
+    Place* place = places[i];
+    members.assign(place->get_members()->begin(), place->get_members()->end());
+    for (int j = 0; j < members.size(); ++j) {
+      members[j]->update_activities(day);
+    }
+  }
+
+  // members who are present and susceptible form each place's view of
+  // possible hosts
+  std::vector<person_vector_t> susceptibles(number_of_places);
+  for (int i = 0; i < number_of_places; ++i) {
+    Place* place = places[i];
+    person_vector_t* place_members = place->get_members();
+    for (int j = 0; j < place_members->size(); ++j) {
+      Person* member = (*place_members)[j];
+      if (member->is_present(day, place) == false) {
+	continue;
+      }
+      for (int k = 0; k < transmitted.size(); ++k) {
+	if (member->is_susceptible(transmitted[k])) {
+	  susceptibles[i].push_back(member);
+	  break;
+	}
+      }
+    }
+  }
+
+  // select exposures in each place using a random stream keyed by
+  // (seed, day, hour, condition, place); the seed follows any reseeding
+  Proximity_Transmission* transmission = static_cast<Proximity_Transmission*>(this->condition->get_transmission());
+  std::vector<exposure_vector_t> exposures(number_of_places);
+
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < number_of_places; ++i) {
+    Place* place = places[i];
+    Stream_RNG rng(Random::get_seed(), day, hour, this->id, place->get_id());
+    transmission->select_exposures(day, hour, this->id, place, time_block, &susceptibles[i], &rng, &exposures[i]);
+  }
+
+  // commit exposures in place order; a host exposed in an earlier place
+  // is skipped in later ones
+  for (int i = 0; i < number_of_places; ++i) {
+    for (int j = 0; j < exposures[i].size(); ++j) {
+      transmission->commit_exposure(exposures[i][j], day, hour);
+    }
+    places[i]->clear_transmissible_people(this->id);
+  }
+}
+
+
 //////////////////////////////////////////////////////////////
 //
 // HANDLING CHANGES TO AN INDIVIDUAL'S STATUS
@@ -580,18 +677,16 @@ void Epidemic::inactivate(Person* person, int day, int hour) {
 
   FRED_VERBOSE(1, "inactivate day %d person %d\n", day, person->get_id());
   
-  person_set_iterator itr = this->transmissible_people_list.find(person);
-  if(itr != this->transmissible_people_list.end()) {
+  if(this->transmissible_people_list.contains(person)) {
     // delete from transmissible list
     // FRED_VERBOSE(0, "DELETE inactive from TRANSMISSIBLE_PEOPLE_LIST day %d hour %d person %d\n", day, hour, person->get_id());
-    this->transmissible_people_list.erase(itr);
+    this->transmissible_people_list.erase(person);
   }
 
-  itr = this->active_people_list.find(person);
-  if(itr != this->active_people_list.end()) {
+  if(this->active_people_list.contains(person)) {
     // delete from active list
     FRED_VERBOSE(1, "DELETE from ACTIVE_PEOPLE_LIST day %d person %d\n", Global::Simulation_Day, person->get_id());
-    this->active_people_list.erase(itr);
+    this->active_people_list.erase(person);
   }
 
   if (this->enable_visualization) {
@@ -642,7 +737,7 @@ void Epidemic::terminate_person(Person* person, int day) {
   int transition_step = person->get_next_transition_step(this->id);
   if (24*day <= transition_step) {
     // printf("person %d delete_event for transition_step %d\n", person->get_id(), transition_step);
-    this->state_transition_event_queue.delete_event(transition_step, person);
+    this->state_transition_event_queue.delete_event(transition_step, person, person->get_transition_event_handle(this->id));
   }
   person->set_next_transition_step(this->id, -1);
 
@@ -855,24 +950,67 @@ void Epidemic::delete_from_epidemic_lists(Person* person) {
   // this only happens for terminated people
   FRED_VERBOSE(1, "deleting terminated person %d from active_people_list list\n", person->get_id());
 
-  person_set_iterator itr = this->active_people_list.find(person);
-  if(itr != this->active_people_list.end()) {
+  if(this->active_people_list.contains(person)) {
     // delete from active list
     FRED_VERBOSE(1, "DELETE from ACTIVE_PEOPLE_LIST day %d person %d\n", Global::Simulation_Day, person->get_id());
-    this->active_people_list.erase(itr);
+    this->active_people_list.erase(person);
   }
 
-  itr = this->transmissible_people_list.find(person);
-  if(itr != this->transmissible_people_list.end()) {
+  if(this->transmissible_people_list.contains(person)) {
     // delete from transmissible list
     FRED_VERBOSE(1, "DELETE from TRANSMISSIBLE_PEOPLE_LIST day %d person %d\n", Global::Simulation_Day, person->get_id());
-    this->transmissible_people_list.erase(itr);
+    this->transmissible_people_list.erase(person);
+  }
+
+}
+
+
+void Epidemic::prepare_batch_transitions(int step, int size) {
+  int nstates = this->natural_history->get_number_of_states();
+  this->batch_people.resize(size);
+  this->batch_state.assign(size, -1);
+  this->batch_members.resize(nstates);
+  this->batch_index.resize(nstates);
+  for (int state = 0; state < nstates; state++) {
+    this->batch_members[state].clear();
+    this->batch_index[state].clear();
+  }
+  if (size < 2) {
+    return;
   }
 
+  // group the people in this bucket by their current state
+  for (int i = 0; i < size; ++i) {
+    Person* person = this->state_transition_event_queue.get_event(step, i);
+    int state = person->get_state(this->id);
+    this->batch_people[i] = person;
+    if (0 <= state && this->natural_history->has_batch_next_rules(state)) {
+      this->batch_members[state].push_back(person);
+      this->batch_index[state].push_back(i);
+    }
+  }
+
+  // evaluate the next rules once per state for everyone in it
+  this->batch_prob.resize(size * nstates);
+  for (int state = 0; state < nstates; state++) {
+    int n = this->batch_members[state].size();
+    if (n == 0) {
+      continue;
+    }
+    this->batch_member_prob.resize(n * nstates);
+    this->natural_history->get_transition_probs(this->batch_members[state].data(), n, state,
+						this->batch_member_prob.data());
+    for (int k = 0; k < n; k++) {
+      int i = this->batch_index[state][k];
+      std::copy(&(this->batch_member_prob[k * nstates]), &(this->batch_member_prob[k * nstates]) + nstates,
+		&(this->batch_prob[i * nstates]));
+      this->batch_state[i] = state;
+    }
+  }
 }
 
 
-void Epidemic::update_state(Person* person, int day, int hour, int new_state, int loop_counter) {
+void Epidemic::update_state(Person* person, int day, int hour, int new_state, int loop_counter, double* transition_prob) {
 
   int step = 24*day + hour;
   int old_state = person->get_state(this->id);
@@ -886,7 +1024,13 @@ void Epidemic::update_state(Person* person, int day, int hour, int new_state, in
 
   if (new_state < 0) {
     // this is a scheduled state transition
-    new_state = this->natural_history->get_next_state(person, old_state);
+    if (transition_prob != NULL) {
+      // transition probabilities were already computed for a batch
+      new_state = this->natural_history->select_next_state(old_state, transition_prob);
+    }
+    else {
+      new_state = this->natural_history->get_next_state(person, old_state);
+    }
 
     if (0) {
       FRED_VERBOSE(0, "UPDATE_STATE day %d hour %d person %d age %0.2f old_state %s SCHEDULED TRANSITION TO new_state %s\n", 
@@ -912,7 +1056,7 @@ void Epidemic::update_state(Person* person, int day, int hour, int new_state, in
     int transition_step = person->get_next_transition_step(this->id);
     if (step <= transition_step) {
       // printf("person %d delete_event for transition_step %d\n", person->get_id(), transition_step);
-      this->state_transition_event_queue.delete_event(transition_step, person);
+      this->state_transition_event_queue.delete_event(transition_step, person, person->get_transition_event_handle(this->id));
     }
   }
 
@@ -938,10 +1082,10 @@ void Epidemic::update_state(Person* person, int day, int hour, int new_state, in
     if (person->is_meta_agent()) {
       FRED_VERBOSE(1, "UPDATE_STATE META cond %s day %d hour %d adding person %d with old_state %d new_state %d step %d to meta_agent_transition_event_queue for step %d\n",
 		   this->name, day, hour, person->get_id(), old_state, new_state, step, transition_step);
-      this->meta_agent_transition_event_queue.add_event(transition_step, person);
+      this->meta_agent_transition_event_queue.add_event(transition_step, person, person->get_transition_event_handle(this->id));
     }
     else {
-      this->state_transition_event_queue.add_event(transition_step, person);
+      this->state_transition_event_queue.add_event(transition_step, person, person->get_transition_event_handle(this->id));
     }
 
     person->set_next_transition_step(this->id, transition_step);
@@ -1014,7 +1158,7 @@ void Epidemic::update_state(Person* person, int day, int hour, int new_state, in
     }
 
     if (this->natural_history->is_dormant_state(new_state) == false && 
-	this->active_people_list.find(person) == this->active_people_list.end()) {
+	this->active_people_list.contains(person) == false) {
       become_active(person, day);
     }
 
@@ -1037,15 +1181,12 @@ void Epidemic::update_state(Person* person, int day, int hour, int new_state, in
     // update person health record
     if (0 <= old_state && this->enable_health_records && Global::Enable_Records) {
       if (0 <= new_state && this->natural_history->get_state_name(new_state)!="Excluded") {
-	char tmp[FRED_STRING_SIZE];
-	person->get_record_string(tmp);
-	fprintf(Global::Recordsfp,
-		"%s CONDITION %s CHANGES from %s to %s\n",
-		tmp,
+	person->print_record_string();
+	Record_Log::print(
+		" CONDITION %s CHANGES from %s to %s\n",
 		this->name,
 		old_state>=0 ? this->natural_history->get_state_name(old_state).c_str() : "-1",
 		new_state>=0 ? this->natural_history->get_state_name(new_state).c_str() : "-1");
-	fflush(Global::Recordsfp);
       }
     }
 
@@ -1079,15 +1220,12 @@ void Epidemic::update_state(Person* person, int day, int hour, int new_state, in
     if (0) {
       // update person health record
       if (this->enable_health_records && Global::Enable_Records) {
-	char tmp[FRED_STRING_SIZE];
-	person->get_record_string(tmp);
-	fprintf(Global::Recordsfp,
-		"%s CONDITION %s STATE %s STAYS %s\n",
-		tmp,
+	person->print_record_string();
+	Record_Log::print(
+		" CONDITION %s STATE %s STAYS %s\n",
 		this->name,
 		old_state>=0 ? this->natural_history->get_state_name(old_state).c_str() : "-1",
 		new_state>=0 ? this->natural_history->get_state_name(new_state).c_str() : "-1");
-	fflush(Global::Recordsfp);
       }
     } // end DEBUGGING
 
@@ -1117,10 +1255,7 @@ void Epidemic::update_state(Person* person, int day, int hour, int new_state, in
   }
   if (!is_now_transmissible && was_transmissible) {
     // delete from transmissible list
-    person_set_iterator itr = this->transmissible_people_list.find(person);
-    if(itr != this->transmissible_people_list.end()) {
-      this->transmissible_people_list.erase(itr);
-    }
+    this->transmissible_people_list.erase(person);
   }
   
   // does entering this state cause agent to starting hosting?
@@ -1163,136 +1298,44 @@ void Epidemic::update_state(Person* person, int day, int hour, int new_state, in
 
 void Epidemic::finish() {
 
-  char dir[FRED_STRING_SIZE];
-  char outfile[FRED_STRING_SIZE];
-  FILE* fp;
-
-  sprintf(dir, "%s/RUN%d/DAILY",
-	  Global::Simulation_directory,
-	  Global::Simulation_run_number);
-  Utils::fred_make_directory(dir);
-
+  this->daily_report.clear();
   for (int i = 0; i < this->number_of_states; i++) {
-    sprintf(outfile, "%s/%s.new%s.txt",
-	    dir,
-	    this->name,
-	    this->natural_history->get_state_name(i).c_str());
-    fp = fopen(outfile, "w");
-    if (fp == NULL) {
-      Utils::fred_abort("Fred: can open file %s\n", outfile);
-    }
-    for (int day = 0; day < Global::Simulation_Days; day++) {
-      fprintf(fp, "%d %d\n", day, this->daily_incidence_count[i][day]);
-    }
-    fclose(fp);
-
-    sprintf(outfile, "%s/%s.%s.txt",
-	    dir,
-	    this->name,
-	    this->natural_history->get_state_name(i).c_str());
-    fp = fopen(outfile, "w");
-    if (fp == NULL) {
-      Utils::fred_abort("Fred: can open file %s\n", outfile);
-    }
+    string state_name = this->natural_history->get_state_name(i);
+    std::vector<int> tot;
+    int total = 0;
     for (int day = 0; day < Global::Simulation_Days; day++) {
-      fprintf(fp, "%d %d\n", day, this->daily_current_count[i][day]);
+      total += this->daily_incidence_count[i][day];
+      tot.push_back(total);
     }
-    fclose(fp);
-
-    sprintf(outfile, "%s/%s.tot%s.txt",
-	    dir,
-	    this->name,
-	    this->natural_history->get_state_name(i).c_str());
-    fp = fopen(outfile, "w");
-    if (fp == NULL) {
-      Utils::fred_abort("Fred: can open file %s\n", outfile);
-    }
-    int tot = 0;
-    for (int day = 0; day < Global::Simulation_Days; day++) {
-      tot += this->daily_incidence_count[i][day];
-      fprintf(fp, "%d %d\n", day, tot);
-    }
-    fclose(fp);
+    this->daily_report.add_column(string(this->name) + ".new" + state_name, this->daily_incidence_count[i]);
+    this->daily_report.add_column(string(this->name) + "." + state_name, this->daily_current_count[i]);
+    this->daily_report.add_column(string(this->name) + ".tot" + state_name, tot);
   }
 
   // reproductive rate
-  sprintf(outfile, "%s/%s.RR.txt",
-	  dir,
-	  this->name);
-  fp = fopen(outfile, "w");
-  if (fp == NULL) {
-    Utils::fred_abort("Fred: can open file %s\n", outfile);
-  }
+  std::vector<double> rr;
   for (int day = 0; day < Global::Simulation_Days; day++) {
-    double rr = 0.0;
+    double value = 0.0;
     if (this->daily_cohort_size[day] > 0) {
-      rr = static_cast<double>(this->number_infected_by_cohort[day]) / static_cast<double>(this->daily_cohort_size[day]);
+      value = static_cast<double>(this->number_infected_by_cohort[day]) / static_cast<double>(this->daily_cohort_size[day]);
     }
-    fprintf(fp, "%d %f\n", day, rr);
+    rr.push_back(value);
   }
-  fclose(fp);
-
-  // create a csv file for this condition
-
-  // this joins two files with same value in column 1, from
-  // https://stackoverflow.com/questions/14984340/using-awk-to-process-input-from-multiple-files
-  char awkcommand[FRED_STRING_SIZE];
-  sprintf(awkcommand, "awk 'FNR==NR{a[$1]=$2 FS $3;next}{print $0, a[$1]}' ");
-
-  char command[FRED_STRING_SIZE];
-  char dailyfile[FRED_STRING_SIZE];
-  sprintf(outfile, "%s/RUN%d/%s.csv", Global::Simulation_directory, Global::Simulation_run_number, this->name);
+  this->daily_report.add_column(string(this->name) + ".RR", rr);
 
-  sprintf(dailyfile, "%s/%s.new%s.txt", dir, this->name, this->natural_history->get_state_name(0).c_str());
-  sprintf(command, "cp %s %s", dailyfile, outfile);
-  system(command);
-
-  for (int i = 0; i < this->number_of_states; i++) {
-    if (i > 0) {
-      sprintf(dailyfile, "%s/%s.new%s.txt", dir, this->name, this->natural_history->get_state_name(i).c_str());
-      sprintf(command, "%s %s %s > %s.tmp; mv %s.tmp %s",
-	      awkcommand, dailyfile, outfile, outfile, outfile, outfile);
-      system(command);
-    }
-    
-    sprintf(dailyfile, "%s/%s.%s.txt", dir, this->name, this->natural_history->get_state_name(i).c_str());
-    sprintf(command, "%s %s %s > %s.tmp; mv %s.tmp %s",
-	    awkcommand, dailyfile, outfile, outfile, outfile, outfile);
-    system(command);
-    
-    sprintf(dailyfile, "%s/%s.tot%s.txt", dir, this->name, this->natural_history->get_state_name(i).c_str());
-    sprintf(command, "%s %s %s > %s.tmp; mv %s.tmp %s",
-	    awkcommand, dailyfile, outfile, outfile, outfile, outfile);
-    system(command);
-  }  
-  sprintf(dailyfile, "%s/%s.RR.txt", dir, this->name);
-  sprintf(command, "%s %s %s > %s.tmp; mv %s.tmp %s",
-	  awkcommand, dailyfile, outfile, outfile, outfile, outfile);
-  system(command);
-
-  // create a header line for the csv file
-  char headerfile[FRED_STRING_SIZE];
-  sprintf(headerfile, "%s/RUN%d/%s.header", Global::Simulation_directory, Global::Simulation_run_number, this->name);
-  fp = fopen(headerfile, "w");
-  fprintf(fp, "Day ");
-  for (int i = 0; i < this->number_of_states; i++) {
-    fprintf(fp, "%s.new%s ", this->name, this->natural_history->get_state_name(i).c_str());
-    fprintf(fp, "%s.%s ", this->name, this->natural_history->get_state_name(i).c_str());
-    fprintf(fp, "%s.tot%s ", this->name, this->natural_history->get_state_name(i).c_str());
+  if (Global::Enable_Daily_Text_Files) {
+    char dir[FRED_STRING_SIZE];
+    sprintf(dir, "%s/RUN%d/DAILY",
+	    Global::Simulation_directory,
+	    Global::Simulation_run_number);
+    Utils::fred_make_directory(dir);
+    this->daily_report.write_daily_files(dir);
   }
-  fprintf(fp, "%s.RR\n", this->name);
-  fclose(fp);
-
-  // concatenate header line
-  sprintf(command, "cat %s %s > %s.tmp; mv %s.tmp %s; unlink %s",
-	  headerfile, outfile, outfile, outfile, outfile, headerfile);
-  system(command);
-
-  // replace spaces with commas
-  sprintf(command, "sed -E 's/ +/,/g' %s | sed -E 's/,$//' | sed -E 's/,/ /' > %s.tmp; mv %s.tmp %s",
-	  outfile, outfile, outfile, outfile);
-  system(command);
 
+  // create a csv file for this condition
+  char outfile[FRED_STRING_SIZE];
+  sprintf(outfile, "%s/RUN%d/%s.csv", Global::Simulation_directory, Global::Simulation_run_number, this->name);
+  this->daily_report.write_csv(outfile, true);
 }
 
 double Epidemic::get_attack_rate() {
@@ -1300,27 +1343,9 @@ double Epidemic::get_attack_rate() {
 }
 
 void Epidemic::inc_state_count(Person* person, int state){
-
   for (int type_id = 0; type_id < Group_Type::get_number_of_group_types(); type_id++) {
     if (this->track_counts_for_group_state[state][type_id]) {
-      Group* group = person->get_group_of_type(type_id);
-      if (group != NULL) {
-	if ( this->group_state_count[state].find(group) == this->group_state_count[state].end() ) {
-	  // not present so insert with count of one
-	  std::pair<Group*,int> new_count(group,1);
-	  this->group_state_count[state].insert(new_count);
-	  this->total_group_state_count[state].insert(new_count);
-	}
-	else { // present so increment count
-	  this->group_state_count[state][group]++;
-	  this->total_group_state_count[state][group]++;
-	}  
-	FRED_VERBOSE(1, "inc_state_count person %d group %s cond %s state %s count %d total_count %d\n",
-		     person->get_id(), group->get_label(), this->name,
-		     this->natural_history->get_state_name(state).c_str(),
-		     this->group_state_count[state][group],
-		     this->total_group_state_count[state][group]); 
-      }
+      increment_group_state_count(type_id, person->get_group_of_type(type_id), state);
     }
   }
 }
@@ -1328,35 +1353,28 @@ void Epidemic::inc_state_count(Person* person, int state){
 void Epidemic::dec_state_count(Person* person, int state){
   for (int type_id = 0; type_id < Group_Type::get_number_of_group_types(); type_id++) {
     if (this->track_counts_for_group_state[state][type_id]) {
-      Group* group = person->get_group_of_type(type_id);
-      if (group != NULL) {
-	if ( this->group_state_count[state].find(group) != this->group_state_count[state].end() ) {
-	  this->group_state_count[state][group]--;
-	  FRED_VERBOSE(1, "dec_state_count person %d group %s cond %s state %s count %d\n",
-		       person->get_id(), group->get_label(), this->name,
-		       this->natural_history->get_state_name(state).c_str(),
-		       this->group_state_count[state][group]); 
-	}  
-      }
+      decrement_group_state_count(type_id, person->get_group_of_type(type_id), state);
     }
   }
 }
 
 
-int Epidemic::get_group_state_count(Group* place, int state) {
-  int count = 0;
-  if( this->group_state_count[state].find(place) != this->group_state_count[state].end() ){
-    count = this->group_state_count[state][place];
+int Epidemic::get_group_state_count(Group* group, int state) {
+  if (group == NULL) {
+    return 0;
   }
-  return count;
+  int_vector_t & count = this->group_state_count[state][group->get_type_id()];
+  int index = group->get_index();
+  return (0 <= index && index < count.size()) ? count[index] : 0;
 }
 
-int Epidemic::get_total_group_state_count(Group* place, int state) {
-  int count = 0;
-  if( this->total_group_state_count[state].find(place) != this->total_group_state_count[state].end() ){
-    count = this->total_group_state_count[state][place];
+int Epidemic::get_total_group_state_count(Group* group, int state) {
+  if (group == NULL) {
+    return 0;
   }
-  return count;
+  int_vector_t & total = this->total_group_state_count[state][group->get_type_id()];
+  int index = group->get_index();
+  return (0 <= index && index < total.size()) ? total[index] : 0;
 }
 
 
@@ -1596,21 +1614,20 @@ void Epidemic::select_imported_cases(int day, int max_imported, double per_cap,
 void Epidemic::increment_group_state_count(int group_type_id, Group* group, int state) {
   if (this->track_counts_for_group_state[state][group_type_id]) {
     if (group != NULL) {
-      if ( this->group_state_count[state].find(group) == this->group_state_count[state].end() ) {
-	// not present so insert with count of one
-	std::pair<Group*,int> new_count(group,1);
-	this->group_state_count[state].insert(new_count);
-	this->total_group_state_count[state].insert(new_count);
+      int index = group->get_index();
+      int_vector_t & count = this->group_state_count[state][group_type_id];
+      int_vector_t & total = this->total_group_state_count[state][group_type_id];
+      if (count.size() <= index) {
+	// a place created during the run
+	count.resize(index + 1, 0);
+	total.resize(index + 1, 0);
       }
-      else { // present so increment count
-	this->group_state_count[state][group]++;
-	this->total_group_state_count[state][group]++;
-      }  
+      count[index]++;
+      total[index]++;
       FRED_VERBOSE(1, "increment_group_state_count group %s cond %s state %s count %d total_count %d\n",
 		   group->get_label(), this->name,
 		   this->natural_history->get_state_name(state).c_str(),
-		   this->group_state_count[state][group],
-		   this->total_group_state_count[state][group]); 
+		   count[index], total[index]);
     }
   }
 }
@@ -1618,29 +1635,155 @@ void Epidemic::increment_group_state_count(int group_type_id, Group* group, int
 void Epidemic::decrement_group_state_count(int group_type_id, Group* group, int state) {
   if (this->track_counts_for_group_state[state][group_type_id]) {
     if (group != NULL) {
-      /*
-	printf("decrementing_group_state_count for cond %d state %d group %s\n",
-	this->id, state, group->get_label());
-      */
-      if ( this->group_state_count[state].find(group) != this->group_state_count[state].end() ) {
-	/*
-	if (this->group_state_count[state][group]<1) {
-	  printf("HELP: decrementing_group_state_count for cond %d state %d group %s would result in negative count\n",
-		 this->id, state, group->get_label());
-	  exit(0);
-	}
-	*/
-	this->group_state_count[state][group]--;
-	/*
-	printf("decrementing_group_state_count for cond %d state %d group %s ==> %d\n",
-	       this->id, state, group->get_label(), this->group_state_count[state][group]);
-	*/
+      int index = group->get_index();
+      int_vector_t & count = this->group_state_count[state][group_type_id];
+      int_vector_t & total = this->total_group_state_count[state][group_type_id];
+      // a group that has never been counted in this state is left alone
+      if (index < count.size() && total[index] > 0) {
+	count[index]--;
 	FRED_VERBOSE(1, "decrement_group_state_count group %s cond %s state %s count = %d\n",
 		     group->get_label(), this->name,
 		     this->natural_history->get_state_name(state).c_str(),
-		     this->group_state_count[state][group]); 
-      }  
+		     count[index]);
+      }
     }
   }
 }
 
+/*
+ * The daily counts are saved for the whole simulation, and restored for
+ * as many days as the restoring simulation has.  Only the events after
+ * the checkpoint day are saved.
+ */
+void Epidemic::save_checkpoint(Checkpoint* checkpoint, int day) {
+  checkpoint->put_int(this->total_cases);
+  checkpoint->put_int(this->susceptible_count);
+  checkpoint->put_double(this->RR);
+  checkpoint->put_double(this->total_serial_interval);
+  checkpoint->put_int(this->total_secondary_cases);
+
+  checkpoint->put_int(Global::Simulation_Days);
+  for(int i = 0; i < this->number_of_states; ++i) {
+    checkpoint->put_int(this->incidence_count[i]);
+    checkpoint->put_int(this->total_count[i]);
+    checkpoint->put_int(this->current_count[i]);
+    for(int d = 0; d <= Global::Simulation_Days; ++d) {
+      checkpoint->put_int(this->daily_incidence_count[i][d]);
+      checkpoint->put_int(this->daily_current_count[i][d]);
+    }
+  }
+  for(int d = 0; d < Global::Simulation_Days; ++d) {
+    checkpoint->put_int(this->daily_cohort_size[d]);
+    checkpoint->put_int(this->number_infected_by_cohort[d]);
+  }
+
+  person_vector_t people;
+  for(person_set_iterator itr = this->active_people_list.begin(); itr != this->active_people_list.end(); ++itr) {
+    people.push_back(*itr);
+  }
+  checkpoint->put_people(people);
+  people.clear();
+  for(person_set_iterator itr = this->transmissible_people_list.begin(); itr != this->transmissible_people_list.end(); ++itr) {
+    people.push_back(*itr);
+  }
+  checkpoint->put_people(people);
+  checkpoint->put_people(this->new_exposed_people_list);
+
+  // save the groups that have been counted in each state
+  int number_of_group_types = Group_Type::get_number_of_group_types();
+  for(int i = 0; i < this->number_of_states; ++i) {
+    int size = 0;
+    for(int type_id = 0; type_id < number_of_group_types; ++type_id) {
+      int_vector_t & total = this->total_group_state_count[i][type_id];
+      for(int index = 0; index < total.size(); ++index) {
+	size += (total[index] > 0);
+      }
+    }
+    checkpoint->put_int(size);
+    for(int type_id = 0; type_id < number_of_group_types; ++type_id) {
+      int_vector_t & count = this->group_state_count[i][type_id];
+      int_vector_t & total = this->total_group_state_count[i][type_id];
+      for(int index = 0; index < total.size(); ++index) {
+	if(total[index] > 0) {
+	  checkpoint->put_group(Group::get_group(type_id, index));
+	  checkpoint->put_int(count[index]);
+	  checkpoint->put_int(total[index]);
+	}
+      }
+    }
+  }
+
+  int first_step = 24 * (day + 1);
+  this->state_transition_event_queue.save_checkpoint(checkpoint, first_step);
+  this->meta_agent_transition_event_queue.save_checkpoint(checkpoint, first_step);
+}
+
+void Epidemic::restore_checkpoint(Checkpoint* checkpoint, int day) {
+  this->total_cases = checkpoint->get_int();
+  this->susceptible_count = checkpoint->get_int();
+  this->RR = checkpoint->get_double();
+  this->total_serial_interval = checkpoint->get_double();
+  this->total_secondary_cases = checkpoint->get_int();
+
+  int saved_days = checkpoint->get_int();
+  for(int i = 0; i < this->number_of_states; ++i) {
+    this->incidence_count[i] = checkpoint->get_int();
+    this->total_count[i] = checkpoint->get_int();
+    this->current_count[i] = checkpoint->get_int();
+    for(int d = 0; d <= saved_days; ++d) {
+      int incidence = checkpoint->get_int();
+      int current = checkpoint->get_int();
+      if(d <= Global::Simulation_Days) {
+	this->daily_incidence_count[i][d] = incidence;
+	this->daily_current_count[i][d] = current;
+      }
+    }
+  }
+  for(int d = 0; d < saved_days; ++d) {
+    int cohort_size = checkpoint->get_int();
+    int infected = checkpoint->get_int();
+    if(d < Global::Simulation_Days) {
+      this->daily_cohort_size[d] = cohort_size;
+      this->number_infected_by_cohort[d] = infected;
+    }
+  }
+
+  person_vector_t people;
+  checkpoint->get_people(people);
+  this->active_people_list.clear();
+  for(int i = 0; i < people.size(); ++i) {
+    this->active_people_list.insert(people[i]);
+  }
+  checkpoint->get_people(people);
+  this->transmissible_people_list.clear();
+  for(int i = 0; i < people.size(); ++i) {
+    this->transmissible_people_list.insert(people[i]);
+  }
+  checkpoint->get_people(this->new_exposed_people_list);
+
+  int number_of_group_types = Group_Type::get_number_of_group_types();
+  for(int i = 0; i < this->number_of_states; ++i) {
+    for(int type_id = 0; type_id < number_of_group_types; ++type_id) {
+      int_vector_t & count = this->group_state_count[i][type_id];
+      int_vector_t & total = this->total_group_state_count[i][type_id];
+      std::fill(count.begin(), count.end(), 0);
+      std::fill(total.begin(), total.end(), 0);
+    }
+    int size = checkpoint->get_int();
+    for(int j = 0; j < size; ++j) {
+      Group* group = checkpoint->get_group();
+      int_vector_t & count = this->group_state_count[i][group->get_type_id()];
+      int_vector_t & total = this->total_group_state_count[i][group->get_type_id()];
+      int index = group->get_index();
+      if(count.size() <= index) {
+	count.resize(index + 1, 0);
+	total.resize(index + 1, 0);
+      }
+      count[index] = checkpoint->get_int();
+      total[index] = checkpoint->get_int();
+    }
+  }
+
+  this->state_transition_event_queue.restore_checkpoint(checkpoint, this->id);
+  this->meta_agent_transition_event_queue.restore_checkpoint(checkpoint, this->id);
+}
@@ -28,34 +28,24 @@
 #define _FRED_EPIDEMIC_H
 
 #include "Global.h"
+#include "Daily_Report.h"
+#include "Dense_Set.h"
 #include "Events.h"
 #include "Person.h"
 #include "Place.h"
 
+class Checkpoint;
 class Group;
 class Condition;
 class Natural_History;
 
-struct person_id_compare {
-  bool operator()(const Person* x, const Person* y) const {
-    return x->get_id() < y->get_id();
-  }
-};
-
-struct place_id_compare {
-  bool operator()(const Place* x, const Place* y) const {
-    return x->get_id() < y->get_id();
-  }
-};
-
-typedef  std::set<Person*, person_id_compare> person_set_t;
+// sets of people and places, iterated in order of id
+typedef  Dense_Set<Person> person_set_t;
 typedef  person_set_t::iterator person_set_iterator;
 
-typedef  std::set<Place*, place_id_compare> place_set_t;
+typedef  Dense_Set<Place> place_set_t;
 typedef  place_set_t::iterator place_set_iterator;
 
-typedef std::unordered_map<Group*,int> group_counter_t;
-
 
 
 class VIS_Location {
@@ -107,11 +97,13 @@ public:
 
   void update(int day, int hour);
   void prepare_for_new_day(int day);
-  void update_state(Person* person, int day, int hour, int new_state, int loop_counter);
+  void update_state(Person* person, int day, int hour, int new_state, int loop_counter, double* transition_prob = NULL);
+  void prepare_batch_transitions(int step, int size);
 
   void update_proximity_transmissions(int day, int hour);
   void find_active_places_of_type(int day, int hour, int place_type);
   void transmission_in_active_places(int day, int hour, int time_block);
+  void parallel_transmission_in_active_places(int day, int hour, int time_block);
 
   void update_network_transmissions(int day, int hour);
 
@@ -169,7 +161,15 @@ public:
   }
 
   void finish();
+
+  // the daily counts written to the csv file for this condition
+  Daily_Report* get_daily_report() {
+    return &this->daily_report;
+  }
+
   void terminate_person(Person* person, int day);
+  void save_checkpoint(Checkpoint* checkpoint, int day);
+  void restore_checkpoint(Checkpoint* checkpoint, int day);
 
 protected:
   Condition* condition;
@@ -186,6 +186,15 @@ protected:
   // list of people with new status
   person_vector_t new_exposed_people_list;
 
+  // transition probabilities for people in the current transition
+  // bucket, computed in batches of people who share the same state
+  person_vector_t batch_people;
+  int_vector_t batch_state;
+  std::vector<double> batch_prob;
+  std::vector<person_vector_t> batch_members;
+  std::vector<int_vector_t> batch_index;
+  std::vector<double> batch_member_prob;
+
   // places attended today by transmissible people:
   place_set_t active_places_list;
 
@@ -216,8 +225,10 @@ protected:
   int* current_count;	  // number of people currently in state
   int** daily_incidence_count; // number of people entering state each day
   int** daily_current_count;	// number of people currently in state each day
-  std::vector<group_counter_t> group_state_count;
-  std::vector<group_counter_t> total_group_state_count;
+  // counts of people in each state for every group of each tracked
+  // group type, indexed by [state][group_type][group index]
+  int_vector_t** group_state_count;
+  int_vector_t** total_group_state_count;
   bool** track_counts_for_group_state;
 
   // used for computing reproductive rate:
@@ -225,6 +236,8 @@ protected:
   int* daily_cohort_size;
   int* number_infected_by_cohort;
 
+  Daily_Report daily_report;
+
   // serial interval
   double total_serial_interval;
   int total_secondary_cases;
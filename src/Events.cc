@@ -24,88 +24,157 @@
 //
 
 #include "Events.h"
+#include "Checkpoint.h"
 #include "Global.h"
+#include "Person.h"
 #include "Utils.h"
 
 Events::Events() {
-  this->event_queue_size = 24*Global::Simulation_Days;
-  this->events = new events_t [ event_queue_size ];
-  for (int step = 0; step < this->event_queue_size; ++step) {
-    clear_events(step);
+  this->pages.clear();
+}
+
+Events::~Events() {
+  for (int page = 0; page < this->pages.size(); ++page) {
+    delete this->pages[page];
   }
+}
 
+bool Events::is_in_range(int step) {
+  // events past the end of the simulation won't happen
+  return 0 <= step && step < 24 * Global::Simulation_Days;
+}
+
+events_t* Events::get_bucket(int step) {
+  int page = step / STEPS_PER_PAGE;
+  if (page < this->pages.size() && this->pages[page] != NULL) {
+    return &(this->pages[page]->bucket[step % STEPS_PER_PAGE]);
+  }
+  return NULL;
 }
 
-void Events::add_event(int step, event_t item) {
+void Events::add_event(int step, event_t item, int* handle) {
 
-  if (step < 0 || this->event_queue_size <= step) {
+  if (is_in_range(step) == false) {
     // won't happen during this simulation
     return;
   }
-  if(this->events[step].size() == this->events[step].capacity()) {
-    if(this->events[step].capacity() < 4) {
-      this->events[step].reserve(4);
-    }
-    this->events[step].reserve(2 * this->events[step].capacity());
+
+  // allocate the page for this step if necessary
+  int page = step / STEPS_PER_PAGE;
+  if (this->pages.size() <= page) {
+    this->pages.resize(page + 1, NULL);
+  }
+  if (this->pages[page] == NULL) {
+    this->pages[page] = new page_t;
+  }
+
+  events_t & bucket = this->pages[page]->bucket[step % STEPS_PER_PAGE];
+  if (handle != NULL) {
+    *handle = bucket.size();
   }
-  this->events[step].push_back(item);
+  event_entry_t entry = { item, handle };
+  bucket.push_back(entry);
   // printf("\nadd_event step %d new size %d\n", step, get_size(step));
   // print_events(step);
 }
 
-void Events::delete_event(int step, event_t item) {
+void Events::delete_event(int step, event_t item, int* handle) {
 
-  if(step < 0 || this->event_queue_size <= step) {
+  if(is_in_range(step) == false) {
     // won't happen during this simulation
     return;
   }
-  // find item in the list
-  int size = get_size(step);
-  for(int pos = 0; pos < size; ++pos) {
-    if(this->events[step][pos] == item) {
-      // copy last item in list into this slot
-      this->events[step][pos] = this->events[step].back();
-      // delete last slot
-      this->events[step].pop_back();
-      // printf("\ndelete_event step %d final size %d\n", step, get_size(step));
-      // print_events(step);
-      return;
+
+  events_t* bucket = get_bucket(step);
+  int size = bucket == NULL ? 0 : bucket->size();
+
+  // find item in the list, using the handle if possible
+  int pos = -1;
+  if (handle != NULL && 0 <= *handle && *handle < size && (*bucket)[*handle].item == item) {
+    pos = *handle;
+  }
+  else {
+    for(int i = 0; i < size; ++i) {
+      if((*bucket)[i].item == item) {
+	pos = i;
+	break;
+      }
     }
   }
-  // item not found
-  FRED_WARNING("delete_events: item not found\n");
-  assert(false);
+
+  if (pos < 0) {
+    // item not found
+    FRED_WARNING("delete_events: item not found\n");
+    assert(false);
+    return;
+  }
+
+  // copy last item in list into this slot
+  (*bucket)[pos] = bucket->back();
+  if ((*bucket)[pos].handle != NULL) {
+    *((*bucket)[pos].handle) = pos;
+  }
+
+  // delete last slot
+  bucket->pop_back();
+  if (handle != NULL) {
+    *handle = -1;
+  }
+  // printf("\ndelete_event step %d final size %d\n", step, get_size(step));
+  // print_events(step);
 }
 
 void Events::clear_events(int step) {
-  assert(0 <= step && step < this->event_queue_size);
-  this->events[step] = events_t();
+  assert(0 <= step);
+  events_t* bucket = get_bucket(step);
+  if (bucket == NULL) {
+    return;
+  }
+  *bucket = events_t();
+
+  // free the page once all its steps are empty
+  int page = step / STEPS_PER_PAGE;
+  for (int i = 0; i < STEPS_PER_PAGE; ++i) {
+    if (this->pages[page]->bucket[i].empty() == false) {
+      return;
+    }
+  }
+  delete this->pages[page];
+  this->pages[page] = NULL;
   // printf("clear_events step %d size %d\n", step, get_size(step));
 }
 
 int Events::get_size(int step) {
-  assert(0 <= step && step < this->event_queue_size);
-  return static_cast<int>(this->events[step].size());
+  assert(0 <= step);
+  events_t* bucket = get_bucket(step);
+  return bucket == NULL ? 0 : static_cast<int>(bucket->size());
 }
 
 event_t Events::get_event(int step, int i) {
-  assert(0 <= step && step < this->event_queue_size);
-  if (0 <= i && i < static_cast<int>(this->events[step].size())) {
-    return this->events[step][i];
+  assert(0 <= step);
+  events_t* bucket = get_bucket(step);
+  int size = bucket == NULL ? 0 : static_cast<int>(bucket->size());
+  if (0 <= i && i < size) {
+    return (*bucket)[i].item;
   }
   else {
-    Utils::fred_abort("get_event: i = %d size = %d\n",
-		      i, (int)this->events[step].size());
+    Utils::fred_abort("get_event: i = %d size = %d\n", i, size);
     return NULL;
   }
 }
 
 
 void Events::print_events(FILE* fp, int step) {
-  assert(0 <= step && step < this->event_queue_size);
-  events_itr_t itr_end = this->events[step].end();
+  assert(0 <= step);
   fprintf(fp, "events[%d] = %d : ", step, get_size(step));
-  for(events_itr_t itr = this->events[step].begin(); itr != itr_end; ++itr) {
+  events_t* bucket = get_bucket(step);
+  if (bucket == NULL) {
+    fprintf(fp,"\n");
+    fflush(fp);
+    return;
+  }
+  events_itr_t itr_end = bucket->end();
+  for(events_itr_t itr = bucket->begin(); itr != itr_end; ++itr) {
     // fprintf(fp, "id %d age %d ", (*itr)->get_id(), (*itr)->get_age());
   }
   fprintf(fp,"\n");
@@ -116,3 +185,38 @@ void Events::print_events(int step) {
   print_events(stdout, step);
 }
 
+void Events::clear() {
+  for (int page = 0; page < this->pages.size(); ++page) {
+    delete this->pages[page];
+  }
+  this->pages.clear();
+}
+
+void Events::save_checkpoint(Checkpoint* checkpoint, int first_step) {
+  int last_step = STEPS_PER_PAGE * this->pages.size();
+  for (int step = first_step; step < last_step; ++step) {
+    int size = get_size(step);
+    if (size > 0) {
+      checkpoint->put_int(step);
+      checkpoint->put_int(size);
+      for (int i = 0; i < size; ++i) {
+	checkpoint->put_person(get_event(step, i));
+      }
+    }
+  }
+  checkpoint->put_int(-1);
+}
+
+void Events::restore_checkpoint(Checkpoint* checkpoint, int condition_id) {
+  clear();
+  int step = checkpoint->get_int();
+  while (step >= 0) {
+    int size = checkpoint->get_int();
+    for (int i = 0; i < size; ++i) {
+      Person* person = checkpoint->get_person();
+      int* handle = condition_id < 0 ? NULL : person->get_transition_event_handle(condition_id);
+      add_event(step, person, handle);
+    }
+    step = checkpoint->get_int();
+  }
+}
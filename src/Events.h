@@ -32,32 +32,66 @@
 
 using namespace std;
 
+class Checkpoint;
 class Person;
 
 // type definitions:
 typedef Person* event_t;
-typedef std::vector<event_t> events_t;
+
+typedef struct {
+  event_t item;
+  int* handle;  // if not NULL, holds the position of item in its bucket
+} event_entry_t;
+
+typedef std::vector<event_entry_t> events_t;
 typedef events_t::iterator events_itr_t;
 
+/**
+ * Events is a calendar queue of items scheduled for simulation steps.
+ * The step buckets are grouped into pages of one day.  A page is
+ * allocated when an event is first added to one of its steps, and freed
+ * once all of its steps have been cleared, so memory depends on the
+ * number of days with pending events rather than on the length of the
+ * simulation.
+ *
+ * Items in a bucket are delivered in the order they were added, except
+ * that deleting an item moves the last item of the bucket into its slot.
+ * An item added with a handle can be deleted in constant time; the
+ * handle is kept up to date when other items are deleted.
+ */
 class Events {
 
 public:
 
   Events();
-  ~Events(){}
+  ~Events();
 
-  void add_event(int step, event_t item);
-  void delete_event(int step, event_t item);
+  void add_event(int step, event_t item, int* handle = NULL);
+  void delete_event(int step, event_t item, int* handle = NULL);
   void clear_events(int step);
+  void clear();
   int get_size(int step);
   event_t get_event(int step, int i);
   void print_events(FILE* fp, int step);
   void print_events(int step);
 
+  // the events scheduled from first_step on, for checkpoints.  If
+  // condition_id >= 0, restored events get the person's transition
+  // event handle for that condition.
+  void save_checkpoint(Checkpoint* checkpoint, int first_step);
+  void restore_checkpoint(Checkpoint* checkpoint, int condition_id);
+
 private:
-  int event_queue_size;
-  events_t* events;
-};
+  static const int STEPS_PER_PAGE = 24;
+
+  typedef struct {
+    events_t bucket[STEPS_PER_PAGE];
+  } page_t;
 
+  bool is_in_range(int step);
+  events_t* get_bucket(int step);
+
+  std::vector<page_t*> pages;
+};
 
 #endif /* EVENTS_H_ */
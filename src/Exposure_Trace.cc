@@ -0,0 +1,180 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Exposure_Trace.cc
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Exposure_Trace.h"
+
+#define EXPOSURE_TRACE_FIELDS (sizeof(Exposure_Trace::record_t) / sizeof(int32_t))
+
+static const char exposure_magic[8] = { 'F', 'R', 'E', 'D', 'E', 'X', 'P', '1' };
+
+Block_Writer Exposure_Trace::writer;
+string Exposure_Trace::filename = "";
+size_t Exposure_Trace::header_size = 0;
+std::vector<Exposure_Trace::record_t> Exposure_Trace::records;
+
+namespace {
+
+  void put_u32(string* block, uint32_t value) {
+    block->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void put_names(string* block, const std::vector<string> & names) {
+    put_u32(block, names.size());
+    for(int i = 0; i < names.size(); ++i) {
+      put_u32(block, names[i].size());
+      block->append(names[i]);
+    }
+  }
+
+  bool read_u32(FILE* fp, uint32_t* value) {
+    return fread(value, sizeof(uint32_t), 1, fp) == 1;
+  }
+
+  bool read_names(FILE* fp, std::vector<string> & names) {
+    uint32_t count, length;
+    if(read_u32(fp, &count) == false) {
+      return false;
+    }
+    names.clear();
+    for(uint32_t i = 0; i < count; ++i) {
+      if(read_u32(fp, &length) == false) {
+	return false;
+      }
+      string name(length, '\0');
+      if(length > 0 && fread(&name[0], 1, length, fp) != length) {
+	return false;
+      }
+      names.push_back(name);
+    }
+    return true;
+  }
+}
+
+bool Exposure_Trace::open(const char* filename, const std::vector<string> & condition_names,
+			  const std::vector<string> & group_type_names) {
+  close();
+  if(Exposure_Trace::writer.open(filename) == false) {
+    return false;
+  }
+  Exposure_Trace::filename = filename;
+  string* block = Exposure_Trace::writer.get_block(1024);
+  block->append(exposure_magic, sizeof(exposure_magic));
+  put_names(block, condition_names);
+  put_names(block, group_type_names);
+  Exposure_Trace::header_size = block->size();
+  Exposure_Trace::writer.write(block);
+  Exposure_Trace::records.clear();
+  Exposure_Trace::records.reserve(EXPOSURE_TRACE_BLOCK);
+
+  // exposures still buffered when the program exits are written
+  static bool close_at_exit = false;
+  if(close_at_exit == false) {
+    atexit(Exposure_Trace::close);
+    close_at_exit = true;
+  }
+  return true;
+}
+
+void Exposure_Trace::close() {
+  if(Exposure_Trace::writer.is_open() == false) {
+    return;
+  }
+  if(Exposure_Trace::records.size() > 0) {
+    pass_block();
+  }
+  Exposure_Trace::writer.close();
+}
+
+void Exposure_Trace::pass_block() {
+  int count = Exposure_Trace::records.size();
+  string* block = Exposure_Trace::writer.get_block(2 * sizeof(uint32_t) + count * sizeof(record_t));
+  put_u32(block, count);
+  put_u32(block, 0);
+  for(int field = 0; field < EXPOSURE_TRACE_FIELDS; ++field) {
+    int64_t previous = 0;
+    for(int i = 0; i < count; ++i) {
+      int64_t value = reinterpret_cast<const int32_t*>(&Exposure_Trace::records[i])[field];
+      Block_Writer::put_varint(block, value - previous);
+      previous = value;
+    }
+  }
+  uint32_t length = block->size() - 2 * sizeof(uint32_t);
+  memcpy(&(*block)[sizeof(uint32_t)], &length, sizeof(length));
+  Exposure_Trace::writer.write(block);
+  Exposure_Trace::records.clear();
+}
+
+void Exposure_Trace::write_prior_records(const string & contents) {
+  if(Exposure_Trace::writer.is_open() == false || contents.size() < Exposure_Trace::header_size) {
+    return;
+  }
+  string* block = Exposure_Trace::writer.get_block(contents.size());
+  block->append(contents, Exposure_Trace::header_size, string::npos);
+  Exposure_Trace::writer.write(block);
+}
+
+bool Exposure_Trace::read(const char* filename, std::vector<string> & condition_names,
+			  std::vector<string> & group_type_names, std::vector<record_t> & records) {
+  FILE* fp = fopen(filename, "rb");
+  if(fp == NULL) {
+    return false;
+  }
+  char magic[sizeof(exposure_magic)];
+  bool ok = fread(magic, 1, sizeof(magic), fp) == sizeof(magic)
+    && memcmp(magic, exposure_magic, sizeof(magic)) == 0
+    && read_names(fp, condition_names)
+    && read_names(fp, group_type_names);
+
+  records.clear();
+  std::vector<unsigned char> data;
+  uint32_t header[2];
+  while(ok && fread(header, sizeof(uint32_t), 2, fp) == 2) {
+    int count = header[0];
+    data.resize(header[1]);
+    if(data.size() > 0 && fread(data.data(), 1, data.size(), fp) != data.size()) {
+      ok = false;
+      break;
+    }
+    size_t first = records.size();
+    records.resize(first + count);
+    const unsigned char* p = data.data();
+    const unsigned char* end = p + data.size();
+    for(int field = 0; ok && field < EXPOSURE_TRACE_FIELDS; ++field) {
+      int64_t value = 0;
+      for(int i = 0; ok && i < count; ++i) {
+	int64_t delta;
+	ok = Block_Writer::get_varint(p, end, &delta);
+	value += delta;
+	reinterpret_cast<int32_t*>(&records[first + i])[field] = static_cast<int32_t>(value);
+      }
+    }
+  }
+  fclose(fp);
+  return ok;
+}
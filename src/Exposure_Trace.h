@@ -0,0 +1,102 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Exposure_Trace.h
+//
+
+#ifndef _FRED_EXPOSURE_TRACE_H
+#define _FRED_EXPOSURE_TRACE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Block_Writer.h"
+
+using namespace std;
+
+/**
+ * A binary trace of every exposure, written to RUNn/exposures.bin when
+ * enable_exposure_trace is set and read by the fred_exposures tool.
+ *
+ * File layout: the 8-byte magic "FREDEXP1", the condition names and the
+ * group type names (each a uint32 count followed by uint32 length and
+ * bytes for each name), then blocks of up to EXPOSURE_TRACE_BLOCK
+ * records.  A block is a header { uint32 records, uint32 length }
+ * followed by length bytes holding each field of record_t in turn, for
+ * all the records of the block, as zigzag varints of the difference from
+ * the field of the previous record.
+ */
+#define EXPOSURE_TRACE_BLOCK 4096
+
+class Exposure_Trace {
+public:
+
+  typedef struct {
+    int32_t day;
+    int32_t hour;
+    int32_t condition;
+    int32_t host;                // person id
+    int32_t host_age;
+    int32_t source;              // person id, or -1 for an imported exposure
+    int32_t source_age;
+    int32_t source_exposure_day; // -1 if not known
+    int32_t group_type;          // -1 if there is no group
+    int32_t group;               // index of the group within its type
+  } record_t;
+
+  static bool open(const char* filename, const std::vector<string> & condition_names,
+		   const std::vector<string> & group_type_names);
+  static void close();
+
+  static bool is_open() {
+    return Exposure_Trace::writer.is_open();
+  }
+
+  static const char* get_filename() {
+    return Exposure_Trace::filename.c_str();
+  }
+
+  static void add(const record_t & record) {
+    Exposure_Trace::records.push_back(record);
+    if(Exposure_Trace::records.size() == EXPOSURE_TRACE_BLOCK) {
+      pass_block();
+    }
+  }
+
+  // write the blocks of an earlier trace with the same header
+  static void write_prior_records(const string & contents);
+
+  // read a trace file; returns false on error
+  static bool read(const char* filename, std::vector<string> & condition_names,
+		   std::vector<string> & group_type_names, std::vector<record_t> & records);
+
+private:
+  static void pass_block();
+
+  static Block_Writer writer;
+  static string filename;
+  static size_t header_size;
+  static std::vector<record_t> records;
+};
+
+#endif // _FRED_EXPOSURE_TRACE_H
@@ -19,6 +19,7 @@
  */
 
 #include "Expression.h"
+#include "Bytecode.h"
 #include "Clause.h"
 #include "Factor.h"
 #include "Geo.h"
@@ -130,6 +131,8 @@ Expression::Expression(string s) {
   this->is_list = false;
   this->is_value = false;
   this->is_distance = false;
+  this->clause = NULL;
+  this->program = NULL;
 }
 
 
@@ -648,6 +651,14 @@ int Expression::find_comma(string s) {
 }
 
 double Expression::get_value(Person* person, Person* other) {
+  if (this->program != NULL) {
+    return this->program->get_value(person, other);
+  }
+  return evaluate(person, other);
+}
+
+
+double Expression::evaluate(Person* person, Person* other) {
 
   FRED_VERBOSE(1, "Expr::get_value entered person %d other %d number_expr %d name %s factor %s\n",
 	       person? person->get_id(): -1,
@@ -683,6 +694,30 @@ double Expression::get_value(Person* person, Person* other) {
     // this is a select expression
     // FRED_VERBOSE(0, "get_value selection entered for person %d |%s|\n", person->get_id(), this->name.c_str());
 
+    if (this->expr1->is_person_list()) {
+      // select from a pool without converting people to ids and back
+      person_vector_t & people = this->expr1->get_person_list(person, other);
+      int size = people.size();
+      if (this->preference == NULL ) {
+	int index = this->expr2->get_value(person,other);
+	if (index < size) {
+	  return people[index]->get_id();
+	}
+	else {
+	  return -99999999;
+	}
+      }
+      else {
+	Person* selected = this->preference->select_person(person,people);
+	if (selected!=NULL) {
+	  return selected->get_id();
+	}
+	else {
+	  return -99999999;
+	}
+      }
+    }
+
     double_vector_t id_vec = this->expr1->get_list_value(person, other);
     int size = id_vec.size();
     // FRED_VERBOSE(0, "get_value selection for person %d size %d\n", person->get_id(), size);
@@ -883,13 +918,15 @@ bool Expression::parse() {
     this->expr1 = NULL;
     this->expr2 = NULL;
     this->pref_str = "1";
-    int pos1 = this->name.find(",");
+    // the list expression may itself contain commas
+    int pos1 = find_comma(this->name.substr(7));
     string list_expr = "";
-    if (pos1==string::npos) {
+    if (pos1 < 0) {
       FRED_VERBOSE(0, "HELP: BAD 1st ARG for SELECT |%s|\n", this->name.c_str());
       Utils::print_error("Select function needs 2 arguments:\n  " + this->name);
       return false;
     }
+    pos1 += 7;
     list_expr = this->name.substr(7,pos1-7);
     // printf("EXPRESSION: inside if -- list expression |%s|\n", list_expr.c_str()); fflush(stdout);
     this->expr1 = new Expression(list_expr);
@@ -899,10 +936,24 @@ bool Expression::parse() {
       return false;
     }
     if (this->name.substr(pos1+1,5)=="pref(") {
-      this->pref_str = this->name.substr(pos1+6,this->name.length()-pos1-8);
+      string args = this->name.substr(pos1+1,this->name.length()-pos1-2);
+      int pos2 = find_comma(args);
+      string pref_arg = (pos2 < 0) ? args : args.substr(0,pos2);
+      this->pref_str = pref_arg.substr(5,pref_arg.length()-6);
       // printf("EXPRESSION: inside if -- pref expression |%s|\n", this->pref_str.c_str()); fflush(stdout);
       this->preference = new Preference();
       this->preference->add_preference_expressions(this->pref_str);
+      if (0 <= pos2) {
+	// select(list, pref(...), k) is the list of k people drawn without replacement
+	string count_expr = args.substr(pos2+1);
+	this->expr2 = new Expression(count_expr);
+	if (this->expr2->parse()==false || this->expr2->is_list_expression()==true) {
+	  FRED_VERBOSE(0, "HELP: BAD 3rd ARG for SELECT |%s|\n", this->name.c_str());
+	  Utils::print_error("Select count expression " +  count_expr + " not recognized:\n  " + this->name);
+	  return false;
+	}
+	this->is_list_expr = true;
+      }
     }
     else {
       string index_expr = this->name.substr(pos1+1,this->name.length()-pos1-2);
@@ -1158,6 +1209,26 @@ bool Expression::parse() {
   return false;
 }
 
+void Expression::compile() {
+  if (this->program == NULL) {
+    this->program = Bytecode::compile_expression(this);
+  }
+}
+
+
+void Expression::compile_children() {
+  Expression* children[] = { this->expr1, this->expr2, this->expr3, this->expr4 };
+  for (int i = 0; i < 4; i++) {
+    if (children[i] != NULL) {
+      children[i]->compile();
+    }
+  }
+  if (this->clause != NULL) {
+    this->clause->compile();
+  }
+}
+
+
 double_vector_t Expression::get_list_value(Person* person, Person* other) {
   double_vector_t results;
   results.clear();
@@ -1168,6 +1239,29 @@ double_vector_t Expression::get_list_value(Person* person, Person* other) {
 	       person->get_id(), other? other->get_id(): -999,
 	       this->is_list_var, this->is_pool, this->is_filter, this->use_other);
 
+  if (this->is_select) {
+    // select(list, pref(...), k)
+    person_vector_t selected;
+    if (this->expr1->is_person_list()) {
+      person_vector_t & people = this->expr1->get_person_list(person, other);
+      int k = this->expr2->get_value(person,other);
+      this->preference->select_people(person, people, k, selected);
+    }
+    else {
+      double_vector_t id_vec = this->expr1->get_list_value(person, other);
+      int k = this->expr2->get_value(person,other);
+      person_vector_t people;
+      for (int i = 0; i < id_vec.size(); i++) {
+	people.push_back(Person::get_person_with_id(id_vec[i]));
+      }
+      this->preference->select_people(person, people, k, selected);
+    }
+    for (int i = 0; i < selected.size(); i++) {
+      results.push_back(selected[i]->get_id());
+    }
+    return results;
+  }
+
   if (this->is_list) {
     // FRED_VERBOSE(0, "get_list_value : |%s|: person %d\n", this->name.c_str(), person->get_id());
     double_vector_t list1;    
@@ -1228,13 +1322,14 @@ double_vector_t Expression::get_list_value(Person* person, Person* other) {
     }
   }
 
-  if (this->is_pool) {
-    if (this->use_other) {
-      return get_pool(other);
-    }
-    else {
-      return get_pool(person);
+  if (is_person_list()) {
+    person_vector_t & people = get_person_list(person, other);
+    int size = people.size();
+    results.reserve(size);
+    for (int i = 0; i < size; i++) {
+      results.push_back(people[i]->get_id());
     }
+    return results;
   }
 
   if (this->is_filter) {
@@ -1248,61 +1343,76 @@ double_vector_t Expression::get_list_value(Person* person, Person* other) {
 
 double_vector_t Expression::get_pool(Person* person) {
 
-  // FRED_VERBOSE(0, "get_pool person %d\n", person->get_id());
-
   // return the list of ids of people in the person's pool groups
 
-  std::unordered_set<int> found = {};
-  double_vector_t people;
-  people.clear();
-  for (int i = 0; i < this->pool.size(); i++) {
-    int group_type_id = this->pool[i];
-    // printf("group_type_id = %d\n", group_type_id); fflush(stdout);
-    Group* group = person->get_activity_group(group_type_id);
-    // printf("group = %s\n", group ? group->get_label() : "NULL"); fflush(stdout);
-    if (group!=NULL) {
-      int size = group->get_size();
-      // printf("size = %d\n", size);
-      for (int j = 0; j < size; j++) {
-	// printf("size = %d j = %d\n", size, j); fflush(stdout);
-	int other_id = group->get_member(j)->get_id();
-	if (found.insert(other_id).second) {
-	  people.push_back(other_id);
-	  // printf("added id %d\n", other_id);
-	}
-	else {
-	  // printf("duplicate id %d\n", other_id);
-	}
-      }
-    }
+  double_vector_t results;
+  person_vector_t & people = get_person_list(person, person);
+  int size = people.size();
+  results.reserve(size);
+  for (int i = 0; i < size; i++) {
+    results.push_back(people[i]->get_id());
   }
-  // FRED_VERBOSE(0, "get_pool person %d pool size %d\n", person->get_id(), (int)people.size());
-
-  return people;
+  return results;
 }
 
 double_vector_t Expression::get_filtered_list(Person* person, double_vector_t &list) {
 
   // create a filtered list of qualified people
-  std::unordered_set<int> found = {};
   double_vector_t filtered;
   filtered.clear();
+  this->marks.begin();
 
   // filter out anyone who fails any requirement
   for (int j = 0; j < list.size(); j++) {
     int other_id = list[j];
     Person* other = Person::get_person_with_id(other_id);
-    // printf("testing filter: other %d age %d sex %c\n", other_id, other->get_age(), other->get_sex());
     if (this->clause->get_value(person, other)) {
-      if (found.insert(other_id).second) {
+      if (this->marks.insert(other_id)) {
 	filtered.push_back(other_id);
-	// printf("passed filter other %d age %d sex %c\n", other_id, other->get_age(), other->get_sex());
       }
     }
-    else {
-      // printf("failed filter other %d age %d sex %c\n", other_id, other->get_age(), other->get_sex());
-    }
   }
   return filtered;
 }
 
+/*
+ * The people in a pool, or in a filter of a pool, in the same order as
+ * their ids in get_list_value().  The list is kept in this expression,
+ * so it is only valid until the expression is evaluated again.
+ */
+person_vector_t & Expression::get_person_list(Person* person, Person* other) {
+  this->people.clear();
+  this->marks.begin();
+
+  if (this->is_pool) {
+    // people in the person's pool groups
+    Person* owner = this->use_other ? other : person;
+    for (int i = 0; i < this->pool.size(); i++) {
+      Group* group = owner->get_activity_group(this->pool[i]);
+      if (group!=NULL) {
+	int size = group->get_size();
+	for (int j = 0; j < size; j++) {
+	  Person* member = group->get_member(j);
+	  if (this->marks.insert(member->get_id())) {
+	    this->people.push_back(member);
+	  }
+	}
+      }
+    }
+    return this->people;
+  }
+
+  // filter out anyone who fails any requirement
+  person_vector_t & candidates = this->expr1->get_person_list(person, other);
+  int size = candidates.size();
+  for (int j = 0; j < size; j++) {
+    Person* candidate = candidates[j];
+    if (this->clause->get_value(person, candidate)) {
+      if (this->marks.insert(candidate->get_id())) {
+	this->people.push_back(candidate);
+      }
+    }
+  }
+  return this->people;
+}
+
@@ -22,21 +22,72 @@
 #define _FRED_EXPRESSION_H
 
 
+#include <algorithm>
+
 #include "Global.h"
 
+class Bytecode;
 class Factor;
 class Person;
 class Preference;
 
+/**
+ * Marks the person ids seen in one pass over a list.  Each pass gets a
+ * new stamp, so the marks never need clearing and repeated passes do
+ * not allocate.
+ */
+class Id_Marks {
+public:
+  Id_Marks() : pass(0) {}
+
+  void begin() {
+    this->pass++;
+    if (this->pass == 0) {
+      std::fill(this->stamp.begin(), this->stamp.end(), 0);
+      this->pass = 1;
+    }
+    this->meta_agents.clear();
+  }
+
+  // true if id was not yet marked in this pass
+  bool insert(int id) {
+    if (id < 0) {
+      // meta agents
+      if (std::find(this->meta_agents.begin(), this->meta_agents.end(), id) != this->meta_agents.end()) {
+	return false;
+      }
+      this->meta_agents.push_back(id);
+      return true;
+    }
+    if (this->stamp.size() <= id) {
+      this->stamp.resize(2 * id + 1, 0);
+    }
+    if (this->stamp[id] == this->pass) {
+      return false;
+    }
+    this->stamp[id] = this->pass;
+    return true;
+  }
+
+private:
+  std::vector<unsigned int> stamp;
+  unsigned int pass;
+  int_vector_t meta_agents;
+};
+
 
 class Expression {
+  friend class Bytecode;
 public:
 
   Expression(string s);
   string get_name();
   double get_value(Person* person, Person* other = NULL);
+  double evaluate(Person* person, Person* other = NULL);
   double_vector_t get_list_value(Person* person, Person* other = NULL);
   bool parse();
+  void compile();
+  void compile_children();
   
   static bool is_known_function(std::string str) {
     return Expression::op_map.find(str)!=Expression::op_map.end();
@@ -55,6 +106,10 @@ public:
   int find_comma(string s);
   double_vector_t get_pool(Person* person);
   double_vector_t get_filtered_list(Person* person, double_vector_t &list);
+  bool is_person_list() {
+    return this->is_pool || (this->is_filter && this->expr1->is_person_list());
+  }
+  person_vector_t & get_person_list(Person* person, Person* other = NULL);
   bool is_warning() {
     return this->warning;
   }
@@ -90,7 +145,10 @@ private:
   bool is_value;
   bool is_distance;
   int_vector_t pool;
+  person_vector_t people;	// result of get_person_list()
+  Id_Marks marks;
   Clause* clause;
+  Bytecode* program;
 
   static std::map<std::string,int> op_map;
   static std::map<std::string,int> value_map;
@@ -0,0 +1,250 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: External_Update.cc
+//
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Condition.h"
+#include "External_Update.h"
+#include "Person.h"
+#include "Property.h"
+#include "Utils.h"
+
+char External_Update::library[FRED_STRING_SIZE];
+char External_Update::program[FRED_STRING_SIZE];
+void* External_Update::handle = NULL;
+fred_api_update_t External_Update::update_function = NULL;
+pid_t External_Update::helper = -1;
+FILE* External_Update::to_helper = NULL;
+FILE* External_Update::from_helper = NULL;
+fred_api_batch_t External_Update::batch;
+std::vector<string> External_Update::names;
+std::vector<const char*> External_Update::name_pointers;
+std::vector<int32_t> External_Update::number_of_states;
+std::vector<const char**> External_Update::state_names;
+std::vector<fred_api_person_t> External_Update::people;
+std::vector<int32_t> External_Update::states;
+std::vector<double> External_Update::vars;
+
+namespace {
+
+  void write_data(FILE* fp, const void* data, size_t size) {
+    if(size > 0 && fwrite(data, size, 1, fp) != 1) {
+      Utils::fred_abort("External_Update: can't write to the external update program\n");
+    }
+  }
+
+  void write_int(FILE* fp, int32_t value) {
+    write_data(fp, &value, sizeof(value));
+  }
+
+  void write_name(FILE* fp, const char* name) {
+    int32_t length = strlen(name);
+    write_int(fp, length);
+    write_data(fp, name, length);
+  }
+}
+
+void External_Update::get_properties() {
+  Property::get_property("external_update_library", External_Update::library);
+  Property::get_property("external_update_program", External_Update::program);
+  if(strcmp(External_Update::library, "none") != 0) {
+    Utils::get_fred_file_name(External_Update::library);
+  }
+  Utils::get_fred_file_name(External_Update::program);
+}
+
+fred_api_batch_t* External_Update::get_batch(int day, int number_of_people) {
+  int number_of_conditions = Condition::get_number_of_conditions();
+  int number_of_vars = Person::get_number_of_vars();
+
+  if(External_Update::names.size() == 0) {
+    for(int c = 0; c < number_of_conditions; ++c) {
+      External_Update::names.push_back(Condition::get_name(c));
+    }
+    for(int c = 0; c < number_of_conditions; ++c) {
+      Condition* condition = Condition::get_condition(c);
+      External_Update::number_of_states.push_back(condition->get_number_of_states());
+      for(int s = 0; s < condition->get_number_of_states(); ++s) {
+	External_Update::names.push_back(condition->get_state_name(s));
+      }
+    }
+    for(int v = 0; v < number_of_vars; ++v) {
+      External_Update::names.push_back(Person::get_var_name(v));
+    }
+    for(int i = 0; i < External_Update::names.size(); ++i) {
+      External_Update::name_pointers.push_back(External_Update::names[i].c_str());
+    }
+    int first = number_of_conditions;
+    for(int c = 0; c < number_of_conditions; ++c) {
+      External_Update::state_names.push_back(&External_Update::name_pointers[first]);
+      first += External_Update::number_of_states[c];
+    }
+    External_Update::batch.number_of_conditions = number_of_conditions;
+    External_Update::batch.condition_names = External_Update::name_pointers.data();
+    External_Update::batch.number_of_states = External_Update::number_of_states.data();
+    External_Update::batch.state_names = External_Update::state_names.data();
+    External_Update::batch.number_of_vars = number_of_vars;
+    External_Update::batch.var_names = External_Update::name_pointers.data() + first;
+  }
+
+  External_Update::people.resize(number_of_people);
+  External_Update::states.resize(number_of_people * number_of_conditions);
+  External_Update::vars.resize(number_of_people * number_of_vars);
+  for(int p = 0; p < number_of_people; ++p) {
+    External_Update::people[p].state = External_Update::states.data() + p * number_of_conditions;
+    External_Update::people[p].var = External_Update::vars.data() + p * number_of_vars;
+  }
+  External_Update::batch.day = day;
+  External_Update::batch.number_of_people = number_of_people;
+  External_Update::batch.people = External_Update::people.data();
+  return &External_Update::batch;
+}
+
+void External_Update::update(fred_api_batch_t* batch) {
+  if(batch->number_of_people == 0) {
+    return;
+  }
+  if(strcmp(External_Update::library, "none") != 0) {
+    if(External_Update::update_function == NULL) {
+      open_library();
+    }
+    if((*External_Update::update_function)(batch) != 0) {
+      Utils::fred_abort("External_Update: %s failed on day %d\n", External_Update::library, batch->day);
+    }
+  }
+  else {
+    if(External_Update::helper < 0) {
+      start_program();
+    }
+    update_by_program(batch);
+  }
+}
+
+void External_Update::open_library() {
+  External_Update::handle = dlopen(External_Update::library, RTLD_NOW | RTLD_LOCAL);
+  if(External_Update::handle == NULL) {
+    Utils::fred_abort("External_Update: can't load %s: %s\n", External_Update::library, dlerror());
+  }
+  External_Update::update_function =
+    reinterpret_cast<fred_api_update_t>(dlsym(External_Update::handle, FRED_API_UPDATE_FUNCTION));
+  if(External_Update::update_function == NULL) {
+    Utils::fred_abort("External_Update: %s has no function %s\n", External_Update::library, FRED_API_UPDATE_FUNCTION);
+  }
+  FRED_STATUS(0, "External_Update: loaded %s\n", External_Update::library);
+}
+
+void External_Update::start_program() {
+  int to_child[2];
+  int from_child[2];
+  if(pipe(to_child) != 0 || pipe(from_child) != 0) {
+    Utils::fred_abort("External_Update: can't create pipes for %s\n", External_Update::program);
+  }
+
+  // a helper that exits early must not kill FRED with SIGPIPE
+  signal(SIGPIPE, SIG_IGN);
+
+  fflush(NULL);
+  External_Update::helper = fork();
+  if(External_Update::helper < 0) {
+    Utils::fred_abort("External_Update: can't fork %s\n", External_Update::program);
+  }
+  if(External_Update::helper == 0) {
+    dup2(to_child[0], STDIN_FILENO);
+    dup2(from_child[1], STDOUT_FILENO);
+    ::close(to_child[0]);
+    ::close(to_child[1]);
+    ::close(from_child[0]);
+    ::close(from_child[1]);
+    execl(External_Update::program, External_Update::program, (char*) NULL);
+    fprintf(stderr, "External_Update: can't run %s\n", External_Update::program);
+    _exit(127);
+  }
+  ::close(to_child[0]);
+  ::close(from_child[1]);
+  External_Update::to_helper = fdopen(to_child[1], "w");
+  External_Update::from_helper = fdopen(from_child[0], "r");
+
+  FILE* fp = External_Update::to_helper;
+  write_data(fp, FRED_API_MAGIC, strlen(FRED_API_MAGIC));
+  write_int(fp, External_Update::batch.number_of_conditions);
+  for(int c = 0; c < External_Update::batch.number_of_conditions; ++c) {
+    write_name(fp, External_Update::batch.condition_names[c]);
+    write_int(fp, External_Update::batch.number_of_states[c]);
+    for(int s = 0; s < External_Update::batch.number_of_states[c]; ++s) {
+      write_name(fp, External_Update::batch.state_names[c][s]);
+    }
+  }
+  write_int(fp, External_Update::batch.number_of_vars);
+  for(int v = 0; v < External_Update::batch.number_of_vars; ++v) {
+    write_name(fp, External_Update::batch.var_names[v]);
+  }
+  FRED_STATUS(0, "External_Update: started %s\n", External_Update::program);
+}
+
+void External_Update::update_by_program(fred_api_batch_t* batch) {
+  FILE* fp = External_Update::to_helper;
+  int number_of_conditions = batch->number_of_conditions;
+  int number_of_vars = batch->number_of_vars;
+  write_int(fp, batch->day);
+  write_int(fp, batch->number_of_people);
+  for(int p = 0; p < batch->number_of_people; ++p) {
+    fred_api_person_t* person = &batch->people[p];
+    write_int(fp, person->id);
+    write_int(fp, person->age);
+    write_int(fp, person->race);
+    write_int(fp, person->sex);
+    write_data(fp, person->state, number_of_conditions * sizeof(int32_t));
+    write_data(fp, person->var, number_of_vars * sizeof(double));
+  }
+  if(fflush(fp) != 0) {
+    Utils::fred_abort("External_Update: can't write to %s\n", External_Update::program);
+  }
+  for(int p = 0; p < batch->number_of_people; ++p) {
+    size_t size = number_of_vars * sizeof(double);
+    if(size > 0 && fread(batch->people[p].var, size, 1, External_Update::from_helper) != 1) {
+      Utils::fred_abort("External_Update: no results from %s on day %d\n", External_Update::program, batch->day);
+    }
+  }
+}
+
+void External_Update::close() {
+  if(External_Update::handle != NULL) {
+    dlclose(External_Update::handle);
+    External_Update::handle = NULL;
+    External_Update::update_function = NULL;
+  }
+  if(External_Update::helper > 0) {
+    fclose(External_Update::to_helper);
+    fclose(External_Update::from_helper);
+    waitpid(External_Update::helper, NULL, 0);
+    External_Update::helper = -1;
+    External_Update::to_helper = NULL;
+    External_Update::from_helper = NULL;
+  }
+}
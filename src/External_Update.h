@@ -0,0 +1,92 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: External_Update.h
+//
+
+#ifndef _FRED_EXTERNAL_UPDATE_H
+#define _FRED_EXTERNAL_UPDATE_H
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+#include "Fred_API.h"
+#include "Global.h"
+
+using namespace std;
+
+/**
+ * Passes the daily batch of external updates to the external model,
+ * either a shared library or a helper program (see Fred_API.h).
+ *
+ * The external model is chosen by two properties:
+ *
+ *   external_update_library = <file>   load the model from a shared library
+ *   external_update_program = <file>   otherwise, run this program
+ */
+class External_Update {
+public:
+
+  static void get_properties();
+
+  // an empty batch with room for the given number of people; the names
+  // are filled in, and each person's state and var point into the batch
+  static fred_api_batch_t* get_batch(int day, int number_of_people);
+
+  // pass the batch to the external model, which updates its vars in place
+  static void update(fred_api_batch_t* batch);
+
+  // unload the library or end the helper program
+  static void close();
+
+private:
+  static void open_library();
+  static void start_program();
+  static void update_by_program(fred_api_batch_t* batch);
+
+  static char library[FRED_STRING_SIZE];
+  static char program[FRED_STRING_SIZE];
+
+  // the loaded library
+  static void* handle;
+  static fred_api_update_t update_function;
+
+  // the helper program
+  static pid_t helper;
+  static FILE* to_helper;
+  static FILE* from_helper;
+
+  // the batch and its storage; names holds the condition names, the
+  // state names of each condition and the var names, in that order
+  static fred_api_batch_t batch;
+  static std::vector<string> names;
+  static std::vector<const char*> name_pointers;
+  static std::vector<int32_t> number_of_states;
+  static std::vector<const char**> state_names;
+  static std::vector<fred_api_person_t> people;
+  static std::vector<int32_t> states;
+  static std::vector<double> vars;
+};
+
+#endif // _FRED_EXTERNAL_UPDATE_H
@@ -65,6 +65,39 @@ string Factor::get_name() {
 }
 
 
+// true if the value depends only on the clock and on the person's own
+// attributes, and so cannot change while other agents are updated in
+// the same hour
+bool Factor::is_local() {
+  if (this->is_constant) {
+    return true;
+  }
+  switch (this->number_of_args) {
+  case 0:
+    return (this->f0 == get_sim_day || this->f0 == get_sim_week ||
+	    this->f0 == get_sim_month || this->f0 == get_sim_year ||
+	    this->f0 == get_day_of_week || this->f0 == get_day_of_month ||
+	    this->f0 == get_day_of_year || this->f0 == get_month ||
+	    this->f0 == get_year || this->f0 == get_date ||
+	    this->f0 == get_hour || this->f0 == get_epi_week ||
+	    this->f0 == get_epi_year);
+  case 1:
+    return (this->f1 == get_id || this->f1 == get_birth_year ||
+	    this->f1 == get_age_in_days || this->f1 == get_age_in_weeks ||
+	    this->f1 == get_age_in_months || this->f1 == get_age_in_years ||
+	    this->f1 == get_age || this->f1 == get_sex || this->f1 == get_race ||
+	    this->f1 == get_profile || this->f1 == get_household_relationship ||
+	    this->f1 == get_number_of_children);
+  case 2:
+    return (this->f2 == get_current_state || this->f2 == get_susceptibility ||
+	    this->f2 == get_transmissibility || this->f2 == get_group_id);
+  case 3:
+    return (this->f3 == get_time_since_entering_state);
+  }
+  return false;
+}
+
+
 /////////////////////////////////////////////////////////
 //
 // 
@@ -447,6 +480,27 @@ double Factor::get_ave_of_vars_in_group(Person* person, int var_id, int group_ty
   }
 }
 
+double Factor::get_median_of_vars_in_group(Person* person, int var_id, int group_type_id) {
+  if (group_type_id < Place_Type::get_number_of_place_types()) {
+    Place* place = NULL;
+    place = person->get_place_of_type(group_type_id);
+    if (place == NULL) {
+      return 0;
+    }
+    double value = place->get_median_of_var(var_id);
+    return value;
+  }
+  else {
+    Network* network = NULL;
+    network = person->get_network_of_type(group_type_id);
+    if (network == NULL) {
+      return 0;
+    }
+    double value = network->get_median_of_var(var_id);
+    return value;
+  }
+}
+
 double Factor::get_block_group_admin_code(Person* person, int place_type_id) {
   Place* place = NULL;
   place = person->get_place_of_type(place_type_id);
@@ -1246,10 +1300,16 @@ bool Factor::parse() {
     return true;
   }
 
-  if (this->name.find("sum_of_")==0 || this->name.find("ave_of_")==0) {
+  if (this->name.find("sum_of_")==0 || this->name.find("ave_of_")==0 || this->name.find("median_of_")==0) {
 
-    // get verb: 0 = "sum_of", 1 = "ave_of"
-    int verb = (this->name.find("ave_of_")==0);
+    // get verb: 0 = "sum_of", 1 = "ave_of", 2 = "median_of"
+    int verb = 0;
+    if (this->name.find("ave_of_")==0) {
+      verb = 1;
+    }
+    if (this->name.find("median_of_")==0) {
+      verb = 2;
+    }
 
     // get var name
     int pos = this->name.find("_of_") + 4;
@@ -1280,15 +1340,21 @@ bool Factor::parse() {
       return false;
     }
 
+    // use the group type's running aggregates if it keeps them
+    Group_Type::get_group_type(group_type_id)->aggregate_var(var_id, verb == 2);
+
     this->arg2 = var_id;
     this->arg3 = group_type_id;
     this->number_of_args = 3;
     if (verb == 0) {
       this->f3 = get_sum_of_vars_in_group;
     }
-    else {
+    if (verb == 1) {
       this->f3 = get_ave_of_vars_in_group;
     }
+    if (verb == 2) {
+      this->f3 = get_median_of_vars_in_group;
+    }
     return true;
   }
 
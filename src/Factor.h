@@ -41,6 +41,7 @@ typedef double (*Fptr_with_2_arg) (Person*,Person*);
 typedef double (*Fptr_with_3_arg) (Person*,Person*,int);
 
 class Factor {
+  friend class Bytecode;
 public:
 
   Factor(string s);
@@ -48,6 +49,7 @@ public:
   string get_name();
   double get_value(Person* person);
   double get_value(Person* person1, Person* person2);
+  bool is_local();
   bool is_warning() {
     return this->warning;
   }
@@ -122,6 +124,7 @@ private:
 			 int group_type_id, int condition_id, int state, int except_me);
   static double get_sum_of_vars_in_group(Person* person, int var_id, int group_type_id);
   static double get_ave_of_vars_in_group(Person* person, int var_id, int group_type_id);
+  static double get_median_of_vars_in_group(Person* person, int var_id, int group_type_id);
 
   /// Factors based on groups
   static double get_group_id(Person* person, int group_type_id);
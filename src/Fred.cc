@@ -23,7 +23,9 @@
 // File: Fred.cc
 //
 
+#include "Checkpoint.h"
 #include "County.h"
+#include "Daily_Report.h"
 #include "Date.h"
 #include "Demographics.h"
 #include "Condition.h"
@@ -39,6 +41,9 @@
 #include "Preference.h"
 #include "Predicate.h"
 #include "Random.h"
+#include "Exposure_Trace.h"
+#include "External_Update.h"
+#include "Record_Log.h"
 #include "Regional_Layer.h"
 #include "Rule.h"
 #include "Transmission.h"
@@ -58,16 +63,30 @@ class Place;
 
 #include <unistd.h>
 #include <stdio.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <sstream>
 
 // for reporting
 std::vector<int> daily_popsize;
 double_vector_t* daily_globals;
 
+// number of forked runs to execute at once (-n)
+int max_run_processes = 1;
+
+// health records and exposures written during a shared initialization
+std::string initial_health_records;
+std::string initial_exposures;
+
 //FRED main program
 
 int main(int argc, char* argv[]) {
   fred_setup(argc, argv);
-  for(Global::Simulation_Day = 0; Global::Simulation_Day < Global::Simulation_Days; ++Global::Simulation_Day) {
+  if(Global::Simulation_run_number < Global::Simulation_last_run_number) {
+    fred_fork_runs();
+    return 0;
+  }
+  for(Global::Simulation_Day = Checkpoint::get_first_day(); Global::Simulation_Day < Global::Simulation_Days; ++Global::Simulation_Day) {
     fred_day(Global::Simulation_Day);
   }
   fred_finish();
@@ -88,12 +107,13 @@ void fred_setup(int argc, char* argv[]) {
 
   strcpy(Global::Program_file, "");
   Global::Simulation_run_number = 1;
+  Global::Simulation_last_run_number = -1;
   strcpy(Global::Simulation_directory, "");
   Global::Compile_FRED = 0;
 
   // command line args using getopt
   int ch;
-  while((ch = getopt(argc, argv, "cd:p:r:")) != -1) {
+  while((ch = getopt(argc, argv, "cd:p:r:l:n:")) != -1) {
     switch (ch) {
     case 'c':
       Global::Compile_FRED = 1;
@@ -107,11 +127,23 @@ void fred_setup(int argc, char* argv[]) {
     case 'r':
       sscanf(optarg,"%d",&Global::Simulation_run_number);
       break;
+    case 'l':
+      sscanf(optarg,"%d",&Global::Simulation_last_run_number);
+      break;
+    case 'n':
+      sscanf(optarg,"%d",&max_run_processes);
+      break;
     case '?':
     default:
-      printf("usage: FRED -p program -r run_number -d output_directory [ -c ]\n");
+      printf("usage: FRED -p program -r run_number -d output_directory [ -l last_run_number [ -n processes ] ] [ -c ]\n");
     }
   }
+  if(Global::Simulation_last_run_number < Global::Simulation_run_number || Global::Compile_FRED) {
+    Global::Simulation_last_run_number = Global::Simulation_run_number;
+  }
+  if(max_run_processes < 1) {
+    max_run_processes = 1;
+  }
 
   if(strcmp(Global::Program_file, "") == 0) {
     strcpy(Global::Program_file, "model.fred");
@@ -155,6 +187,12 @@ void fred_setup(int argc, char* argv[]) {
   // open output files with global file pointers
   Utils::fred_open_output_files();
 
+  // checkpoint properties (checked once the output files are open)
+  Checkpoint::get_properties();
+
+  // the external model for update_vars_externally
+  External_Update::get_properties();
+
   // clear warnings_file and error_file
   sprintf(error_file, "%s/errors.txt", Global::Simulation_directory);
   unlink(error_file);
@@ -166,6 +204,17 @@ void fred_setup(int argc, char* argv[]) {
   // set up dates and verify start_date and end_date
   Date::setup_dates();
 
+  // runs forked from a shared initialization are started from the same
+  // seed and separated by reseeding on day 0
+  if(Global::Simulation_run_number < Global::Simulation_last_run_number) {
+    if(Global::Enable_Visualization_Layer) {
+      Utils::fred_abort("the visualization layer can't be used when one process serves several runs\n");
+    }
+    if(Global::Reseed_day == -1) {
+      Global::Reseed_day = 0;
+    }
+  }
+
   // set random number seed based on run number
   if(Global::Simulation_run_number > 1 && Global::Reseed_day == -1) {
     Global::Simulation_seed = Global::Seed * 100 + (Global::Simulation_run_number - 1);
@@ -192,6 +241,9 @@ void fred_setup(int argc, char* argv[]) {
   Place::get_place_properties();
   Utils::fred_print_lap_time("PHASE 1: get_properties");
 
+  // the exposure trace names the conditions and group types defined above
+  fred_open_exposure_trace();
+
   // PHASE 2: SETUP CONDITIONS AND DEFINE PLACES
 
   Condition::setup_conditions();
@@ -347,6 +399,10 @@ void fred_setup(int argc, char* argv[]) {
   // prepare for daily reports
   daily_popsize.clear();
   daily_globals = new double_vector_t [Person::get_number_of_global_vars()];
+
+  // optional: continue from a checkpoint
+  Checkpoint::restore();
+
   Utils::fred_print_wall_time("FRED initialization complete");
   Utils::fred_start_timer(&Global::Simulation_start_time);
   Utils::fred_print_initialization_timer();
@@ -355,6 +411,111 @@ void fred_setup(int argc, char* argv[]) {
 }
 
 
+/*
+ * Serve runs Simulation_run_number through Simulation_last_run_number
+ * from the world initialized by fred_setup(): each run is a forked copy
+ * of this process, so the initialized world is shared copy-on-write, and
+ * the runs differ only through the reseeding on Reseed_day.  Each run
+ * writes its status log to RUNn/LOG.
+ */
+void fred_fork_runs() {
+  std::map<pid_t, int> run_of_process;
+  int failed = 0;
+
+  // the health records and exposures written so far belong to every
+  // run; closing the files also stops their writer threads, which must
+  // not be forked
+  if(Record_Log::is_open()) {
+    string filename = Record_Log::get_filename();
+    Record_Log::close();
+    std::ifstream records(filename.c_str(), std::ios::binary);
+    std::stringstream contents;
+    contents << records.rdbuf();
+    initial_health_records = contents.str();
+  }
+  if(Exposure_Trace::is_open()) {
+    string filename = Exposure_Trace::get_filename();
+    Exposure_Trace::close();
+    std::ifstream exposures(filename.c_str(), std::ios::binary);
+    std::stringstream contents;
+    contents << exposures.rdbuf();
+    initial_exposures = contents.str();
+  }
+
+  // don't let the runs repeat any output buffered so far
+  fflush(NULL);
+
+  for(int run = Global::Simulation_run_number; run <= Global::Simulation_last_run_number; ++run) {
+    if(run_of_process.size() == max_run_processes) {
+      failed += fred_wait_for_run(run_of_process);
+    }
+    pid_t pid = fork();
+    if(pid < 0) {
+      Utils::fred_abort("can't fork a process for run %d\n", run);
+    }
+    if(pid == 0) {
+      fred_setup_run(run);
+      for(Global::Simulation_Day = Checkpoint::get_first_day(); Global::Simulation_Day < Global::Simulation_Days; ++Global::Simulation_Day) {
+	fred_day(Global::Simulation_Day);
+      }
+      fred_finish();
+      exit(0);
+    }
+    run_of_process[pid] = run;
+    fprintf(Global::Statusfp, "FRED run %d started in process %d\n", run, (int) pid);
+    fflush(Global::Statusfp);
+  }
+  while(run_of_process.size() > 0) {
+    failed += fred_wait_for_run(run_of_process);
+  }
+  Utils::fred_print_wall_time("FRED finished %d runs, %d failed,",
+			      Global::Simulation_last_run_number - Global::Simulation_run_number + 1, failed);
+}
+
+// wait for one forked run to end; returns 1 if it failed
+int fred_wait_for_run(std::map<pid_t, int> & run_of_process) {
+  int status;
+  pid_t pid = wait(&status);
+  if(pid < 0) {
+    Utils::fred_abort("lost track of %d forked runs\n", (int) run_of_process.size());
+  }
+  int run = run_of_process[pid];
+  run_of_process.erase(pid);
+  bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  fprintf(Global::Statusfp, "FRED run %d %s\n", run, ok ? "finished" : "FAILED");
+  fflush(Global::Statusfp);
+  return ok ? 0 : 1;
+}
+
+// in a forked process, switch the per-run state and output files to the given run
+void fred_setup_run(int run) {
+  Global::Simulation_run_number = run;
+  Global::Simulation_last_run_number = run;
+  if(Global::Health_Records_Run != -1 && run != Global::Health_Records_Run) {
+    Global::Enable_Records = false;
+  }
+
+  char directory[FRED_STRING_SIZE];
+  char logfile[FRED_STRING_SIZE];
+  sprintf(directory, "%s/RUN%d", Global::Simulation_directory, run);
+  Utils::fred_make_directory(directory);
+  sprintf(logfile, "%s/LOG", directory);
+  if(freopen(logfile, "w", stdout) == NULL) {
+    Utils::fred_abort("can't open %s\n", logfile);
+  }
+  Global::Statusfp = stdout;
+
+  Utils::fred_open_output_files();
+  Record_Log::write_prior_records(initial_health_records);
+  fred_open_exposure_trace();
+  Exposure_Trace::write_prior_records(initial_exposures);
+  Demographics::open_output_files();
+
+  Utils::fred_print_wall_time("FRED run %d started from shared initialization", run);
+  Utils::fred_start_timer(&Global::Simulation_start_time);
+}
+
+
 void fred_day(int day) {
 
   Utils::fred_start_day_timer();
@@ -394,6 +555,27 @@ void fred_step(int day, int hour) {
   }
 }
 
+// open RUNn/exposures.bin if enable_exposure_trace is set
+void fred_open_exposure_trace() {
+  if(Global::Enable_Exposure_Trace == false) {
+    return;
+  }
+  std::vector<string> condition_names;
+  for(int i = 0; i < Condition::get_number_of_conditions(); ++i) {
+    condition_names.push_back(Condition::get_name(i));
+  }
+  std::vector<string> group_type_names;
+  for(int i = 0; i < Group_Type::get_number_of_group_types(); ++i) {
+    group_type_names.push_back(Group_Type::get_group_type_name(i));
+  }
+  char filename[FRED_STRING_SIZE];
+  sprintf(filename, "%s/RUN%d/exposures.bin", Global::Simulation_directory, Global::Simulation_run_number);
+  if(Exposure_Trace::open(filename, condition_names, group_type_names) == false) {
+    Utils::fred_abort("Can't open %s\n", filename);
+  }
+}
+
+
 void fred_setup_day(int day) {
 
   // optional: reseed the random number generator to create alternative
@@ -467,6 +649,7 @@ void fred_finish_day(int day) {
   }
   Utils::fred_print_lap_time("day %d report place_types", day);
   
+  Network_Type::update_network_types(day);
   Network_Type::print_network_types(day);
   Utils::fred_print_lap_time("day %d print network_types", day);
   
@@ -497,98 +680,48 @@ void fred_finish_day(int day) {
   FRED_STATUS(0, "%s %s ", Date::get_day_of_week_string().c_str(), Date::get_date_string().c_str());
   Utils::fred_print_day_timer(day);
 
+  // let the writer catch up with the day's health records
+  Record_Log::flush();
+
   // advance date counter
   Date::update();
+
+  // optional: save the state of the simulation
+  Checkpoint::save(day);
 }
 
 
 void make_output_variable_files() {
-  // parse the output files into csv files, one for each column
-  char dir[FRED_STRING_SIZE];
-  sprintf(dir, "%s/RUN%d/DAILY", Global::Simulation_directory, Global::Simulation_run_number);
-  Utils::fred_make_directory(dir);
-
-  char outfile[FRED_STRING_SIZE];
-  sprintf(outfile, "%s/Popsize.txt", dir);
-  FILE *fp = fopen(outfile, "w");
-  if(fp == NULL) {
-    Utils::fred_abort("Fred: can't open file %s\n", outfile);
-  }
-  for(int day = 0; day < Global::Simulation_Days; ++day) {
-    fprintf(fp, "%d %d\n", day, daily_popsize[day]);
-  }
-  fclose(fp);
+  // collect the daily output variables into one csv file for the run
+  Daily_Report report;
 
-  sprintf(outfile, "%s/Date.txt", dir);
-  fp = fopen(outfile, "w");
-  if(fp == NULL) {
-    Utils::fred_abort("Fred: can open file %s\n", outfile);
-  }
-  for(int day = 0; day < Global::Simulation_Days; ++day) {
-    string datestring = Date::get_date_string(day);
-    fprintf(fp, "%d %s\n", day, datestring.c_str());
-  }
-  fclose(fp);
-
-  sprintf(outfile, "%s/EpiWeek.txt", dir);
-  fp = fopen(outfile, "w");
-  if(fp == NULL) {
-    Utils::fred_abort("Fred: can open file %s\n", outfile);
-  }
+  std::vector<string> dates;
+  std::vector<string> epiweeks;
   for(int day = 0; day < Global::Simulation_Days; ++day) {
+    dates.push_back(Date::get_date_string(day));
     char epiweek[FRED_STRING_SIZE];
     sprintf(epiweek, "%d.%02d", Date::get_epi_year(day), Date::get_epi_week(day));
-    fprintf(fp, "%d %s\n", day, epiweek);
+    epiweeks.push_back(epiweek);
   }
-  fclose(fp);
-
-  // create a csv file for this run
-
-  // this joins two files with same value in column 1, from
-  // https://stackoverflow.com/questions/14984340/using-awk-to-process-input-from-multiple-files
-  char awkcommand[FRED_STRING_SIZE];
-  sprintf(awkcommand, "awk 'FNR==NR{a[$1]=$2 FS $3;next}{print $0, a[$1]}' ");
+  report.add_column("Date", dates);
+  report.add_column("EpiWeek", epiweeks);
+  report.add_column("Popsize", daily_popsize);
 
-  char command[FRED_STRING_SIZE];
-  char csvfile[FRED_STRING_SIZE];
+  if(Global::Enable_Daily_Text_Files) {
+    char dir[FRED_STRING_SIZE];
+    sprintf(dir, "%s/RUN%d/DAILY", Global::Simulation_directory, Global::Simulation_run_number);
+    Utils::fred_make_directory(dir);
+    report.write_daily_files(dir);
+  }
 
-  sprintf(csvfile, "%s/RUN%d/out.csv", Global::Simulation_directory, Global::Simulation_run_number);
-  sprintf(command, "cp %s/Date.txt %s", dir, csvfile);
-  system(command);
-
-  sprintf(command, "%s %s/EpiWeek.txt %s > %s.tmp; mv %s.tmp %s", awkcommand, dir, csvfile, csvfile, csvfile, csvfile);
-  system(command);
-    
-  sprintf(command, "%s %s/Popsize.txt %s > %s.tmp; mv %s.tmp %s", awkcommand, dir, csvfile, csvfile, csvfile, csvfile);
-  system(command);
-
-  // add a header line
-  // create a header line for the csv file
-  char headerfile[FRED_STRING_SIZE];
-  sprintf(headerfile, "%s/RUN%d/out.header", Global::Simulation_directory, Global::Simulation_run_number);
-  fp = fopen(headerfile, "w");
-  fprintf(fp, "Day Date EpiWeek Popsize \n");
-  fclose(fp);
-
-  // concatenate header line
-  sprintf(command, "cat %s %s > %s.tmp; mv %s.tmp %s; unlink %s", headerfile, csvfile, csvfile, csvfile, csvfile, headerfile);
-  system(command);
-
-  // join all the condition csv files
-  char condfile[FRED_STRING_SIZE];
+  // add the columns of all the condition csv files
   for(int cond_id = 0; cond_id < Condition::get_number_of_conditions(); ++cond_id) {
-    string condname = Condition::get_name(cond_id);
-    sprintf(condfile, "%s/RUN%d/%s.csv", Global::Simulation_directory, Global::Simulation_run_number, condname.c_str());
-    sprintf(command, "%s %s %s > %s.tmp; mv %s.tmp %s", awkcommand, condfile, csvfile, csvfile, csvfile, csvfile);
-    // FRED_VERBOSE(0, "command = |%s|\n", command);
-    system(command);
+    report.add_columns(Condition::get_condition(cond_id)->get_epidemic()->get_daily_report());
   }
 
-  // replace spaces with commas
-  sprintf(command, "sed -E 's/ +/,/g' %s | sed -E 's/,$//' > %s.tmp; mv %s.tmp %s", csvfile, csvfile, csvfile, csvfile);
-  system(command);
-
-  return;
+  char csvfile[FRED_STRING_SIZE];
+  sprintf(csvfile, "%s/RUN%d/out.csv", Global::Simulation_directory, Global::Simulation_run_number);
+  report.write_csv(csvfile, false);
 }
 
 
@@ -628,69 +761,21 @@ void fred_finish_global_vars() {
     return;
   }
 
-  char dir[FRED_STRING_SIZE];
-  char outfile[FRED_STRING_SIZE];
-  FILE* fp;
-
-  sprintf(dir, "%s/RUN%d/DAILY", Global::Simulation_directory, Global::Simulation_run_number);
-  Utils::fred_make_directory(dir);
-
+  Daily_Report report;
   for(int var_id = 0; var_id < num_vars; ++var_id) {
     string var_name = Person::get_global_var_name(var_id);
+    report.add_column("FRED." + var_name, daily_globals[var_id]);
+  }
 
-    sprintf(outfile, "%s/FRED.%s.txt", dir, var_name.c_str());
-    fp = fopen(outfile, "w");
-    if(fp == NULL) {
-      Utils::fred_abort("Fred: can't open file %s\n", outfile);
-    }
-    for(int day = 0; day < Global::Simulation_Days; ++day) {
-      double value = daily_globals[var_id][day];
-      fprintf(fp, "%d %f\n", day, value);
-    }
-    fclose(fp);
+  if(Global::Enable_Daily_Text_Files) {
+    char dir[FRED_STRING_SIZE];
+    sprintf(dir, "%s/RUN%d/DAILY", Global::Simulation_directory, Global::Simulation_run_number);
+    Utils::fred_make_directory(dir);
+    report.write_daily_files(dir);
   }
 
   // create a csv file for global vars
-  
-  // this joins two files with same value in column 1, from
-  // https://stackoverflow.com/questions/14984340/using-awk-to-process-input-from-multiple-files
-  char awkcommand[FRED_STRING_SIZE];
-  sprintf(awkcommand, "awk 'FNR==NR{a[$1]=$2 FS $3;next}{print $0, a[$1]}' ");
-  
-  char command[FRED_STRING_SIZE];
-  char dailyfile[FRED_STRING_SIZE];
-  
+  char outfile[FRED_STRING_SIZE];
   sprintf(outfile, "%s/RUN%d/FRED.csv", Global::Simulation_directory, Global::Simulation_run_number);
-  
-  for(int var_id = 0; var_id < num_vars; ++var_id) {
-    string var_name = Person::get_global_var_name(var_id);
-    sprintf(dailyfile, "%s/FRED.%s.txt", dir, var_name.c_str());
-    if(var_id == 0) {
-      sprintf(command, "cp %s %s", dailyfile, outfile);
-    } else {
-      sprintf(command, "%s %s %s > %s.tmp; mv %s.tmp %s", awkcommand, dailyfile, outfile, outfile, outfile, outfile);
-    }
-    system(command);
-  }  
-  
-  // create a header line for the csv file
-  char headerfile[FRED_STRING_SIZE];
-  sprintf(headerfile, "%s/RUN%d/FRED.header", Global::Simulation_directory, Global::Simulation_run_number);
-  fp = fopen(headerfile, "w");
-  fprintf(fp, "Day ");
-  for (int var_id = 0; var_id < num_vars; var_id++) {
-    string var_name = Person::get_global_var_name(var_id);
-    fprintf(fp, "FRED.%s ", var_name.c_str());
-  }
-  fprintf(fp, "\n");
-  fclose(fp);
-  
-  // concatenate header line
-  sprintf(command, "cat %s %s > %s.tmp; mv %s.tmp %s; unlink %s", headerfile, outfile, outfile, outfile, outfile, headerfile);
-  system(command);
-  
-  // replace spaces with commas
-  sprintf(command, "sed -E 's/ +/,/g' %s | sed -E 's/,$//' | sed -E 's/,/ /' > %s.tmp; mv %s.tmp %s", outfile, outfile, outfile, outfile);
-  system(command);
-
+  report.write_csv(outfile, true);
 }
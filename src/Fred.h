@@ -25,8 +25,15 @@
 
 #ifndef _FRED_H
 
+#include <map>
+#include <sys/types.h>
+
 int main(int argc, char* argv[]);
 void fred_setup(int argc, char* argv[]);
+void fred_fork_runs();
+int fred_wait_for_run(std::map<pid_t, int> & run_of_process);
+void fred_setup_run(int run);
+void fred_open_exposure_trace();
 void fred_setup_day(int day);
 void fred_day(int day);
 void fred_step(int day, int hour);
@@ -24,17 +24,23 @@
 //
 
 #include <stdio.h>
-#include <assert.h>
-#include <vector>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
-#include <cstring>
+#include <unordered_map>
+#include <vector>
 
-#include "Global.h"
+#include "Fred_API.h"
 
 using namespace std;
 
+// The external model for update_vars_externally (see Fred_API.h).  Built
+// as the FRED_API program it reads batches from its standard input and
+// writes the results to its standard output; built as fred_api.so it is
+// called by FRED through fred_api_update().  Either way, update() below
+// is called for each person in the batch.
+
 // include default RNG
-#include <stdlib.h>
 double get_urand() {
   double val = random();
   return val / (1.0 * RAND_MAX);
@@ -44,121 +50,197 @@ double get_urand() {
 void update();
 
 
-// keys
+// keys: day, person, age, race, sex, the conditions and the variables
 std::vector<std::string> keys;
+std::unordered_map<std::string, int> key_index;
+
+// values (the state of a condition is the index of the state, and the
+// value of sex is 1 for males)
+std::vector<double> values;
 
-// values
-std::vector<std::string> values;
+// position of the first condition in keys
+#define FIRST_CONDITION_KEY 5
 
 
 double get_value(string key) {
-  int size = keys.size();
-  for (int i = 0; i < size; i++) {
-    if (keys[i] == key) {
-      double val;
-      if (key == "sex") {
-	char chr;
-	sscanf(values[i].c_str(), "%c", &chr);
-	val = (chr == 'M');
-      }
-      else {
-	sscanf(values[i].c_str(), "%lf", &val);
-      }
-      return val;
-    }
+  std::unordered_map<std::string, int>::const_iterator found = key_index.find(key);
+  if (found != key_index.end()) {
+    return values[found->second];
   }
   return 0.0;
 }
 
 
 void set_value(string key, double val) {
-  int size = keys.size();
-  for (int i = 0; i < size; i++) {
-    if (keys[i] == key) {
-      char vstr[64];
-      sprintf(vstr, "%f", val);
-      values[i] = string(vstr);
-      return;
-    }
+  std::unordered_map<std::string, int>::const_iterator found = key_index.find(key);
+  if (found != key_index.end()) {
+    values[found->second] = val;
   }
   return;
 }
 
 
-char dir[FRED_STRING_SIZE];
+void set_keys(fred_api_batch_t* batch) {
+  keys.clear();
+  key_index.clear();
+  keys.push_back("day");
+  keys.push_back("person");
+  keys.push_back("age");
+  keys.push_back("race");
+  keys.push_back("sex");
+  for (int c = 0; c < batch->number_of_conditions; c++) {
+    keys.push_back(batch->condition_names[c]);
+  }
+  for (int v = 0; v < batch->number_of_vars; v++) {
+    keys.push_back(batch->var_names[v]);
+  }
+  for (int i = 0; i < keys.size(); i++) {
+    key_index[keys[i]] = i;
+  }
+  values.resize(keys.size());
+}
 
-int main(int argc, char* argv[]) {
 
-  // read working directory from command line
-  if(argc > 1) {
-    strcpy(dir, argv[1]);
-  } else {
-    strcpy(dir, "");
+extern "C" int fred_api_update(fred_api_batch_t* batch) {
+  int number_of_conditions = batch->number_of_conditions;
+  int number_of_vars = batch->number_of_vars;
+  if (keys.size() != FIRST_CONDITION_KEY + number_of_conditions + number_of_vars) {
+    set_keys(batch);
   }
-  // printf("dir = |%s|\n", dir);
+  int first_var = FIRST_CONDITION_KEY + number_of_conditions;
+  for (int p = 0; p < batch->number_of_people; p++) {
+    fred_api_person_t* person = &batch->people[p];
+    values[0] = batch->day;
+    values[1] = person->id;
+    values[2] = person->age;
+    values[3] = person->race;
+    values[4] = (person->sex == 'M');
+    for (int c = 0; c < number_of_conditions; c++) {
+      values[FIRST_CONDITION_KEY + c] = person->state[c];
+    }
+    for (int v = 0; v < number_of_vars; v++) {
+      values[first_var + v] = person->var[v];
+    }
 
-  // requests filename
-  char requests[FRED_STRING_SIZE];
-  sprintf(requests, "%s/requests", dir);
+    update();
 
-  // open request file
-  FILE* reqfp = fopen(requests, "r");
-  if (reqfp == NULL) {
-    //abort
+    for (int v = 0; v < number_of_vars; v++) {
+      person->var[v] = values[first_var + v];
+    }
   }
+  return 0;
+}
 
-  char next_filename[FRED_STRING_SIZE];
-  char requestfile[FRED_STRING_SIZE];
-  
-  while (fscanf(reqfp, "%s", next_filename)==1) {
 
-    // request filename
-    sprintf(requestfile, "%s/%s", dir, next_filename);
+bool read_data(void* data, size_t size) {
+  return size == 0 || fread(data, size, 1, stdin) == 1;
+}
 
-    // open request file
-    FILE* fp = fopen(requestfile, "r");
-    if (fp == NULL) {
-      // abort
-    }
 
-    // clear keys and values
-    keys.clear();
-    values.clear();
+bool read_int(int32_t* value) {
+  return read_data(value, sizeof(int32_t));
+}
 
-    char key[FRED_STRING_SIZE];
-    char val[FRED_STRING_SIZE];
-    while (fscanf(fp, "%s = %s ", key, val) == 2) {
-      keys.push_back(string(key));
-      values.push_back(string(val));
-      // printf("%s == %s\n", key,val);
+
+bool read_name(std::vector<char> & storage, std::vector<size_t> & offsets) {
+  int32_t length;
+  if (read_int(&length) == false) {
+    return false;
+  }
+  offsets.push_back(storage.size());
+  storage.resize(storage.size() + length + 1);
+  storage.back() = '\0';
+  return read_data(&storage[offsets.back()], length);
+}
+
+
+int main(int argc, char* argv[]) {
+
+  // names of the conditions, their states and the variables
+  char magic[sizeof(FRED_API_MAGIC) - 1];
+  if (read_data(magic, sizeof(magic)) == false || memcmp(magic, FRED_API_MAGIC, sizeof(magic)) != 0) {
+    fprintf(stderr, "%s: expected a batch from FRED on standard input\n", argv[0]);
+    return 1;
+  }
+  std::vector<char> storage;
+  std::vector<size_t> offsets;
+  fred_api_batch_t batch;
+  std::vector<int32_t> number_of_states;
+  if (read_int(&batch.number_of_conditions) == false) {
+    return 1;
+  }
+  for (int c = 0; c < batch.number_of_conditions; c++) {
+    int32_t states;
+    if (read_name(storage, offsets) == false || read_int(&states) == false) {
+      return 1;
     }
-    fclose(fp);
-    if (keys.size() == 0) {
-      continue;
+    number_of_states.push_back(states);
+    for (int s = 0; s < states; s++) {
+      if (read_name(storage, offsets) == false) {
+	return 1;
+      }
+    }
+  }
+  if (read_int(&batch.number_of_vars) == false) {
+    return 1;
+  }
+  for (int v = 0; v < batch.number_of_vars; v++) {
+    if (read_name(storage, offsets) == false) {
+      return 1;
     }
+  }
 
-    update();
+  // the storage is complete, so the names can point into it
+  std::vector<const char*> names;
+  for (int i = 0; i < offsets.size(); i++) {
+    names.push_back(&storage[offsets[i]]);
+  }
+  std::vector<const char*> condition_names;
+  std::vector<const char**> state_names;
+  int next = 0;
+  for (int c = 0; c < batch.number_of_conditions; c++) {
+    condition_names.push_back(names[next++]);
+    state_names.push_back(&names[next]);
+    next += number_of_states[c];
+  }
+  batch.condition_names = condition_names.data();
+  batch.number_of_states = number_of_states.data();
+  batch.state_names = state_names.data();
+  batch.var_names = &names[next];
+
+  // answer each batch until FRED closes the input
+  std::vector<fred_api_person_t> people;
+  std::vector<int32_t> states;
+  std::vector<double> vars;
+  while (read_int(&batch.day)) {
+    if (read_int(&batch.number_of_people) == false) {
+      return 1;
+    }
+    int count = batch.number_of_people;
+    people.resize(count);
+    states.resize(count * batch.number_of_conditions);
+    vars.resize(count * batch.number_of_vars);
+    for (int p = 0; p < count; p++) {
+      fred_api_person_t* person = &people[p];
+      person->state = states.data() + p * batch.number_of_conditions;
+      person->var = vars.data() + p * batch.number_of_vars;
+      if (read_int(&person->id) == false || read_int(&person->age) == false
+	  || read_int(&person->race) == false || read_int(&person->sex) == false
+	  || read_data(person->state, batch.number_of_conditions * sizeof(int32_t)) == false
+	  || read_data(person->var, batch.number_of_vars * sizeof(double)) == false) {
+	return 1;
+      }
+    }
+    batch.people = people.data();
 
-    // set results filename
-    char results_file[FRED_STRING_SIZE];
-    int id = get_value("person");
-    sprintf(results_file, "%s/results.%d", dir, id);
-    
-    // open results file
-    fp = fopen(results_file, "w");
-    int size = keys.size();
-    for (int i = 0; i < size; i++) {
-      fprintf(fp, "%s = %s\n", keys[i].c_str(), values[i].c_str());
+    fred_api_update(&batch);
+
+    if (vars.size() > 0 && fwrite(vars.data(), vars.size() * sizeof(double), 1, stdout) != 1) {
+      return 1;
     }
-    fclose(fp);
+    fflush(stdout);
   }
 
-  // send ready signal
-  char ready_file[FRED_STRING_SIZE];
-  sprintf(ready_file, "%s/results_ready", dir);
-  FILE* fp = fopen(ready_file, "w");
-  fclose(fp);
-
   return 0;
 }
 
@@ -0,0 +1,87 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Fred_API.h
+//
+// The interface between FRED and an external model that updates the
+// variables of people in states with update_vars_externally = 1.
+//
+// Each day FRED passes all such people to the external model as one
+// batch, in one of two ways:
+//
+// - If external_update_library names a shared library, FRED loads it
+//   with dlopen and calls its function fred_api_update(batch), which
+//   updates the var arrays of the batch in place.
+//
+// - Otherwise FRED starts external_update_program (FRED_API by default)
+//   once per run and talks to it through its standard input and output.
+//   When the program starts, FRED sends it the magic "FREDAPI1" and the
+//   names of the conditions, their states and the variables.  For each
+//   batch FRED then sends the day and the number of people, and for each
+//   person the id, age, race, sex, the state of each condition and the
+//   variables.  The program answers with the new variables of each
+//   person, in the same order.  All numbers are in native byte order:
+//   int32 for counts and people, double for variables; a name is an
+//   int32 length followed by its characters.  The program should exit
+//   when its input is closed.
+//
+// Fred_API.cc implements both: make builds it as the FRED_API program
+// and as the library fred_api.so.
+//
+
+#ifndef _FRED_API_H
+#define _FRED_API_H
+
+#include <stdint.h>
+
+#define FRED_API_MAGIC "FREDAPI1"
+#define FRED_API_UPDATE_FUNCTION "fred_api_update"
+
+extern "C" {
+
+  typedef struct {
+    int32_t id;
+    int32_t age;
+    int32_t race;
+    int32_t sex;             // 'M' or 'F'
+    int32_t* state;          // the state of each condition
+    double* var;             // the variables, updated by the external model
+  } fred_api_person_t;
+
+  typedef struct {
+    int32_t day;
+    int32_t number_of_conditions;
+    const char** condition_names;
+    int32_t* number_of_states;
+    const char*** state_names;
+    int32_t number_of_vars;
+    const char** var_names;
+    int32_t number_of_people;
+    fred_api_person_t* people;
+  } fred_api_batch_t;
+
+  // returns 0 on success
+  typedef int (*fred_api_update_t)(fred_api_batch_t* batch);
+
+}
+
+#endif // _FRED_API_H
@@ -0,0 +1,53 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown, 
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse, 
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the 
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Fred_Cache_Pop.cc
+//
+// Converts synthetic population directories to the binary population
+// cache read by FRED at startup (see Population_Cache.h).
+//
+// usage: fred_cache_pop pop_dir [pop_dir ...]
+//
+// where each pop_dir holds households.txt, people.txt, etc., for
+// example $FRED_HOME/data/country/usa/RTI_2010_ver1/42065
+//
+
+#include <stdio.h>
+
+#include "Population_Cache.h"
+
+int main(int argc, char* argv[]) {
+
+  if(argc < 2) {
+    fprintf(stderr, "usage: %s pop_dir [pop_dir ...]\n", argv[0]);
+    return 1;
+  }
+
+  int errors = 0;
+  for(int i = 1; i < argc; ++i) {
+    if(Population_Cache::convert(argv[i]) == false) {
+      fprintf(stderr, "%s: could not convert %s\n", argv[0], argv[i]);
+      errors++;
+    }
+  }
+  return errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Fred_Exposures.cc
+//
+// Summarizes the exposure trace written when enable_exposure_trace = 1
+// (see Exposure_Trace.h).  For each condition it reports the number of
+// exposures and imported exposures, the mean serial interval (in days,
+// as in the LOG file), the mean generation time (in hours, from the
+// exposure of the source to the exposure of the host) and the exposures
+// in each group type, followed by a csv table of the daily cohort size,
+// the number of people infected by the cohort and the resulting
+// reproductive rate (the RR column of the output).
+//
+// usage: fred_exposures exposures.bin [condition]
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <utility>
+
+#include "Exposure_Trace.h"
+
+typedef Exposure_Trace::record_t record_t;
+
+void report_condition(int condition, const std::vector<string> & condition_names,
+		      const std::vector<string> & group_type_names, const std::vector<record_t> & records) {
+
+  int exposures = 0;
+  int imported = 0;
+  int secondary = 0;
+  double total_serial_interval = 0.0;
+  int generations = 0;
+  double total_generation_time = 0.0;
+  std::vector<int> exposures_in_group_type(group_type_names.size() + 1, 0);
+  std::vector<int> cohort_size;
+  std::vector<int> infected_by_cohort;
+
+  // hour of the latest exposure of each person, and the day of the
+  // exposure, which identifies it to the people the person infects
+  std::map<int, std::pair<int, int> > exposure_of_person;
+
+  for(int i = 0; i < records.size(); ++i) {
+    const record_t & record = records[i];
+    if(record.condition != condition) {
+      continue;
+    }
+    ++exposures;
+    exposure_of_person[record.host] = std::make_pair(record.day, record.day * 24 + record.hour);
+    if(cohort_size.size() <= record.day) {
+      cohort_size.resize(record.day + 1, 0);
+      infected_by_cohort.resize(record.day + 1, 0);
+    }
+    ++cohort_size[record.day];
+    int group_type = record.group_type;
+    if(group_type < 0 || group_type >= group_type_names.size()) {
+      group_type = group_type_names.size();
+    }
+    ++exposures_in_group_type[group_type];
+
+    if(record.source < 0) {
+      ++imported;
+      continue;
+    }
+    ++secondary;
+    total_serial_interval += record.day - record.source_exposure_day;
+    if(0 <= record.source_exposure_day && record.source_exposure_day < infected_by_cohort.size()) {
+      ++infected_by_cohort[record.source_exposure_day];
+    }
+    std::map<int, std::pair<int, int> >::const_iterator found = exposure_of_person.find(record.source);
+    if(found != exposure_of_person.end() && found->second.first == record.source_exposure_day) {
+      total_generation_time += record.day * 24 + record.hour - found->second.second;
+      ++generations;
+    }
+  }
+
+  printf("condition %s\n", condition_names[condition].c_str());
+  printf("exposures %d\n", exposures);
+  printf("imported_exposures %d\n", imported);
+  printf("mean_serial_interval %.2f\n", secondary > 0 ? total_serial_interval / secondary : 0.0);
+  printf("mean_generation_time_hours %.2f\n", generations > 0 ? total_generation_time / generations : 0.0);
+  for(int i = 0; i < group_type_names.size(); ++i) {
+    if(exposures_in_group_type[i] > 0) {
+      printf("exposures_in %s %d\n", group_type_names[i].c_str(), exposures_in_group_type[i]);
+    }
+  }
+  if(exposures_in_group_type[group_type_names.size()] > 0) {
+    printf("exposures_in NONE %d\n", exposures_in_group_type[group_type_names.size()]);
+  }
+  printf("Day,CohortSize,InfectedByCohort,RR\n");
+  for(int day = 0; day < cohort_size.size(); ++day) {
+    double rr = 0.0;
+    if(cohort_size[day] > 0) {
+      rr = static_cast<double>(infected_by_cohort[day]) / static_cast<double>(cohort_size[day]);
+    }
+    printf("%d,%d,%d,%f\n", day, cohort_size[day], infected_by_cohort[day], rr);
+  }
+  printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+
+  if(argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s exposures.bin [condition]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<string> condition_names;
+  std::vector<string> group_type_names;
+  std::vector<record_t> records;
+  if(Exposure_Trace::read(argv[1], condition_names, group_type_names, records) == false) {
+    fprintf(stderr, "%s: could not read %s\n", argv[0], argv[1]);
+    return 1;
+  }
+
+  bool found = false;
+  for(int condition = 0; condition < condition_names.size(); ++condition) {
+    if(argc == 3 && strcmp(argv[2], condition_names[condition].c_str()) != 0) {
+      continue;
+    }
+    found = true;
+    report_condition(condition, condition_names, group_type_names, records);
+  }
+  if(found == false) {
+    fprintf(stderr, "%s: no condition %s in %s\n", argv[0], argv[2], argv[1]);
+    return 1;
+  }
+  return 0;
+}
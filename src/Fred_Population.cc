@@ -0,0 +1,124 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Fred_Population.cc
+//
+// Reads the population snapshots written when output_population = 1 and
+// output_population_binary = 1 (see Population_Snapshot.h).
+//
+// usage: fred_population pop_out.bin [day]
+//
+// Without a day, lists the snapshots in the file.  With a day, writes
+// the snapshot of that day (the last one, if there are several) to
+// standard output, one person per line: the fields of the text
+// population file, followed by the state of each condition and the
+// selected variables.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Population_Snapshot.h"
+
+typedef Population_Snapshot::reader_t reader_t;
+
+void print_snapshot(const reader_t & reader) {
+  int columns = reader.kinds.size();
+  int people = reader.people;
+  for(int r = 0; r < people; ++r) {
+    for(int c = 0; c < columns; ++c) {
+      int64_t value = reader.table[c * people + r];
+      if(c > 0) {
+	putchar(' ');
+      }
+      switch(reader.kinds[c]) {
+      case Population_Snapshot::CHARACTER:
+	putchar(static_cast<char>(value));
+	break;
+      case Population_Snapshot::PLACE:
+	if(0 <= value && value < reader.labels.size()) {
+	  fputs(reader.labels[value].c_str(), stdout);
+	}
+	else {
+	  fputs("-1", stdout);
+	}
+	break;
+      case Population_Snapshot::REAL:
+	printf("%f", Population_Snapshot::to_real(value));
+	break;
+      default:
+	printf("%lld", static_cast<long long>(value));
+      }
+    }
+    putchar('\n');
+  }
+}
+
+int main(int argc, char* argv[]) {
+
+  if(argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s pop_out.bin [day]\n", argv[0]);
+    return 1;
+  }
+
+  reader_t reader;
+  if(Population_Snapshot::open_reader(argv[1], &reader) == false) {
+    fprintf(stderr, "%s: could not read %s\n", argv[0], argv[1]);
+    return 1;
+  }
+
+  if(argc == 2) {
+    printf("columns:");
+    for(int c = 0; c < reader.names.size(); ++c) {
+      printf(" %s", reader.names[c].c_str());
+    }
+    printf("\n");
+  }
+
+  // deltas depend on the snapshots before them, so each is read in turn
+  int day = argc == 3 ? atoi(argv[2]) : -1;
+  bool found = false;
+  reader_t snapshot;
+  while(Population_Snapshot::read(&reader)) {
+    if(argc == 2) {
+      printf("day %d %s people %d%s\n", reader.day, reader.date.c_str(), reader.people,
+	     reader.delta ? " delta" : "");
+    }
+    else if(reader.day == day) {
+      found = true;
+      snapshot.kinds = reader.kinds;
+      snapshot.labels = reader.labels;
+      snapshot.people = reader.people;
+      snapshot.table = reader.table;
+    }
+  }
+  Population_Snapshot::close_reader(&reader);
+
+  if(argc == 3) {
+    if(found == false) {
+      fprintf(stderr, "%s: no snapshot for day %d in %s\n", argv[0], day, argv[1]);
+      return 1;
+    }
+    print_snapshot(snapshot);
+  }
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Fred_Records.cc
+//
+// Converts a binary health records file (written when
+// enable_binary_health_records = 1, see Record_Log.h) to the text form
+// of health_records.txt.
+//
+// usage: fred_records health_records.bin [health_records.txt]
+//
+// The text is written to standard output if no output file is given.
+//
+
+#include <stdio.h>
+
+#include "Record_Log.h"
+
+int main(int argc, char* argv[]) {
+
+  if(argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s health_records.bin [health_records.txt]\n", argv[0]);
+    return 1;
+  }
+
+  FILE* out = stdout;
+  if(argc == 3) {
+    out = fopen(argv[2], "w");
+    if(out == NULL) {
+      fprintf(stderr, "%s: can't open %s\n", argv[0], argv[2]);
+      return 1;
+    }
+  }
+
+  bool ok = Record_Log::convert(argv[1], out);
+  if(out != stdout) {
+    fclose(out);
+  }
+  if(ok == false) {
+    fprintf(stderr, "%s: could not convert %s\n", argv[0], argv[1]);
+    return 1;
+  }
+  return 0;
+}
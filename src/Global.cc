@@ -34,6 +34,7 @@ char Global::Simulation_directory[FRED_STRING_SIZE];
 char Global::Plot_directory[FRED_STRING_SIZE];
 char Global::Visualization_directory[FRED_STRING_SIZE];
 int Global::Simulation_run_number = 1;
+int Global::Simulation_last_run_number = 1;
 unsigned long Global::Simulation_seed = 1;
 high_resolution_clock::time_point Global::Simulation_start_time = high_resolution_clock::now();
 int Global::Simulation_Day = 0;
@@ -60,7 +61,14 @@ int Global::Max_Loops = 0;
 bool Global::Enable_Profiles = false;
 bool Global::Enable_Records = false;
 bool Global::Enable_Var_Records = false;
+bool Global::Enable_Binary_Records = false;
+bool Global::Enable_Exposure_Trace = false;
 bool Global::Enable_Transmission_Bias = false;
+bool Global::Enable_Parallel_Transmission = false;
+bool Global::Enable_Rule_Bytecode = true;
+bool Global::Enable_Preference_Weight_Reuse = false;
+bool Global::Enable_Population_Cache = true;
+bool Global::Enable_Daily_Text_Files = true;
 bool Global::Enable_New_Transmission_Model = false;
 bool Global::Enable_Hospitals = false;
 bool Global::Enable_Health_Insurance = false;
@@ -87,7 +95,6 @@ Visualization_Layer* Global::Visualization = NULL;
 
 // global file pointers
 FILE* Global::Statusfp = NULL;
-FILE* Global::Recordsfp = stdout;
 FILE* Global::Birthfp = NULL;
 FILE* Global::Deathfp = NULL;
 FILE* Global::ErrorLogfp = NULL;
@@ -108,7 +115,14 @@ void Global::get_global_properties() {
   Property::get_property("enable_profiles", &Global::Enable_Profiles);
   Property::get_property("enable_health_records", &Global::Enable_Records);
   Property::get_property("enable_var_records", &Global::Enable_Var_Records);
+  Property::get_property("enable_binary_health_records", &Global::Enable_Binary_Records);
+  Property::get_property("enable_exposure_trace", &Global::Enable_Exposure_Trace);
   Property::get_property("enable_transmission_bias", &Global::Enable_Transmission_Bias);
+  Property::get_property("enable_parallel_transmission", &Global::Enable_Parallel_Transmission);
+  Property::get_property("enable_rule_bytecode", &Global::Enable_Rule_Bytecode);
+  Property::get_property("enable_preference_weight_reuse", &Global::Enable_Preference_Weight_Reuse);
+  Property::get_property("enable_population_cache", &Global::Enable_Population_Cache);
+  Property::get_property("enable_daily_text_files", &Global::Enable_Daily_Text_Files);
   Property::get_property("enable_new_transmission_model", &Global::Enable_New_Transmission_Model);
   Property::get_property("enable_Hospitals", &Global::Enable_Hospitals);
   Property::get_property("enable_health_insurance", &Global::Enable_Health_Insurance);
@@ -124,15 +138,18 @@ void Global::get_global_properties() {
   Property::get_property("report_contacts", &Global::Report_Contacts);
 
   // set any properties that are dependent on other properties
+  // (when one process serves several runs, keep them if any run needs them)
   Property::get_property("visualization_run", &Global::Visualization_Run);
   if(Global::Visualization_Run != -1 &&
-      Global::Simulation_run_number != Global::Visualization_Run) {
+      (Global::Visualization_Run < Global::Simulation_run_number ||
+       Global::Simulation_last_run_number < Global::Visualization_Run)) {
     Global::Enable_Visualization_Layer = false;
   }
 
   Property::get_property("health_records_run", &Global::Health_Records_Run);
   if(Global::Health_Records_Run != -1 &&
-      Global::Simulation_run_number != Global::Health_Records_Run) {
+      (Global::Health_Records_Run < Global::Simulation_run_number ||
+       Global::Simulation_last_run_number < Global::Health_Records_Run)) {
     Global::Enable_Records = false;
   }
 
@@ -144,6 +144,7 @@ public:
   static char Plot_directory[FRED_STRING_SIZE];
   static char Visualization_directory[FRED_STRING_SIZE];
   static int Simulation_run_number;
+  static int Simulation_last_run_number;
   static unsigned long Simulation_seed;
   static high_resolution_clock::time_point Simulation_start_time;
   static int Simulation_Day;
@@ -171,8 +172,15 @@ public:
   static bool Enable_Profiles;
   static bool Enable_Records;
   static bool Enable_Var_Records;
+  static bool Enable_Binary_Records;
+  static bool Enable_Exposure_Trace;
   static bool Enable_Transmission_Network;
   static bool Enable_Transmission_Bias;
+  static bool Enable_Parallel_Transmission;
+  static bool Enable_Rule_Bytecode;
+  static bool Enable_Preference_Weight_Reuse;
+  static bool Enable_Population_Cache;
+  static bool Enable_Daily_Text_Files;
   static bool Enable_New_Transmission_Model;
   static bool Enable_Hospitals;
   static bool Enable_Health_Insurance;
@@ -202,7 +210,6 @@ public:
   static FILE* Birthfp;
   static FILE* Deathfp;
   static FILE* ErrorLogfp;
-  static FILE* Recordsfp;
 
   /**
    * Fills the static variables with values from the program file.
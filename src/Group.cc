@@ -24,7 +24,10 @@
 //
 
 #include "Group.h"
+#include "Checkpoint.h"
 #include "Condition.h"
+#include "Group_Type.h"
+#include "Network.h"
 #include "Person.h"
 #include "Utils.h"
 
@@ -92,6 +95,10 @@ int Group::begin_membership(Person* per) {
     this->members.reserve(2 * this->get_size());
   }
   this->members.push_back(per);
+  for(int slot = 0; slot < this->var_aggregate.size(); ++slot) {
+    int var_id = get_group_type()->get_aggregated_var(slot);
+    this->var_aggregate[slot].add(per->get_var(var_id));
+  }
   FRED_VERBOSE(1, "Enroll person %d age %d in group %d %s\n", per->get_id(), per->get_age(), this->get_id(), this->get_label());
   return this->members.size()-1;
 }
@@ -103,6 +110,10 @@ void Group::end_membership(int pos) {
   }
   assert(0 <= pos && pos < size);
   Person* removed = this->members[pos];
+  for(int slot = 0; slot < this->var_aggregate.size(); ++slot) {
+    int var_id = get_group_type()->get_aggregated_var(slot);
+    this->var_aggregate[slot].remove(removed->get_var(var_id));
+  }
   if(pos < size - 1) {
     Person* moved = this->members[size - 1];
     FRED_VERBOSE(1, "UNENROLL group %d %s pos = %d size = %d removed %d moved %d\n",
@@ -153,6 +164,10 @@ void Group::record_transmissible_days(int day, int condition_id) {
 }
 
 double Group::get_sum_of_var(int var_id) {
+  int slot = get_group_type()->get_var_aggregate_slot(var_id);
+  if(0 <= slot) {
+    return get_var_aggregate(slot)->get_sum();
+  }
   double sum = 0.0;
   for(int i = 0; i < this->members.size(); ++i) {
     Person* person = this->members[i];
@@ -162,6 +177,10 @@ double Group::get_sum_of_var(int var_id) {
 }
 
 double Group::get_median_of_var(int var_id) {
+  int slot = get_group_type()->get_var_aggregate_slot(var_id);
+  if(0 <= slot && get_group_type()->var_aggregate_keeps_values(slot)) {
+    return get_var_aggregate(slot)->get_median();
+  }
   int size = get_size();
   double median = 0.0;
   if(size > 0) {
@@ -177,6 +196,80 @@ double Group::get_median_of_var(int var_id) {
   return median;
 }
 
+Var_Aggregate* Group::get_var_aggregate(int slot) {
+  if(this->var_aggregate.size() <= slot) {
+    prepare_var_aggregates();
+  }
+  return &(this->var_aggregate[slot]);
+}
+
+/*
+ * Compute the aggregates from the current members.  From then on they
+ * are updated as members join and leave and as members' variables
+ * change.
+ */
+void Group::prepare_var_aggregates() {
+  Group_Type* group_type = get_group_type();
+  int slots = group_type->get_number_of_var_aggregates();
+  this->var_aggregate.clear();
+  this->var_aggregate.resize(slots);
+  for(int slot = 0; slot < slots; ++slot) {
+    int var_id = group_type->get_aggregated_var(slot);
+    this->var_aggregate[slot].keep_values = group_type->var_aggregate_keeps_values(slot);
+    for(int i = 0; i < this->members.size(); ++i) {
+      this->var_aggregate[slot].add(this->members[i]->get_var(var_id));
+    }
+  }
+}
+
+void Group::update_var_aggregate(int slot, double old_value, double new_value) {
+  if(slot < this->var_aggregate.size()) {
+    this->var_aggregate[slot].remove(old_value);
+    this->var_aggregate[slot].add(new_value);
+  }
+}
+
+void Var_Aggregate::add(double value) {
+  this->sum += value;
+  if(this->keep_values) {
+    if(this->upper.empty() || *(this->upper.begin()) <= value) {
+      this->upper.insert(value);
+    } else {
+      this->lower.insert(value);
+    }
+    rebalance();
+  }
+}
+
+void Var_Aggregate::remove(double value) {
+  this->sum -= value;
+  if(this->keep_values) {
+    std::multiset<double>::iterator itr = this->upper.find(value);
+    if(itr != this->upper.end()) {
+      this->upper.erase(itr);
+    } else {
+      itr = this->lower.find(value);
+      if(itr != this->lower.end()) {
+        this->lower.erase(itr);
+      }
+    }
+    rebalance();
+  }
+}
+
+// keep the size/2 smallest values in the lower half
+void Var_Aggregate::rebalance() {
+  if(this->lower.size() > this->upper.size()) {
+    std::multiset<double>::iterator last = --(this->lower.end());
+    this->upper.insert(*last);
+    this->lower.erase(last);
+  } else if(this->upper.size() > this->lower.size() + 1) {
+    std::multiset<double>::iterator first = this->upper.begin();
+    this->lower.insert(*first);
+    this->upper.erase(first);
+  }
+}
+
 void Group::report_size(int day) {
   int vec_size = this->size_on_day.size();
   if(vec_size == 0 || get_size() != this->size_on_day[vec_size - 1]) {
@@ -293,6 +386,25 @@ bool Group::is_a_network(int type_id) {
   return (Place_Type::get_number_of_place_types() <= type_id);
 }
 
+int Group::get_number_of_groups(int type_id) {
+  if(Group::is_a_place(type_id)) {
+    return Place_Type::get_place_type(type_id)->get_number_of_places();
+  }
+  return 1;
+}
+
+Group* Group::get_group(int type_id, int index) {
+  if(Group::is_a_place(type_id)) {
+    Place_Type* place_type = Place_Type::get_place_type(type_id);
+    if(0 <= index && index < place_type->get_number_of_places()) {
+      return place_type->get_place(index);
+    }
+    return NULL;
+  }
+  // one network per network type
+  return Network_Type::get_network(type_id);
+}
+
 /**
  * Set the sp_id of this mixing Group. There is a static map that is used to avoid duplications. If the value is a duplicate, a warning message will be
  * created.
@@ -312,3 +424,42 @@ void Group::set_sp_id(long long int value) {
   }
 }
 
+/*
+ * Members are restored in their saved order, so that each member gets
+ * the same index in the group as in the run that wrote the checkpoint.
+ * People's memberships must have been cleared first.
+ */
+void Group::save_checkpoint(Checkpoint* checkpoint) {
+  checkpoint->put_people(this->members);
+  checkpoint->put_bool(this->reporting_size);
+  checkpoint->put_vector(this->size_change_day);
+  checkpoint->put_vector(this->size_on_day);
+  for(int d = 0; d < Condition::get_number_of_conditions(); ++d) {
+    checkpoint->put_int(this->first_transmissible_day[d]);
+    checkpoint->put_int(this->first_transmissible_count[d]);
+    checkpoint->put_int(this->first_susceptible_count[d]);
+    checkpoint->put_int(this->last_transmissible_day[d]);
+    checkpoint->put_people(this->transmissible_people[d]);
+  }
+}
+
+void Group::restore_checkpoint(Checkpoint* checkpoint) {
+  person_vector_t saved_members;
+  checkpoint->get_people(saved_members);
+  if(this->members.size() > 0) {
+    checkpoint->mismatch("group memberships were not cleared");
+  }
+  for(int i = 0; i < saved_members.size(); ++i) {
+    saved_members[i]->begin_membership_in_group(this);
+  }
+  this->reporting_size = checkpoint->get_bool();
+  checkpoint->get_vector(this->size_change_day);
+  checkpoint->get_vector(this->size_on_day);
+  for(int d = 0; d < Condition::get_number_of_conditions(); ++d) {
+    this->first_transmissible_day[d] = checkpoint->get_int();
+    this->first_transmissible_count[d] = checkpoint->get_int();
+    this->first_susceptible_count[d] = checkpoint->get_int();
+    this->last_transmissible_day[d] = checkpoint->get_int();
+    checkpoint->get_people(this->transmissible_people[d]);
+  }
+}
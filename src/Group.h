@@ -29,10 +29,41 @@
 #include "Global.h"
 #include <iomanip>
 #include <limits>
+#include <set>
 
+class Checkpoint;
 class Person;
 class Group_Type;
 
+/**
+ * Running sum of a person variable over the members of a group, and
+ * optionally the members' values split at the median, so that the
+ * median is the smallest value in the upper half.
+ */
+class Var_Aggregate {
+public:
+  Var_Aggregate() : sum(0.0), keep_values(false) {}
+
+  void add(double value);
+  void remove(double value);
+
+  double get_sum() {
+    return this->sum;
+  }
+
+  double get_median() {
+    return this->upper.empty() ? 0.0 : *(this->upper.begin());
+  }
+
+  double sum;
+  bool keep_values;
+  std::multiset<double> lower;
+  std::multiset<double> upper;
+
+private:
+  void rebalance();
+};
+
 class Group {
 public:
 
@@ -155,6 +186,12 @@ public:
 
   double get_median_of_var(int var_id);
 
+  // aggregates of the variables listed by this group's type, kept up to
+  // date once first used
+  Var_Aggregate* get_var_aggregate(int slot);
+  void prepare_var_aggregates();
+  void update_var_aggregate(int slot, double old_value, double new_value);
+
   void report_size(int day);
 
   int get_size_on_day(int day);
@@ -183,6 +220,10 @@ public:
 
   void set_sp_id(long long int value);
 
+  // members and epidemic counters, for checkpoints
+  void save_checkpoint(Checkpoint* checkpoint);
+  void restore_checkpoint(Checkpoint* checkpoint);
+
   long long int get_sp_id() {
     return this->sp_id;
   }
@@ -191,6 +232,11 @@ public:
 
   static bool is_a_network(int type_id);
 
+  // groups are indexed from 0 within their group type
+  static int get_number_of_groups(int type_id);
+
+  static Group* get_group(int type_id, int index);
+
   static Group* get_group_from_sp_id(long long int sp_id) {
     if(Group::sp_id_exists(sp_id)) {
       return Group::sp_id_map.find(sp_id)->second;
@@ -220,6 +266,7 @@ protected:
 
   // lists of people
   person_vector_t members;
+  std::vector<Var_Aggregate> var_aggregate;
   person_vector_t* transmissible_people;
   Person* host;    // person hosting this group
   Person* admin;   // person administering this group
@@ -41,6 +41,7 @@ std::vector <Group_Type*> Group_Type::group_types;
 std::vector<std::string> Group_Type::names;
 std::unordered_map<std::string, int> Group_Type::group_name_map;
 std::unordered_map<Person*, Group*> Group_Type::host_group_map;
+std::vector<bool> Group_Type::var_is_aggregated;
 
 
 Group_Type::Group_Type(string _name) {
@@ -52,6 +53,7 @@ Group_Type::Group_Type(string _name) {
   this->contact_rate_for_cond = NULL;
   this->deterministic_contacts_for_cond = NULL;
   this->has_admin = false;
+  this->aggregate_vars = false;
   Group_Type::group_name_map[this->name] = Group_Type::get_number_of_group_types();
   Group_Type::names.push_back(this->name);
 }
@@ -193,11 +195,37 @@ void Group_Type::get_properties() {
     Person::include_global_list_variable(this->name + "List");
   }
 
+  // keep sums and medians of person variables over groups of this type?
+  n = 0;
+  sprintf(property_name, "%s.aggregate_vars", this->name.c_str());
+  Property::get_property(property_name, &n);
+  this->aggregate_vars = n;
+
   Property::set_abort_on_failure();
 
   FRED_STATUS(0, "group_type %s read_properties finished\n", this->name.c_str());
 }
 
+void Group_Type::aggregate_var(int var_id, bool keep_values) {
+  if (this->aggregate_vars == false) {
+    return;
+  }
+  int slot = get_var_aggregate_slot(var_id);
+  if (slot < 0) {
+    this->aggregated_var.push_back(var_id);
+    this->aggregated_var_keeps_values.push_back(keep_values);
+  }
+  else if (keep_values) {
+    this->aggregated_var_keeps_values[slot] = true;
+  }
+  if (Group_Type::var_is_aggregated.size() <= var_id) {
+    Group_Type::var_is_aggregated.resize(var_id + 1, false);
+  }
+  Group_Type::var_is_aggregated[var_id] = true;
+  FRED_VERBOSE(0, "AGGREGATE var %s over group type %s median %d\n",
+	       Person::get_var_name(var_id).c_str(), this->name.c_str(), keep_values);
+}
+
 //////////////////////////
 //
 // STATIC METHODS
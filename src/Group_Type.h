@@ -81,6 +81,35 @@ public:
     return this->has_admin;
   }
 
+  // person variables whose sum and median over each group of this type
+  // are kept up to date, for the sum_of_, ave_of_ and median_of_ factors
+  void aggregate_var(int var_id, bool keep_values);
+
+  int get_var_aggregate_slot(int var_id) {
+    for (int slot = 0; slot < this->aggregated_var.size(); ++slot) {
+      if (this->aggregated_var[slot] == var_id) {
+        return slot;
+      }
+    }
+    return -1;
+  }
+
+  int get_number_of_var_aggregates() {
+    return this->aggregated_var.size();
+  }
+
+  int get_aggregated_var(int slot) {
+    return this->aggregated_var[slot];
+  }
+
+  bool var_aggregate_keeps_values(int slot) {
+    return this->aggregated_var_keeps_values[slot];
+  }
+
+  static bool is_aggregated_var(int var_id) {
+    return var_id < Group_Type::var_is_aggregated.size() && Group_Type::var_is_aggregated[var_id];
+  }
+
   // static methods
 
   static Group_Type* get_group_type(int type_id) {
@@ -156,6 +185,12 @@ protected:
   // administrator
   bool has_admin;
 
+  // aggregated person variables
+  bool aggregate_vars;
+  int_vector_t aggregated_var;
+  std::vector<bool> aggregated_var_keeps_values;
+  static std::vector<bool> var_is_aggregated;
+
   // lists of group types
   static std::vector <Group_Type*> group_types;
   static std::vector<std::string> names;
@@ -38,7 +38,7 @@
 std::vector<double> Hospital::Hospital_health_insurance_prob;
 
 Hospital::Hospital() : Place() {
-  this->type_id = Place_Type::get_type_id("Hospital");
+  this->type_id = Place_Type::HOSPITAL;
   this->set_subtype(Place::SUBTYPE_NONE);
   this->bed_count = 0;
   this->occupied_bed_count = 0;
@@ -57,7 +57,7 @@ Hospital::Hospital() : Place() {
 
 
 Hospital::Hospital(const char* lab, char _subtype, fred::geo lon, fred::geo lat) : Place(lab, lon, lat) {
-  this->type_id = Place_Type::get_type_id("Hospital");
+  this->type_id = Place_Type::HOSPITAL;
   this->set_subtype(_subtype);
   this->bed_count = 0;
   this->occupied_bed_count = 0;
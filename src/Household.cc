@@ -38,7 +38,7 @@
 
 using namespace std;
 
-Household::Household(const char* lab, char _subtype, fred::geo lon, fred::geo lat) : Place(lab, Place_Type::get_type_id("Household"), lon, lat) {
+Household::Household(const char* lab, char _subtype, fred::geo lon, fred::geo lat) : Place(lab, Place_Type::HOUSEHOLD, lon, lat) {
   this->set_subtype(_subtype);
   this->orig_household_structure = UNKNOWN;
   this->household_structure = UNKNOWN;
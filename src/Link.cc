@@ -19,6 +19,7 @@
  */
 
 #include "Link.h"
+#include "Checkpoint.h"
 #include "Group.h"
 #include "Network.h"
 #include "Person.h"
@@ -417,3 +418,21 @@ void Link::unlink(Person* person) {
   // printf("UNLINK: group %s size %d\n", this->group->get_label(), this->group->get_size()); fflush(stdout);
 }
   
+
+void Link::save_edges(Checkpoint* checkpoint) {
+  checkpoint->put_people(this->inward_edge);
+  checkpoint->put_vector(this->inward_timestamp);
+  checkpoint->put_vector(this->inward_weight);
+  checkpoint->put_people(this->outward_edge);
+  checkpoint->put_vector(this->outward_timestamp);
+  checkpoint->put_vector(this->outward_weight);
+}
+
+void Link::restore_edges(Checkpoint* checkpoint) {
+  checkpoint->get_people(this->inward_edge);
+  checkpoint->get_vector(this->inward_timestamp);
+  checkpoint->get_vector(this->inward_weight);
+  checkpoint->get_people(this->outward_edge);
+  checkpoint->get_vector(this->outward_timestamp);
+  checkpoint->get_vector(this->outward_weight);
+}
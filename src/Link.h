@@ -27,6 +27,7 @@
 
 #include "Global.h"
 
+class Checkpoint;
 class Group;
 class Network;
 class Person;
@@ -113,6 +114,8 @@ class Link {
   void update_member_index(int new_index);
   void link(Person* person, Group* new_group);
   void unlink(Person* person);
+  void save_edges(Checkpoint* checkpoint);
+  void restore_edges(Checkpoint* checkpoint);
 
  private:
   Group* group;
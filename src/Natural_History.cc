@@ -32,6 +32,7 @@
 #include "Predicate.h"
 #include "Preference.h"
 #include "Random.h"
+#include "Record_Log.h"
 #include "Rule.h"
 #include "State_Space.h"
 #include "Utils.h"
@@ -51,6 +52,7 @@ Natural_History::Natural_History() {
   this->wait_rule = NULL;
   this->exposure_rule = NULL;
   this->next_rules = NULL;
+  this->batch_next_rules = NULL;
   this->default_rule = NULL;
   this->import_count_rule = NULL;
   this->import_per_capita_rule = NULL;
@@ -137,6 +139,7 @@ void Natural_History::get_properties() {
 
   // STATE CONTACT RESTRICTIONS
   this->absent_groups = new bool* [this->number_of_states];
+  this->absent_mask = new std::bitset<64> [this->number_of_states];
   this->close_groups = new bool* [this->number_of_states];
 
   // IMPORT STATE
@@ -523,11 +526,38 @@ int Natural_History::get_next_transition_step(Person* person, int state, int day
 
 
 
+void Natural_History::get_transition_probs(Person** people, int n, int state, double* trans_prob) {
+
+  // evaluate each rule over the whole batch
+  int nstates = this->number_of_states;
+  this->batch_values.resize(n);
+  double* value = this->batch_values.data();
+  for (int i = 0; i < n * nstates; i++) {
+    trans_prob[i] = 0.0;
+  }
+  for(int next = 0; next < nstates; ++next) {
+    int nrules = this->next_rules[state][next].size();
+    for (int r = 0; r < nrules; r++) {
+      this->next_rules[state][next][r]->get_values(people, n, value);
+      for (int i = 0; i < n; i++) {
+	double & max_value = trans_prob[i * nstates + next];
+	if (value[i] > max_value) {
+	  max_value = value[i];
+	}
+      }
+    }
+  }
+
+  for (int i = 0; i < n; i++) {
+    normalize_transition_probs(state, trans_prob + i * nstates);
+  }
+}
+
+
 int Natural_History::get_next_state(Person* person, int state) {
 
   // FRED_VERBOSE(0, "get_next_state entered day %d person %d current state %s\n", Global::Simulation_Day, person->get_id(), get_state_name(state).c_str());
 
-  double total = 0.0;
   double trans_prob [this->number_of_states];
   for(int next = 0; next < this->number_of_states; ++next) {
 
@@ -548,6 +578,36 @@ int Natural_History::get_next_state(Person* person, int state) {
       // use max_value as transition prob
       trans_prob[next] = max_value;
     }
+  }
+
+  normalize_transition_probs(state, trans_prob);
+
+  // DEBUGGING
+  if (0) {
+    if (Global::Enable_Records) {
+      Record_Log::print(
+	      "HEALTH RECORD: person %d COND %s TRANSITION_PROBS: ",
+	      person->get_id(), get_name());
+      for(int next = 0; next < this->number_of_states; ++next) {
+	Record_Log::print("%d: %e |", next, trans_prob[next]);
+      }
+      Record_Log::print("\n");
+    }
+  }
+
+  int next_state = select_next_state(state, trans_prob);
+
+  assert(next_state > -1);
+  // FRED_VERBOSE(0, "get_next_state returns person %d next state %d %s\n", person->get_id(), next_state, get_state_name(next_state).c_str());
+
+  return next_state;
+}
+
+
+void Natural_History::normalize_transition_probs(int state, double* trans_prob) {
+
+  double total = 0.0;
+  for(int next = 0; next < this->number_of_states; ++next) {
 
     // the following is needed to correct for round-off effects in "zero probability" logit computations
     if (trans_prob[next] < 1e-20) {
@@ -585,26 +645,6 @@ int Natural_History::get_next_state(Person* person, int state) {
       printf("\n");
     */
   }
-
-  // DEBUGGING
-  if (0) {
-    if (Global::Enable_Records) {
-      fprintf(Global::Recordsfp,
-	      "HEALTH RECORD: person %d COND %s TRANSITION_PROBS: ",
-	      person->get_id(), get_name());
-      for(int next = 0; next < this->number_of_states; ++next) {
-	fprintf(Global::Recordsfp, "%d: %e |", next, trans_prob[next]);
-      }
-      fprintf(Global::Recordsfp,"\n");
-    }
-  }
-
-  int next_state = select_next_state(state, trans_prob);
-
-  assert(next_state > -1);
-  // FRED_VERBOSE(0, "get_next_state returns person %d next state %d %s\n", person->get_id(), next_state, get_state_name(next_state).c_str());
-
-  return next_state;
 }
 
 
@@ -756,9 +796,11 @@ void Natural_History::prepare_rules() {
 	    int type_id = Group_Type::get_type_id(group_name);
 	    if (rule->get_action()=="absent") {
 	      this->absent_groups[state][type_id] = true;
+	      this->absent_mask[state][type_id] = true;
 	    }
 	    if (rule->get_action()=="present") {
 	      this->absent_groups[state][type_id] = false;
+	      this->absent_mask[state][type_id] = false;
 	    }
 	    if (rule->get_action()=="close") {
 	      this->close_groups[state][type_id] = true;
@@ -960,6 +1002,21 @@ void Natural_History::prepare_rules() {
       this->default_rule[i]->print();
 
   }
+
+  // find the states whose next rules can be evaluated for a batch of
+  // people at once
+  this->batch_next_rules = new bool [this->number_of_states];
+  for (int i = 0; i < this->number_of_states; i++) {
+    int nrules = 0;
+    bool local = Global::Enable_Rule_Bytecode;
+    for (int j = 0; j < this->number_of_states; j++) {
+      for (int n = 0; n < this->next_rules[i][j].size();n++) {
+	local = local && this->next_rules[i][j][n]->is_local();
+	nrules++;
+      }
+    }
+    this->batch_next_rules[i] = local && 0 < nrules;
+  }
 }
 
 
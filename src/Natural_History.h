@@ -72,6 +72,19 @@ public:
 
   int get_next_state(Person* person, int state);
 
+  /// true if the next rules for this state can be evaluated by
+  /// get_transition_probs() for a batch of people at once
+  bool has_batch_next_rules(int state) {
+    return this->batch_next_rules[state];
+  }
+
+  /// fill trans_prob with an n by number_of_states matrix of
+  /// transition probabilities for n people all currently in the given
+  /// state, one row per person
+  void get_transition_probs(Person** people, int n, int state, double* trans_prob);
+
+  void normalize_transition_probs(int state, double* trans_prob);
+
   int select_next_state(int state, double* transition_prob);
 
   int get_next_transition_step(Person* person, int state, int day, int hour);
@@ -179,6 +192,11 @@ public:
 
   bool is_absent(int state, int group_type_id);
 
+  // the group types a person in this state stays away from
+  const std::bitset<64> & get_absent_groups(int state) {
+    return this->absent_mask[state];
+  }
+
   bool is_closed(int state, int group_type_id);
 
   Rule* get_import_count_rule(int state) {
@@ -224,6 +242,8 @@ protected:
   Rule** wait_rule;
   Rule* exposure_rule;
   rule_vector_t** next_rules;
+  bool* batch_next_rules;
+  std::vector<double> batch_values;
   Rule** default_rule;
 
   // STATE SIDE EFFECTS
@@ -266,6 +286,7 @@ protected:
 
   // STATE CONTACT RESTRICTIONS
   bool** absent_groups;
+  std::bitset<64>* absent_mask;
   bool** close_groups;
 
   // TRANSMISSIBILITY
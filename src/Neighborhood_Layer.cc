@@ -27,6 +27,8 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <string.h>
+#include <unistd.h>
 using namespace std;
 
 #include "Global.h"
@@ -55,8 +57,11 @@ Neighborhood_Layer::Neighborhood_Layer() {
   this->max_y = base_grid->get_max_y();
 
   this->offset = NULL;
-  this->gravity_cdf = NULL;
+  this->gravity_sampler = NULL;
+  this->destination = NULL;
   this->max_offset = 0;
+  this->offset_stride = 1;
+  this->gravity_cache_key = 0;
 
   // determine patch size for this layer
   strcpy(property, "Neighborhood.patch_size");
@@ -129,12 +134,13 @@ Neighborhood_Layer::Neighborhood_Layer() {
   } else {
     Property::get_property("Neighborhood_population_exponent", &this->pop_exponent);
   }
+  Property::get_property("gravity_model_cache_dir", this->gravity_cache_dir);
 
 }
 
 void Neighborhood_Layer::setup() {
 
-  int type = Place_Type::get_type_id("Neighborhood");
+  int type = Place_Type::NEIGHBORHOOD;
 
   // create one neighborhood per patch
   for(int i = 0; i < this->rows; ++i) {
@@ -316,18 +322,16 @@ static bool compare_pair( const pair<double,int>& p1, const pair<double,int>& p2
 }
 
 void Neighborhood_Layer::setup_gravity_model() {
-  int tmp_offset[256*256];
-  double tmp_prob[256*256];
-  int mark[256*256];
-  int count = 0;
 
   // print_distances();  // DEBUGGING
 
   this->offset = new offset_t*[this->rows];
-  this->gravity_cdf = new gravity_cdf_t*[this->rows];
+  this->gravity_sampler = new Alias_Table*[this->rows];
+  this->destination = new place_vector_t*[this->rows];
   for(int i = 0; i < rows; ++i) {
     this->offset[i] = new offset_t[this->cols];
-    this->gravity_cdf[i] = new gravity_cdf_t[this->cols];
+    this->gravity_sampler[i] = new Alias_Table[this->cols];
+    this->destination[i] = new place_vector_t[this->cols];
   }
 
   if(this->max_distance < 0) {
@@ -336,18 +340,45 @@ void Neighborhood_Layer::setup_gravity_model() {
   }
 
   this->max_offset = this->max_distance / this->patch_size;
-  assert(this->max_offset < 128);
+  this->offset_stride = 2 * this->max_offset + 1;
 
+  if(read_gravity_cache()) {
+    return;
+  }
+
+  // the distance term depends only on the offset between the patches,
+  // and the population term only on the destination patch
+  std::vector<double> distance_term(this->offset_stride * this->offset_stride);
+  for(int di = -this->max_offset; di <= this->max_offset; ++di) {
+    for(int dj = -this->max_offset; dj <= this->max_offset; ++dj) {
+      double dist = this->patch_size * sqrt((double) (di * di + dj * dj));
+      int off = this->offset_stride * (di + this->max_offset) + (dj + this->max_offset);
+      if(this->max_distance < dist) {
+        distance_term[off] = -1.0;
+      } else {
+        distance_term[off] = 1.0 + pow(dist / this->min_distance, this->dist_exponent);
+      }
+    }
+  }
+  std::vector<double> population_term(this->rows * this->cols);
   for(int i = 0; i < this->rows; ++i) {
+    for(int j = 0; j < this->cols; ++j) {
+      population_term[i * this->cols + j] = pow(this->grid[i][j].get_popsize(), this->pop_exponent);
+    }
+  }
+
+  // each source patch is independent
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < this->rows; ++i) {
+    vector<pair<double, int>> candidates;
+    std::vector<double> gravity;
+    std::vector<int> off;
     for(int j = 0; j < this->cols; ++j) {
       // set up gravity model for grid[i][j];
-      Neighborhood_Patch * patch = (Neighborhood_Patch *)&grid[i][j];
-      assert(patch != NULL);
-      double x_src = patch->get_center_x();
-      double y_src = patch->get_center_y();
-      int pop_src = patch->get_popsize();
-      if (pop_src == 0) continue;
-      count = 0;
+      if(this->grid[i][j].get_popsize() == 0) {
+        continue;
+      }
+      candidates.clear();
       for(int ii = i - this->max_offset; ii < this->rows && ii <= i + this->max_offset; ++ii) {
         if(ii < 0) {
           continue;
@@ -358,23 +389,15 @@ void Neighborhood_Layer::setup_gravity_model() {
             continue;
           }
 
-          Neighborhood_Patch* dest_patch = (Neighborhood_Patch*)&this->grid[ii][jj];
-          assert (dest_patch != NULL);
-          int pop_dest = dest_patch->get_popsize();
-          if(pop_dest == 0) {
+          if(this->grid[ii][jj].get_popsize() == 0) {
             continue;
           }
 
-          double x_dest = dest_patch->get_center_x();
-          double y_dest = dest_patch->get_center_y();
-          double dist = sqrt((x_src - x_dest) * (x_src - x_dest) + (y_src - y_dest) * (y_src - y_dest));
-          if(this->max_distance < dist) {
+          int k = this->offset_stride * (i - ii + this->max_offset) + (j - jj + this->max_offset);
+          if(distance_term[k] < 0.0) {
             continue;
           }
 
-          double gravity = pow(pop_dest, this->pop_exponent) / (1.0 + pow(dist / this->min_distance, this->dist_exponent));
-          int off = 256*(i - ii + this->max_offset) + (j - jj + this->max_offset);
-
           /*
            * consider income similarity in gravity model
            * double mean_household_income_dest = dest_patch->get_mean_household_income();
@@ -384,53 +407,184 @@ void Neighborhood_Layer::setup_gravity_model() {
            * }
            * gravity = ...;
            */
-          tmp_offset[count] = off;
-          tmp_prob[count++] = gravity;
+          candidates.push_back(pair<double, int>(population_term[ii * this->cols + jj] / distance_term[k], k));
         }
       }
 
-      // sort by gravity value
-      this->sort_pair.clear();
-      for(int k = 0; k < count; ++k) {
-        this->sort_pair.push_back(pair <double,int> (tmp_prob[k], tmp_offset[k]));
-      }
-      std::sort(this->sort_pair.begin(), this->sort_pair.end(), compare_pair);
-
-      // keep at most largest max_destinations
+      // keep at most largest max_destinations, by gravity value
+      int count = candidates.size();
       if(count > this->max_destinations) {
         count = this->max_destinations;
       }
+      std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), compare_pair);
+      gravity.clear();
+      off.clear();
       for(int k = 0; k < count; ++k) {
-        tmp_prob[k] = this->sort_pair[k].first;
-        tmp_offset[k] = this->sort_pair[k].second;
+        gravity.push_back(candidates[k].first);
+        off.push_back(candidates[k].second);
       }
-      this->sort_pair.clear();
+      set_gravity_model(i, j, gravity, off);
+    }
+  }
 
-      // transform gravity values into a prob distribution
-      double total = 0.0;
-      for(int k = 0; k < count; ++k) {
-        total += tmp_prob[k];
+  write_gravity_cache();
+}
+
+/**
+ * Store the gravity values and offsets of the destinations of patch
+ * (row, col), with an alias table to draw from them in constant time.
+ */
+void Neighborhood_Layer::set_gravity_model(int row, int col, const std::vector<double> & gravity, const std::vector<int> & off) {
+  set_destinations(row, col, off);
+  this->gravity_sampler[row][col].setup(gravity);
+}
+
+void Neighborhood_Layer::set_destinations(int row, int col, const std::vector<int> & off) {
+  int count = off.size();
+  this->offset[row][col] = off;
+  this->destination[row][col].clear();
+  this->destination[row][col].reserve(count);
+  for(int k = 0; k < count; ++k) {
+    int i_dest = row + this->max_offset - (off[k] / this->offset_stride);
+    int j_dest = col + this->max_offset - (off[k] % this->offset_stride);
+    Neighborhood_Patch* dest_patch = this->get_patch(i_dest, j_dest);
+    assert(dest_patch != NULL);
+    this->destination[row][col].push_back(dest_patch->get_neighborhood());
+  }
+}
+
+/**
+ * The gravity model cache file for this grid, population and set of
+ * gravity properties, or "" if gravity_model_cache_dir is not set.
+ */
+std::string Neighborhood_Layer::get_gravity_cache_file() {
+  if(strcmp(this->gravity_cache_dir, "none") == 0) {
+    return "";
+  }
+
+  // FNV-1a hash of everything the gravity model depends on
+  uint64_t key = 14695981039346656037ULL;
+  std::vector<double> values;
+  values.push_back(this->rows);
+  values.push_back(this->cols);
+  values.push_back(this->min_x);
+  values.push_back(this->min_y);
+  values.push_back(this->patch_size);
+  values.push_back(this->max_distance);
+  values.push_back(this->min_distance);
+  values.push_back(this->max_destinations);
+  values.push_back(this->pop_exponent);
+  values.push_back(this->dist_exponent);
+  for(int i = 0; i < this->rows; ++i) {
+    for(int j = 0; j < this->cols; ++j) {
+      values.push_back(this->grid[i][j].get_popsize());
+    }
+  }
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values.data());
+  for(size_t k = 0; k < values.size() * sizeof(double); ++k) {
+    key = (key ^ bytes[k]) * 1099511628211ULL;
+  }
+  this->gravity_cache_key = key;
+
+  char filename[FRED_STRING_SIZE];
+  snprintf(filename, FRED_STRING_SIZE, "%s/gravity-%016llx.bin", this->gravity_cache_dir, (unsigned long long) key);
+  return filename;
+}
+
+bool Neighborhood_Layer::read_gravity_cache() {
+  std::string path = get_gravity_cache_file();
+  if(path == "") {
+    return false;
+  }
+  FILE* fp = fopen(path.c_str(), "rb");
+  if(fp == NULL) {
+    return false;
+  }
+  char magic[8];
+  uint64_t key;
+  int header[3];
+  bool ok = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, "FREDGRAV", 8) == 0
+    && fread(&key, sizeof(key), 1, fp) == 1 && key == this->gravity_cache_key
+    && fread(header, sizeof(header), 1, fp) == 1
+    && header[0] == this->rows && header[1] == this->cols && header[2] == this->max_offset;
+  std::vector<int> off;
+  std::vector<double> prob;
+  std::vector<int> alias;
+  for(int i = 0; ok && i < this->rows; ++i) {
+    for(int j = 0; ok && j < this->cols; ++j) {
+      if(this->grid[i][j].get_popsize() == 0) {
+        continue;
       }
-      for(int k = 0; k < count; ++k) {
-        tmp_prob[k] /= total;
+      int count;
+      ok = fread(&count, sizeof(count), 1, fp) == 1 && 0 <= count && count <= this->max_destinations;
+      if(ok) {
+        off.resize(count);
+        prob.resize(count);
+        alias.resize(count);
+        ok = (int) fread(off.data(), sizeof(int), count, fp) == count
+          && (int) fread(prob.data(), sizeof(double), count, fp) == count
+          && (int) fread(alias.data(), sizeof(int), count, fp) == count;
       }
-
-      // convert to cdf
-      for(int k = 1; k < count; ++k) {
-        tmp_prob[k] += tmp_prob[k - 1];
+      for(int k = 0; ok && k < count; ++k) {
+        ok = 0 <= off[k] && off[k] < this->offset_stride * this->offset_stride
+          && 0 <= alias[k] && alias[k] < count;
       }
+      if(ok) {
+        set_destinations(i, j, off);
+        this->gravity_sampler[i][j].set_table(prob, alias);
+      }
+    }
+  }
+  fclose(fp);
+  if(ok == false) {
+    FRED_VERBOSE(0, "WARNING: ignoring bad gravity model cache %s\n", path.c_str());
+    return false;
+  }
+  FRED_VERBOSE(0, "gravity model read from %s\n", path.c_str());
+  return true;
+}
 
-      // store gravity prob and offsets for this patch
-      this->gravity_cdf[i][j].reserve(count);
-      this->gravity_cdf[i][j].clear();
-      this->offset[i][j].reserve(count);
-      this->offset[i][j].clear();
-      for(int k = 0; k < count; ++k) {
-        this->gravity_cdf[i][j].push_back(tmp_prob[k]);
-        this->offset[i][j].push_back(tmp_offset[k]);
+void Neighborhood_Layer::write_gravity_cache() {
+  std::string path = get_gravity_cache_file();
+  if(path == "") {
+    return;
+  }
+
+  // write to a temporary file and rename it, so a reader never sees a partial cache
+  std::string tmp_path = path + ".tmp";
+  FILE* fp = fopen(tmp_path.c_str(), "wb");
+  if(fp == NULL) {
+    FRED_VERBOSE(0, "WARNING: can't write gravity model cache %s\n", tmp_path.c_str());
+    return;
+  }
+  int header[3] = { this->rows, this->cols, this->max_offset };
+  bool ok = fwrite("FREDGRAV", 8, 1, fp) == 1
+    && fwrite(&this->gravity_cache_key, sizeof(uint64_t), 1, fp) == 1
+    && fwrite(header, sizeof(header), 1, fp) == 1;
+  std::vector<double> prob;
+  std::vector<int> alias;
+  for(int i = 0; ok && i < this->rows; ++i) {
+    for(int j = 0; ok && j < this->cols; ++j) {
+      if(this->grid[i][j].get_popsize() == 0) {
+        continue;
       }
+      // the alias table itself is saved, so a cached model draws exactly
+      // as a newly built one
+      int count = this->offset[i][j].size();
+      this->gravity_sampler[i][j].get_table(prob, alias);
+      ok = fwrite(&count, sizeof(count), 1, fp) == 1
+        && (int) fwrite(this->offset[i][j].data(), sizeof(int), count, fp) == count
+        && (int) fwrite(prob.data(), sizeof(double), count, fp) == count
+        && (int) fwrite(alias.data(), sizeof(int), count, fp) == count;
     }
   }
+  ok = (fclose(fp) == 0) && ok;
+  if(ok == false || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    FRED_VERBOSE(0, "WARNING: error writing gravity model cache %s\n", path.c_str());
+    unlink(tmp_path.c_str());
+    return;
+  }
+  FRED_VERBOSE(0, "gravity model written to %s\n", path.c_str());
 }
 
 void Neighborhood_Layer::print_gravity_model() {
@@ -448,8 +602,8 @@ void Neighborhood_Layer::print_gravity_model() {
       for(int k = 0; k < count; ++k) {
         int off = this->offset[i_src][j_src][k];
         printf("GRAVITY_MODEL row %3d col %3d pop %5d count %4d k %4d offset %d ", i_src, j_src, pop_src, count, k, off);
-        int i_dest = i_src + this->max_offset - (off / 256);
-        int j_dest = j_src + this->max_offset - (off % 256);
+        int i_dest = i_src + this->max_offset - (off / this->offset_stride);
+        int j_dest = j_src + this->max_offset - (off % this->offset_stride);
         printf("row %3d col %3d ", i_dest, j_dest);
         Neighborhood_Patch* dest_patch = this->get_patch(i_dest, j_dest);
         assert (dest_patch != NULL);
@@ -457,10 +611,7 @@ void Neighborhood_Layer::print_gravity_model() {
         double y_dest = dest_patch->get_center_y();
         double dist = sqrt((x_src-x_dest)*(x_src-x_dest) + (y_src - y_dest) * (y_src - y_dest));
         int pop_dest = dest_patch->get_popsize();
-        double gravity_prob = this->gravity_cdf[i_src][j_src][k];
-        if(k > 0) {
-          gravity_prob -= this->gravity_cdf[i_src][j_src][k-1];
-        }
+        double gravity_prob = this->gravity_sampler[i_src][j_src].get_probability(k);
         printf("pop %5d dist %0.4f prob %f", pop_dest, dist, gravity_prob);
         printf("\n");
       }
@@ -508,17 +659,12 @@ void Neighborhood_Layer::print_distances() {
 }
 
 void Neighborhood_Layer::setup_null_gravity_model() {
-  int tmp_offset[256*256];
-  double tmp_prob[256*256];
-  int count = 0;
-
-  this->offset = new offset_t*[this->rows];
-  this->gravity_cdf = new gravity_cdf_t*[this->rows];
-  this->offset[0] = new offset_t[this->cols];
-  this->gravity_cdf[0] = new gravity_cdf_t[this->cols];
+  std::vector<int> off;
+  std::vector<double> gravity;
 
-  this->max_offset = this->rows * this->patch_size;
-  assert(this->max_offset < 128);
+  // every destination is an offset from patch (0,0)
+  this->max_offset = (this->rows > this->cols) ? this->rows : this->cols;
+  this->offset_stride = 2 * this->max_offset + 1;
 
   for(int i_dest = 0; i_dest < this->rows; ++i_dest) {
     for(int j_dest = 0; j_dest < this->cols; ++j_dest) {
@@ -528,56 +674,48 @@ void Neighborhood_Layer::setup_null_gravity_model() {
         continue;
       }
       // double gravity = pow(pop_dest,pop_exponent);
-      double gravity = pop_dest;
-      int off = 256 * (0 - i_dest + this->max_offset) + (0 - j_dest + this->max_offset);
-      tmp_offset[count] = off;
-      tmp_prob[count++] = gravity;
+      off.push_back(this->offset_stride * (0 - i_dest + this->max_offset) + (0 - j_dest + this->max_offset));
+      gravity.push_back(pop_dest);
     }
   }
 
-  // transform gravity values into a prob distribution
-  double total = 0.0;
-  for(int k = 0; k < count; ++k) {
-    total += tmp_prob[k];
-  }
-  for(int k = 0; k < count; ++k) {
-    tmp_prob[k] /= total;
-  }
+  set_gravity_model(0, 0, gravity, off);
+}
 
-  // convert to cdf
-  for (int k = 1; k < count; ++k) {
-    tmp_prob[k] += tmp_prob[k - 1];
+Neighborhood_Patch* Neighborhood_Layer::get_source_patch(Place* src_neighborhood) {
+  if(this->max_distance < 0) {
+    // use null gravity model
+    return &this->grid[0][0];
   }
-
-  // store gravity prob and offsets for this patch
-  this->gravity_cdf[0][0].reserve(count);
-  this->gravity_cdf[0][0].clear();
-  this->offset[0][0].reserve(count);
-  this->offset[0][0].clear();
-  for(int k = 0; k < count; ++k) {
-    this->gravity_cdf[0][0].push_back(tmp_prob[k]);
-    this->offset[0][0].push_back(tmp_offset[k]);
+  Neighborhood_Patch* src_patch = src_neighborhood->get_patch();
+  if(src_patch == NULL) {
+    src_patch = this->get_patch(src_neighborhood->get_latitude(), src_neighborhood->get_longitude());
   }
+  return src_patch;
 }
 
 Place* Neighborhood_Layer::select_destination_neighborhood(Place* src_neighborhood) {
-
-  Neighborhood_Patch* src_patch = this->get_patch(src_neighborhood->get_latitude(), src_neighborhood->get_longitude());
+  Neighborhood_Patch* src_patch = get_source_patch(src_neighborhood);
   int i_src = src_patch->get_row();
   int j_src = src_patch->get_col();
-  if(this->max_distance < 0) {
-    // use null gravity model
-    i_src = j_src = 0;
-  }
-  int offset_index = Random::draw_from_cdf_vector(this->gravity_cdf[i_src][j_src]);
-  int off = this->offset[i_src][j_src][offset_index];
-  int i_dest = i_src + this->max_offset - (off / 256);
-  int j_dest = j_src + this->max_offset - (off % 256);
-
-  Neighborhood_Patch* dest_patch = this->get_patch(i_dest, j_dest);
-  assert (dest_patch != NULL);
+  int k = this->gravity_sampler[i_src][j_src].draw();
+  return this->destination[i_src][j_src][k];
+}
 
-  return dest_patch->get_neighborhood();
+/**
+ * Select a destination for each of the given source neighborhoods, with
+ * one draw per source, as select_destination_neighborhood() would.
+ */
+void Neighborhood_Layer::select_destination_neighborhoods(const place_vector_t & src_neighborhoods, place_vector_t & destinations) {
+  int n = src_neighborhoods.size();
+  destinations.resize(n);
+  for(int p = 0; p < n; ++p) {
+    Neighborhood_Patch* src_patch = get_source_patch(src_neighborhoods[p]);
+    int i_src = src_patch->get_row();
+    int j_src = src_patch->get_col();
+    int k = this->gravity_sampler[i_src][j_src].draw();
+    destinations[p] = this->destination[i_src][j_src][k];
+  }
 }
 
 /**
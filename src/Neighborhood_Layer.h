@@ -26,13 +26,14 @@
 #ifndef _FRED_NEIGHBORHOOD_LAYER_H
 #define _FRED_NEIGHBORHOOD_LAYER_H
 
+#include <string>
 #include <vector>
 using namespace std;
 
 #include "Abstract_Grid.h"
+#include "Random.h"
 
 typedef std::vector<int> offset_t;
-typedef std::vector<double> gravity_cdf_t;
 typedef std::vector<Place*> place_vector_t;
 
 class Neighborhood_Patch;
@@ -60,17 +61,27 @@ public:
   void print_gravity_model();
   void print_distances();
   Place * select_destination_neighborhood(Place* src_neighborhood);
+  void select_destination_neighborhoods(const place_vector_t & src_neighborhoods, place_vector_t & destinations);
   void add_place(Place *place);
 
 private:
 
   Neighborhood_Patch** grid;     // Rectangular array of patches
 
+  void set_gravity_model(int row, int col, const std::vector<double> & gravity, const std::vector<int> & off);
+  void set_destinations(int row, int col, const std::vector<int> & off);
+  std::string get_gravity_cache_file();
+  bool read_gravity_cache();
+  void write_gravity_cache();
+  Neighborhood_Patch* get_source_patch(Place* src_neighborhood);
+
   // data used by neighborhood gravity model
   offset_t** offset;
-  gravity_cdf_t** gravity_cdf;
+  Alias_Table** gravity_sampler;
+  place_vector_t** destination;   // the neighborhood at each offset
   int max_offset;
-  vector<pair<double, int>> sort_pair;
+  int offset_stride;             // offsets are stride * row offset + col offset
+  uint64_t gravity_cache_key;
 
   // runtime properties for neighborhood gravity model
   double max_distance;
@@ -78,6 +89,7 @@ private:
   int max_destinations;
   double pop_exponent;
   double dist_exponent;
+  char gravity_cache_dir[FRED_STRING_SIZE];
 
 };
 
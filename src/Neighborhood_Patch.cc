@@ -122,6 +122,8 @@ void Neighborhood_Patch::make_neighborhood(int type) {
 						Place::SUBTYPE_NONE,
 						lon, lat, 0.0,
 						this->admin_code);
+  // cache the patch on the neighborhood for the gravity model
+  this->neighborhood->set_patch(this);
 }
 
 void Neighborhood_Patch::add_place(Place* place) {
@@ -84,40 +84,40 @@ public:
   }
 
   int get_number_of_households() {
-    return (int) this->places[Place_Type::get_type_id("Household")].size();
+    return (int) this->places[Place_Type::HOUSEHOLD].size();
   }
 
   Place* get_household(int i) {
-    return get_place(Place_Type::get_type_id("Household"), i);
+    return get_place(Place_Type::HOUSEHOLD, i);
   }
   
   int get_number_of_schools() {
-    return (int) this->places[Place_Type::get_type_id("School")].size();
+    return (int) this->places[Place_Type::SCHOOL].size();
   }
   
   Place* get_school(int i) {
-    return get_place(Place_Type::get_type_id("School"), i);
+    return get_place(Place_Type::SCHOOL, i);
   }
 
   int get_number_of_workplaces() {
-    return (int) this->places[Place_Type::get_type_id("Workplace")].size();
+    return (int) this->places[Place_Type::WORKPLACE].size();
   }
 
   Place* get_workplace(int i) {
     if(0 <= i && i < get_number_of_workplaces()) {
-      return get_place(Place_Type::get_type_id("Workplace"), i);
+      return get_place(Place_Type::WORKPLACE, i);
     } else {
       return NULL;
     }
   }
 
   int get_number_of_hospitals() {
-    return (int) this->places[Place_Type::get_type_id("Hospital")].size();
+    return (int) this->places[Place_Type::HOSPITAL].size();
   }
 
   Place* get_hospital(int i) {
     if(0 <= i && i < get_number_of_hospitals()) {
-      return get_place(Place_Type::get_type_id("Hospital"), i);
+      return get_place(Place_Type::HOSPITAL, i);
     } else {
       return NULL;
     }
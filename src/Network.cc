@@ -30,32 +30,206 @@
 #include "Person.h"
 #include "Property.h"
 #include "Random.h"
+#include "Text_File.h"
+#include "Utils.h"
 
 Network::Network(const char* lab, int _type_id, Network_Type* net_type) : Group(lab, _type_id) {
   this->network_type = net_type;
+  this->outward = NULL;
+  this->inward = NULL;
 }
 
 void Network::read_edges() {
+  std::vector<Adjacency::edge_t> edges;
   pair_vector_t results = Property::get_edges(this->get_label());
   for(int i = 0; i < results.size(); ++i) {
     int p1 = results[i].first;
     int p2 = results[i].second;
     printf("%s.add_edge %d %d\n", this->get_label(), p1, p2);
-    Person* person1 = Person::get_person(p1);
-    Person* person2 = Person::get_person(p2);
-    if(p1 == p2) {
-      person1->join_network(this);
+    Adjacency::edge_t edge = { Person::get_person(p1)->get_id(), Person::get_person(p2)->get_id(), 1.0, Global::Simulation_Step };
+    edges.push_back(edge);
+  }
+  if(strcmp(this->network_type->get_edge_file(), "none") != 0) {
+    read_edge_file(this->network_type->get_edge_file(), edges);
+  }
+  if(this->network_type->uses_compact_edges()) {
+    this->outward = new Adjacency;
+    this->inward = new Adjacency;
+  }
+  add_edges(edges);
+}
+
+namespace {
+
+  // binary edge files start with this header, followed by count records
+  typedef struct {
+    char magic[8];		// "FREDEDGE"
+    long long int count;
+  } edge_file_header_t;
+
+  typedef struct {
+    int from;
+    int to;
+    double weight;
+  } edge_file_record_t;
+
+  // parses "from to [weight]" lines, separated by commas or whitespace
+  class Edge_Reader {
+  public:
+    Edge_Reader(std::vector<Adjacency::edge_t> & _edges) : edges(_edges) {}
+
+    bool parse(int file_index, char* line, Adjacency::edge_t* edge) {
+      for(char* c = line; *c != '\0'; ++c) {
+        if(*c == ',') {
+          *c = ' ';
+        }
+      }
+      char* cursor = line;
+      if(Text_File::get_int(cursor, &edge->from) == false || Text_File::get_int(cursor, &edge->to) == false) {
+        return false;
+      }
+      if(Text_File::get_double(cursor, &edge->weight) == false) {
+        edge->weight = 1.0;
+      }
+      edge->timestamp = Global::Simulation_Step;
+      return true;
+    }
+
+    void commit(int file_index, Adjacency::edge_t & edge) {
+      this->edges.push_back(edge);
+    }
+
+  private:
+    std::vector<Adjacency::edge_t> & edges;
+  };
+
+}
+
+/**
+ * Append the edges in the given edge-list file.  Edges are between
+ * person ids, either as text lines "from,to[,weight]" after a header
+ * line (commas or whitespace), or in binary as an edge_file_header_t
+ * followed by edge_file_record_t records.
+ */
+void Network::read_edge_file(const char* filename, std::vector<Adjacency::edge_t> & edges) {
+  char path[FRED_STRING_SIZE];
+  strcpy(path, filename);
+  Utils::get_fred_file_name(path);
+  FILE* fp = Utils::fred_open_file(path);
+  if(fp == NULL) {
+    Utils::fred_abort("Network %s edge_file %s not found\n", this->get_label(), path);
+  }
+  edge_file_header_t header;
+  bool binary = fread(&header, sizeof(header), 1, fp) == 1 && memcmp(header.magic, "FREDEDGE", 8) == 0;
+  size_t first = edges.size();
+  if(binary) {
+    std::vector<edge_file_record_t> records(header.count);
+    if(header.count < 0 || fread(records.data(), sizeof(edge_file_record_t), header.count, fp) != (size_t) header.count) {
+      Utils::fred_abort("Network %s edge_file %s is truncated\n", this->get_label(), path);
+    }
+    fclose(fp);
+    edges.reserve(first + header.count);
+    for(long long int i = 0; i < header.count; ++i) {
+      Adjacency::edge_t edge = { records[i].from, records[i].to, records[i].weight, Global::Simulation_Step };
+      edges.push_back(edge);
+    }
+  } else {
+    fclose(fp);
+    Text_File file;
+    if(file.open(path) == false) {
+      Utils::fred_abort("Network %s can't read edge_file %s\n", this->get_label(), path);
+    }
+    std::vector<Text_File*> files(1, &file);
+    Edge_Reader reader(edges);
+    Text_File::read_files<Adjacency::edge_t>(files, reader);
+  }
+  FRED_STATUS(0, "network %s read %d edges from %s\n", this->get_label(), (int) (edges.size() - first), path);
+}
+
+/**
+ * Add the given edges (and their reverse, for an undirected network);
+ * an edge from a person to itself only makes the person a member.
+ */
+void Network::add_edges(std::vector<Adjacency::edge_t> & edges) {
+  int undirected = is_undirected();
+  int bad = 0;
+  int n = 0;
+  for(int i = 0; i < edges.size(); ++i) {
+    Person* person1 = Person::get_person_with_id(edges[i].from);
+    Person* person2 = Person::get_person_with_id(edges[i].to);
+    if(person1 == NULL || person2 == NULL) {
+      ++bad;
+      continue;
+    }
+    person1->join_network(this);
+    if(person1 == person2) {
+      continue;
+    }
+    person2->join_network(this);
+    if(has_compact_edges()) {
+      edges[n++] = edges[i];
     } else {
-      person1->join_network(this);
-      person2->join_network(this);
       person1->add_edge_to(person2, this);
       person2->add_edge_from(person1, this);
-      if(this->is_undirected()) {
+      if(edges[i].weight != 1.0) {
+        person1->set_weight_to(person2, this, edges[i].weight);
+        person2->set_weight_from(person1, this, edges[i].weight);
+      }
+      if(undirected) {
         person2->add_edge_to(person1, this);
         person1->add_edge_from(person2, this);
+        if(edges[i].weight != 1.0) {
+          person2->set_weight_to(person1, this, edges[i].weight);
+          person1->set_weight_from(person2, this, edges[i].weight);
+        }
       }
     }
   }
+  if(bad > 0) {
+    FRED_VERBOSE(0, "WARNING: network %s: %d edges refer to unknown people\n", this->get_label(), bad);
+  }
+
+  if(has_compact_edges()) {
+    edges.resize(n);
+    if(undirected) {
+      edges.reserve(2 * n);
+      for(int i = 0; i < n; ++i) {
+        Adjacency::edge_t reverse = { edges[i].to, edges[i].from, edges[i].weight, edges[i].timestamp };
+        edges.push_back(reverse);
+      }
+    }
+    this->outward->build(edges);
+    for(int i = 0; i < edges.size(); ++i) {
+      std::swap(edges[i].from, edges[i].to);
+    }
+    this->inward->build(edges);
+    FRED_STATUS(0, "network %s has %lld edges in compact storage\n", this->get_label(), this->outward->get_number_of_edges());
+  }
+}
+
+void Network::compact_edges() {
+  if(has_compact_edges() && this->outward->needs_compaction(0.1)) {
+    this->outward->compact();
+  }
+  if(has_compact_edges() && this->inward->needs_compaction(0.1)) {
+    this->inward->compact();
+  }
+}
+
+void Network::save_checkpoint(Checkpoint* checkpoint) {
+  Group::save_checkpoint(checkpoint);
+  if(has_compact_edges()) {
+    this->outward->save_checkpoint(checkpoint);
+    this->inward->save_checkpoint(checkpoint);
+  }
+}
+
+void Network::restore_checkpoint(Checkpoint* checkpoint) {
+  Group::restore_checkpoint(checkpoint);
+  if(has_compact_edges()) {
+    this->outward->restore_checkpoint(checkpoint);
+    this->inward->restore_checkpoint(checkpoint);
+  }
 }
 
 void Network::get_properties() {
@@ -188,6 +362,12 @@ int Network::get_time_block(int day, int hour) {
 }
 
 
+/**
+ * Replace the network's edges with a random network of about
+ * mean_degree * size edges, none of which gives a member more than
+ * max_degree edges.  The <network>.random_network_model property
+ * picks the generator.
+ */
 void Network::randomize(double mean_degree, int max_degree) {
   int size = this->get_size();
   if(size < 2) {
@@ -197,62 +377,323 @@ void Network::randomize(double mean_degree, int max_degree) {
     Person* person = get_member(i);
     person->clear_network(this);
   }
-  // print_stdout();
   int number_edges = mean_degree * size + 0.5;
   FRED_DEBUG(0, "RANDOMIZE size = %d  edges = %d\n\n", size, number_edges);
-  int edges = 0;
-  int found = 1;
-  while(edges < number_edges && found==1) {
-    found = 0;
-    int pos1 = Random::draw_random_int(0, size - 1);
-    Person* src = this->get_member(pos1);
-    while(src->get_degree(this) >= max_degree) {
-      FRED_DEBUG(0, "RANDOMIZE src degree = %d >= max_degree = %d\n", src->get_degree(this), max_degree);
-      pos1 = Random::draw_random_int(0, size - 1);
-      src = this->get_member(pos1);
-    }
-    FRED_DEBUG(0, "RANDOMIZE src person %d sex %c\n", src->get_id(), src->get_sex());
-
-    // get a qualified destination
-
-    // shuffle the order of candidates
-    std::vector<int> shuffle_index;
-    shuffle_index.clear();
-    shuffle_index.reserve(size);
-    for(int i = 0; i < size; ++i) {
-      shuffle_index.push_back(i);
+
+  // the generators work on member positions
+  std::vector<Adjacency::edge_t> edges;
+  edges.reserve(number_edges);
+  const char* model = this->network_type->get_random_network_model();
+  if(strcmp(model, "erdos_renyi") == 0) {
+    randomize_erdos_renyi(number_edges, max_degree, edges);
+  } else if(strcmp(model, "configuration") == 0) {
+    randomize_configuration(number_edges, max_degree, edges);
+  } else {
+    randomize_uniform(number_edges, max_degree, edges);
+  }
+  for(int i = 0; i < edges.size(); ++i) {
+    edges[i].from = get_member(edges[i].from)->get_id();
+    edges[i].to = get_member(edges[i].to)->get_id();
+  }
+  int found = edges.size() == number_edges;
+  int count = edges.size();
+  add_edges(edges);
+  printf("RANDOMIZE size = %d  found = %d edges = %d  mean_degree = %f\n\n", size, found, count, (count*1.0)/size);
+}
+
+namespace {
+
+  // the positions of members that can take another edge, with O(1) removal
+  class Open_Set {
+  public:
+    void add(int pos) {
+      if(this->where.size() <= pos) {
+        this->where.resize(pos + 1, -1);
+      }
+      this->where[pos] = this->member.size();
+      this->member.push_back(pos);
+    }
+    void remove(int pos) {
+      int k = this->where[pos];
+      int last = this->member.back();
+      this->member[k] = last;
+      this->where[last] = k;
+      this->member.pop_back();
+      this->where[pos] = -1;
+    }
+    int size() {
+      return this->member.size();
+    }
+    int draw() {
+      return this->member[Random::draw_random_int(0, this->member.size() - 1)];
+    }
+    std::vector<int> member;
+  private:
+    std::vector<int> where;
+  };
+
+  inline long long int edge_key(int from, int to, int size, bool undirected) {
+    if(undirected && to < from) {
+      std::swap(from, to);
     }
+    return (long long int) from * size + to;
+  }
+
+  // an open member other than src and not yet connected to it, or -1
+  int draw_partner(int src, Open_Set & candidates, std::unordered_set<long long int> & connected, int size, bool undirected) {
+    if(candidates.size() == 0) {
+      return -1;
+    }
+    for(int t = 0; t < 32; ++t) {
+      int pos = candidates.draw();
+      if(pos != src && connected.count(edge_key(src, pos, size, undirected)) == 0) {
+        return pos;
+      }
+    }
+    // crowded: look at every candidate in random order
+    std::vector<int> shuffle_index = candidates.member;
     FYShuffle<int>(shuffle_index);
+    for(int k = 0; k < shuffle_index.size(); ++k) {
+      int pos = shuffle_index[k];
+      if(pos != src && connected.count(edge_key(src, pos, size, undirected)) == 0) {
+        return pos;
+      }
+    }
+    return -1;
+  }
 
-    int index = 0;
-    while(index < size && found == 0) {
-      int pos = shuffle_index[index];
-      Person* dest = get_member(pos);
-      if(dest == src) {
-        ++index;
-        continue;
+}
+
+int Network::get_number_of_mixing_groups() {
+  int width = this->network_type->get_mixing_age_width();
+  int max_age = 0;
+  if(width > 0) {
+    for(int i = 0; i < this->get_size(); ++i) {
+      max_age = std::max(max_age, get_member(i)->get_age());
+    }
+  }
+  return 2 * (width > 0 ? max_age / width + 1 : 1);
+}
+
+/**
+ * The mixing group of the member at the given position: the member's
+ * age band and sex, or if partner is set, the group of the people the
+ * member prefers to be connected to.
+ */
+int Network::get_mixing_group(int pos, bool partner) {
+  Person* person = get_member(pos);
+  int width = this->network_type->get_mixing_age_width();
+  const char* mixing_sex = this->network_type->get_mixing_sex();
+  int band = width > 0 ? person->get_age() / width : 0;
+  int female = 0;
+  if(strcmp(mixing_sex, "any") != 0) {
+    female = person->get_sex() == 'F';
+    if(partner && strcmp(mixing_sex, "opposite") == 0) {
+      female = 1 - female;
+    }
+  }
+  return 2 * band + female;
+}
+
+/**
+ * Add edges one at a time between a random member and a random other
+ * member, both with fewer than max_degree edges and not yet connected.
+ * Destinations are found by rejection sampling from the set of open
+ * members, falling back to a scan of the set for crowded networks.
+ * With assortative mixing, the destination is drawn from the source's
+ * partner group with probability <network>.assortativity.
+ */
+void Network::randomize_uniform(int number_edges, int max_degree, std::vector<Adjacency::edge_t> & edges) {
+  int size = this->get_size();
+  bool undirected = is_undirected();
+  bool mixing = this->network_type->has_mixing();
+  double assortativity = this->network_type->get_assortativity();
+  std::vector<int> degree(size, 0);
+  std::unordered_set<long long int> connected;
+  Open_Set open;
+  std::vector<Open_Set> open_group(mixing ? get_number_of_mixing_groups() : 0);
+  std::vector<int> group(size, 0);
+  for(int pos = 0; pos < size; ++pos) {
+    if(max_degree > 0) {
+      open.add(pos);
+      if(mixing) {
+        group[pos] = get_mixing_group(pos, false);
+        open_group[group[pos]].add(pos);
+      }
+    }
+  }
+
+  while(edges.size() < number_edges && open.size() > 1) {
+    int src = open.draw();
+    int dest = -1;
+    if(mixing && Random::draw_random() < assortativity) {
+      dest = draw_partner(src, open_group[get_mixing_group(src, true)], connected, size, undirected);
+    }
+    if(dest < 0) {
+      dest = draw_partner(src, open, connected, size, undirected);
+    }
+    if(dest < 0) {
+      // src is connected to everyone open, and stays so as others fill up
+      open.remove(src);
+      if(mixing) {
+        open_group[group[src]].remove(src);
+      }
+      continue;
+    }
+    Adjacency::edge_t edge = { src, dest, 1.0, Global::Simulation_Step };
+    edges.push_back(edge);
+    connected.insert(edge_key(src, dest, size, undirected));
+    int ends[2] = { src, dest };
+    for(int k = 0; k < 2; ++k) {
+      if(++degree[ends[k]] >= max_degree) {
+        open.remove(ends[k]);
+        if(mixing) {
+          open_group[group[ends[k]]].remove(ends[k]);
+        }
       }
-      if(dest->get_degree(this) >= max_degree) {
-        ++index;
-        continue;
+    }
+  }
+}
+
+/**
+ * Include each pair of members independently with the probability
+ * that gives number_edges edges on average, skipping over the pairs
+ * left out with geometrically distributed jumps so the cost is linear
+ * in the number of edges.  Pairs with an end at max_degree are dropped.
+ */
+void Network::randomize_erdos_renyi(int number_edges, int max_degree, std::vector<Adjacency::edge_t> & edges) {
+  int size = this->get_size();
+  bool undirected = is_undirected();
+  long long int pairs = undirected ? (long long int) size * (size - 1) / 2 : (long long int) size * (size - 1);
+  double p = (double) number_edges / pairs;
+  if(p <= 0.0) {
+    return;
+  }
+  double log_q = p < 1.0 ? log(1.0 - p) : 0.0;
+  std::vector<int> degree(size, 0);
+
+  // pairs are numbered row by row: (1,0), (2,0), (2,1), ... if
+  // undirected, else (0,1), ..., (0,n-1), (1,0), (1,2), ...
+  int src = undirected ? 1 : 0;
+  long long int row_start = 0;
+  long long int row_length = undirected ? 1 : size - 1;
+  for(long long int k = -1; ; ) {
+    double skip = p < 1.0 ? floor(log(1.0 - Random::draw_random()) / log_q) : 0.0;
+    if(k + 1 + skip >= pairs) {
+      break;
+    }
+    k += 1 + (long long int) skip;
+    while(k >= row_start + row_length) {
+      row_start += row_length;
+      ++src;
+      if(undirected) {
+        ++row_length;
       }
-      if(src->is_connected_to(dest, this)) {
-        ++index;
-        continue;
+    }
+    int dest = k - row_start;
+    if(undirected == false && dest >= src) {
+      ++dest;
+    }
+    if(degree[src] < max_degree && degree[dest] < max_degree) {
+      Adjacency::edge_t edge = { src, dest, 1.0, Global::Simulation_Step };
+      edges.push_back(edge);
+      ++degree[src];
+      ++degree[dest];
+    }
+  }
+}
+
+/**
+ * Give each member a number of edge ends drawn from
+ * <network>.degree_distribution, or from a Poisson distribution with
+ * mean 2 * number_edges / size if none is given, capped at max_degree.
+ * The ends are then paired at random, dropping self-loops and repeated
+ * edges.  With assortative mixing, each end is first offered to the
+ * owner's partner group with probability <network>.assortativity.
+ */
+void Network::randomize_configuration(int number_edges, int max_degree, std::vector<Adjacency::edge_t> & edges) {
+  int size = this->get_size();
+  bool undirected = is_undirected();
+  bool mixing = this->network_type->has_mixing();
+  double assortativity = this->network_type->get_assortativity();
+  Alias_Table degree_sampler;
+  std::vector<double> & degree_distribution = this->network_type->get_degree_distribution();
+  if(degree_distribution.size() > 0) {
+    degree_sampler.setup(degree_distribution);
+  }
+  double mean = 2.0 * number_edges / size;
+
+  // the ends of the edges, by mixing group (the last entry is the general pool)
+  int groups = mixing ? get_number_of_mixing_groups() : 0;
+  std::vector<std::vector<int> > ends(groups + 1);
+  for(int pos = 0; pos < size; ++pos) {
+    int degree = degree_sampler.size() > 0 ? degree_sampler.draw() : Random::draw_poisson(mean);
+    degree = std::min(degree, max_degree);
+    int own_group = mixing ? get_mixing_group(pos, false) : 0;
+    for(int k = 0; k < degree; ++k) {
+      if(mixing && Random::draw_random() < assortativity) {
+        ends[own_group].push_back(pos);
+      } else {
+        ends[groups].push_back(pos);
       }
+    }
+  }
 
-      // printf("RANDOMIZE ADD EDGE from person %d sex %c to person %d sex %c \n", src->get_id(), src->get_sex(), dest->get_id(), dest->get_sex());
-      src->add_edge_to(dest, this);
-      dest->add_edge_from(src, this);
-      if(this->is_undirected()) {
-        src->add_edge_from(dest, this);
-        dest->add_edge_to(src, this);
+  std::unordered_set<long long int> connected;
+  std::vector<int> & pool = ends[groups];
+
+  // pair the assortative ends with their partner group's ends, and
+  // leave what is not matched for the general pool
+  bool opposite = strcmp(this->network_type->get_mixing_sex(), "opposite") == 0;
+  for(int g = 0; g < groups; ++g) {
+    int h = opposite ? (g ^ 1) : g;
+    if(h < g) {
+      continue;
+    }
+    FYShuffle<int>(ends[g]);
+    if(h == g) {
+      int n = ends[g].size() / 2;
+      for(int k = 0; k < n; ++k) {
+        int src = ends[g][2 * k];
+        int dest = ends[g][2 * k + 1];
+        if(src != dest && connected.insert(edge_key(src, dest, size, undirected)).second) {
+          Adjacency::edge_t edge = { src, dest, 1.0, Global::Simulation_Step };
+          edges.push_back(edge);
+        }
+      }
+      if(ends[g].size() % 2) {
+        pool.push_back(ends[g].back());
       }
-      ++edges;
-      found = 1;
+    } else {
+      FYShuffle<int>(ends[h]);
+      int n = std::min(ends[g].size(), ends[h].size());
+      for(int k = 0; k < n; ++k) {
+        int src = Random::draw_random() < 0.5 ? ends[g][k] : ends[h][k];
+        int dest = src == ends[g][k] ? ends[h][k] : ends[g][k];
+        if(connected.insert(edge_key(src, dest, size, undirected)).second) {
+          Adjacency::edge_t edge = { src, dest, 1.0, Global::Simulation_Step };
+          edges.push_back(edge);
+        }
+      }
+      for(int k = n; k < ends[g].size(); ++k) {
+        pool.push_back(ends[g][k]);
+      }
+      for(int k = n; k < ends[h].size(); ++k) {
+        pool.push_back(ends[h][k]);
+      }
+    }
+  }
+
+  // pair the rest at random; a shuffle also picks the direction
+  FYShuffle<int>(pool);
+  for(int k = 0; k + 1 < pool.size(); k += 2) {
+    int src = pool[k];
+    int dest = pool[k + 1];
+    if(src != dest && connected.insert(edge_key(src, dest, size, undirected)).second) {
+      Adjacency::edge_t edge = { src, dest, 1.0, Global::Simulation_Step };
+      edges.push_back(edge);
     }
   }
-  printf("RANDOMIZE size = %d  found = %d edges = %d  mean_degree = %f\n\n", size, found, edges, (edges*1.0)/size);
 }
 
 const char* Network::get_name() {
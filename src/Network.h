@@ -28,6 +28,7 @@
 
 #include "Global.h"
 #include "Group.h"
+#include "Adjacency.h"
 
 class Condition;
 class Preference;
@@ -54,6 +55,20 @@ public:
   bool is_undirected();
   void read_edges();
 
+  // compact (CSR) edge storage, used if <network>.compact_edges is set
+  bool has_compact_edges() {
+    return this->outward != NULL;
+  }
+  Adjacency* get_outward_adjacency() {
+    return this->outward;
+  }
+  Adjacency* get_inward_adjacency() {
+    return this->inward;
+  }
+  void compact_edges();
+  void save_checkpoint(Checkpoint* checkpoint);
+  void restore_checkpoint(Checkpoint* checkpoint);
+
   Network_Type* get_network_type() {
     return this->network_type;
   }
@@ -71,8 +86,20 @@ public:
 
 
 protected:
+  void read_edge_file(const char* filename, std::vector<Adjacency::edge_t> & edges);
+  void add_edges(std::vector<Adjacency::edge_t> & edges);
+
+  // random network generators; edges join member positions
+  void randomize_uniform(int number_edges, int max_degree, std::vector<Adjacency::edge_t> & edges);
+  void randomize_erdos_renyi(int number_edges, int max_degree, std::vector<Adjacency::edge_t> & edges);
+  void randomize_configuration(int number_edges, int max_degree, std::vector<Adjacency::edge_t> & edges);
+  int get_mixing_group(int pos, bool partner);
+  int get_number_of_mixing_groups();
+
   pair_vector_t edge;
   Network_Type* network_type;
+  Adjacency* outward;
+  Adjacency* inward;
   // string_vector_t pool_str;
   // int_vector_t pool;
   // clause_vector_t requirements;
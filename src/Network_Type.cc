@@ -24,6 +24,7 @@
 //
 
 
+#include "Checkpoint.h"
 #include "Property.h"
 #include "Network.h"
 #include "Network_Type.h"
@@ -46,8 +47,15 @@ Network_Type::Network_Type(int type_id, string _name) : Group_Type(_name) {
   // generate one network for each network_type
   this->id = type_id;
   this->network = new Network(_name.c_str(), type_id, this);
+  this->network->set_index(0);
   this->print_interval = 0;
   this->next_print_day = 999999;
+  strcpy(this->edge_file, "none");
+  this->compact_edges = false;
+  strcpy(this->random_network_model, "uniform");
+  this->mixing_age_width = 0;
+  strcpy(this->mixing_sex, "any");
+  this->assortativity = 1.0;
   Group_Type::add_group_type(this);
 }
 
@@ -117,6 +125,37 @@ void Network_Type::get_properties() {
   Property::get_property(property_name, &n);
   this->undirected = n;
 
+  sprintf(property_name, "%s.edge_file", this->name.c_str());
+  Property::get_property(property_name, this->edge_file);
+
+  sprintf(property_name, "%s.compact_edges", this->name.c_str());
+  n = 0;
+  Property::get_property(property_name, &n);
+  this->compact_edges = n;
+
+  sprintf(property_name, "%s.random_network_model", this->name.c_str());
+  Property::get_property(property_name, this->random_network_model);
+  if(strcmp(this->random_network_model, "uniform") != 0 && strcmp(this->random_network_model, "erdos_renyi") != 0
+     && strcmp(this->random_network_model, "configuration") != 0) {
+    Utils::fred_abort("Network %s: unknown random_network_model %s\n", this->name.c_str(), this->random_network_model);
+  }
+
+  sprintf(property_name, "%s.degree_distribution", this->name.c_str());
+  Property::get_property_vector(property_name, this->degree_distribution);
+
+  sprintf(property_name, "%s.mixing_age_width", this->name.c_str());
+  Property::get_property(property_name, &this->mixing_age_width);
+
+  sprintf(property_name, "%s.mixing_sex", this->name.c_str());
+  Property::get_property(property_name, this->mixing_sex);
+  if(strcmp(this->mixing_sex, "any") != 0 && strcmp(this->mixing_sex, "same") != 0
+     && strcmp(this->mixing_sex, "opposite") != 0) {
+    Utils::fred_abort("Network %s: unknown mixing_sex %s\n", this->name.c_str(), this->mixing_sex);
+  }
+
+  sprintf(property_name, "%s.assortativity", this->name.c_str());
+  Property::get_property(property_name, &this->assortativity);
+
   sprintf(property_name, "%s.print_interval", this->name.c_str());
   Property::get_property(property_name, &this->print_interval);
   if (this->print_interval > 0) {
@@ -137,6 +176,13 @@ void Network_Type::prepare_network_types() {
   }
 }
 
+void Network_Type::update_network_types(int day) {
+  // fold the day's edge changes into compact storage
+  for(int index = 0; index < Network_Type::get_number_of_network_types(); ++index) {
+    Network_Type::network_types[index]->get_network()->compact_edges();
+  }
+}
+
 void Network_Type::print_network_types(int day) {
   for(int index = 0; index < Network_Type::get_number_of_network_types(); ++index) {
     Network_Type* net_type = Network_Type::network_types[index];
@@ -155,4 +201,14 @@ void Network_Type::finish_network_types() {
   }
 }
 
+void Network_Type::save_checkpoint(Checkpoint* checkpoint) {
+  for(int index = 0; index < Network_Type::get_number_of_network_types(); ++index) {
+    checkpoint->put_int(Network_Type::network_types[index]->next_print_day);
+  }
+}
 
+void Network_Type::restore_checkpoint(Checkpoint* checkpoint) {
+  for(int index = 0; index < Network_Type::get_number_of_network_types(); ++index) {
+    Network_Type::network_types[index]->next_print_day = checkpoint->get_int();
+  }
+}
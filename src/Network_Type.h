@@ -29,6 +29,8 @@
 #include "Global.h"
 #include "Group_Type.h"
 
+class Checkpoint;
+
 
 namespace Network_Action {
   enum e {NONE, JOIN, ADD_EDGE_TO, ADD_EDGE_FROM, DELETE_EDGE_TO, DELETE_EDGE_FROM, RANDOMIZE, QUIT  };
@@ -57,6 +59,38 @@ public:
     return this->undirected;
   }
 
+  const char* get_edge_file() {
+    return this->edge_file;
+  }
+
+  bool uses_compact_edges() {
+    return this->compact_edges;
+  }
+
+  const char* get_random_network_model() {
+    return this->random_network_model;
+  }
+
+  std::vector<double> & get_degree_distribution() {
+    return this->degree_distribution;
+  }
+
+  bool has_mixing() {
+    return this->mixing_age_width > 0 || strcmp(this->mixing_sex, "any") != 0;
+  }
+
+  int get_mixing_age_width() {
+    return this->mixing_age_width;
+  }
+
+  const char* get_mixing_sex() {
+    return this->mixing_sex;
+  }
+
+  double get_assortativity() {
+    return this->assortativity;
+  }
+
   // static methods
 
   static void get_network_type_properties();
@@ -137,10 +171,16 @@ public:
     return Network_Type::network_types.size();
   }
 
+  static void update_network_types(int day);
+
   static void print_network_types(int day);
 
   static void finish_network_types();
 
+  static void save_checkpoint(Checkpoint* checkpoint);
+
+  static void restore_checkpoint(Checkpoint* checkpoint);
+
 private:
 
   // index in this vector of network types
@@ -150,6 +190,21 @@ private:
   int id;
   bool undirected;
 
+  // edge-list file read at setup, and whether to store edges in CSR form
+  char edge_file[FRED_STRING_SIZE];
+  bool compact_edges;
+
+  // how randomize_network builds edges: "uniform", "erdos_renyi" or "configuration"
+  char random_network_model[FRED_STRING_SIZE];
+  std::vector<double> degree_distribution;
+
+  // assortative mixing in random networks: the fraction of edges
+  // that join people in the same age band and of the chosen sex
+  // ("same", "opposite" or "any")
+  int mixing_age_width;
+  char mixing_sex[FRED_STRING_SIZE];
+  double assortativity;
+
   // each network type has one network
   Network* network;
 
@@ -26,18 +26,22 @@
 #include "Person.h"
 
 #include "Census_Tract.h"
+#include "Checkpoint.h"
 #include "Clause.h"
 #include "Condition.h"
 #include "County.h"
+#include "Daily_Report.h"
 #include "Date.h"
 #include "Demographics.h"
 #include "Epidemic.h"
 #include "Factor.h"
 #include "Global.h"
 #include "Expression.h"
+#include "External_Update.h"
 #include "Geo.h"
 #include "Group.h"
 #include "Group_Type.h"
+#include "Hospital.h"
 #include "Household.h"
 #include "Link.h"
 #include "Neighborhood_Layer.h"
@@ -47,9 +51,14 @@
 #include "Property.h"
 #include "Place.h"
 #include "Place_Type.h"
+#include "Population_Cache.h"
+#include "Population_Snapshot.h"
 #include "Preference.h"
 #include "Random.h"
+#include "Exposure_Trace.h"
+#include "Record_Log.h"
 #include "Rule.h"
+#include "Text_File.h"
 #include "Travel.h"
 #include "Utils.h"
 
@@ -73,6 +82,16 @@ int Person::next_meta_id = -1;
 Person* Person::Import_agent = NULL;
 std::unordered_map<Person*, Group*> Person::admin_group_map;
 bool Person::record_location = false;
+
+// storage
+bool Person::storage_ready = false;
+Arena<Person> Person::person_arena;
+Arena<condition_t> Person::condition_arena;
+Arena<int> Person::entered_arena;
+std::vector<int> Person::entered_offset;
+Arena<double> Person::var_arena;
+Arena<double_vector_t> Person::list_var_arena;
+person_vector_t Person::released_list;
   
 // personal variables
 std::vector<std::string> Person::var_name;
@@ -98,6 +117,10 @@ int Person::report_initial_population = 0;
 int Person::output_population = 0;
 char Person::pop_outfile[FRED_STRING_SIZE];
 char Person::output_population_date_match[FRED_STRING_SIZE];
+int Person::output_population_interval = 0;
+int Person::output_population_binary = 0;
+int Person::output_population_deltas = 0;
+char Person::output_population_vars[FRED_STRING_SIZE] = "none";
 int Person::Popsize_by_age [Demographics::MAX_AGE+1];
 
 // static variables
@@ -118,6 +141,7 @@ Person::Person() {
   this->sex = 'n';
   this->birthday_sim_day = -1;
   this->deceased = false;
+  this->pinned = false;
   this->household_relationship = -1;
   this->race = -1;
   this->number_of_children = -1;
@@ -126,6 +150,7 @@ Person::Person() {
   this->insurance_type = Insurance_assignment_index::UNSET;
   this->condition = NULL;
   this->var = NULL;
+  this->list_var = NULL;
   this->home_neighborhood = NULL;
   this->profile = Activity_Profile::UNDEFINED;
   this->schedule_updated = -1;
@@ -368,7 +393,7 @@ void Person::quit_place_of_type(int place_type_id) {
 	       place == NULL ? "NULL" : place->get_label(),
 	       size);
   if (Global::Enable_Records) {
-    fprintf(Global::Recordsfp,
+    Record_Log::print(
 	    "HEALTH RECORD: %s %s day %d person %d QUITS PLACE type %s label %s new size = %d\n",
 	    Date::get_date_string().c_str(),
 	    Date::get_12hr_clock().c_str(),
@@ -416,7 +441,7 @@ void Person::select_place_of_type(int place_type_id) {
 	       place == NULL ? "NULL" : place->get_label(),
 	       size);
   if (Global::Enable_Records) {
-    fprintf(Global::Recordsfp,
+    Record_Log::print(
 	    "HEALTH RECORD: %s %s day %d person %d JOINS PLACE type %s label %s new size = %d\n",
 	    Date::get_date_string().c_str(),
 	    Date::get_12hr_clock().c_str(),
@@ -601,6 +626,10 @@ void Person::get_population_properties() {
   Property::get_property("pop_outfile", Person::pop_outfile);
   Property::get_property("output_population_date_match",
 		    Person::output_population_date_match);
+  Property::get_property("output_population_interval", &Person::output_population_interval);
+  Property::get_property("output_population_binary", &Person::output_population_binary);
+  Property::get_property("output_population_deltas", &Person::output_population_deltas);
+  Property::get_property("output_population_vars", Person::output_population_vars);
   Property::get_property("max_reporting_agents", &Person::max_reporting_agents);
 
   // restore requiring properties
@@ -664,7 +693,7 @@ Person* Person::add_person_to_population(int age, char sex, int race, int rel,
 					     Place* house, Place* school, Place* work,
 					     int day, bool today_is_birthday) {
 
-  Person* person = new Person;
+  Person* person = new (Person::person_arena.allocate()) Person;
   int id = Person::next_id++;
   int idx = Person::people.size();
   // FRED_VERBOSE(0, "setup:\n");
@@ -753,6 +782,8 @@ void Person::setup() {
     }
   }
 
+  Person::setup_storage();
+
   // define the Import_agent
   Person::Import_agent = Person::create_meta_agent();
 
@@ -804,65 +835,142 @@ void Person::setup() {
 }
 
 void Person::get_person_data(char* line, bool gq) {
+  person_data_t data;
+  if (parse_person_line(line, gq, &data)) {
+    find_person_places(&data);
+    add_person_from_data(data);
+  }
+}
 
-  // FRED_STATUS(0, "get_person_data %s\n", line);
-  int day = Global::Simulation_Day;
+/*
+ * Split a line of people.txt or gq_people.txt into fields, in place.
+ * Fields missing from the line keep their defaults, as with sscanf.
+ * Returns false for lines that are skipped.
+ */
+bool Person::parse_person_line(char* line, bool gq, person_data_t* data) {
+  static char no_label[] = "X";
 
-  // person data
-  char label[FRED_STRING_SIZE];
-  Place* house = NULL;
-  Place* work = NULL;
-  Place* school = NULL;
-  int age = -1;
-  int race = -1;
-  int household_relationship = -1;
-  char sex = 'X';
-  bool today_is_birthday = false;
+  // skip empty lines and header lines ...
+  if((line[0] == '\0') || strncmp(line, "sp_id", 6) == 0 || strncmp(line, "per_id", 7) == 0) {
+    return false;
+  }
+
+  data->label = no_label;
+  data->house_label = no_label;
+  data->school_label = no_label;
+  data->work_label = no_label;
+  data->age = -1;
+  data->race = -1;
+  data->household_relationship = -1;
+  data->sex = 'X';
+  data->gq = gq;
+  data->too_old = false;
+  data->house = NULL;
+  data->school = NULL;
+  data->work = NULL;
+
+  char* cursor = line;
+  if (gq) {
+    // fields: sp_id sp_gq_id age sex
+    Text_File::get_string(cursor, &data->label)
+      && Text_File::get_string(cursor, &data->house_label)
+      && Text_File::get_int(cursor, &data->age)
+      && Text_File::get_char(cursor, &data->sex);
+  }
+  else {
+    // fields: sp_id sp_hh_id age sex race relate school_id work_id
+    Text_File::get_string(cursor, &data->label)
+      && Text_File::get_string(cursor, &data->house_label)
+      && Text_File::get_int(cursor, &data->age)
+      && Text_File::get_char(cursor, &data->sex)
+      && Text_File::get_int(cursor, &data->race)
+      && Text_File::get_int(cursor, &data->household_relationship)
+      && Text_File::get_string(cursor, &data->school_label)
+      && Text_File::get_string(cursor, &data->work_label);
+  }
+  return true;
+}
+
+// the labels of the places named by a person's data
+void Person::get_person_labels(person_data_t* data, char* house_label, char* school_label, char* work_label) {
+  if (data->gq) {
+    snprintf(house_label, FRED_STRING_SIZE, "GH-%s", data->house_label);
+    snprintf(work_label, FRED_STRING_SIZE, "GW-%s", data->house_label);
+    strcpy(school_label, "X");
+  }
+  else {
+    snprintf(house_label, FRED_STRING_SIZE, "H-%s", data->house_label);
+    snprintf(work_label, FRED_STRING_SIZE, "W-%s", data->work_label);
+    snprintf(school_label, FRED_STRING_SIZE, "S-%s", data->school_label);
+  }
+}
+
+bool Person::has_school_label(person_data_t* data) {
+  return data->gq == false && strcmp(data->school_label, "X") != 0;
+}
+
+bool Person::has_work_label(person_data_t* data) {
+  return data->gq || strcmp(data->work_label, "X") != 0;
+}
 
-  // place labels
+/*
+ * Look up the places named by a person's data.  This only reads the
+ * place label maps, so it may run on several threads at once.
+ */
+void Person::find_person_places(person_data_t* data) {
   char house_label[FRED_STRING_SIZE];
   char school_label[FRED_STRING_SIZE];
   char work_label[FRED_STRING_SIZE];
-  char gq_label[FRED_STRING_SIZE];
-  char tmp_house_label[FRED_STRING_SIZE];
-  char tmp_school_label[FRED_STRING_SIZE];
-  char tmp_work_label[FRED_STRING_SIZE];
+  get_person_labels(data, house_label, school_label, work_label);
 
-  strcpy(label, "X");
+  // a person too old for schools in FRED is not assigned one
+  data->too_old = has_school_label(data) && Global::GRADES <= data->age;
+
+  data->house = Place::get_household_from_label(house_label);
+  data->work = Place::get_workplace_from_label(work_label);
+  if (data->too_old == false) {
+    data->school = Place::get_school_from_label(school_label);
+  }
+}
+
+void Person::add_person_from_data(person_data_t & data) {
+  int day = Global::Simulation_Day;
+  bool has_school = has_school_label(&data);
+  bool has_work = has_work_label(&data);
+
+  // labels are only needed for warnings
+  char house_label[FRED_STRING_SIZE];
+  char school_label[FRED_STRING_SIZE];
+  char work_label[FRED_STRING_SIZE];
   strcpy(house_label, "X");
   strcpy(school_label, "X");
   strcpy(work_label, "X");
-
-  if (gq) {
-    sscanf(line, "%s %s %d %c", label, gq_label, &age, &sex);
-    sprintf(house_label, "GH-%s", gq_label);
-    sprintf(work_label, "GW-%s", gq_label);
-  }
-  else {
-    sscanf(line, "%s %s %d %c %d %d %s %s", label, tmp_house_label, &age, &sex, &race, &household_relationship, tmp_school_label, tmp_work_label);
-    sprintf(house_label, "H-%s", tmp_house_label);
-    sprintf(work_label, "W-%s", tmp_work_label);
-    sprintf(school_label, "S-%s", tmp_school_label);
+  if (data.too_old || data.house == NULL || (has_work && data.work == NULL) || (has_school && data.school == NULL)) {
+    get_person_labels(&data, house_label, school_label, work_label);
   }
 
-  // FRED_VERBOSE(0,"GET_PERSON_DATA %s %s %d %c %d %d %s %s\n", label, house_label, age, (char) sex, race, household_relationship, school_label, work_label); fflush(stdout);
-
-  if (strcmp(tmp_school_label,"X") != 0 && Global::GRADES <= age) {
-    // person is too old for schools in FRED!
+  if (data.too_old) {
     FRED_VERBOSE(0, "WARNING: person %s age %d is too old to attend school %s\n",
-		 label,
-		 age,
+		 data.label,
+		 data.age,
 		 school_label);
-    // reset school _label
     strcpy(school_label, "X");
   }
 
-  // set pointer to primary places in init data object
-  house = Place::get_household_from_label(house_label);
-  // FRED_VERBOSE(0, "get_household_from_label ok\n");
-  work =  Place::get_workplace_from_label(work_label);
-  school = Place::get_school_from_label(school_label);
+  add_person_with_places(data.label, data.age, data.sex, data.race, data.household_relationship,
+			 data.house, data.school, data.work, house_label, school_label, work_label,
+			 has_school, has_work, day, false);
+}
 
+/*
+ * Add a person read from a population file, once its places have been
+ * found.  has_school and has_work are true if the file named a school
+ * or workplace for the person.
+ */
+void Person::add_person_with_places(const char* label, int age, char sex, int race, int household_relationship,
+				    Place* house, Place* school, Place* work,
+				    const char* house_label, const char* school_label, const char* work_label,
+				    bool has_school, bool has_work, int day, bool today_is_birthday) {
   if(house == NULL) {
     // we need at least a household (homeless people not yet supported), so
     // skip this person
@@ -872,7 +980,7 @@ void Person::get_person_data(char* line, bool gq) {
   }
 
   // warn if we can't find workplace
-  if(strcmp(tmp_work_label, "X") != 0 && work == NULL) {
+  if(has_work && work == NULL) {
     FRED_VERBOSE(2, "WARNING: person %s -- no workplace found for label = %s\n", label,
 		 work_label);
     if(Global::Enable_Local_Workplace_Assignment) {
@@ -888,7 +996,7 @@ void Person::get_person_data(char* line, bool gq) {
   }
 
   // warn if we can't find school.
-  if (strcmp(tmp_school_label,"X") != 0 && school == NULL) {
+  if (has_school && school == NULL) {
     FRED_VERBOSE(0, "WARNING: person %s -- no school found for label = %s\n", label, school_label);
   }
 
@@ -897,19 +1005,72 @@ void Person::get_person_data(char* line, bool gq) {
 			   school, work, day, today_is_birthday);
 }
 
+/*
+ * Reads people.txt and gq_people.txt files for Text_File::read_files():
+ * lines are parsed and their places found on all threads, and people
+ * are added in file order.
+ */
+class People_File_Reader {
+public:
+  ~People_File_Reader() {
+    clear();
+  }
+
+  void add_file(Text_File* file, bool gq) {
+    this->files.push_back(file);
+    this->gq.push_back(gq);
+  }
+
+  // read and close the files added so far
+  void read_files() {
+    if (this->files.empty()) {
+      return;
+    }
+    Text_File::read_files<person_data_t>(this->files, *this);
+    clear();
+    FRED_VERBOSE(0, "finished reading population, pop_size = %d\n", Person::get_population_size());
+  }
+
+  bool parse(int file_index, char* line, person_data_t* data) {
+    if (Person::parse_person_line(line, this->gq[file_index], data) == false) {
+      return false;
+    }
+    Person::find_person_places(data);
+    return true;
+  }
+
+  void commit(int file_index, person_data_t & data) {
+    Person::add_person_from_data(data);
+  }
+
+private:
+  void clear() {
+    for (int i = 0; i < this->files.size(); ++i) {
+      delete this->files[i];
+    }
+    this->files.clear();
+    this->gq.clear();
+  }
+
+  std::vector<Text_File*> files;
+  std::vector<bool> gq;
+};
 
 void Person::read_all_populations() {
 
-  // process each specified location
+  // process each specified location; the text files of all locations
+  // are read together
+  People_File_Reader reader;
   int locs = Place::get_number_of_location_ids();
   for (int i = 0; i < locs; ++i) {
     char pop_dir[FRED_STRING_SIZE];
     Place::get_population_directory(pop_dir, i);
-    read_population(pop_dir, "people");
+    read_population(pop_dir, "people", reader);
     if(Global::Enable_Group_Quarters) {
-      read_population(pop_dir, "gq_people");
+      read_population(pop_dir, "gq_people", reader);
     }
   }
+  reader.read_files();
 
   // mark all original people as original
   for (int i = 0; i < people.size(); i++) {
@@ -921,7 +1082,11 @@ void Person::read_all_populations() {
 
 }
 
-void Person::read_population(const char* pop_dir, const char* pop_type) {
+/*
+ * Add the population file of one location to the reader, or read it
+ * from the location's binary cache after the files already added.
+ */
+void Person::read_population(const char* pop_dir, const char* pop_type, People_File_Reader & reader) {
 
   FRED_STATUS(0, "read population entered\n");
 
@@ -942,24 +1107,129 @@ void Person::read_population(const char* pop_dir, const char* pop_type) {
     return;
   }
 
-  std::ifstream stream(population_file, ifstream::in);
+  Population_Cache* cache = Population_Cache::get_cache(pop_dir);
+  if (cache != NULL) {
+    reader.read_files();
+    read_population_from_cache(cache, is_group_quarters_pop);
+    FRED_VERBOSE(0, "finished reading population from cache, pop_size = %d\n", Person::pop_size);
+    return;
+  }
 
-  char line[FRED_STRING_SIZE];
-  // discard header line
-  stream.getline(line, FRED_STRING_SIZE);
-  while(stream.good()) {
-    stream.getline(line, FRED_STRING_SIZE);
-    // skip empty lines and header lines ...
-    if((line[0] == '\0') || strncmp(line, "sp_id", 6) == 0 || strncmp(line, "per_id", 7) == 0) {
-      continue;
+  Text_File* file = new Text_File;
+  if (file->open(population_file) == false) {
+    Utils::fred_abort("population_file %s can't be read\n", population_file);
+  }
+  reader.add_file(file, is_group_quarters_pop);
+}
+
+/*
+ * Add the people of one location from its binary population cache.
+ * Places are found by row, except those skipped when the places were
+ * read or defined in another location, which are found by label.
+ * Labels are only formatted when a warning needs them.
+ */
+void Person::read_population_from_cache(Population_Cache* cache, bool gq) {
+  int day = Global::Simulation_Day;
+  char label[FRED_STRING_SIZE];
+  char house_label[FRED_STRING_SIZE];
+  char school_label[FRED_STRING_SIZE];
+  char work_label[FRED_STRING_SIZE];
+  strcpy(label, "X");
+  strcpy(house_label, "X");
+  strcpy(school_label, "X");
+  strcpy(work_label, "X");
+
+  if (gq) {
+    int n = cache->get_count(Population_Cache::GQ_PEOPLE);
+    for (int i = 0; i < n; ++i) {
+      const Population_Cache::gq_person_record_t* rec = cache->get_gq_person(i);
+      Place* house = get_cached_place(cache, Population_Cache::GROUP_QUARTERS, rec->gq,
+				      cache->gq_household_place, Place_Type::HOUSEHOLD, "GH-");
+      Place* work = get_cached_place(cache, Population_Cache::GROUP_QUARTERS, rec->gq,
+				     cache->gq_workplace_place, Place_Type::WORKPLACE, "GW-");
+      if (house == NULL || work == NULL) {
+	sprintf(label, "%lld", rec->sp_id);
+	get_cached_label(cache, Population_Cache::GROUP_QUARTERS, rec->gq, "GH-", house_label);
+	get_cached_label(cache, Population_Cache::GROUP_QUARTERS, rec->gq, "GW-", work_label);
+      }
+      add_person_with_places(label, rec->age, rec->sex, -1, -1, house, NULL, work,
+			     house_label, "X", work_label, false, rec->gq != Population_Cache::NO_PLACE, day, false);
     }
-    get_person_data(line, is_group_quarters_pop);
+    return;
+  }
+
+  int n = cache->get_count(Population_Cache::PEOPLE);
+  for (int i = 0; i < n; ++i) {
+    const Population_Cache::person_record_t* rec = cache->get_person(i);
+    bool has_school = rec->school != Population_Cache::NO_PLACE;
+    bool has_work = rec->work != Population_Cache::NO_PLACE;
+    bool too_old = has_school && Global::GRADES <= rec->age;
+    Place* house = get_cached_place(cache, Population_Cache::HOUSEHOLDS, rec->house,
+				    cache->household_place, Place_Type::HOUSEHOLD, "H-");
+    Place* work = get_cached_place(cache, Population_Cache::WORKPLACES, rec->work,
+				   cache->workplace_place, Place_Type::WORKPLACE, "W-");
+    Place* school = NULL;
+    if (too_old == false) {
+      school = get_cached_place(cache, Population_Cache::SCHOOLS, rec->school,
+				cache->school_place, Place_Type::SCHOOL, "S-");
+    }
+    if (house == NULL || (has_work && work == NULL) || (has_school && school == NULL)) {
+      sprintf(label, "%lld", rec->sp_id);
+      get_cached_label(cache, Population_Cache::HOUSEHOLDS, rec->house, "H-", house_label);
+      get_cached_label(cache, Population_Cache::WORKPLACES, rec->work, "W-", work_label);
+      get_cached_label(cache, Population_Cache::SCHOOLS, rec->school, "S-", school_label);
+      if (too_old) {
+	// person is too old for schools in FRED!
+	FRED_VERBOSE(0, "WARNING: person %s age %d is too old to attend school %s\n",
+		     label, rec->age, school_label);
+	strcpy(school_label, "X");
+      }
+    }
+    add_person_with_places(label, rec->age, rec->sex, rec->race, rec->relationship, house, school, work,
+			   house_label, school_label, work_label, has_school, has_work, day, false);
+  }
+}
+
+Place* Person::get_cached_place(Population_Cache* cache, int section, int ref,
+				std::vector<Place*> & places, int type_id, const char* prefix) {
+  if (ref == Population_Cache::NO_PLACE) {
+    return NULL;
+  }
+  bool is_row = 0 <= ref && ref < (int) places.size();
+  if (is_row && places[ref] != NULL) {
+    return places[ref];
+  }
+  char label[FRED_STRING_SIZE];
+  get_cached_label(cache, section, ref, prefix, label);
+  Place* place = NULL;
+  if (type_id == Place_Type::HOUSEHOLD) {
+    place = Place::get_household_from_label(label);
+  }
+  else if (type_id == Place_Type::SCHOOL) {
+    place = Place::get_school_from_label(label);
+  }
+  else {
+    place = Place::get_workplace_from_label(label);
+  }
+  if (is_row) {
+    places[ref] = place;
+  }
+  return place;
+}
+
+void Person::get_cached_label(Population_Cache* cache, int section, int ref, const char* prefix, char* label) {
+  if (ref == Population_Cache::NO_PLACE) {
+    sprintf(label, "%sX", prefix);
+  }
+  else {
+    sprintf(label, "%s%s", prefix, cache->get_reference_label(section, ref));
   }
-  FRED_VERBOSE(0, "finished reading population, pop_size = %d\n", Person::pop_size);
 }
 
 void Person::remove_dead_from_population(int day) {
   FRED_VERBOSE(1, "remove_dead_from_population\n");
+  // reuse the storage of people removed on earlier days
+  Person::recycle_released_people();
   size_t deaths = Person::death_list.size();
   for(size_t i = 0; i < deaths; ++i) {
     Person* person = Person::death_list[i];
@@ -1009,8 +1279,403 @@ void Person::delete_person_from_population(int day, Person* person) {
   // record new population_size
   Person::pop_size = Person::people.size();
 
-  // call Person's destructor directly!!!
-  person->~Person();
+  // the storage is reused only after today's reports are written,
+  // since the daily lists may still refer to this person
+  Person::released_list.push_back(person);
+}
+
+/*
+ * People are allocated from arenas, in the order they are created, so
+ * that scans over the population touch contiguous memory.  Each person
+ * has one row in each of the condition, entered-state, var and list_var
+ * arenas instead of separate heap arrays.  Rows must be sized after the
+ * conditions and personal variables are known.
+ */
+void Person::setup_storage() {
+  Person::person_arena.set_row_size(1);
+  int number_of_conditions = Condition::get_number_of_conditions();
+  Person::condition_arena.set_row_size(number_of_conditions);
+  Person::entered_offset.clear();
+  int total_states = 0;
+  for(int condition_id = 0; condition_id < number_of_conditions; ++condition_id) {
+    Person::entered_offset.push_back(total_states);
+    total_states += Condition::get_condition(condition_id)->get_number_of_states();
+  }
+  Person::entered_arena.set_row_size(total_states);
+  Person::var_arena.set_row_size(Person::number_of_vars);
+  Person::list_var_arena.set_row_size(Person::number_of_list_vars);
+  Person::storage_ready = true;
+  FRED_VERBOSE(0, "setup_storage: conditions %d states %d vars %d list_vars %d\n",
+	       number_of_conditions, total_states, Person::number_of_vars, Person::number_of_list_vars);
+}
+
+void Person::recycle_released_people() {
+  int size = Person::released_list.size();
+  for(int i = 0; i < size; ++i) {
+    Person* person = Person::released_list[i];
+    if (person->is_pinned()) {
+      // still referenced elsewhere
+      continue;
+    }
+    person->release_storage();
+    person->~Person();
+    Person::person_arena.release(person);
+  }
+  Person::released_list.clear();
+  FRED_VERBOSE(1, "recycle_released_people: %d people in use, %lu bytes\n",
+	       Person::person_arena.get_rows_in_use(), Person::person_arena.get_bytes_allocated());
+}
+
+/*
+ * Checkpoints.  The population read at startup is the population of
+ * day 0; the checkpoint lists the people still in the population, in
+ * order, and the dynamic state of each of them.
+ */
+void Person::save_checkpoint_header(Checkpoint* checkpoint) {
+  checkpoint->put_int(Person::next_id);
+  checkpoint->put_int(Person::admin_agents.size());
+  checkpoint->put_int(Person::number_of_vars);
+  for(int i = 0; i < Person::number_of_vars; ++i) {
+    checkpoint->put_string(Person::var_name[i]);
+  }
+  checkpoint->put_int(Person::number_of_list_vars);
+  for(int i = 0; i < Person::number_of_list_vars; ++i) {
+    checkpoint->put_string(Person::list_var_name[i]);
+  }
+  checkpoint->put_int(Person::number_of_global_vars);
+  for(int i = 0; i < Person::number_of_global_vars; ++i) {
+    checkpoint->put_string(Person::global_var_name[i]);
+  }
+  checkpoint->put_int(Person::number_of_global_list_vars);
+  for(int i = 0; i < Person::number_of_global_list_vars; ++i) {
+    checkpoint->put_string(Person::global_list_var_name[i]);
+  }
+}
+
+void Person::check_checkpoint_header(Checkpoint* checkpoint) {
+  if(checkpoint->get_int() != Person::next_id) {
+    checkpoint->mismatch("population does not match");
+  }
+  if(checkpoint->get_int() != Person::admin_agents.size()) {
+    checkpoint->mismatch("number of admin agents does not match");
+  }
+  if(checkpoint->get_int() != Person::number_of_vars) {
+    checkpoint->mismatch("number of agent variables does not match");
+  }
+  for(int i = 0; i < Person::number_of_vars; ++i) {
+    if(checkpoint->get_string() != Person::var_name[i]) {
+      checkpoint->mismatch("agent variables do not match");
+    }
+  }
+  if(checkpoint->get_int() != Person::number_of_list_vars) {
+    checkpoint->mismatch("number of agent list variables does not match");
+  }
+  for(int i = 0; i < Person::number_of_list_vars; ++i) {
+    if(checkpoint->get_string() != Person::list_var_name[i]) {
+      checkpoint->mismatch("agent list variables do not match");
+    }
+  }
+  if(checkpoint->get_int() != Person::number_of_global_vars) {
+    checkpoint->mismatch("number of global variables does not match");
+  }
+  for(int i = 0; i < Person::number_of_global_vars; ++i) {
+    if(checkpoint->get_string() != Person::global_var_name[i]) {
+      checkpoint->mismatch("global variables do not match");
+    }
+  }
+  if(checkpoint->get_int() != Person::number_of_global_list_vars) {
+    checkpoint->mismatch("number of global list variables does not match");
+  }
+  for(int i = 0; i < Person::number_of_global_list_vars; ++i) {
+    if(checkpoint->get_string() != Person::global_list_var_name[i]) {
+      checkpoint->mismatch("global list variables do not match");
+    }
+  }
+}
+
+void Person::save_population_checkpoint(Checkpoint* checkpoint) {
+  checkpoint->put_people(Person::people);
+  checkpoint->put_people(Person::death_list);
+  checkpoint->put_people(Person::migrant_list);
+
+  for(int i = 0; i < Person::number_of_global_vars; ++i) {
+    checkpoint->put_double(Person::global_var[i]);
+  }
+  for(int i = 0; i < Person::number_of_global_list_vars; ++i) {
+    checkpoint->put_vector(Person::global_list_var[i]);
+  }
+
+  for(int p = 0; p < Person::pop_size; ++p) {
+    Person::people[p]->save_checkpoint(checkpoint);
+  }
+  for(int p = 0; p < Person::admin_agents.size(); ++p) {
+    Person::admin_agents[p]->save_checkpoint(checkpoint);
+  }
+  Person::Import_agent->save_checkpoint(checkpoint);
+
+  // reports on individual agents
+  checkpoint->put_people(Person::report_person);
+  checkpoint->put_int(Person::report_vec.size());
+  for(int i = 0; i < Person::report_vec.size(); ++i) {
+    report_t* report = Person::report_vec[i];
+    int rule_id = -1;
+    for(int r = 0; r < Rule::get_number_of_rules(); ++r) {
+      if(Rule::get_rule(r)->get_expression() == report->expression) {
+	rule_id = r;
+	break;
+      }
+    }
+    checkpoint->put_int(rule_id);
+    checkpoint->put_int(report->person_index);
+    checkpoint->put_person(report->person);
+    checkpoint->put_vector(report->change_day);
+    checkpoint->put_vector(report->value_on_day);
+  }
+}
+
+void Person::restore_population_checkpoint(Checkpoint* checkpoint) {
+  person_vector_t saved_people;
+  int size = checkpoint->get_int();
+  std::vector<bool> is_saved(Person::id_map.size(), false);
+  std::vector<int> saved_id;
+  saved_id.reserve(size);
+  for(int i = 0; i < size; ++i) {
+    int id = checkpoint->get_int();
+    if(id < 0 || id >= is_saved.size() || Person::id_map[id] < 0) {
+      checkpoint->mismatch("population does not match");
+    }
+    is_saved[id] = true;
+    saved_id.push_back(id);
+  }
+
+  // remove the people who left the population before the checkpoint
+  for(int id = 0; id < Person::id_map.size(); ++id) {
+    if(Person::id_map[id] >= 0 && is_saved[id] == false) {
+      Person* person = Person::get_person_with_id(id);
+      person->set_deceased();
+      Person::delete_person_from_population(Global::Simulation_Day, person);
+      checkpoint->add_removed_person(person);
+    }
+  }
+
+  // put the rest in the saved order
+  for(int i = 0; i < size; ++i) {
+    Person* person = Person::get_person_with_id(saved_id[i]);
+    saved_people.push_back(person);
+  }
+  Person::people = saved_people;
+  for(int i = 0; i < size; ++i) {
+    Person::people[i]->set_pop_index(i);
+    Person::id_map[saved_id[i]] = i;
+  }
+  Person::pop_size = size;
+
+  checkpoint->get_people(Person::death_list);
+  checkpoint->get_people(Person::migrant_list);
+
+  for(int i = 0; i < Person::number_of_global_vars; ++i) {
+    Person::global_var[i] = checkpoint->get_double();
+  }
+  for(int i = 0; i < Person::number_of_global_list_vars; ++i) {
+    checkpoint->get_vector(Person::global_list_var[i]);
+  }
+
+  // group memberships are rebuilt in the saved order when the groups are restored
+  for(int p = 0; p < Person::pop_size; ++p) {
+    Person::people[p]->end_all_links();
+  }
+  for(int p = 0; p < Person::admin_agents.size(); ++p) {
+    Person::admin_agents[p]->end_all_links();
+  }
+  Person::Import_agent->end_all_links();
+
+  for(int p = 0; p < Person::pop_size; ++p) {
+    Person::people[p]->restore_checkpoint(checkpoint);
+  }
+  for(int p = 0; p < Person::admin_agents.size(); ++p) {
+    Person::admin_agents[p]->restore_checkpoint(checkpoint);
+  }
+  Person::Import_agent->restore_checkpoint(checkpoint);
+
+  checkpoint->get_people(Person::report_person);
+  for(int i = 0; i < Person::report_vec.size(); ++i) {
+    delete Person::report_vec[i];
+  }
+  Person::report_vec.clear();
+  int reports = checkpoint->get_int();
+  for(int i = 0; i < reports; ++i) {
+    int rule_id = checkpoint->get_int();
+    if(rule_id < 0 || rule_id >= Rule::get_number_of_rules()) {
+      checkpoint->mismatch("report rule does not match");
+    }
+    report_t* report = new report_t;
+    report->expression = Rule::get_rule(rule_id)->get_expression();
+    report->person_index = checkpoint->get_int();
+    report->person = checkpoint->get_person();
+    report->person_id = report->person->get_id();
+    report->person->pin();
+    checkpoint->get_vector(report->change_day);
+    checkpoint->get_vector(report->value_on_day);
+    Person::report_vec.push_back(report);
+  }
+}
+
+void Person::save_checkpoint(Checkpoint* checkpoint) {
+  checkpoint->put_int(this->birthday_sim_day);
+  checkpoint->put_int(this->number_of_children);
+  checkpoint->put_int(this->household_relationship);
+  checkpoint->put_int(this->profile);
+  checkpoint->put_int(this->schedule_updated);
+  checkpoint->put_int(this->return_from_travel_sim_day);
+  checkpoint->put_int(this->sim_day_hospitalization_ends);
+  checkpoint->put_int(this->previous_infection_serotype);
+  checkpoint->put_int(this->insurance_type);
+  checkpoint->put_bool(this->alive);
+  checkpoint->put_bool(this->deceased);
+  checkpoint->put_bool(this->in_parents_home);
+  checkpoint->put_bool(this->eligible_to_migrate);
+  checkpoint->put_bool(this->native);
+  checkpoint->put_bool(this->original);
+  checkpoint->put_bool(this->vaccine_refusal);
+  checkpoint->put_bool(this->ineligible_for_vaccine);
+  checkpoint->put_bool(this->received_vaccine);
+  checkpoint->put_bool(this->is_traveling);
+  checkpoint->put_bool(this->is_traveling_outside);
+  checkpoint->put_bool(this->is_hospitalized);
+  checkpoint->put_string(this->on_schedule.to_string());
+  checkpoint->put_group(this->home_neighborhood);
+  checkpoint->put_group(this->last_school);
+  checkpoint->put_group(this->primary_healthcare_facility);
+
+  int group_types = Group_Type::get_number_of_group_types();
+  checkpoint->put_bool(this->stored_activity_groups != NULL);
+  if(this->stored_activity_groups != NULL) {
+    for(int i = 0; i < group_types; ++i) {
+      checkpoint->put_group(this->stored_activity_groups[i]);
+    }
+  }
+  if(is_meta_agent()) {
+    // memberships of other agents are saved with the groups
+    for(int i = 0; i < group_types; ++i) {
+      checkpoint->put_group(get_activity_group(i));
+    }
+  }
+  for(int i = 0; i < group_types; ++i) {
+    if(Group::is_a_network(i)) {
+      this->link[i].save_edges(checkpoint);
+    }
+  }
+
+  for(int condition_id = 0; condition_id < this->number_of_conditions; ++condition_id) {
+    condition_t* cond = &(this->condition[condition_id]);
+    checkpoint->put_int(cond->state);
+    checkpoint->put_int(cond->last_transition_step);
+    checkpoint->put_int(cond->next_transition_step);
+    checkpoint->put_double(cond->susceptibility);
+    checkpoint->put_double(cond->transmissibility);
+    checkpoint->put_int(cond->exposure_day);
+    checkpoint->put_person(cond->source);
+    checkpoint->put_group(cond->group);
+    checkpoint->put_int(cond->number_of_hosts);
+    int states = Condition::get_condition(condition_id)->get_number_of_states();
+    for(int s = 0; s < states; ++s) {
+      checkpoint->put_int(cond->entered[s]);
+    }
+    checkpoint->put_bool(cond->is_fatal);
+    checkpoint->put_bool(cond->sus_set);
+    checkpoint->put_bool(cond->trans_set);
+  }
+
+  for(int i = 0; i < Person::number_of_vars; ++i) {
+    checkpoint->put_double(this->var[i]);
+  }
+  for(int i = 0; i < Person::number_of_list_vars; ++i) {
+    checkpoint->put_vector(this->list_var[i]);
+  }
+}
+
+void Person::restore_checkpoint(Checkpoint* checkpoint) {
+  this->birthday_sim_day = checkpoint->get_int();
+  this->number_of_children = checkpoint->get_int();
+  this->household_relationship = checkpoint->get_int();
+  this->profile = checkpoint->get_int();
+  this->schedule_updated = checkpoint->get_int();
+  this->return_from_travel_sim_day = checkpoint->get_int();
+  this->sim_day_hospitalization_ends = checkpoint->get_int();
+  this->previous_infection_serotype = checkpoint->get_int();
+  this->insurance_type = Person::get_insurance_type_from_int(checkpoint->get_int());
+  this->alive = checkpoint->get_bool();
+  this->deceased = checkpoint->get_bool();
+  this->in_parents_home = checkpoint->get_bool();
+  this->eligible_to_migrate = checkpoint->get_bool();
+  this->native = checkpoint->get_bool();
+  this->original = checkpoint->get_bool();
+  this->vaccine_refusal = checkpoint->get_bool();
+  this->ineligible_for_vaccine = checkpoint->get_bool();
+  this->received_vaccine = checkpoint->get_bool();
+  this->is_traveling = checkpoint->get_bool();
+  this->is_traveling_outside = checkpoint->get_bool();
+  this->is_hospitalized = checkpoint->get_bool();
+  this->on_schedule = std::bitset<64>(checkpoint->get_string());
+  this->home_neighborhood = static_cast<Place*>(checkpoint->get_group());
+  this->last_school = static_cast<Place*>(checkpoint->get_group());
+  this->primary_healthcare_facility = static_cast<Hospital*>(checkpoint->get_group());
+
+  int group_types = Group_Type::get_number_of_group_types();
+  if(this->stored_activity_groups != NULL) {
+    delete[] this->stored_activity_groups;
+    this->stored_activity_groups = NULL;
+  }
+  if(checkpoint->get_bool()) {
+    this->stored_activity_groups = new Group* [group_types];
+    for(int i = 0; i < group_types; ++i) {
+      this->stored_activity_groups[i] = checkpoint->get_group();
+    }
+  }
+  if(is_meta_agent()) {
+    for(int i = 0; i < group_types; ++i) {
+      Group* group = checkpoint->get_group();
+      if(group != NULL) {
+	this->link[i].link(this, group);
+      }
+    }
+  }
+  for(int i = 0; i < group_types; ++i) {
+    if(Group::is_a_network(i)) {
+      this->link[i].restore_edges(checkpoint);
+    }
+  }
+
+  for(int condition_id = 0; condition_id < this->number_of_conditions; ++condition_id) {
+    condition_t* cond = &(this->condition[condition_id]);
+    cond->state = checkpoint->get_int();
+    cond->last_transition_step = checkpoint->get_int();
+    cond->next_transition_step = checkpoint->get_int();
+    cond->transition_event_handle = -1;
+    cond->susceptibility = checkpoint->get_double();
+    cond->transmissibility = checkpoint->get_double();
+    cond->exposure_day = checkpoint->get_int();
+    cond->source = checkpoint->get_person();
+    cond->group = checkpoint->get_group();
+    cond->number_of_hosts = checkpoint->get_int();
+    int states = Condition::get_condition(condition_id)->get_number_of_states();
+    for(int s = 0; s < states; ++s) {
+      cond->entered[s] = checkpoint->get_int();
+    }
+    cond->is_fatal = checkpoint->get_bool();
+    cond->sus_set = checkpoint->get_bool();
+    cond->trans_set = checkpoint->get_bool();
+  }
+  update_absent_groups();
+
+  for(int i = 0; i < Person::number_of_vars; ++i) {
+    double value = checkpoint->get_double();
+    update_var_aggregates(i, value);
+    this->var[i] = value;
+  }
+  for(int i = 0; i < Person::number_of_list_vars; ++i) {
+    checkpoint->get_vector(this->list_var[i]);
+  }
 }
 
 void Person::report(int day) {
@@ -1019,14 +1684,16 @@ void Person::report(int day) {
 
   // Write out the population if the output_population property is set.
   // Will write only on the first day of the simulation, on days
-  // matching the date pattern in the program file, and the on
+  // matching the date pattern in the program file, every
+  // output_population_interval days if that is set, and the on
   // the last day of the simulation
   if(Person::output_population > 0) {
     int month;
     int day_of_month;
     sscanf(Person::output_population_date_match,"%d-%d", &month, &day_of_month);
     if((day == 0)
-       || (month == Date::get_month() && day_of_month == Date::get_day_of_month())) {
+       || (month == Date::get_month() && day_of_month == Date::get_day_of_month())
+       || (Person::output_population_interval > 0 && day % Person::output_population_interval == 0)) {
       Person::write_population_output_file(day);
     }
   }
@@ -1144,29 +1811,20 @@ void Person::finish() {
   // simulation
   if(Person::output_population > 0) {
     Person::write_population_output_file(Global::Simulation_Days);
+    Population_Snapshot::close();
   }
 
   // write final reports
   if(Person::report_vec.size()>0) {
 
-    char dir[FRED_STRING_SIZE];
-    char outfile[FRED_STRING_SIZE];
-    FILE* fp;
-
-    sprintf(dir, "%s/RUN%d/DAILY",
-	    Global::Simulation_directory,
-	    Global::Simulation_run_number);
-    Utils::fred_make_directory(dir);
-
+    Daily_Report report;
+    char name[FRED_STRING_SIZE];
+    std::vector<double> values;
     for (int i = 0; i < Person::report_vec.size(); i++) {
       int person_index = Person::report_vec[i]->person_index;
       std::string expression_str = Person::report_vec[i]->expression->get_name();
-
-      sprintf(outfile, "%s/PERSON.Person%d_%s.txt", dir, person_index, expression_str.c_str());
-      fp = fopen(outfile, "w");
-      if (fp == NULL) {
-	Utils::fred_abort("Fred: can't open file %s\n", outfile);
-      }
+      sprintf(name, "PERSON.Person%d_%s", person_index, expression_str.c_str());
+      values.clear();
       for (int day = 0; day < Global::Simulation_Days; day++) {
 	double value = 0.0;
 	int vec_size = Person::report_vec[i]->value_on_day.size();
@@ -1178,60 +1836,24 @@ void Person::finish() {
 	    value = Person::report_vec[i]->value_on_day[j];
 	  }
 	}
-	fprintf(fp, "%d %f\n", day, value);
+	values.push_back(value);
       }
-      fclose(fp);
+      report.add_column(name, values);
     }
 
-    // create a csv file for PERSON
-
-    // this joins two files with same value in column 1, from
-    // https://stackoverflow.com/questions/14984340/using-awk-to-process-input-from-multiple-files
-    char awkcommand[FRED_STRING_SIZE];
-    sprintf(awkcommand, "awk 'FNR==NR{a[$1]=$2 FS $3;next}{print $0, a[$1]}' ");
-
-    char command[FRED_STRING_SIZE];
-    char dailyfile[FRED_STRING_SIZE];
-
-    sprintf(outfile, "%s/RUN%d/%s.csv", Global::Simulation_directory, Global::Simulation_run_number, "PERSON");
-
-    for (int i = 0; i < Person::report_vec.size(); i++) {
-      int person_index = Person::report_vec[i]->person_index;
-      std::string expression_str = Person::report_vec[i]->expression->get_name();
-      sprintf(dailyfile, "%s/PERSON.Person%d_%s.txt", dir, person_index, expression_str.c_str());
-      if (i==0) {
-	sprintf(command, "cp %s %s", dailyfile, outfile);
-      }
-      else {
-	sprintf(command, "%s %s %s > %s.tmp; mv %s.tmp %s",
-		awkcommand, dailyfile, outfile, outfile, outfile, outfile);
-      }
-      system(command);
-    }  
-
-    // create a header line for the csv file
-    char headerfile[FRED_STRING_SIZE];
-    sprintf(headerfile, "%s/RUN%d/%s.header", Global::Simulation_directory, Global::Simulation_run_number, "PERSON");
-    fp = fopen(headerfile, "w");
-    fprintf(fp, "Day ");
-    for (int i = 0; i < Person::report_vec.size(); i++) {
-      int person_index = Person::report_vec[i]->person_index;
-      std::string expression_str = Person::report_vec[i]->expression->get_name();
-      fprintf(fp, "PERSON.Person%d_%s ", person_index, expression_str.c_str()); 
+    if (Global::Enable_Daily_Text_Files) {
+      char dir[FRED_STRING_SIZE];
+      sprintf(dir, "%s/RUN%d/DAILY",
+	      Global::Simulation_directory,
+	      Global::Simulation_run_number);
+      Utils::fred_make_directory(dir);
+      report.write_daily_files(dir);
     }
-    fprintf(fp, "\n");
-    fclose(fp);
-
-    // concatenate header line
-    sprintf(command, "cat %s %s > %s.tmp; mv %s.tmp %s; unlink %s",
-	    headerfile, outfile, outfile, outfile, outfile, headerfile);
-    system(command);
-
-    // replace spaces with commas
-    sprintf(command, "sed -E 's/ +/,/g' %s | sed -E 's/,$//' | sed -E 's/,/ /' > %s.tmp; mv %s.tmp %s",
-	    outfile, outfile, outfile, outfile);
-    system(command);
 
+    // create a csv file for PERSON
+    char outfile[FRED_STRING_SIZE];
+    sprintf(outfile, "%s/RUN%d/%s.csv", Global::Simulation_directory, Global::Simulation_run_number, "PERSON");
+    report.write_csv(outfile, true);
   }
 }
 
@@ -1370,6 +1992,11 @@ Person* Person::select_random_person() {
 
 void Person::write_population_output_file(int day) {
 
+  if(Person::output_population_binary) {
+    Person::write_population_snapshot(day);
+    return;
+  }
+
   //Loop over the whole population and write the output of each Person's to_string to the file
   char population_output_file[FRED_STRING_SIZE];
   sprintf(population_output_file, "%s/%s_%s.txt", Global::Output_directory, Person::pop_outfile,
@@ -1387,6 +2014,76 @@ void Person::write_population_output_file(int day) {
   fclose(fp);
 }
 
+void Person::write_population_snapshot(int day) {
+
+  // the fields of to_string(), the state of each condition and the
+  // vars named in output_population_vars
+  static std::vector<int> snapshot_vars;
+  int number_of_conditions = Condition::get_number_of_conditions();
+  if(Population_Snapshot::is_open() == false) {
+    const char* fields[] = { "id", "age", "sex", "race", "household", "school", "classroom",
+			     "workplace", "office", "neighborhood", "hospital", "relationship" };
+    std::vector<string> names(fields, fields + 12);
+    std::vector<int> kinds(names.size(), Population_Snapshot::PLACE);
+    kinds[0] = kinds[1] = kinds[3] = kinds[11] = Population_Snapshot::INTEGER;
+    kinds[2] = Population_Snapshot::CHARACTER;
+    for(int c = 0; c < number_of_conditions; ++c) {
+      names.push_back(Condition::get_name(c));
+      kinds.push_back(Population_Snapshot::INTEGER);
+    }
+    snapshot_vars.clear();
+    if(strcmp(Person::output_population_vars, "none") != 0) {
+      string_vector_t var_names = Utils::get_string_vector(Person::output_population_vars, ' ');
+      for(int i = 0; i < var_names.size(); ++i) {
+	int var_id = Person::get_var_id(var_names[i]);
+	if(var_id < 0) {
+	  Utils::fred_abort("output_population_vars: unknown variable %s\n", var_names[i].c_str());
+	}
+	snapshot_vars.push_back(var_id);
+	names.push_back(var_names[i]);
+	kinds.push_back(Population_Snapshot::REAL);
+      }
+    }
+    char filename[FRED_STRING_SIZE];
+    sprintf(filename, "%s/RUN%d/%s.bin", Global::Simulation_directory, Global::Simulation_run_number,
+	    Person::pop_outfile);
+    if(Population_Snapshot::open(filename, names, kinds, Person::output_population_deltas) == false) {
+      Utils::fred_abort("Help! population_output_file %s not found\n", filename);
+    }
+  }
+
+  int people = Person::get_population_size();
+  int64_t* table = Population_Snapshot::start(day, Date::get_date_string(), people);
+  for(int p = 0; p < people; ++p) {
+    Person* person = get_person(p);
+    Place* places[] = { person->get_household(), person->get_school(), person->get_classroom(),
+			person->get_workplace(), person->get_office(), person->get_neighborhood(),
+			person->get_hospital() };
+    table[p] = person->get_id();
+    table[people + p] = person->get_age();
+    table[2 * people + p] = person->get_sex();
+    table[3 * people + p] = person->get_race();
+    for(int i = 0; i < 7; ++i) {
+      int place_id = -1;
+      if(places[i] != NULL) {
+	place_id = places[i]->get_id();
+	if(Population_Snapshot::has_label(place_id) == false) {
+	  Population_Snapshot::set_label(place_id, places[i]->get_label());
+	}
+      }
+      table[(4 + i) * people + p] = place_id;
+    }
+    table[11 * people + p] = person->get_household_relationship();
+    for(int c = 0; c < number_of_conditions; ++c) {
+      table[(12 + c) * people + p] = person->get_state(c);
+    }
+    for(int i = 0; i < snapshot_vars.size(); ++i) {
+      table[(12 + number_of_conditions + i) * people + p] = Population_Snapshot::from_real(person->var[snapshot_vars[i]]);
+    }
+  }
+  Population_Snapshot::finish();
+}
+
 void Person::get_age_distribution(int* count_males_by_age, int* count_females_by_age) {
   for(int i = 0; i <= Demographics::MAX_AGE; ++i) {
     count_males_by_age[i] = 0;
@@ -1518,26 +2215,12 @@ void Person::set_health_insurance(Person* p) {
 
 void Person::get_external_updates(int day) {
 
-  FILE* fp = NULL;
-  char filename [FRED_STRING_SIZE];
-
-  // create the API directory, if necessary
-  char dirname [FRED_STRING_SIZE];
-  sprintf(dirname, "%s/RUN%d/API", Global::Simulation_directory, Global::Simulation_run_number);
-  Utils::fred_make_directory(dirname);
-
+  // the people in a state that gets external updates
   person_vector_t updates;
-  updates.clear();
-
-  char requests_file[FRED_STRING_SIZE];
-  sprintf(requests_file, "%s/requests", dirname);
-  FILE* reqfp = fopen(requests_file, "w");
-
-  int requests = 0;
+  int number_of_conditions = Condition::get_number_of_conditions();
   for(int p = 0; p < Person::get_population_size(); ++p) {
     Person* person = get_person(p);
     bool update = false;
-    int number_of_conditions = Condition::get_number_of_conditions();
     for (int condition_id = 0; update==false && condition_id < number_of_conditions; condition_id++) {
       Condition* condition = Condition::get_condition(condition_id);
       if (condition->is_external_update_enabled()) {
@@ -1547,58 +2230,20 @@ void Person::get_external_updates(int day) {
     }
     if (update) {
       updates.push_back(person);
-      sprintf(filename, "%s/request.%d", dirname, person->get_id());
-      fp = fopen(filename, "w");
-      person->request_external_updates(fp, day);
-      fclose(fp);
-
-      // add filename to the list of requests
-      fprintf(reqfp, "request.%d\n", person->get_id());
-      requests++;
     }
   }
-  fclose(reqfp);
 
-  if (requests > 0) {
-    char command [FRED_STRING_SIZE];
-    sprintf(command, "%s/bin/FRED_API %s", getenv("FRED_HOME"), dirname);
-    system(command);
+  FRED_VERBOSE(1, "external updates day %d requests %d\n", day, (int) updates.size());
 
-    sprintf(filename, "%s/results_ready", dirname);
-    int tries = 0;
-    while (tries < 1000 && NULL == (fp = fopen(filename, "r"))) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
-      tries++;
-    }
-    if (fp != NULL) {
-      fclose(fp);
-      unlink(filename);
-      
-      for (int p = 0; p < updates.size(); p++) {
-	Person* person = updates[p];
-	sprintf(filename, "%s/results.%d", dirname, person->get_id());
-	fp = fopen(filename, "r");
-	person->get_external_updates(fp, day);
-	fclose(fp);
-	
-	// clean up files
-	// unlink(filename);
-	// sprintf(filename, "%s/request.%d", dirname, person->get_id());
-	// unlink(filename);
-      }
-    }
+  // pass them to the external model as one batch
+  fred_api_batch_t* batch = External_Update::get_batch(day, updates.size());
+  for (int p = 0; p < updates.size(); p++) {
+    updates[p]->request_external_updates(&batch->people[p]);
   }
-
-  sprintf(filename, "%s/log", dirname);
-  fp = NULL;
-  if (day == 0) {
-    fp = fopen(filename, "w");
+  External_Update::update(batch);
+  for (int p = 0; p < updates.size(); p++) {
+    updates[p]->get_external_updates(&batch->people[p]);
   }
-  else {
-    fp = fopen(filename, "a");
-  }
-  fprintf(fp, "day %d requests %d\n", day, requests);
-  fclose(fp);
 }
 
 void Person::set_admin_group(Group* group) {
@@ -1923,6 +2568,7 @@ void Person::start_reporting(Rule *rule) {
   Person::report_vec[n]->person_index = index;
   Person::report_vec[n]->person_id = this->id;
   Person::report_vec[n]->person = this;
+  this->pin();
   Person::report_vec[n]->expression = expression;
 }
 
@@ -1958,7 +2604,16 @@ void Person::setup_conditions() {
   this->number_of_conditions = Condition::get_number_of_conditions();
   // FRED_VERBOSE(0, "Person::setup person %d conditions %d\n", get_id(), this->number_of_conditions);
 
-  this->condition = new condition_t [this->number_of_conditions];
+  int* entered = NULL;
+  if (Person::storage_ready) {
+    this->condition = Person::condition_arena.allocate();
+    if (Person::entered_arena.get_row_size() > 0) {
+      entered = Person::entered_arena.allocate();
+    }
+  }
+  else {
+    this->condition = new condition_t [this->number_of_conditions];
+  }
 
   for(int condition_id = 0; condition_id < this->number_of_conditions; ++condition_id) {
     this->condition[condition_id].state = -1;
@@ -1966,13 +2621,19 @@ void Person::setup_conditions() {
     this->condition[condition_id].transmissibility = 0;
     this->condition[condition_id].last_transition_step = -1;
     this->condition[condition_id].next_transition_step = -1;
+    this->condition[condition_id].transition_event_handle = -1;
     this->condition[condition_id].exposure_day = -1;
     this->condition[condition_id].is_fatal = false;
     this->condition[condition_id].source = NULL;
     this->condition[condition_id].group = NULL;
     this->condition[condition_id].number_of_hosts = 0;
     int states = get_natural_history(condition_id)->get_number_of_states();
-    this->condition[condition_id].entered = new int [states];
+    if (entered != NULL) {
+      this->condition[condition_id].entered = entered + Person::entered_offset[condition_id];
+    }
+    else {
+      this->condition[condition_id].entered = new int [states];
+    }
     for (int i = 0; i < states; i++) {
       this->condition[condition_id].entered[i] = -1;
     }
@@ -1980,7 +2641,12 @@ void Person::setup_conditions() {
   this->previous_infection_serotype = -1;
   int number_of_vars = Person::get_number_of_vars();
   if (number_of_vars > 0) {
-    this->var = new double [number_of_vars];
+    if (Person::storage_ready) {
+      this->var = Person::var_arena.allocate();
+    }
+    else {
+      this->var = new double [number_of_vars];
+    }
     for (int i = 0; i < number_of_vars; i++) {
       this->var[i] = Person::var_init_value[i];
     }
@@ -1991,13 +2657,49 @@ void Person::setup_conditions() {
 
   int number_of_list_vars = Person::get_number_of_list_vars();
   if (number_of_list_vars > 0) {
-    this->list_var = new double_vector_t [number_of_list_vars];
-    for (int i = 0; i < number_of_list_vars; i++) {
-      this->list_var[i].clear();
+    if (Person::storage_ready) {
+      this->list_var = Person::list_var_arena.allocate();
+      for (int i = 0; i < number_of_list_vars; i++) {
+	new (&this->list_var[i]) double_vector_t;
+      }
+    }
+    else {
+      this->list_var = new double_vector_t [number_of_list_vars];
     }
   }
 }
 
+/*
+ * Return this person's rows to the arenas.  Only valid for people set
+ * up after Person::setup_storage().
+ */
+void Person::release_storage() {
+  if (this->condition != NULL) {
+    if (this->number_of_conditions > 0 && Person::entered_arena.get_row_size() > 0) {
+      Person::entered_arena.release(this->condition[0].entered);
+    }
+    Person::condition_arena.release(this->condition);
+    this->condition = NULL;
+  }
+  if (this->var != NULL) {
+    Person::var_arena.release(this->var);
+    this->var = NULL;
+  }
+  if (this->list_var != NULL) {
+    for (int i = 0; i < Person::number_of_list_vars; i++) {
+      this->list_var[i].~double_vector_t();
+    }
+    Person::list_var_arena.release(this->list_var);
+    this->list_var = NULL;
+  }
+  if (this->stored_activity_groups != NULL) {
+    delete[] this->stored_activity_groups;
+    this->stored_activity_groups = NULL;
+  }
+  delete[] this->link;
+  this->link = NULL;
+}
+
 void Person::initialize_conditions(int day) {
   for(int condition_id = 0; condition_id < this->number_of_conditions; ++condition_id) {
     Condition::get_condition(condition_id)->initialize_person(this, day);
@@ -2010,7 +2712,7 @@ void Person::become_exposed(int condition_id, Person* source, Group* group, int
 	       get_id(), condition_id, day, hour);
   
   if (Global::Enable_Records) {
-    fprintf(Global::Recordsfp,
+    Record_Log::print(
 	    "HEALTH RECORD: %s %s day %d person %d age %d is %s to %s%s%s",
 	    Date::get_date_string().c_str(),
 	    Date::get_12hr_clock(hour).c_str(),
@@ -2021,14 +2723,39 @@ void Person::become_exposed(int condition_id, Person* source, Group* group, int
 	    group == NULL ? "" : " at ",
 	    group == NULL ? "" : group->get_label());
     if (source == Person::get_import_agent()) {
-      fprintf(Global::Recordsfp, "\n");
+      Record_Log::print("\n");
+    }
+    else {
+      Record_Log::print(" from person %d age %d\n", source->get_id(), source->get_age());
+    }
+  }
+
+  if (Exposure_Trace::is_open()) {
+    Exposure_Trace::record_t record;
+    record.day = day;
+    record.hour = hour;
+    record.condition = condition_id;
+    record.host = get_id();
+    record.host_age = get_age();
+    if (source == NULL || source == Person::get_import_agent()) {
+      record.source = -1;
+      record.source_age = -1;
+      record.source_exposure_day = -1;
     }
     else {
-      fprintf(Global::Recordsfp, " from person %d age %d\n", source->get_id(), source->get_age());
+      record.source = source->get_id();
+      record.source_age = source->get_age();
+      record.source_exposure_day = source->get_exposure_day(condition_id);
     }
+    record.group_type = group == NULL ? -1 : group->get_type_id();
+    record.group = group == NULL ? -1 : group->get_index();
+    Exposure_Trace::add(record);
   }
 
   set_source(condition_id, source);
+  if (source != NULL) {
+    source->pin();
+  }
   set_group(condition_id, group);
   set_exposure_day(condition_id, day);
 
@@ -2062,7 +2789,7 @@ void Person::become_exposed(int condition_id, Person* source, Group* group, int
     }
 
     if (Global::Enable_Records) {
-      fprintf(Global::Recordsfp,
+      Record_Log::print(
 	      "HEALTH RECORD: %s %s day %d person %d GETS TRANSMITTED PLACE type %s label %s from person %d size = %d\n",
 	      Date::get_date_string().c_str(),
 	      Date::get_12hr_clock(hour).c_str(),
@@ -2088,7 +2815,7 @@ void Person::become_case_fatality(int condition_id, int day) {
 	       day, get_id());
 
   if (Global::Enable_Records) {
-    fprintf(Global::Recordsfp,
+    Record_Log::print(
 	    "HEALTH RECORD: %s %s day %d person %d age %d sex %c race %d income %d is CASE_FATALITY for %s.%s\n",
 	    Date::get_date_string().c_str(),
 	    Date::get_12hr_clock(Global::Simulation_Hour).c_str(),
@@ -2166,6 +2893,7 @@ void Person::terminate_conditions(int day) {
 
 void Person::set_state(int condition_id, int state, int day) {
   this->condition[condition_id].state = state;
+  update_absent_groups();
   int current_time = 24*Global::Simulation_Day + Global::Simulation_Hour;
   this->condition[condition_id].entered[state] = current_time;
   set_last_transition_step(condition_id, current_time);
@@ -2204,10 +2932,30 @@ void Person::set_var(int index, double value) {
   int number_of_vars = Person::get_number_of_vars();
   FRED_VERBOSE(0, "set_var person %d index %d number of vars %d\n", this->id, index, number_of_vars);
   if (index < number_of_vars) {
+    update_var_aggregates(index, value);
     this->var[index] = value;
   }
 }
 
+// tell the groups that aggregate this variable about the new value
+void Person::update_var_aggregates(int index, double value) {
+  if (Group_Type::is_aggregated_var(index) == false) {
+    return;
+  }
+  double old_value = this->var[index];
+  if (old_value == value) {
+    return;
+  }
+  for (int type_id = 0; type_id < Group_Type::get_number_of_group_types(); ++type_id) {
+    if (this->link[type_id].is_member()) {
+      int slot = Group_Type::get_group_type(type_id)->get_var_aggregate_slot(index);
+      if (0 <= slot) {
+	this->link[type_id].get_group()->update_var_aggregate(slot, old_value, value);
+      }
+    }
+  }
+}
+
 double Person::get_global_var(int index) {
   int number_of_vars = Person::get_number_of_global_vars();
   if (index < number_of_vars) {
@@ -2268,82 +3016,26 @@ void Person::push_back_global_list_var(int list_var_id, double value) {
   Person::global_list_var[list_var_id].push_back(value);
 }
 
-void Person::request_external_updates(FILE* fp, int day) {
-  fprintf(fp, "day = %d\n", day);
-  fprintf(fp, "person = %d\n", get_id());
-  fprintf(fp, "age = %d\n", get_age());
-  fprintf(fp, "race = %d\n", get_race());
-  fprintf(fp, "sex = %c\n", get_sex());
+void Person::request_external_updates(fred_api_person_t* request) {
+  request->id = get_id();
+  request->age = get_age();
+  request->race = get_race();
+  request->sex = get_sex();
   for (int condition_id = 0; condition_id < this->number_of_conditions; condition_id++) {
-    Condition* condition = Condition::get_condition(condition_id);
-    int state = get_state(condition_id);
-    fprintf(fp, "%s = %s\n",
-	   condition->get_name(),
-	   condition->get_state_name(state).c_str());
+    request->state[condition_id] = get_state(condition_id);
   }
   int number_of_vars = Person::get_number_of_vars();
   for (int i = 0; i < number_of_vars; i++) {
-    fprintf(fp, "%s = %f\n",
-	    Person::get_var_name(i).c_str(),
-	    this->var[i]);
-  }  
-  fflush(fp);
-}
-
-void Person::get_external_updates(FILE* fp, int day) {
-  int n;
-  int ival;
-  char cval;
-  double fval;
-  char vstr[FRED_STRING_SIZE];
-  char vstr2[FRED_STRING_SIZE];
-
-  fscanf(fp, "day = %d ", &ival);
-  if (ival!=day) {
-    printf("Error: day out of sync %d %d\n", day, ival);
-    assert(ival==day);
+    request->var[i] = this->var[i];
   }
+}
 
-  fscanf(fp, "person = %d ", &ival);
-  if (ival!=get_id()) {
-    printf("Error: id %d %d\n", get_id(), ival);
-    assert(ival==get_id());
-  }
-
-  fscanf(fp, "age = %d ", &ival);
-  if (ival!=get_age()) {
-    printf("Error: age %d %d\n", get_age(), ival);
-    assert(ival==get_age());
-  }
-
-  fscanf(fp, "race = %d ", &ival);
-  if (ival!=get_race()) {
-    printf("Error: race %d %d\n", get_race(), ival);
-    assert(ival==get_race());
-  }
-
-  fscanf(fp, "sex = %c ", &cval);
-  if (cval!=get_sex()) {
-    printf("Error: sex %c %c\n", get_sex(), cval);
-    assert(cval==get_sex());
-  }
-
-  for (int condition_id = 0; condition_id < this->number_of_conditions; condition_id++) {
-    Condition* condition = Condition::get_condition(condition_id);
-    int state = get_state(condition_id);
-
-    fscanf(fp, "%s = %s ", vstr, vstr2);
-    assert(strcmp(vstr,condition->get_name())==0);
-    assert(strcmp(vstr2,condition->get_state_name(state).c_str())==0);
-
-  }
+void Person::get_external_updates(fred_api_person_t* result) {
   int number_of_vars = Person::get_number_of_vars();
   for (int i = 0; i < number_of_vars; i++) {
-    fscanf(fp, "%s = %lf ", vstr, &fval);
-    sprintf(vstr2, "%s", Person::get_var_name(i).c_str());
-    assert(strcmp(vstr,vstr2)==0);
-    this->var[i] = fval;
-  }  
+    update_var_aggregates(i, result->var[i]);
+    this->var[i] = result->var[i];
+  }
 }
 
 Natural_History* Person::get_natural_history(int condition_id) const {
@@ -2521,10 +3213,10 @@ void Person::update_activities(int sim_day) {
   set_neighborhood(get_household()->get_patch()->get_neighborhood());
 
   // normally participate in household activities
-  this->on_schedule[Place_Type::get_type_id("Household")] = true;
+  this->on_schedule[Place_Type::HOUSEHOLD] = true;
 
   // non-built-in activities
-  for(int i = Place_Type::get_type_id("Hospital")+1; i < Group_Type::get_number_of_group_types(); ++i) {
+  for(int i = Place_Type::HOSPITAL+1; i < Group_Type::get_number_of_group_types(); ++i) {
     if(this->link[i].is_member()) {
       this->on_schedule[i] = 1;
     }
@@ -2535,13 +3227,13 @@ void Person::update_activities(int sim_day) {
 
   if(this->profile == Activity_Profile::PRISONER || this->profile == Activity_Profile::NURSING_HOME_RESIDENT) {
     // prisoners and nursing home residents stay indoors
-    this->on_schedule[Place_Type::get_type_id("Workplace")] = true;
-    this->on_schedule[Place_Type::get_type_id("Office")] = true;
+    this->on_schedule[Place_Type::WORKPLACE] = true;
+    this->on_schedule[Place_Type::OFFICE] = true;
     return;
   }
 
   // normally visit the neighborhood
-  this->on_schedule[Place_Type::get_type_id("Neighborhood")] = true;
+  this->on_schedule[Place_Type::NEIGHBORHOOD] = true;
 
   // decide which neighborhood to visit today
   if (is_transmissible()) {
@@ -2553,14 +3245,14 @@ void Person::update_activities(int sim_day) {
     set_neighborhood(get_household()->get_patch()->get_neighborhood());
   }
   // FRED_VERBOSE(0,"update_activities for person %d day %d nbhd %s\n",
-  // get_id(), sim_day, get_activity_group(Place_Type::get_type_id("Neighborhood"))->get_label());
+  // get_id(), sim_day, get_activity_group(Place_Type::NEIGHBORHOOD)->get_label());
 
   // attend school only on weekdays
   if(Person::is_weekday) {
     if(get_school() != NULL) {
-      this->on_schedule[Place_Type::get_type_id("School")] = true;
+      this->on_schedule[Place_Type::SCHOOL] = true;
       if(get_classroom() != NULL) {
-	this->on_schedule[Place_Type::get_type_id("Classroom")] = true;
+	this->on_schedule[Place_Type::CLASSROOM] = true;
       }
     }
   }
@@ -2568,9 +3260,9 @@ void Person::update_activities(int sim_day) {
   // normal worker work only on weekdays
   if(Person::is_weekday) {
     if(get_workplace() != NULL) {
-      this->on_schedule[Place_Type::get_type_id("Workplace")] = true;
+      this->on_schedule[Place_Type::WORKPLACE] = true;
       if(get_office() != NULL) {
-	this->on_schedule[Place_Type::get_type_id("Office")] = true;
+	this->on_schedule[Place_Type::OFFICE] = true;
       }
     }
   }
@@ -2578,9 +3270,9 @@ void Person::update_activities(int sim_day) {
     // students with jobs and weekend worker work on weekends
     if(this->profile == Activity_Profile::WEEKEND_WORKER || this->profile == Activity_Profile::STUDENT) {
       if(get_workplace() != NULL) {
-	this->on_schedule[Place_Type::get_type_id("Workplace")] = true;
+	this->on_schedule[Place_Type::WORKPLACE] = true;
 	if(get_office() != NULL) {
-	  this->on_schedule[Place_Type::get_type_id("Office")] = true;
+	  this->on_schedule[Place_Type::OFFICE] = true;
 	}
       }
     }
@@ -2691,19 +3383,19 @@ int Person::get_degree() {
   int degree;
   int n;
   degree = 0;
-  n = get_group_size(Place_Type::get_type_id("Neighborhood"));
+  n = get_group_size(Place_Type::NEIGHBORHOOD);
   if(n > 0) {
     degree += (n - 1);
   }
-  n = get_group_size(Place_Type::get_type_id("School"));
+  n = get_group_size(Place_Type::SCHOOL);
   if(n > 0) {
     degree += (n - 1);
   }
-  n = get_group_size(Place_Type::get_type_id("Workplace"));
+  n = get_group_size(Place_Type::WORKPLACE);
   if(n > 0) {
     degree += (n - 1);
   }
-  n = get_group_size(Place_Type::get_type_id("Hospital"));
+  n = get_group_size(Place_Type::HOSPITAL);
   if(n > 0) {
     degree += (n - 1);
   }
@@ -3235,6 +3927,23 @@ void Person::begin_membership_in_activity_group(int i) {
   }
 }
 
+// join the given group directly, even if it is not one of our activity groups
+void Person::begin_membership_in_group(Group* group) {
+  this->link[group->get_type_id()].begin_membership(this, group);
+}
+
+// leave every group, including those a meta agent is only linked to
+void Person::end_all_links() {
+  for(int i = 0; i < Group_Type::get_number_of_group_types(); ++i) {
+    if(this->link[i].is_member()) {
+      this->link[i].end_membership(this);
+    }
+    else {
+      this->link[i].unlink(this);
+    }
+  }
+}
+
 void Person::begin_membership_in_activity_groups() {
   for(int i = 0; i < Group_Type::get_number_of_group_types(); ++i) {
     begin_membership_in_activity_group(i);
@@ -3269,6 +3978,7 @@ void Person::restore_activity_groups() {
     set_activity_group(i, this->stored_activity_groups[i]);
   }
   delete[] this->stored_activity_groups;
+  this->stored_activity_groups = NULL;
 }
 
 int Person::get_activity_group_id(int p) {
@@ -3353,23 +4063,29 @@ bool Person::is_present(int sim_day, Group* group) {
     update_activities(sim_day);
   }
 
-  // see if this group is on the list
-  if (this->on_schedule[group->get_type_id()]) {
-    for (int cond_id = 0; cond_id < Condition::get_number_of_conditions(); cond_id++) {
-      int state = get_state(cond_id);
-      if (Condition::get_condition(cond_id)->is_absent(state, type_id)) {
-	// printf("absent due to condition %d\n", cond_id);
-	return false;
-      }
-    }
-    // printf("is on schedule\n");
-    return true;
+  // see if this group is on the list and not avoided due to a condition
+  return this->on_schedule[type_id] && this->absent_groups[type_id] == false;
+}
+
+/**
+ * The group types this person attends today: the day's schedule less
+ * those avoided due to the person's condition states.
+ */
+std::bitset<64> Person::get_presence(int sim_day) {
+  if (this->is_meta_agent() || this->is_traveling_outside) {
+    return std::bitset<64>();
   }
-  else {
-    // printf("not on schedule\n");
-    return false;
+  if(sim_day > this->schedule_updated) {
+    update_activities(sim_day);
   }
+  return this->on_schedule & ~this->absent_groups;
+}
 
+void Person::update_absent_groups() {
+  this->absent_groups.reset();
+  for (int cond_id = 0; cond_id < this->number_of_conditions; cond_id++) {
+    this->absent_groups |= Condition::get_condition(cond_id)->get_absent_groups(this->condition[cond_id].state);
+  }
 }
 
 void Person::join_network(Network* network) {
@@ -3385,6 +4101,21 @@ void Person::join_network(Network* network) {
 void Person::quit_network(Network* network) {
   FRED_VERBOSE(1, "UNENROLL NETWORK: id = %d\n", get_id());
   int network_type_id = network->get_type_id();
+  if (network->has_compact_edges()) {
+    // remove edges to and from other people
+    Adjacency* outward = network->get_outward_adjacency();
+    Adjacency* inward = network->get_inward_adjacency();
+    int size = outward->get_degree(this->id);
+    for (int k = 0; k < size; k++) {
+      inward->delete_edge(outward->get_neighbor(this->id, k), this->id);
+    }
+    size = inward->get_degree(this->id);
+    for (int k = 0; k < size; k++) {
+      outward->delete_edge(inward->get_neighbor(this->id, k), this->id);
+    }
+    outward->clear(this->id);
+    inward->clear(this->id);
+  }
   this->link[network_type_id].remove_from_network(this);
 }
 
@@ -3397,7 +4128,12 @@ void Person::add_edge_to(Person* other, Network* network) {
   int n = network->get_type_id();
   if (0 <= n) {
     join_network(network);
-    this->link[n].add_edge_to(other);
+    if (network->has_compact_edges()) {
+      network->get_outward_adjacency()->add_edge(this->id, other->get_id(), 1.0, Global::Simulation_Step);
+    }
+    else {
+      this->link[n].add_edge_to(other);
+    }
   }
 }
 
@@ -3408,7 +4144,12 @@ void Person::add_edge_from(Person* other, Network* network) {
   int n = network->get_type_id();
   if (0 <= n) {
     join_network(network);
-    this->link[n].add_edge_from(other);
+    if (network->has_compact_edges()) {
+      network->get_inward_adjacency()->add_edge(this->id, other->get_id(), 1.0, Global::Simulation_Step);
+    }
+    else {
+      this->link[n].add_edge_from(other);
+    }
   }
 }
 
@@ -3417,7 +4158,10 @@ void Person::delete_edge_to(Person* person, Network* network) {
     return;
   }
   int n = network->get_type_id();
-  if (0 <= n) {
+  if (network->has_compact_edges()) {
+    network->get_outward_adjacency()->delete_edge(this->id, person->get_id());
+  }
+  else if (0 <= n) {
     this->link[n].delete_edge_to(person);
   }
 }
@@ -3427,7 +4171,10 @@ void Person::delete_edge_from(Person* person, Network* network) {
     return;
   }
   int n = network->get_type_id();
-  if (0 <= n) {
+  if (network->has_compact_edges()) {
+    network->get_inward_adjacency()->delete_edge(this->id, person->get_id());
+  }
+  else if (0 <= n) {
     this->link[n].delete_edge_from(person);
   }
 }
@@ -3439,6 +4186,9 @@ bool Person::is_member_of_network(Network* network) {
 
 bool Person::is_connected_to(Person* person, Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_outward_adjacency()->find(this->id, person->get_id()) >= 0;
+  }
   if (0 <= n) {
     return this->link[n].is_connected_to(person);
   }
@@ -3448,6 +4198,9 @@ bool Person::is_connected_to(Person* person, Network* network) {
 
 bool Person::is_connected_from(Person* person, Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_inward_adjacency()->find(this->id, person->get_id()) >= 0;
+  }
   if (0 <= n) {
     return this->link[n].is_connected_from(person);
   }
@@ -3456,6 +4209,9 @@ bool Person::is_connected_from(Person* person, Network* network) {
 
 int Person::get_id_of_max_weight_inward_edge_in_network(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_inward_adjacency()->get_neighbor_with_max_weight(this->id);
+  }
   if (0 <= n) {
     return this->link[n].get_id_of_max_weight_inward_edge();
   }
@@ -3466,6 +4222,9 @@ int Person::get_id_of_max_weight_inward_edge_in_network(Network* network) {
 
 int Person::get_id_of_max_weight_outward_edge_in_network(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_outward_adjacency()->get_neighbor_with_max_weight(this->id);
+  }
   if (0 <= n) {
     return this->link[n].get_id_of_max_weight_outward_edge();
   }
@@ -3476,6 +4235,9 @@ int Person::get_id_of_max_weight_outward_edge_in_network(Network* network) {
 
 int Person::get_id_of_min_weight_inward_edge_in_network(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_inward_adjacency()->get_neighbor_with_min_weight(this->id);
+  }
   if (0 <= n) {
     return this->link[n].get_id_of_min_weight_inward_edge();
   }
@@ -3486,6 +4248,9 @@ int Person::get_id_of_min_weight_inward_edge_in_network(Network* network) {
 
 int Person::get_id_of_min_weight_outward_edge_in_network(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_outward_adjacency()->get_neighbor_with_min_weight(this->id);
+  }
   if (0 <= n) {
     return this->link[n].get_id_of_min_weight_outward_edge();
   }
@@ -3496,6 +4261,9 @@ int Person::get_id_of_min_weight_outward_edge_in_network(Network* network) {
 
 int Person::get_id_of_last_inward_edge_in_network(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_inward_adjacency()->get_last_neighbor(this->id);
+  }
   if (0 <= n) {
     return this->link[n].get_id_of_last_inward_edge();
   }
@@ -3506,6 +4274,9 @@ int Person::get_id_of_last_inward_edge_in_network(Network* network) {
 
 int Person::get_id_of_last_outward_edge_in_network(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_outward_adjacency()->get_last_neighbor(this->id);
+  }
   if (0 <= n) {
     return this->link[n].get_id_of_last_outward_edge();
   }
@@ -3517,6 +4288,11 @@ int Person::get_id_of_last_outward_edge_in_network(Network* network) {
 
 double Person::get_weight_to(Person* person, Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    Adjacency* adjacency = network->get_outward_adjacency();
+    int k = adjacency->find(this->id, person->get_id());
+    return (k < 0) ? 0.0 : adjacency->get_weight_at(this->id, k);
+  }
   if (0 <= n) {
     return this->link[n].get_weight_to(person);
   }
@@ -3525,20 +4301,31 @@ double Person::get_weight_to(Person* person, Network* network) {
 
 void Person::set_weight_to(Person* person, Network* network, double value) {
   int n = network->get_type_id();
-  if (0 <= n) {
+  if (network->has_compact_edges()) {
+    network->get_outward_adjacency()->set_weight(this->id, person->get_id(), value);
+  }
+  else if (0 <= n) {
     this->link[n].set_weight_to(person, value);
   }
 }
 
 void Person::set_weight_from(Person* person, Network* network, double value) {
   int n = network->get_type_id();
-  if (0 <= n) {
+  if (network->has_compact_edges()) {
+    network->get_inward_adjacency()->set_weight(this->id, person->get_id(), value);
+  }
+  else if (0 <= n) {
     this->link[n].set_weight_from(person, value);
   }
 }
 
 double Person::get_weight_from(Person* person, Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    Adjacency* adjacency = network->get_inward_adjacency();
+    int k = adjacency->find(this->id, person->get_id());
+    return (k < 0) ? 0.0 : adjacency->get_weight_at(this->id, k);
+  }
   if (0 <= n) {
     return this->link[n].get_weight_from(person);
   }
@@ -3547,6 +4334,11 @@ double Person::get_weight_from(Person* person, Network* network) {
 
 double Person::get_timestamp_to(Person* person, Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    Adjacency* adjacency = network->get_outward_adjacency();
+    int k = adjacency->find(this->id, person->get_id());
+    return (k < 0) ? -1 : adjacency->get_timestamp_at(this->id, k);
+  }
   if (0 <= n) {
     return this->link[n].get_timestamp_to(person);
   }
@@ -3555,6 +4347,11 @@ double Person::get_timestamp_to(Person* person, Network* network) {
 
 double Person::get_timestamp_from(Person* person, Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    Adjacency* adjacency = network->get_inward_adjacency();
+    int k = adjacency->find(this->id, person->get_id());
+    return (k < 0) ? -1 : adjacency->get_timestamp_at(this->id, k);
+  }
   if (0 <= n) {
     return this->link[n].get_timestamp_from(person);
   }
@@ -3563,6 +4360,9 @@ double Person::get_timestamp_from(Person* person, Network* network) {
 
 int Person::get_out_degree(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_outward_adjacency()->get_degree(this->id);
+  }
   if (0 <= n) {
     return this->link[n].get_out_degree();
   }
@@ -3573,6 +4373,9 @@ int Person::get_out_degree(Network* network) {
 
 int Person::get_in_degree(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return network->get_inward_adjacency()->get_degree(this->id);
+  }
   if (0 <= n) {
     return this->link[n].get_in_degree();
   }
@@ -3584,6 +4387,14 @@ int Person::get_in_degree(Network* network) {
 
 int Person::get_degree(Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    if (network->is_undirected()) {
+      return get_in_degree(network);
+    }
+    else {
+      return get_in_degree(network) + get_out_degree(network);
+    }
+  }
   if (0 <= n) {
     if (network->is_undirected()) {
       return this->link[n].get_in_degree();
@@ -3601,7 +4412,11 @@ int Person::get_degree(Network* network) {
 
 void Person::clear_network(Network* network) {
   int n = network->get_type_id();
-  if (0 <= n) {
+  if (network->has_compact_edges()) {
+    network->get_outward_adjacency()->clear(this->id);
+    network->get_inward_adjacency()->clear(this->id);
+  }
+  else if (0 <= n) {
     this->link[n].clear();
   }
 }
@@ -3618,7 +4433,17 @@ person_vector_t Person::get_outward_edges(Network* network, int max_dist) {
   }
   int n = network->get_type_id();
   if (1 <= max_dist) {
-    person_vector_t tmp = this->link[n].get_outward_edges();
+    person_vector_t tmp;
+    if (network->has_compact_edges()) {
+      Adjacency* adjacency = network->get_outward_adjacency();
+      int size = adjacency->get_degree(this->id);
+      for (int k = 0; k < size; k++) {
+	tmp.push_back(Person::get_person_with_id(adjacency->get_neighbor(this->id, k)));
+      }
+    }
+    else {
+      tmp = this->link[n].get_outward_edges();
+    }
     for (int k = 0; k < tmp.size(); k++) {
       if (tmp[k] != this && found.insert(tmp[k]->get_id()).second) {
 	results.push_back(tmp[k]);
@@ -3669,7 +4494,17 @@ person_vector_t Person::get_inward_edges(Network* network, int max_dist) {
   }
   int n = network->get_type_id();
   if (1 <= max_dist) {
-    person_vector_t tmp = this->link[n].get_inward_edges();
+    person_vector_t tmp;
+    if (network->has_compact_edges()) {
+      Adjacency* adjacency = network->get_inward_adjacency();
+      int size = adjacency->get_degree(this->id);
+      for (int k = 0; k < size; k++) {
+	tmp.push_back(Person::get_person_with_id(adjacency->get_neighbor(this->id, k)));
+      }
+    }
+    else {
+      tmp = this->link[n].get_inward_edges();
+    }
     for (int k = 0; k < tmp.size(); k++) {
       if (tmp[k] != this && found.insert(tmp[k]->get_id()).second) {
 	results.push_back(tmp[k]);
@@ -3710,6 +4545,9 @@ person_vector_t Person::get_inward_edges(Network* network, int max_dist) {
 
 Person* Person::get_outward_edge(int k, Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return Person::get_person_with_id(network->get_outward_adjacency()->get_neighbor(this->id, k));
+  }
   if (0 <= n) {
     return this->link[n].get_outward_edge(k);
   }
@@ -3720,6 +4558,9 @@ Person* Person::get_outward_edge(int k, Network* network) {
 
 Person* Person::get_inward_edge(int k, Network* network) {
   int n = network->get_type_id();
+  if (network->has_compact_edges()) {
+    return Person::get_person_with_id(network->get_inward_adjacency()->get_neighbor(this->id, k));
+  }
   if (0 <= n) {
     return this->link[n].get_inward_edge(k);
   }
@@ -3733,7 +4574,7 @@ Person* Person::get_inward_edge(int k, Network* network) {
  * @return a pointer to this agent's Household
  */
 Household* Person::get_household() {
-  int i = Place_Type::get_type_id("Household");
+  int i = Place_Type::HOUSEHOLD;
   Group* group = this->link[i].get_group();
   group = get_activity_group(i);
   Household* hh = static_cast<Household*>(group);
@@ -3741,7 +4582,7 @@ Household* Person::get_household() {
 }
 
 Household* Person::get_stored_household() {
-  return static_cast<Household*>(this->stored_activity_groups[Place_Type::get_type_id("Household")]);
+  return static_cast<Household*>(this->stored_activity_groups[Place_Type::HOUSEHOLD]);
 }
 
 
@@ -3749,7 +4590,7 @@ Household* Person::get_stored_household() {
  * @return a pointer to this agent's Hospital
  */
 Hospital* Person::get_hospital() {
-  return static_cast<Hospital*>( get_activity_group(Place_Type::get_type_id("Hospital")));
+  return static_cast<Hospital*>( get_activity_group(Place_Type::HOSPITAL));
 }
 
 void Person::set_last_school(Place* school) {
@@ -3932,11 +4773,9 @@ void Person::run_action_rules(int condition_id, int state, rule_vector_t rules)
 	double value = expr2->get_value(this);
 	Condition::get_condition(rule->get_source_cond_id())->set_transmissibility(value);
 	if (Global::Enable_Records && Global::Enable_Var_Records && old_value!=value) {
-	  char tmp[FRED_STRING_SIZE];
-	  get_record_string(tmp);
-	  fprintf(Global::Recordsfp,
-		  "%s state %s.%s changes %s.transmissibility from %f to %f\n",
-		  tmp,
+	  print_record_string();
+	  Record_Log::print(
+		  " state %s.%s changes %s.transmissibility from %f to %f\n",
 		  get_natural_history(condition_id)->get_name(),
 		  get_natural_history(condition_id)->get_state_name(state).c_str(),
 		  Condition::get_condition(rule->get_source_cond_id())->get_name(),
@@ -4100,11 +4939,9 @@ void Person::run_action_rules(int condition_id, int state, rule_vector_t rules)
 	value = rule->get_value(this, other);
 	if (global) {
 	  if (Global::Enable_Records && Global::Enable_Var_Records && Person::global_var[var_id]!=value) {
-	    char tmp[FRED_STRING_SIZE];
-	    get_record_string(tmp);
-	    fprintf(Global::Recordsfp,
-		    "%s state %s.%s changes %s from %f to %f\n",
-		    tmp,
+	    print_record_string();
+	    Record_Log::print(
+		    " state %s.%s changes %s from %f to %f\n",
 		    get_natural_history(condition_id)->get_name(),
 		    get_natural_history(condition_id)->get_state_name(state).c_str(),
 		    Person::get_global_var_name(var_id).c_str(),
@@ -4116,26 +4953,23 @@ void Person::run_action_rules(int condition_id, int state, rule_vector_t rules)
 	else {
 	  if (other==NULL) {
 	    if (Global::Enable_Records && Global::Enable_Var_Records && this->var[var_id]!=value) {
-	      char tmp[FRED_STRING_SIZE];
-	      get_record_string(tmp);
-	      fprintf(Global::Recordsfp,
-		      "%s state %s.%s changes %s from %f to %f\n",
-		      tmp,
+	      print_record_string();
+	      Record_Log::print(
+		      " state %s.%s changes %s from %f to %f\n",
 		      get_natural_history(condition_id)->get_name(),
 		      get_natural_history(condition_id)->get_state_name(state).c_str(),
 		      Person::get_var_name(var_id).c_str(),
 		      this->var[var_id],
 		      value);
 	    }
+	    update_var_aggregates(var_id, value);
 	    this->var[var_id] = value;
 	  }
 	  else {
 	    if (Global::Enable_Records && Global::Enable_Var_Records && other->get_var(var_id)!=value) {
-	      char tmp[FRED_STRING_SIZE];
-	      get_record_string(tmp);
-	      fprintf(Global::Recordsfp,
-		      "%s state %s.%s changes other %d age %d var %s from %f to %f\n",
-		      tmp,
+	      print_record_string();
+	      Record_Log::print(
+		      " state %s.%s changes other %d age %d var %s from %f to %f\n",
 		      get_natural_history(condition_id)->get_name(),
 		      get_natural_history(condition_id)->get_state_name(state).c_str(),
 		      other->get_id(), other->get_age(),
@@ -4196,7 +5030,7 @@ void Person::run_action_rules(int condition_id, int state, rule_vector_t rules)
 	  int day = Global::Simulation_Day;
 	  int hour = Global::Simulation_Hour;
 	  if (1 && Global::Enable_Records) {
-	    fprintf(Global::Recordsfp,
+	    Record_Log::print(
 		    "HEALTH RECORD: %s %s day %d person %d ENTERING state %s.%s MODIFIES state %s.%s to %s.%s\n",
 		    Date::get_date_string().c_str(),
 		    Date::get_12hr_clock(hour).c_str(),
@@ -4208,7 +5042,6 @@ void Person::run_action_rules(int condition_id, int state, rule_vector_t rules)
 		    rule->get_source_state().c_str(),
 		    rule->get_source_cond().c_str(),
 		    rule->get_dest_state().c_str());
-	    fflush(Global::Recordsfp);
 	  }
 	  Condition::get_condition(source_cond_id)->get_epidemic()->update_state(this, day, hour, dest_state_id, 0);
 	}
@@ -4287,9 +5120,9 @@ void Person::run_action_rules(int condition_id, int state, rule_vector_t rules)
   }
 }
 
-void Person::get_record_string(char* result) {
+void Person::print_record_string() {
   if (Person::record_location) {
-    sprintf(result,"HEALTH RECORD: %s %s day %d person %d age %d sex %c race %d latitude %f longitude %f income %d",
+    Record_Log::print("HEALTH RECORD: %s %s day %d person %d age %d sex %c race %d latitude %f longitude %f income %d",
 	    Date::get_date_string().c_str(),
 	    Date::get_12hr_clock(Global::Simulation_Hour).c_str(),
 	    Global::Simulation_Day,
@@ -4302,7 +5135,7 @@ void Person::get_record_string(char* result) {
 	    get_household()? get_income() : 0 );
   }
   else {
-    sprintf(result,"HEALTH RECORD: %s %s day %d person %d age %d sex %c race %d household %s school %s income %d",
+    Record_Log::print("HEALTH RECORD: %s %s day %d person %d age %d sex %c race %d household %s school %s income %d",
 	    Date::get_date_string().c_str(),
 	    Date::get_12hr_clock(Global::Simulation_Hour).c_str(),
 	    Global::Simulation_Day,
@@ -33,8 +33,10 @@
 
 using namespace std;
 
+#include "Arena.h"
 #include "Date.h"
 #include "Demographics.h"
+#include "Fred_API.h"
 #include "Global.h"
 #include "Link.h"
 #include "Network_Type.h"
@@ -44,6 +46,7 @@ using namespace std;
 #include "Utils.h"
 
 class Activities_Tracking_Data;
+class Checkpoint;
 class Condition;
 class Expression;
 class Factor;
@@ -55,8 +58,27 @@ class Natural_History;
 class Network;
 class Place;
 class Population;
+class Population_Cache;
+class People_File_Reader;
 class Preference;
 
+// one line of people.txt or gq_people.txt; the labels point into the file
+typedef struct {
+  char* label;
+  char* house_label;		// the group quarters id for gq_people.txt
+  char* school_label;
+  char* work_label;
+  int age;
+  int race;
+  int household_relationship;
+  char sex;
+  bool gq;
+  bool too_old;			// names a school but is too old to attend
+  Place* house;
+  Place* school;
+  Place* work;
+} person_data_t;
+
 typedef struct {
   int person_index;
   int person_id;
@@ -71,6 +93,7 @@ typedef struct {
   int state;
   int last_transition_step;
   int next_transition_step;
+  int transition_event_handle;  // position in the epidemic's event queue
 
   // transmission info
   double susceptibility;
@@ -193,6 +216,7 @@ public:
 	     bool today_is_birthday);
   void print(FILE* fp, int condition_id);
   bool is_present(int sim_day, Group* group);
+  std::bitset<64> get_presence(int sim_day);
   std::string to_string();
   int get_id() const {
     return this->id;
@@ -288,6 +312,18 @@ public:
   void set_deceased() {
     this->deceased = true;
   }
+
+  /**
+   * A pinned person is still referenced by other agents or groups
+   * after death (as a transmission source, a host or a reporting
+   * agent), so its storage is never handed to a new person.
+   */
+  void pin() {
+    this->pinned = true;
+  }
+  bool is_pinned() {
+    return this->pinned;
+  }
   void set_household_relationship(int rel) {
     this->household_relationship = rel;
   }
@@ -370,6 +406,8 @@ public:
   void begin_membership_in_activity_groups();
   void end_membership_in_activity_group(int i);
   void end_membership_in_activity_groups();
+  void begin_membership_in_group(Group* group);
+  void end_all_links();
   void store_activity_groups();
   void restore_activity_groups();
   int get_activity_group_id(int i);
@@ -386,29 +424,29 @@ public:
     }
   }
   void set_household(Place* p) {
-    set_activity_group(Group_Type::get_type_id("Household"), p);
+    set_activity_group(Place_Type::HOUSEHOLD, p);
   }
   void set_neighborhood(Place* p) {
-    set_activity_group(Group_Type::get_type_id("Neighborhood"), p);
+    set_activity_group(Place_Type::NEIGHBORHOOD, p);
   }
   void set_school(Place* p) {
-    set_activity_group(Group_Type::get_type_id("School"), p);
+    set_activity_group(Place_Type::SCHOOL, p);
     if (p != NULL) {
       set_last_school(p);
     }
   }
   void set_last_school(Place* school);
   void set_classroom(Place* p) {
-    set_activity_group(Group_Type::get_type_id("Classroom"), p);
+    set_activity_group(Place_Type::CLASSROOM, p);
   }
   void set_workplace(Place* p) {
-    set_activity_group(Group_Type::get_type_id("Workplace"), p);
+    set_activity_group(Place_Type::WORKPLACE, p);
   }
   void set_office(Place* p) {
-    set_activity_group(Group_Type::get_type_id("Office"), p);
+    set_activity_group(Place_Type::OFFICE, p);
   }
   void set_hospital(Place* p) {
-    set_activity_group(Group_Type::get_type_id("Hospital"), p);
+    set_activity_group(Place_Type::HOSPITAL, p);
   }
   void terminate_activities();
 
@@ -426,41 +464,41 @@ public:
   void assign_workplace();
   void assign_office();
   Place* get_neighborhood() {
-    return static_cast<Place*>(get_activity_group(Place_Type::get_type_id("Neighborhood")));
+    return static_cast<Place*>(get_activity_group(Place_Type::NEIGHBORHOOD));
   }
   Household* get_household();
   Place* get_school() {
-    return static_cast<Place*>(get_activity_group(Place_Type::get_type_id("School")));
+    return static_cast<Place*>(get_activity_group(Place_Type::SCHOOL));
   }
   Place* get_classroom() {
-    return static_cast<Place*>(get_activity_group(Place_Type::get_type_id("Classroom")));
+    return static_cast<Place*>(get_activity_group(Place_Type::CLASSROOM));
   }
   Place* get_workplace() {
-    return static_cast<Place*>(get_activity_group(Place_Type::get_type_id("Workplace")));
+    return static_cast<Place*>(get_activity_group(Place_Type::WORKPLACE));
   }
   Place* get_office() {
-    return static_cast<Place*>(get_activity_group(Place_Type::get_type_id("Office")));
+    return static_cast<Place*>(get_activity_group(Place_Type::OFFICE));
   }
   int get_household_size() {
-    return get_place_size(Place_Type::get_type_id("Household"));
+    return get_place_size(Place_Type::HOUSEHOLD);
   }
   int get_neighborhood_size() {
-    return get_place_size(Place_Type::get_type_id("Neighborhood"));
+    return get_place_size(Place_Type::NEIGHBORHOOD);
   }
   int get_school_size() {
-    return get_place_size(Place_Type::get_type_id("School"));
+    return get_place_size(Place_Type::SCHOOL);
   }
   int get_classroom_size() {
-    return get_place_size(Place_Type::get_type_id("Classroom"));
+    return get_place_size(Place_Type::CLASSROOM);
   }
   int get_workplace_size() {
-    return get_place_size(Place_Type::get_type_id("Workplace"));
+    return get_place_size(Place_Type::WORKPLACE);
   }
   int get_office_size() {
-    return get_place_size(Place_Type::get_type_id("Office"));
+    return get_place_size(Place_Type::OFFICE);
   }
   int get_hospital_size() {
-    return get_place_size(Place_Type::get_type_id("Hospital"));
+    return get_place_size(Place_Type::HOSPITAL);
   }
   int get_place_elevation(int type);
   int get_place_income(int type);
@@ -604,6 +642,7 @@ public:
   // VARIABLES
   double get_var(int index);
   void set_var(int index, double value);
+  void update_var_aggregates(int index, double value);
   double_vector_t get_list_var(int index);
   int get_list_size(int list_var_id);
 
@@ -713,6 +752,7 @@ public:
 
   // CONDITIONS
   void setup_conditions();
+  void release_storage();
   Natural_History* get_natural_history (int condition_id) const;
   void initialize_conditions(int day);
   void update_condition(int day, int condition_id);
@@ -722,6 +762,7 @@ public:
   void update_group_counts(int day, int condition_id, Group* group);
   void terminate_conditions(int day);
   void set_state(int condition_id, int state, int step);
+  void update_absent_groups();
   int get_state(int condition_id) const {
     return this->condition[condition_id].state;
   }
@@ -740,6 +781,9 @@ public:
   int get_next_transition_step(int condition_id) const {
     return this->condition[condition_id].next_transition_step;
   }
+  int* get_transition_event_handle(int condition_id) {
+    return &(this->condition[condition_id].transition_event_handle);
+  }
   void set_exposure_day(int condition_id, int day) {
     this->condition[condition_id].exposure_day = day;
   }
@@ -815,8 +859,8 @@ public:
     return (day - 24*get_last_transition_step(condition_id));
   }
   int get_new_health_state(int condition_id);
-  void request_external_updates(FILE* fp, int day);
-  void get_external_updates(FILE* fp, int day);
+  void request_external_updates(fred_api_person_t* request);
+  void get_external_updates(fred_api_person_t* result);
   bool was_ever_in_state(int condition_id, int state) {
     return this->condition[condition_id].entered[state] > -1;
   }
@@ -850,7 +894,8 @@ public:
   Group* get_admin_group();
   bool has_closure();
 
-  void get_record_string(char* result);
+  // start a health record for this person
+  void print_record_string();
 
   //// STATIC METHODS
 
@@ -861,8 +906,14 @@ public:
   static void initialize_static_activity_variables();
   static void setup();
   static void read_all_populations();
-  static void read_population(const char* pop_dir, const char* pop_type );
+  static void read_population(const char* pop_dir, const char* pop_type, People_File_Reader & reader);
   static void get_person_data(char* line, bool gq);
+  static bool parse_person_line(char* line, bool gq, person_data_t* data);
+  static void find_person_places(person_data_t* data);
+  static void add_person_from_data(person_data_t & data);
+  static void get_person_labels(person_data_t* data, char* house_label, char* school_label, char* work_label);
+  static bool has_school_label(person_data_t* data);
+  static bool has_work_label(person_data_t* data);
   static Person* add_person_to_population(int age, char sex, int race, int rel, Place* house,
 					  Place* school, Place* work, int day, bool today_is_birthday);
   static int get_population_size() {
@@ -912,9 +963,23 @@ public:
   static Person* select_random_person();
   static void prepare_to_die(int day, Person* person);
   static void remove_dead_from_population(int day);
+  static void add_person_with_places(const char* label, int age, char sex, int race, int household_relationship,
+				     Place* house, Place* school, Place* work,
+				     const char* house_label, const char* school_label, const char* work_label,
+				     bool has_school, bool has_work, int day, bool today_is_birthday);
+  static void read_population_from_cache(Population_Cache* cache, bool gq);
+  static Place* get_cached_place(Population_Cache* cache, int section, int ref,
+				 std::vector<Place*> & places, int type_id, const char* prefix);
+  static void get_cached_label(Population_Cache* cache, int section, int ref, const char* prefix, char* label);
   static void prepare_to_migrate(int day, Person* person);
   static void remove_migrants_from_population(int day);
   static void delete_person_from_population(int day, Person *person);
+  static void setup_storage();
+  static void recycle_released_people();
+  static void save_checkpoint_header(Checkpoint* checkpoint);
+  static void check_checkpoint_header(Checkpoint* checkpoint);
+  static void save_population_checkpoint(Checkpoint* checkpoint);
+  static void restore_population_checkpoint(Checkpoint* checkpoint);
   static void assign_classrooms();
   static void assign_partitions();
   static void assign_primary_healthcare_facilities();
@@ -964,6 +1029,10 @@ public:
   static std::string get_list_var_name(int index);
   static int get_list_var_id(string var_name);
 
+  // the dynamic state of this person, for checkpoints
+  void save_checkpoint(Checkpoint* checkpoint);
+  void restore_checkpoint(Checkpoint* checkpoint);
+
   // HEALTH INSURANCE
 
   Insurance_assignment_index::e get_insurance_type() const {
@@ -1034,6 +1103,7 @@ private:
   char sex;					// male or female?
   bool alive;
   bool deceased;				// is the agent deceased
+  bool pinned;				// storage is kept after death
   bool in_parents_home;			       // still in parents home?
   Place* home_neighborhood;
   Place* last_school;
@@ -1070,6 +1140,7 @@ private:
 
   // activity schedule:
   std::bitset<64> on_schedule; // true iff activity location is on schedule
+  std::bitset<64> absent_groups; // group types avoided in the current condition states
   int schedule_updated;			 // date of last schedule update
   bool is_traveling;				// true if traveling
   bool is_traveling_outside;   // true if traveling outside modeled area
@@ -1091,6 +1162,16 @@ private:
   static int next_meta_id;
   static std::vector<int> id_map;
 
+  // storage for people and their per-person rows
+  static bool storage_ready;
+  static Arena<Person> person_arena;
+  static Arena<condition_t> condition_arena;
+  static Arena<int> entered_arena;
+  static std::vector<int> entered_offset;
+  static Arena<double> var_arena;
+  static Arena<double_vector_t> list_var_arena;
+  static person_vector_t released_list;	// deleted people awaiting reuse
+
   // personal variables
   static int number_of_vars;
   static std::vector<std::string> var_name;
@@ -1124,7 +1205,12 @@ private:
   static int output_population;
   static char pop_outfile[FRED_STRING_SIZE];
   static char output_population_date_match[FRED_STRING_SIZE];
+  static int output_population_interval;
+  static int output_population_binary;
+  static int output_population_deltas;
+  static char output_population_vars[FRED_STRING_SIZE];
   static void write_population_output_file(int day);
+  static void write_population_snapshot(int day);
   static int Popsize_by_age [Demographics::MAX_AGE+1];
   static person_vector_t report_person;
   static std::vector<report_t*> report_vec;
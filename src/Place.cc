@@ -46,6 +46,7 @@
 #include "Neighborhood_Patch.h"
 #include "Property.h"
 #include "Person.h"
+#include "Population_Cache.h"
 #include "Random.h"
 #include "Utils.h"
 #include "Census_Tract.h"
@@ -55,6 +56,7 @@
 #include "Place_Type.h"
 #include "Regional_Layer.h"
 #include "Regional_Patch.h"
+#include "Text_File.h"
 #include "State.h"
 #include "Visualization_Layer.h"
 
@@ -573,6 +575,45 @@ void Place::get_place_properties() {
 
 }
 
+/*
+ * Reads households.txt files for Text_File::read_files().  As in a
+ * serial scan with sscanf, each file ends at its first line with fewer
+ * than six fields, and a line without an elevation keeps the elevation
+ * of the line before it.
+ */
+class Household_File_Reader {
+public:
+  Household_File_Reader(int number_of_files) :
+    households(number_of_files), finished(number_of_files, false), elevation(number_of_files, 0.0) {
+  }
+
+  bool parse(int file_index, char* line, household_data_t* data) {
+    Place::parse_household_line(line, data);
+    return true;
+  }
+
+  void commit(int file_index, household_data_t & data) {
+    if(this->finished[file_index]) {
+      return;
+    }
+    if(data.items < 6) {
+      this->finished[file_index] = true;
+      return;
+    }
+    if(data.items < 7) {
+      data.elevation = this->elevation[file_index];
+    }
+    this->elevation[file_index] = data.elevation;
+    this->households[file_index].push_back(data);
+  }
+
+  std::vector<std::vector<household_data_t> > households;
+
+private:
+  std::vector<bool> finished;
+  std::vector<double> elevation;
+};
+
 void Place::read_all_places() {
 
   // clear the vectors and maps
@@ -584,10 +625,41 @@ void Place::read_all_places() {
   Place::min_lat = Place::min_lon = 999;
   Place::max_lat = Place::max_lon = -999;
 
-  // process each specified location
+  // parse the household files of all locations together; the places are
+  // then added one location at a time, in the same order as before
   int locs = get_number_of_location_ids();
+  std::vector<Text_File*> household_files;
+  std::vector<int> household_file_index(locs, -1);
   for(int i = 0; i < locs; ++i) {
-    Place::read_places(get_location_id(i));
+    verify_pop_directory(get_location_id(i));
+    if (Global::Compile_FRED && Place_Type::get_number_of_place_types() <= 7) {
+      continue;
+    }
+    char pop_dir[FRED_STRING_SIZE];
+    get_population_directory(pop_dir, i);
+    if(Global::Enable_Population_Cache && Population_Cache::open(pop_dir) != NULL) {
+      continue;
+    }
+    char location_file[FRED_STRING_SIZE];
+    sprintf(location_file, "%s/households.txt", pop_dir);
+    Text_File* file = new Text_File;
+    if(file->open(location_file) == false) {
+      Utils::fred_abort("Can't open household file %s\n", location_file);
+    }
+    household_file_index[i] = household_files.size();
+    household_files.push_back(file);
+  }
+  Household_File_Reader reader(household_files.size());
+  Text_File::read_files<household_data_t>(household_files, reader);
+  Utils::fred_print_lap_time("Places.read_household_files");
+
+  // process each specified location
+  for(int i = 0; i < locs; ++i) {
+    int index = household_file_index[i];
+    Place::read_places(get_location_id(i), index < 0 ? NULL : &reader.households[index]);
+  }
+  for(int i = 0; i < household_files.size(); ++i) {
+    delete household_files[i];
   }
 
   // temporarily compute income levels to use for group quarters
@@ -669,12 +741,10 @@ void Place::verify_pop_directory(const char* loc_id) {
   }
 }
 
-void Place::read_places(const char* loc_id) {
+void Place::read_places(const char* loc_id, std::vector<household_data_t>* households) {
 
   FRED_STATUS(0, "read places entered\n", "");
 
-  verify_pop_directory(loc_id);
-
   char pop_dir[FRED_STRING_SIZE];
   sprintf(pop_dir, "%s/%s/%s/%s", Place::Population_directory,
 	  Place::Country, Place::Population_version, loc_id);
@@ -686,24 +756,39 @@ void Place::read_places(const char* loc_id) {
     return;
   }
 
-  // read household locations
-  char location_file[FRED_STRING_SIZE];
-  sprintf(location_file, "%s/households.txt", pop_dir);
-  read_household_file(location_file);
-  Utils::fred_print_lap_time("Places.read_household_file");
-  // FRED_VERBOSE(0, "after %s num_households = %d\n", location_file, get_number_of_households());
+  // use the binary population cache if read_all_places() found one
+  Population_Cache* cache = Population_Cache::get_cache(pop_dir);
 
-  // read school locations
-  sprintf(location_file, "%s/schools.txt", pop_dir);
-  read_school_file(location_file);
+  if(cache != NULL) {
+    read_places_from_cache(cache);
+    Utils::fred_print_lap_time("Places.read_places_from_cache");
+  } else {
+    // add the households parsed by read_all_places()
+    int n = 0;
+    for(int i = 0; i < households->size(); ++i) {
+      household_data_t & data = (*households)[i];
+      // debugging:
+      // printf("HH %d %s %lld %d %d %lf %lf %lf\n", n, data.label, data.admin_code, data.race, data.income, data.lat, data.lon, data.elevation); fflush(stdout);
+      if(add_household(data.label, data.admin_code, data.race, data.income, data.lat, data.lon, data.elevation) != NULL) {
+	n++;
+      }
+    }
+    FRED_VERBOSE(0, "finished reading in %d households\n", n);
+    Utils::fred_print_lap_time("Places.read_household_file");
 
-  // read workplace locations
-  sprintf(location_file, "%s/workplaces.txt", pop_dir);
-  read_workplace_file(location_file);
+    // read school locations
+    char location_file[FRED_STRING_SIZE];
+    sprintf(location_file, "%s/schools.txt", pop_dir);
+    read_school_file(location_file);
 
-  // read hospital locations
-  sprintf(location_file, "%s/hospitals.txt", pop_dir);
-  read_hospital_file(location_file);
+    // read workplace locations
+    sprintf(location_file, "%s/workplaces.txt", pop_dir);
+    read_workplace_file(location_file);
+
+    // read hospital locations
+    sprintf(location_file, "%s/hospitals.txt", pop_dir);
+    read_hospital_file(location_file);
+  }
 
   // read in user-defined place types
   Place_Type::read_places(pop_dir);
@@ -724,9 +809,14 @@ void Place::read_gq_places(const char* loc_id) {
 
     // read group quarters locations (a new workplace and household is created 
     // for each group quarters)
-    char location_file[FRED_STRING_SIZE];
-    sprintf(location_file, "%s/gq.txt", pop_dir);
-    read_group_quarters_file(location_file);
+    Population_Cache* cache = Population_Cache::get_cache(pop_dir);
+    if(cache != NULL) {
+      read_group_quarters_from_cache(cache);
+    } else {
+      char location_file[FRED_STRING_SIZE];
+      sprintf(location_file, "%s/gq.txt", pop_dir);
+      read_group_quarters_file(location_file);
+    }
     Utils::fred_print_lap_time("Places.read_group_quarters_file");
     // FRED_VERBOSE(0, "after %s num_households = %d\n", location_file, get_number_of_households());
 
@@ -735,90 +825,59 @@ void Place::read_gq_places(const char* loc_id) {
 }
 
 
-void Place::read_household_file(char* location_file) {
-
-  char line[FRED_STRING_SIZE];
+// fields: sp_id stcotrbg hh_race hh_income latitude longitude [elevation]
+void Place::parse_household_line(char* line, household_data_t* data) {
+  char* cursor = line;
+  int items = 0;
+  Text_File::get_string(cursor, &data->label) && ++items
+    && Text_File::get_long_long(cursor, &data->admin_code) && ++items
+    && Text_File::get_int(cursor, &data->race) && ++items
+    && Text_File::get_int(cursor, &data->income) && ++items
+    && Text_File::get_double(cursor, &data->lat) && ++items
+    && Text_File::get_double(cursor, &data->lon) && ++items
+    && Text_File::get_double(cursor, &data->elevation) && ++items;
+  data->items = items;
+}
 
-  // data to fill in from input file
-  int type_id = Place_Type::HOUSEHOLD;
-  char place_subtype = Place::SUBTYPE_NONE;
+/*
+ * Add the household on one line of households.txt.  Returns NULL if
+ * a place with the same sp_id already exists.
+ */
+Place* Place::add_household(const char* label, long long int admin_code, int race, int income,
+			    double lat, double lon, double elevation) {
   char new_label[FRED_STRING_SIZE];
-  char label[FRED_STRING_SIZE];
-  long long int admin_code = 0;
   long long int sp_id = 0;
-  double lat = 0;
-  double lon = 0;
-  double elevation = 0;
-  int race;
-  int income;
-  int n = 0;
-
-  FILE* fp = Utils::fred_open_file(location_file);
-
-  // skip header line
-  fgets(label, FRED_STRING_SIZE, fp);
-
-  // read first data line
-  strcpy(line, "");
-  fgets(line, FRED_STRING_SIZE, fp);
-  int items = sscanf(line, "%s %lld %d %d %lf %lf %lf", label, &admin_code, &race, &income, &lat, &lon, &elevation);
-  
-  while(6 <= items) {
-      
-    // debugging:
-    // printf("HH %d %s %lld %d %d %lf %lf %lf\n", n, label, admin_code, race, income, lat, lon, elevation); fflush(stdout);
-
-
-
-    // debugging:
-    // printf("HH added: %d %s %lld %d %d %lf %lf %lf\n", n, place->get_label(), place->get_admin_code(),
-    // race, income, place->get_latitude(), place->get_longitude(), place->get_elevation()); fflush(stdout);
-
-    sscanf(label, "%lld", &sp_id);
-    if(!Group::sp_id_exists(sp_id + 100000000)) {
-      // negative income disallowed
-      if(income < 0) {
-        income = 0;
-      }
-
-      sprintf(new_label, "H-%s", label);
+  sscanf(label, "%lld", &sp_id);
+  if(Group::sp_id_exists(sp_id + 100000000)) {
+    return NULL;
+  }
 
-      Household* place = static_cast<Household*>(add_place(new_label, type_id, place_subtype, lon, lat, elevation, admin_code));
-      place->set_sp_id(sp_id + 100000000);
+  // negative income disallowed
+  if(income < 0) {
+    income = 0;
+  }
 
-      // household race and income
-      place->set_household_race(race);
-      place->set_income(income);
+  sprintf(new_label, "H-%s", label);
 
-      n++;
+  Household* place = static_cast<Household*>(add_place(new_label, Place_Type::HOUSEHOLD, Place::SUBTYPE_NONE, lon, lat, elevation, admin_code));
+  place->set_sp_id(sp_id + 100000000);
 
-      Place::update_geo_boundaries(lat, lon);
-    }
+  // household race and income
+  place->set_household_race(race);
+  place->set_income(income);
 
-    // get next line
-    strcpy(line, "");
-    fgets(line, FRED_STRING_SIZE, fp);
-    items = sscanf(line, "%s %lld %d %d %lf %lf %lf", label, &admin_code, &race, &income, &lat, &lon, &elevation);
-
-  }
-  fclose(fp);
-  FRED_VERBOSE(0, "finished reading in %d households\n", n);
-  return;
+  Place::update_geo_boundaries(lat, lon);
+  return place;
 }
 
 void Place::read_workplace_file(char* location_file) {
   char line[FRED_STRING_SIZE];
 
   // data to fill in from input file
-  int type_id = Place_Type::WORKPLACE;
-  char place_subtype = Place::SUBTYPE_NONE;
   char label[FRED_STRING_SIZE];
-  char new_label[FRED_STRING_SIZE];
   double lat;
   double lon;
   double elevation = 0;
-  long long int admin_code = 0;
-  long long int sp_id = 0;
 
   FILE* fp = Utils::fred_open_file(location_file);
   if (fp == NULL) {
@@ -834,14 +893,7 @@ void Place::read_workplace_file(char* location_file) {
   int items = sscanf(line, "%s %lf %lf %lf", label, &lat, &lon, &elevation);
 
   while(3 <= items) {
-    sprintf(new_label, "W-%s", label);
-    sscanf(label, "%lld", &sp_id);
-
-    if(!Group::sp_id_exists(sp_id)) {
-      // printf("%s %lf %lf %lf\n", new_label, lat, lon, elevation); fflush(stdout);
-      Place* place = add_place(new_label, type_id, place_subtype, lon, lat, elevation, admin_code);
-      place->set_sp_id(sp_id);
-    }
+    add_workplace(label, lat, lon, elevation);
 
     // read next data line
     strcpy(line, "");
@@ -852,23 +904,31 @@ void Place::read_workplace_file(char* location_file) {
   return;
 }
 
+Place* Place::add_workplace(const char* label, double lat, double lon, double elevation) {
+  char new_label[FRED_STRING_SIZE];
+  long long int sp_id = 0;
+  sprintf(new_label, "W-%s", label);
+  sscanf(label, "%lld", &sp_id);
+  if(Group::sp_id_exists(sp_id)) {
+    return NULL;
+  }
+  // printf("%s %lf %lf %lf\n", new_label, lat, lon, elevation); fflush(stdout);
+  Place* place = add_place(new_label, Place_Type::WORKPLACE, Place::SUBTYPE_NONE, lon, lat, elevation, 0);
+  place->set_sp_id(sp_id);
+  return place;
+}
 
 void Place::read_hospital_file(char* location_file) {
   char line[FRED_STRING_SIZE];
 
   // data to fill in from input file
-  int type_id = Place_Type::HOSPITAL;
-  char place_subtype = Place::SUBTYPE_NONE;
   char label[FRED_STRING_SIZE];
-  char new_label[FRED_STRING_SIZE];
   double lat;
   double lon;
   double elevation = 0;
   int workers;
   int physicians;
   int beds;
-  long long int admin_code = 0;
-  long long int sp_id = 0;
 
   FILE* fp = Utils::fred_open_file(location_file);
   if(fp == NULL) {
@@ -885,21 +945,7 @@ void Place::read_hospital_file(char* location_file) {
     int items = sscanf(line, "%s %d %d %d %lf %lf %lf", label, &workers, &physicians, &beds, &lat, &lon, &elevation);
 
     while (6 <= items) {
-      sprintf(new_label, "M-%s", label);
-      sscanf(label, "%lld", &sp_id);
-      if(!Group::sp_id_exists(sp_id + 600000000)) {
-        Hospital* place = static_cast<Hospital*>(add_place(new_label, type_id, place_subtype, lon, lat, elevation, admin_code));
-
-        place->set_sp_id(sp_id + 600000000);
-
-        place->set_employee_count(workers);
-        place->set_physician_count(physicians);
-        place->set_bed_count(beds);
-
-        string hosp_label_str(label);
-        int hosp_id = get_number_of_hospitals() - 1;
-        Place::hosp_label_hosp_id_map.insert(std::pair<string, int>(hosp_label_str, hosp_id));
-      }
+      add_hospital(label, workers, physicians, beds, lat, lon, elevation);
 
       // read next data line
       strcpy(line, "");
@@ -912,20 +958,38 @@ void Place::read_hospital_file(char* location_file) {
   return;
 }
 
+Place* Place::add_hospital(const char* label, int workers, int physicians, int beds,
+			   double lat, double lon, double elevation) {
+  char new_label[FRED_STRING_SIZE];
+  long long int sp_id = 0;
+  sprintf(new_label, "M-%s", label);
+  sscanf(label, "%lld", &sp_id);
+  if(Group::sp_id_exists(sp_id + 600000000)) {
+    return NULL;
+  }
+  Hospital* place = static_cast<Hospital*>(add_place(new_label, Place_Type::HOSPITAL, Place::SUBTYPE_NONE, lon, lat, elevation, 0));
+
+  place->set_sp_id(sp_id + 600000000);
+
+  place->set_employee_count(workers);
+  place->set_physician_count(physicians);
+  place->set_bed_count(beds);
+
+  string hosp_label_str(label);
+  int hosp_id = get_number_of_hospitals() - 1;
+  Place::hosp_label_hosp_id_map.insert(std::pair<string, int>(hosp_label_str, hosp_id));
+  return place;
+}
 
 void Place::read_school_file(char* location_file) {
   char line[FRED_STRING_SIZE];
 
   // data to fill in from input file
-  int type_id = Place_Type::SCHOOL;
-  char place_subtype = Place::SUBTYPE_NONE;
-  char new_label[FRED_STRING_SIZE];
   char label[FRED_STRING_SIZE];
   long long int admin_code = 0;
   double lat;
   double lon;
   double elevation = 0;
-  long long int sp_id = 0;
 
   FILE* fp = Utils::fred_open_file(location_file);
   if (fp == NULL) {
@@ -941,20 +1005,7 @@ void Place::read_school_file(char* location_file) {
   int items = sscanf(line, "%s %lld %lf %lf %lf", label, &admin_code, &lat, &lon, &elevation);
   
   while (4 <= items) {
-
-    if(Place::country_is_usa) {
-      // convert county admin code to block group code
-      admin_code *= 10000000;
-    }
-
-    sscanf(label, "%lld", &sp_id);
-    if(!Group::sp_id_exists(sp_id)) {
-      sprintf(new_label, "S-%s", label);
-      // printf("%s %lld %lf %lf %lf\n", new_label, admin_code, lat, lon, elevation); fflush(stdout);
-      Place* place = add_place(new_label, type_id, place_subtype, lon, lat, elevation, admin_code);
-
-      place->set_sp_id(sp_id);
-    }
+    add_school(label, admin_code, lat, lon, elevation);
 
     // read next data line
     strcpy(line, "");
@@ -965,12 +1016,30 @@ void Place::read_school_file(char* location_file) {
   return;
 }
 
+Place* Place::add_school(const char* label, long long int admin_code, double lat, double lon, double elevation) {
+  char new_label[FRED_STRING_SIZE];
+  long long int sp_id = 0;
+
+  if(Place::country_is_usa) {
+    // convert county admin code to block group code
+    admin_code *= 10000000;
+  }
+
+  sscanf(label, "%lld", &sp_id);
+  if(Group::sp_id_exists(sp_id)) {
+    return NULL;
+  }
+  sprintf(new_label, "S-%s", label);
+  // printf("%s %lld %lf %lf %lf\n", new_label, admin_code, lat, lon, elevation); fflush(stdout);
+  Place* place = add_place(new_label, Place_Type::SCHOOL, Place::SUBTYPE_NONE, lon, lat, elevation, admin_code);
+  place->set_sp_id(sp_id);
+  return place;
+}
 
 void Place::read_group_quarters_file(char* location_file) {
   char line[FRED_STRING_SIZE];
 
   // data to fill in from input file
-  char place_subtype = Place::SUBTYPE_NONE;
   char gq_type;
   char id[FRED_STRING_SIZE];
   char label[FRED_STRING_SIZE];
@@ -979,8 +1048,6 @@ void Place::read_group_quarters_file(char* location_file) {
   double lon;
   double elevation = 0;
   int capacity;
-  int income;
-  long long int sp_id = 0;
 
   FILE* fp = Utils::fred_open_file(location_file);
   if (fp == NULL) {
@@ -998,73 +1065,137 @@ void Place::read_group_quarters_file(char* location_file) {
   while (6 <= items) {
     // printf("read_gq_file: %s %c %lld %d %lf %lf %lf\n", id, gq_type, admin_code, capacity, lat, lon, elevation); fflush(stdout);
 
-    update_geo_boundaries(lat, lon);
-
-    // set number of units and subtype for this group quarters
-    int number_of_units = 0;
-    if(gq_type == 'C') {
-      number_of_units = capacity / Place::College_dorm_mean_size;
-      place_subtype = Place::SUBTYPE_COLLEGE;
-      income = Place_Type::get_household_place_type()->get_income_second_quartile();
-    }
-    if(gq_type == 'M') {
-      number_of_units = capacity / Place::Military_barracks_mean_size;
-      place_subtype = Place::SUBTYPE_MILITARY_BASE;
-      income = Place_Type::get_household_place_type()->get_income_second_quartile();
-    }
-    if(gq_type == 'P') {
-      number_of_units = capacity / Place::Prison_cell_mean_size;
-      place_subtype = Place::SUBTYPE_PRISON;
-      income = Place_Type::get_household_place_type()->get_income_first_quartile();
-    }
-    if(gq_type == 'N') {
-      number_of_units = capacity / Place::Nursing_home_room_mean_size;
-      place_subtype = Place::SUBTYPE_NURSING_HOME;
-      income = Place_Type::get_household_place_type()->get_income_first_quartile();
-    }
-    if(number_of_units == 0) {
-      number_of_units = 1;
-    }
-
-    // add a workplace for this group quarters
-    sprintf(label, "GW-%s", id);
-    // sprintf(label, "WRK-%s", label);
-    FRED_VERBOSE(1, "Adding GQ Workplace %s subtype %c\n", label, place_subtype);
-    Place* workplace = add_place(label, Place_Type::WORKPLACE, place_subtype, lon, lat, elevation, admin_code);
-    sscanf(id, "%lld", &sp_id);
-    sp_id *= 10000;
-    workplace->set_sp_id(sp_id);
+    add_group_quarters(id, gq_type, admin_code, capacity, lat, lon, elevation);
+
+    // read next data line
+    strcpy(line, "");
+    fgets(line, FRED_STRING_SIZE, fp);
+    items = sscanf(line, "%s %c %lld %d %lf %lf %lf", id, &gq_type, &admin_code, &capacity, &lat, &lon, &elevation);
+  }
+  fclose(fp);
+  return;
+}
+
+/*
+ * Add the workplace and household units for one line of gq.txt.
+ * Returns the first household unit.
+ */
+Household* Place::add_group_quarters(const char* id, char gq_type, long long int admin_code, int capacity,
+				     double lat, double lon, double elevation) {
+  char label[FRED_STRING_SIZE];
+  char place_subtype = Place::SUBTYPE_NONE;
+  int income = 0;
+  long long int sp_id = 0;
+
+  update_geo_boundaries(lat, lon);
+
+  // set number of units and subtype for this group quarters
+  int number_of_units = 0;
+  if(gq_type == 'C') {
+    number_of_units = capacity / Place::College_dorm_mean_size;
+    place_subtype = Place::SUBTYPE_COLLEGE;
+    income = Place_Type::get_household_place_type()->get_income_second_quartile();
+  }
+  if(gq_type == 'M') {
+    number_of_units = capacity / Place::Military_barracks_mean_size;
+    place_subtype = Place::SUBTYPE_MILITARY_BASE;
+    income = Place_Type::get_household_place_type()->get_income_second_quartile();
+  }
+  if(gq_type == 'P') {
+    number_of_units = capacity / Place::Prison_cell_mean_size;
+    place_subtype = Place::SUBTYPE_PRISON;
+    income = Place_Type::get_household_place_type()->get_income_first_quartile();
+  }
+  if(gq_type == 'N') {
+    number_of_units = capacity / Place::Nursing_home_room_mean_size;
+    place_subtype = Place::SUBTYPE_NURSING_HOME;
+    income = Place_Type::get_household_place_type()->get_income_first_quartile();
+  }
+  if(number_of_units == 0) {
+    number_of_units = 1;
+  }
+
+  // add a workplace for this group quarters
+  sprintf(label, "GW-%s", id);
+  // sprintf(label, "WRK-%s", label);
+  FRED_VERBOSE(1, "Adding GQ Workplace %s subtype %c\n", label, place_subtype);
+  Place* workplace = add_place(label, Place_Type::WORKPLACE, place_subtype, lon, lat, elevation, admin_code);
+  sscanf(id, "%lld", &sp_id);
+  sp_id *= 10000;
+  workplace->set_sp_id(sp_id);
     
-    // add as household
-    sprintf(label, "GH-%s",id);
-    FRED_VERBOSE(1, "Adding GQ Household %s subtype %c\n", label, place_subtype);
+  // add as household
+  sprintf(label, "GH-%s",id);
+  FRED_VERBOSE(1, "Adding GQ Household %s subtype %c\n", label, place_subtype);
+  Household* first_unit = static_cast<Household *>(add_place(label, Place_Type::HOUSEHOLD, place_subtype, lon, lat, elevation, admin_code));
+  first_unit->set_group_quarters_units(number_of_units);
+  first_unit->set_group_quarters_workplace(workplace);
+  first_unit->set_income(income);
+  sp_id += 1;
+  first_unit->set_sp_id(sp_id);
+
+  // add this to the list of externally defined gq's
+  Place::gq.push_back(first_unit);
+
+  // generate additional household units associated with this group quarters
+  for(int i = 1; i < number_of_units; ++i) {
+    sprintf(label, "GH-%s-%03d", id, i+1);
     Household *place = static_cast<Household *>(add_place(label, Place_Type::HOUSEHOLD, place_subtype, lon, lat, elevation, admin_code));
-    place->set_group_quarters_units(number_of_units);
-    place->set_group_quarters_workplace(workplace);
+    FRED_VERBOSE(1, "Adding GQ Household %s subtype %c out of %d units\n", label, place_subtype, number_of_units);
     place->set_income(income);
     sp_id += 1;
     place->set_sp_id(sp_id);
+  }
+  return first_unit;
+}
 
-    // add this to the list of externally defined gq's
-    Place::gq.push_back(place);
+/*
+ * Add the places of one location from its binary population cache,
+ * recording the place made from each row for Person::read_population().
+ */
+void Place::read_places_from_cache(Population_Cache* cache) {
+  int n = cache->get_count(Population_Cache::HOUSEHOLDS);
+  cache->household_place.assign(n, NULL);
+  for(int i = 0; i < n; ++i) {
+    const Population_Cache::household_record_t* rec = cache->get_household(i);
+    cache->household_place[i] = add_household(rec->label, rec->admin_code, rec->race, rec->income,
+					       rec->lat, rec->lon, rec->elevation);
+  }
+  FRED_VERBOSE(0, "finished reading in %d households\n", n);
 
-    // generate additional household units associated with this group quarters
-    for(int i = 1; i < number_of_units; ++i) {
-      sprintf(label, "GH-%s-%03d", id, i+1);
-      Household *place = static_cast<Household *>(add_place(label, Place_Type::HOUSEHOLD, place_subtype, lon, lat, elevation, admin_code));
-      FRED_VERBOSE(1, "Adding GQ Household %s subtype %c out of %d units\n", label, place_subtype, number_of_units);
-      place->set_income(income);
-      sp_id += 1;
-      place->set_sp_id(sp_id);
-    }
+  n = cache->get_count(Population_Cache::SCHOOLS);
+  cache->school_place.assign(n, NULL);
+  for(int i = 0; i < n; ++i) {
+    const Population_Cache::school_record_t* rec = cache->get_school(i);
+    cache->school_place[i] = add_school(rec->label, rec->admin_code, rec->lat, rec->lon, rec->elevation);
+  }
 
-    // read next data line
-    strcpy(line, "");
-    fgets(line, FRED_STRING_SIZE, fp);
-    items = sscanf(line, "%s %c %lld %d %lf %lf %lf", id, &gq_type, &admin_code, &capacity, &lat, &lon, &elevation);
+  n = cache->get_count(Population_Cache::WORKPLACES);
+  cache->workplace_place.assign(n, NULL);
+  for(int i = 0; i < n; ++i) {
+    const Population_Cache::workplace_record_t* rec = cache->get_workplace(i);
+    cache->workplace_place[i] = add_workplace(rec->label, rec->lat, rec->lon, rec->elevation);
+  }
+
+  n = cache->get_count(Population_Cache::HOSPITALS);
+  for(int i = 0; i < n; ++i) {
+    const Population_Cache::hospital_record_t* rec = cache->get_hospital(i);
+    add_hospital(rec->label, rec->workers, rec->physicians, rec->beds, rec->lat, rec->lon, rec->elevation);
+  }
+  FRED_VERBOSE(0, "read_hospital_file: found %d hospitals\n", get_number_of_hospitals());
+}
+
+void Place::read_group_quarters_from_cache(Population_Cache* cache) {
+  int n = cache->get_count(Population_Cache::GROUP_QUARTERS);
+  cache->gq_household_place.assign(n, NULL);
+  cache->gq_workplace_place.assign(n, NULL);
+  for(int i = 0; i < n; ++i) {
+    const Population_Cache::gq_record_t* rec = cache->get_gq(i);
+    Household* house = add_group_quarters(rec->label, rec->gq_type, rec->admin_code, rec->capacity,
+					  rec->lat, rec->lon, rec->elevation);
+    cache->gq_household_place[i] = house;
+    cache->gq_workplace_place[i] = house->get_group_quarters_workplace();
   }
-  fclose(fp);
-  return;
 }
 
 
@@ -41,11 +41,24 @@ typedef std::unordered_map<std::string, int> LabelMapT;
 typedef std::map<char, std::string> TypeNameMapT;
 typedef std::map<int, int> HospitalIDCountMapT;
 
+// one line of households.txt; label points into the file's Text_File
+typedef struct {
+  char* label;
+  long long int admin_code;
+  int race;
+  int income;
+  double lat;
+  double lon;
+  double elevation;
+  int items;			// number of fields read, as sscanf would count them
+} household_data_t;
+
 class Block_Group;
 class Household;
 class Hospital;
 class Neighborhood_Patch;
 class Person;
+class Population_Cache;
 class School;
 
 class Place : public Group {
@@ -75,31 +88,31 @@ class Place : public Group {
 
   // test place types
   bool is_household() {
-    return this->type_id == Place_Type::get_type_id("Household");
+    return this->type_id == Place_Type::HOUSEHOLD;
   }
   
   bool is_neighborhood() {
-    return this->type_id == Place_Type::get_type_id("Neighborhood");
+    return this->type_id == Place_Type::NEIGHBORHOOD;
   }
   
   bool is_school() {
-    return this->type_id == Place_Type::get_type_id("School");
+    return this->type_id == Place_Type::SCHOOL;
   }
   
   bool is_classroom() {
-    return this->type_id == Place_Type::get_type_id("Classroom");
+    return this->type_id == Place_Type::CLASSROOM;
   }
   
   bool is_workplace() {
-    return this->type_id == Place_Type::get_type_id("Workplace");
+    return this->type_id == Place_Type::WORKPLACE;
   }
   
   bool is_office() {
-    return this->type_id == Place_Type::get_type_id("Office");
+    return this->type_id == Place_Type::OFFICE;
   }
   
   bool is_hospital() {
-    return this->type_id == Place_Type::get_type_id("Hospital");
+    return this->type_id == Place_Type::HOSPITAL;
   }
   
   // test place subtypes
@@ -328,7 +341,7 @@ class Place : public Group {
   // initialization methods
   static void read_all_places();
   static void verify_pop_directory(const char* loc_id);
-  static void read_places(const char* loc_id);
+  static void read_places(const char* loc_id, std::vector<household_data_t>* households);
   static void read_gq_places(const char* loc_id);
   static void get_elevation_data();
   static Place* add_place(char* label, int place_type_id, char subtype, fred::geo lon, fred::geo lat, double elevation, long long int census_tract);
@@ -498,11 +511,21 @@ class Place : public Group {
   static place_vector_t get_candidate_places(Place* target, int type_id);
   static void read_place_file(char* location_file, int type);
   static Hospital* get_hospital_assigned_to_household(Household* hh);
-  static void read_household_file(char* location_file);
+  static void parse_household_line(char* line, household_data_t* data);
   static void read_workplace_file(char* location_file);
   static void read_school_file(char* location_file);
   static void read_hospital_file(char* location_file);
   static void read_group_quarters_file(char* location_file);
+  static void read_places_from_cache(Population_Cache* cache);
+  static void read_group_quarters_from_cache(Population_Cache* cache);
+  static Place* add_household(const char* label, long long int admin_code, int race, int income,
+			      double lat, double lon, double elevation);
+  static Place* add_school(const char* label, long long int admin_code, double lat, double lon, double elevation);
+  static Place* add_workplace(const char* label, double lat, double lon, double elevation);
+  static Place* add_hospital(const char* label, int workers, int physicians, int beds,
+			     double lat, double lon, double elevation);
+  static Household* add_group_quarters(const char* id, char gq_type, long long int admin_code, int capacity,
+				       double lat, double lon, double elevation);
   static void update_household_file(char* location_file);
   static void update_school_file(char* location_file);
   static void update_workplace_file(char* location_file);
@@ -24,6 +24,7 @@
 //
 
 #include "Condition.h"
+#include "Daily_Report.h"
 #include "Group_Type.h"
 #include "Neighborhood_Layer.h"
 #include "Property.h"
@@ -278,6 +279,17 @@ void Place_Type::get_place_type_properties() {
 
   }
 
+  // the built-in place types are used by their GTYPE id throughout, so
+  // config.fred must declare them first and in this order
+  const char* built_in_names[] = {
+    "Household", "Neighborhood", "School", "Classroom", "Workplace", "Office", "Hospital"
+  };
+  for(int type_id = Place_Type::HOUSEHOLD; type_id <= Place_Type::HOSPITAL; ++type_id) {
+    if(Place_Type::get_type_id(built_in_names[type_id]) != type_id) {
+      Utils::fred_abort("Help! built-in place type %s must be place type %d\n", built_in_names[type_id], type_id);
+    }
+  }
+
   // setup partitions
   for(int type_id = 0; type_id < Place_Type::place_types.size(); ++type_id) {
     Place_Type* place_type = Place_Type::place_types[type_id];
@@ -444,6 +456,7 @@ Place* Place_Type::generate_new_place(Person* person) {
   place = Place::add_place(label, Group_Type::get_type_id(this->name), 'x', lon, lat, elevation, census_tract_admin_code);
   place->set_sp_id(sp_id);
   place->set_host(person);
+  person->pin();
   Place_Type::host_place_map[person] = place;
   // create an administrator if needed
   if(this->has_admin) {
@@ -527,67 +540,29 @@ void Place_Type::finish() {
     return;
   }
 
-  char dir[FRED_STRING_SIZE];
-  char outfile[FRED_STRING_SIZE];
-  FILE* fp;
-
-  sprintf(dir, "%s/RUN%d/DAILY", Global::Simulation_directory, Global::Simulation_run_number);
-  Utils::fred_make_directory(dir);
-
-  for (int i = 0; i < get_number_of_places(); ++i) {
-    sprintf(outfile, "%s/%s.SizeOf%s%03d.txt", dir, this->name.c_str(), this->name.c_str(), i);
-    fp = fopen(outfile, "w");
-    if(fp == NULL) {
-      Utils::fred_abort("Fred: can't open file %s\n", outfile);
-    }
+  Daily_Report report;
+  char name[FRED_STRING_SIZE];
+  std::vector<int> size;
+  for(int i = 0; i < get_number_of_places(); ++i) {
+    sprintf(name, "%s.SizeOf%s%03d", this->name.c_str(), this->name.c_str(), i);
+    size.clear();
     for(int day = 0; day < Global::Simulation_Days; ++day) {
-      fprintf(fp, "%d %d\n", day, get_place(i)->get_size_on_day(day));
+      size.push_back(get_place(i)->get_size_on_day(day));
     }
-    fclose(fp);
+    report.add_column(name, size);
   }
 
-  // create a csv file for this place_type
-
-  // this joins two files with same value in column 1, from
-  // https://stackoverflow.com/questions/14984340/using-awk-to-process-input-from-multiple-files
-  char awkcommand[FRED_STRING_SIZE];
-  sprintf(awkcommand, "awk 'FNR==NR{a[$1]=$2 FS $3;next}{print $0, a[$1]}' ");
+  if(Global::Enable_Daily_Text_Files) {
+    char dir[FRED_STRING_SIZE];
+    sprintf(dir, "%s/RUN%d/DAILY", Global::Simulation_directory, Global::Simulation_run_number);
+    Utils::fred_make_directory(dir);
+    report.write_daily_files(dir);
+  }
 
-  char command[FRED_STRING_SIZE];
-  char dailyfile[FRED_STRING_SIZE];
+  // create a csv file for this place_type
+  char outfile[FRED_STRING_SIZE];
   sprintf(outfile, "%s/RUN%d/%s.csv", Global::Simulation_directory, Global::Simulation_run_number, this->name.c_str());
-
-  sprintf(dailyfile, "%s/%s.SizeOf%s000.txt", dir, this->name.c_str(), this->name.c_str());
-  sprintf(command, "cp %s %s", dailyfile, outfile);
-  system(command);
-
-  for(int i = 0; i < get_number_of_places(); ++i) {
-    if(i > 0) {
-      sprintf(dailyfile, "%s/%s.SizeOf%s%03d.txt", dir, this->name.c_str(), this->name.c_str(), i);
-      sprintf(command, "%s %s %s > %s.tmp; mv %s.tmp %s", awkcommand, dailyfile, outfile, outfile, outfile, outfile);
-      system(command);
-    }
-  }  
-  
-  // create a header line for the csv file
-  char headerfile[FRED_STRING_SIZE];
-  sprintf(headerfile, "%s/RUN%d/%s.header", Global::Simulation_directory, Global::Simulation_run_number, this->name.c_str());
-  fp = fopen(headerfile, "w");
-  fprintf(fp, "Day ");
-  for(int i = 0; i < get_number_of_places(); ++i) {
-    fprintf(fp, "%s.SizeOf%s%03d ", this->name.c_str(), this->name.c_str(), i);
-  }
-  fprintf(fp, "\n");
-  fclose(fp);
-  
-  // concatenate header line
-  sprintf(command, "cat %s %s > %s.tmp; mv %s.tmp %s; unlink %s", headerfile, outfile, outfile, outfile, outfile, headerfile);
-  system(command);
-  
-  // replace spaces with commas
-  sprintf(command, "sed -E 's/ +/,/g' %s | sed -E 's/,$//' | sed -E 's/,/ /' > %s.tmp; mv %s.tmp %s", outfile, outfile, outfile, outfile);
-  system(command);
-  
+  report.write_csv(outfile, true);
 }
 
 void Place_Type::report_place_size(int place_type_id) {
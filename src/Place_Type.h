@@ -204,31 +204,31 @@ public:
   }
 
   static Place_Type* get_household_place_type() {
-    return Place_Type::place_types[Place_Type::get_type_id("Household")];
+    return Place_Type::place_types[Place_Type::HOUSEHOLD];
   }
 
   static Place_Type* get_neighborhood_place_type() {
-    return Place_Type::place_types[Place_Type::get_type_id("Neighborhood")];
+    return Place_Type::place_types[Place_Type::NEIGHBORHOOD];
   }
 
   static Place_Type* get_school_place_type() {
-    return Place_Type::place_types[Place_Type::get_type_id("School")];
+    return Place_Type::place_types[Place_Type::SCHOOL];
   }
 
   static Place_Type* get_classroom_place_type() {
-    return Place_Type::place_types[Place_Type::get_type_id("Classroom")];
+    return Place_Type::place_types[Place_Type::CLASSROOM];
   }
 
   static Place_Type* get_workplace_place_type() {
-    return Place_Type::place_types[Place_Type::get_type_id("Workplace")];
+    return Place_Type::place_types[Place_Type::WORKPLACE];
   }
 
   static Place_Type* get_office_place_type() {
-    return Place_Type::place_types[Place_Type::get_type_id("Office")];
+    return Place_Type::place_types[Place_Type::OFFICE];
   }
 
   static Place_Type* get_hospital_place_type() {
-    return Place_Type::place_types[Place_Type::get_type_id("Hospital")];
+    return Place_Type::place_types[Place_Type::HOSPITAL];
   }
 
   static void add_places_to_neighborhood_layer();
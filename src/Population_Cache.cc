@@ -0,0 +1,628 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Population_Cache.cc
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <unordered_map>
+
+#include "Global.h"
+#include "Population_Cache.h"
+
+std::map<std::string, Population_Cache*> Population_Cache::cache_map;
+
+namespace {
+
+  const char* cache_file_name = "population.bin";
+  const char cache_magic[8] = "FREDPOP";
+  const int cache_version = 1;
+
+  // the text files covered by the cache, in section order
+  const char* source_file_name[Population_Cache::LABELS] = {
+    "households.txt",
+    "schools.txt",
+    "workplaces.txt",
+    "hospitals.txt",
+    "gq.txt",
+    "people.txt",
+    "gq_people.txt"
+  };
+
+  typedef struct {
+    long long int size;		// -1 if the file does not exist
+    long long int mtime;
+  } source_t;
+
+  typedef struct {
+    long long int offset;
+    int count;
+    int record_size;
+  } section_entry_t;
+
+  typedef struct {
+    char magic[8];
+    int version;
+    int number_of_sections;
+    source_t source[Population_Cache::LABELS];
+    section_entry_t section[Population_Cache::NUMBER_OF_SECTIONS];
+  } header_t;
+
+  const int expected_record_size[Population_Cache::NUMBER_OF_SECTIONS] = {
+    sizeof(Population_Cache::household_record_t),
+    sizeof(Population_Cache::school_record_t),
+    sizeof(Population_Cache::workplace_record_t),
+    sizeof(Population_Cache::hospital_record_t),
+    sizeof(Population_Cache::gq_record_t),
+    sizeof(Population_Cache::person_record_t),
+    sizeof(Population_Cache::gq_person_record_t),
+    sizeof(Population_Cache::label_record_t)
+  };
+
+  typedef std::unordered_map<std::string, int> row_map_t;
+
+  // expand a leading $FRED_HOME, as Utils::get_fred_file_name does
+  std::string get_path(const char* pop_dir, const char* file_name) {
+    std::string path(pop_dir);
+    if(path.compare(0, 10, "$FRED_HOME") == 0) {
+      char* fred_home = getenv("FRED_HOME");
+      if(fred_home != NULL) {
+	path.replace(0, 10, fred_home);
+      }
+    }
+    path += "/";
+    path += file_name;
+    return path;
+  }
+
+  source_t get_source(const char* pop_dir, int i) {
+    source_t source;
+    struct stat st;
+    if(stat(get_path(pop_dir, source_file_name[i]).c_str(), &st) == 0) {
+      source.size = st.st_size;
+      source.mtime = st.st_mtime;
+    } else {
+      source.size = -1;
+      source.mtime = 0;
+    }
+    return source;
+  }
+
+  bool copy_label(char* dest, const char* label, const char* file_name) {
+    if(strlen(label) >= POPULATION_CACHE_LABEL_SIZE) {
+      fprintf(stderr, "population cache: label %s in %s is too long\n", label, file_name);
+      return false;
+    }
+    strcpy(dest, label);
+    return true;
+  }
+
+  int get_row(row_map_t & rows, const char* label) {
+    row_map_t::iterator itr = rows.find(label);
+    if(itr == rows.end()) {
+      return -1;
+    }
+    return itr->second;
+  }
+
+  /*
+   * Converter state for one population directory.  The readers below
+   * mirror the text readers in Place.cc and Person.cc line for line, so
+   * every record holds exactly the values those readers would see.
+   */
+  class Converter {
+  public:
+
+    Converter(const char* dir) {
+      this->pop_dir = dir;
+    }
+
+    bool read_all() {
+      return read_households() && read_schools() && read_workplaces() && read_hospitals()
+	&& read_group_quarters() && read_people("people.txt", false)
+	&& read_people("gq_people.txt", true);
+    }
+
+    bool write();
+
+  private:
+
+    FILE* open_source(int i) {
+      return fopen(get_path(this->pop_dir, source_file_name[i]).c_str(), "r");
+    }
+
+    // place reference for a person: a row in this directory, or an entry in the label table
+    int get_reference(row_map_t & rows, const char* label) {
+      if(label[0] == '\0' || strcmp(label, "X") == 0) {
+	return Population_Cache::NO_PLACE;
+      }
+      int row = get_row(rows, label);
+      if(row >= 0) {
+	return row;
+      }
+      row = get_row(this->label_row, label);
+      if(row < 0) {
+	Population_Cache::label_record_t record;
+	memset(&record, 0, sizeof(record));
+	if(copy_label(record.label, label, "people")) {
+	  row = this->labels.size();
+	  this->labels.push_back(record);
+	  this->label_row[label] = row;
+	} else {
+	  this->ok = false;
+	  return Population_Cache::NO_PLACE;
+	}
+      }
+      return Population_Cache::FIRST_LABEL - row;
+    }
+
+    bool read_households() {
+      char line[FRED_STRING_SIZE];
+      char label[FRED_STRING_SIZE];
+      long long int admin_code = 0;
+      double lat = 0;
+      double lon = 0;
+      double elevation = 0;
+      int race;
+      int income;
+
+      FILE* fp = open_source(Population_Cache::HOUSEHOLDS);
+      if(fp == NULL) {
+	fprintf(stderr, "population cache: can't open households.txt in %s\n", this->pop_dir);
+	return false;
+      }
+      fgets(label, FRED_STRING_SIZE, fp);
+      strcpy(line, "");
+      fgets(line, FRED_STRING_SIZE, fp);
+      int items = sscanf(line, "%s %lld %d %d %lf %lf %lf", label, &admin_code, &race, &income, &lat, &lon, &elevation);
+      while(6 <= items) {
+	Population_Cache::household_record_t record;
+	memset(&record, 0, sizeof(record));
+	if(copy_label(record.label, label, "households.txt") == false) {
+	  fclose(fp);
+	  return false;
+	}
+	record.admin_code = admin_code;
+	record.lat = lat;
+	record.lon = lon;
+	record.elevation = elevation;
+	record.race = race;
+	record.income = income;
+	if(get_row(this->household_row, label) < 0) {
+	  this->household_row[label] = this->households.size();
+	}
+	this->households.push_back(record);
+	strcpy(line, "");
+	fgets(line, FRED_STRING_SIZE, fp);
+	items = sscanf(line, "%s %lld %d %d %lf %lf %lf", label, &admin_code, &race, &income, &lat, &lon, &elevation);
+      }
+      fclose(fp);
+      return true;
+    }
+
+    bool read_schools() {
+      char line[FRED_STRING_SIZE];
+      char label[FRED_STRING_SIZE];
+      long long int admin_code = 0;
+      double lat;
+      double lon;
+      double elevation = 0;
+
+      FILE* fp = open_source(Population_Cache::SCHOOLS);
+      if(fp == NULL) {
+	return true;
+      }
+      fgets(label, FRED_STRING_SIZE, fp);
+      strcpy(line, "");
+      fgets(line, FRED_STRING_SIZE, fp);
+      int items = sscanf(line, "%s %lld %lf %lf %lf", label, &admin_code, &lat, &lon, &elevation);
+      while(4 <= items) {
+	Population_Cache::school_record_t record;
+	memset(&record, 0, sizeof(record));
+	if(copy_label(record.label, label, "schools.txt") == false) {
+	  fclose(fp);
+	  return false;
+	}
+	record.admin_code = admin_code;
+	record.lat = lat;
+	record.lon = lon;
+	record.elevation = elevation;
+	if(get_row(this->school_row, label) < 0) {
+	  this->school_row[label] = this->schools.size();
+	}
+	this->schools.push_back(record);
+	strcpy(line, "");
+	fgets(line, FRED_STRING_SIZE, fp);
+	items = sscanf(line, "%s %lld %lf %lf %lf", label, &admin_code, &lat, &lon, &elevation);
+      }
+      fclose(fp);
+      return true;
+    }
+
+    bool read_workplaces() {
+      char line[FRED_STRING_SIZE];
+      char label[FRED_STRING_SIZE];
+      double lat;
+      double lon;
+      double elevation = 0;
+
+      FILE* fp = open_source(Population_Cache::WORKPLACES);
+      if(fp == NULL) {
+	return true;
+      }
+      fgets(label, FRED_STRING_SIZE, fp);
+      strcpy(line, "");
+      fgets(line, FRED_STRING_SIZE, fp);
+      int items = sscanf(line, "%s %lf %lf %lf", label, &lat, &lon, &elevation);
+      while(3 <= items) {
+	Population_Cache::workplace_record_t record;
+	memset(&record, 0, sizeof(record));
+	if(copy_label(record.label, label, "workplaces.txt") == false) {
+	  fclose(fp);
+	  return false;
+	}
+	record.lat = lat;
+	record.lon = lon;
+	record.elevation = elevation;
+	if(get_row(this->workplace_row, label) < 0) {
+	  this->workplace_row[label] = this->workplaces.size();
+	}
+	this->workplaces.push_back(record);
+	strcpy(line, "");
+	fgets(line, FRED_STRING_SIZE, fp);
+	items = sscanf(line, "%s %lf %lf %lf", label, &lat, &lon, &elevation);
+      }
+      fclose(fp);
+      return true;
+    }
+
+    bool read_hospitals() {
+      char line[FRED_STRING_SIZE];
+      char label[FRED_STRING_SIZE];
+      double lat;
+      double lon;
+      double elevation = 0;
+      int workers;
+      int physicians;
+      int beds;
+
+      FILE* fp = open_source(Population_Cache::HOSPITALS);
+      if(fp == NULL) {
+	return true;
+      }
+      fgets(label, FRED_STRING_SIZE, fp);
+      strcpy(line, "");
+      fgets(line, FRED_STRING_SIZE, fp);
+      int items = sscanf(line, "%s %d %d %d %lf %lf %lf", label, &workers, &physicians, &beds, &lat, &lon, &elevation);
+      while(6 <= items) {
+	Population_Cache::hospital_record_t record;
+	memset(&record, 0, sizeof(record));
+	if(copy_label(record.label, label, "hospitals.txt") == false) {
+	  fclose(fp);
+	  return false;
+	}
+	record.lat = lat;
+	record.lon = lon;
+	record.elevation = elevation;
+	record.workers = workers;
+	record.physicians = physicians;
+	record.beds = beds;
+	this->hospitals.push_back(record);
+	strcpy(line, "");
+	fgets(line, FRED_STRING_SIZE, fp);
+	items = sscanf(line, "%s %d %d %d %lf %lf %lf", label, &workers, &physicians, &beds, &lat, &lon, &elevation);
+      }
+      fclose(fp);
+      return true;
+    }
+
+    bool read_group_quarters() {
+      char line[FRED_STRING_SIZE];
+      char id[FRED_STRING_SIZE];
+      char label[FRED_STRING_SIZE];
+      char gq_type;
+      long long int admin_code = 0;
+      double lat;
+      double lon;
+      double elevation = 0;
+      int capacity;
+
+      FILE* fp = open_source(Population_Cache::GROUP_QUARTERS);
+      if(fp == NULL) {
+	return true;
+      }
+      fgets(label, FRED_STRING_SIZE, fp);
+      strcpy(line, "");
+      fgets(line, FRED_STRING_SIZE, fp);
+      int items = sscanf(line, "%s %c %lld %d %lf %lf %lf", id, &gq_type, &admin_code, &capacity, &lat, &lon, &elevation);
+      while(6 <= items) {
+	Population_Cache::gq_record_t record;
+	memset(&record, 0, sizeof(record));
+	if(copy_label(record.label, id, "gq.txt") == false) {
+	  fclose(fp);
+	  return false;
+	}
+	record.gq_type = gq_type;
+	record.admin_code = admin_code;
+	record.capacity = capacity;
+	record.lat = lat;
+	record.lon = lon;
+	record.elevation = elevation;
+	if(get_row(this->gq_row, id) < 0) {
+	  this->gq_row[id] = this->gq.size();
+	}
+	this->gq.push_back(record);
+	strcpy(line, "");
+	fgets(line, FRED_STRING_SIZE, fp);
+	items = sscanf(line, "%s %c %lld %d %lf %lf %lf", id, &gq_type, &admin_code, &capacity, &lat, &lon, &elevation);
+      }
+      fclose(fp);
+      return true;
+    }
+
+    bool read_people(const char* file_name, bool gq) {
+      std::string path = get_path(this->pop_dir, file_name);
+      std::ifstream stream(path.c_str(), ifstream::in);
+      if(stream.good() == false) {
+	if(gq) {
+	  return true;
+	}
+	fprintf(stderr, "population cache: can't open %s\n", path.c_str());
+	return false;
+      }
+
+      char line[FRED_STRING_SIZE];
+      char label[FRED_STRING_SIZE];
+      char house_label[FRED_STRING_SIZE];
+      char school_label[FRED_STRING_SIZE];
+      char work_label[FRED_STRING_SIZE];
+      int age;
+      int race;
+      int relationship;
+      char sex;
+
+      this->ok = true;
+      stream.getline(line, FRED_STRING_SIZE);
+      while(stream.good()) {
+	stream.getline(line, FRED_STRING_SIZE);
+	if((line[0] == '\0') || strncmp(line, "sp_id", 6) == 0 || strncmp(line, "per_id", 7) == 0) {
+	  continue;
+	}
+	if(gq) {
+	  if(sscanf(line, "%s %s %d %c", label, house_label, &age, &sex) != 4) {
+	    fprintf(stderr, "population cache: can't convert line in %s: %s\n", file_name, line);
+	    return false;
+	  }
+	  Population_Cache::gq_person_record_t record;
+	  memset(&record, 0, sizeof(record));
+	  record.sp_id = atoll(label);
+	  record.age = age;
+	  record.sex = sex;
+	  record.gq = get_reference(this->gq_row, house_label);
+	  this->gq_people.push_back(record);
+	} else {
+	  if(sscanf(line, "%s %s %d %c %d %d %s %s", label, house_label, &age, &sex, &race, &relationship,
+		    school_label, work_label) != 8) {
+	    fprintf(stderr, "population cache: can't convert line in %s: %s\n", file_name, line);
+	    return false;
+	  }
+	  Population_Cache::person_record_t record;
+	  memset(&record, 0, sizeof(record));
+	  record.sp_id = atoll(label);
+	  record.age = age;
+	  record.sex = sex;
+	  record.race = race;
+	  record.relationship = relationship;
+	  record.house = get_reference(this->household_row, house_label);
+	  record.school = get_reference(this->school_row, school_label);
+	  record.work = get_reference(this->workplace_row, work_label);
+	  this->people.push_back(record);
+	}
+	if(this->ok == false) {
+	  return false;
+	}
+      }
+      return true;
+    }
+
+    template <typename T>
+    void add_section(header_t & header, int section, std::vector<T> & records, long long int & offset) {
+      header.section[section].offset = offset;
+      header.section[section].count = records.size();
+      header.section[section].record_size = sizeof(T);
+      offset += (long long int) sizeof(T) * records.size();
+      // keep every section 8-byte aligned
+      offset = (offset + 7) & ~7LL;
+    }
+
+    template <typename T>
+    bool write_section(FILE* fp, const header_t & header, int section, std::vector<T> & records) {
+      if(fseek(fp, header.section[section].offset, SEEK_SET) != 0) {
+	return false;
+      }
+      return records.empty() || fwrite(records.data(), sizeof(T), records.size(), fp) == records.size();
+    }
+
+    const char* pop_dir;
+    bool ok;
+    std::vector<Population_Cache::household_record_t> households;
+    std::vector<Population_Cache::school_record_t> schools;
+    std::vector<Population_Cache::workplace_record_t> workplaces;
+    std::vector<Population_Cache::hospital_record_t> hospitals;
+    std::vector<Population_Cache::gq_record_t> gq;
+    std::vector<Population_Cache::person_record_t> people;
+    std::vector<Population_Cache::gq_person_record_t> gq_people;
+    std::vector<Population_Cache::label_record_t> labels;
+    row_map_t household_row;
+    row_map_t school_row;
+    row_map_t workplace_row;
+    row_map_t gq_row;
+    row_map_t label_row;
+  };
+
+  bool Converter::write() {
+    header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cache_magic, sizeof(header.magic));
+    header.version = cache_version;
+    header.number_of_sections = Population_Cache::NUMBER_OF_SECTIONS;
+    for(int i = 0; i < Population_Cache::LABELS; ++i) {
+      header.source[i] = get_source(this->pop_dir, i);
+    }
+
+    long long int offset = (sizeof(header) + 7) & ~7LL;
+    add_section(header, Population_Cache::HOUSEHOLDS, this->households, offset);
+    add_section(header, Population_Cache::SCHOOLS, this->schools, offset);
+    add_section(header, Population_Cache::WORKPLACES, this->workplaces, offset);
+    add_section(header, Population_Cache::HOSPITALS, this->hospitals, offset);
+    add_section(header, Population_Cache::GROUP_QUARTERS, this->gq, offset);
+    add_section(header, Population_Cache::PEOPLE, this->people, offset);
+    add_section(header, Population_Cache::GQ_PEOPLE, this->gq_people, offset);
+    add_section(header, Population_Cache::LABELS, this->labels, offset);
+
+    // write to a temporary file and rename it, so a reader never sees a partial cache
+    std::string path = get_path(this->pop_dir, cache_file_name);
+    std::string tmp_path = path + ".tmp";
+    FILE* fp = fopen(tmp_path.c_str(), "wb");
+    if(fp == NULL) {
+      fprintf(stderr, "population cache: can't write %s\n", tmp_path.c_str());
+      return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+      && write_section(fp, header, Population_Cache::HOUSEHOLDS, this->households)
+      && write_section(fp, header, Population_Cache::SCHOOLS, this->schools)
+      && write_section(fp, header, Population_Cache::WORKPLACES, this->workplaces)
+      && write_section(fp, header, Population_Cache::HOSPITALS, this->hospitals)
+      && write_section(fp, header, Population_Cache::GROUP_QUARTERS, this->gq)
+      && write_section(fp, header, Population_Cache::PEOPLE, this->people)
+      && write_section(fp, header, Population_Cache::GQ_PEOPLE, this->gq_people)
+      && write_section(fp, header, Population_Cache::LABELS, this->labels);
+    // pad the file to the end of the last section
+    if(written && ftell(fp) < offset) {
+      written = fseek(fp, offset - 1, SEEK_SET) == 0 && fputc(0, fp) != EOF;
+    }
+    written = (fclose(fp) == 0) && written;
+    if(written == false || rename(tmp_path.c_str(), path.c_str()) != 0) {
+      fprintf(stderr, "population cache: error writing %s\n", path.c_str());
+      unlink(tmp_path.c_str());
+      return false;
+    }
+    printf("population cache: wrote %s: %d households %d schools %d workplaces %d hospitals %d gq %d people %d gq_people\n",
+	   path.c_str(), (int) this->households.size(), (int) this->schools.size(), (int) this->workplaces.size(),
+	   (int) this->hospitals.size(), (int) this->gq.size(), (int) this->people.size(), (int) this->gq_people.size());
+    return true;
+  }
+
+}
+
+bool Population_Cache::convert(const char* pop_dir) {
+  Converter converter(pop_dir);
+  return converter.read_all() && converter.write();
+}
+
+Population_Cache* Population_Cache::open(const char* pop_dir) {
+  std::string key(pop_dir);
+  std::map<std::string, Population_Cache*>::iterator itr = Population_Cache::cache_map.find(key);
+  if(itr != Population_Cache::cache_map.end()) {
+    return itr->second;
+  }
+
+  std::string path = get_path(pop_dir, cache_file_name);
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(header_t)) {
+    close(fd);
+    return NULL;
+  }
+  void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED) {
+    return NULL;
+  }
+
+  // check that the cache is readable by this build and up to date
+  const header_t* header = static_cast<const header_t*>(map);
+  const char* reason = NULL;
+  if(memcmp(header->magic, cache_magic, sizeof(cache_magic)) != 0) {
+    reason = "not a population cache";
+  } else if(header->version != cache_version || header->number_of_sections != NUMBER_OF_SECTIONS) {
+    reason = "wrong version";
+  } else {
+    for(int i = 0; reason == NULL && i < NUMBER_OF_SECTIONS; ++i) {
+      const section_entry_t & section = header->section[i];
+      if(section.record_size != expected_record_size[i] || section.count < 0 || section.offset < 0
+	 || section.offset + (long long int) section.count * section.record_size > (long long int) st.st_size) {
+	reason = "wrong record layout";
+      }
+    }
+    for(int i = 0; reason == NULL && i < LABELS; ++i) {
+      source_t source = get_source(pop_dir, i);
+      if(source.size != header->source[i].size || source.mtime != header->source[i].mtime) {
+	reason = "text files have changed";
+      }
+    }
+  }
+  if(reason != NULL) {
+    printf("population cache: ignoring %s: %s\n", path.c_str(), reason);
+    munmap(map, st.st_size);
+    return NULL;
+  }
+
+  Population_Cache* cache = new Population_Cache;
+  cache->data = static_cast<const char*>(map);
+  cache->size = st.st_size;
+  for(int i = 0; i < NUMBER_OF_SECTIONS; ++i) {
+    cache->count[i] = header->section[i].count;
+    cache->record_size[i] = header->section[i].record_size;
+    cache->offset[i] = header->section[i].offset;
+  }
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+  Population_Cache::cache_map[key] = cache;
+  printf("population cache: using %s\n", path.c_str());
+  return cache;
+}
+
+Population_Cache* Population_Cache::get_cache(const char* pop_dir) {
+  std::map<std::string, Population_Cache*>::iterator itr = Population_Cache::cache_map.find(std::string(pop_dir));
+  if(itr == Population_Cache::cache_map.end()) {
+    return NULL;
+  }
+  return itr->second;
+}
+
+const char* Population_Cache::get_reference_label(int section, int ref) {
+  if(ref <= FIRST_LABEL) {
+    return static_cast<const label_record_t*>(get_record(LABELS, FIRST_LABEL - ref))->label;
+  }
+  // the label field comes first in every place record
+  return static_cast<const char*>(get_record(section, ref));
+}
@@ -0,0 +1,210 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Population_Cache.h
+//
+
+#ifndef _FRED_POPULATION_CACHE_H
+#define _FRED_POPULATION_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Place;
+
+/**
+ * A binary copy of the synthetic population files in one population
+ * directory (households.txt, schools.txt, workplaces.txt, hospitals.txt,
+ * gq.txt, people.txt and gq_people.txt), written by the fred_cache_pop
+ * tool to population.bin in the same directory.
+ *
+ * The file holds fixed-size records that are used in place, through a
+ * read-only memory map.  Each section holds the records of one text
+ * file, in file order, with the fields exactly as FRED's text readers
+ * would parse them.  People refer to their places by the row of the
+ * place in this directory's files; a place that is not defined here is
+ * referred to through the label table and is looked up by label.
+ *
+ * The sizes and modification times of the text files are recorded in
+ * the header, and the cache is ignored if any of them has changed.
+ */
+
+#define POPULATION_CACHE_LABEL_SIZE 32
+
+class Population_Cache {
+public:
+
+  enum section_t {
+    HOUSEHOLDS,
+    SCHOOLS,
+    WORKPLACES,
+    HOSPITALS,
+    GROUP_QUARTERS,
+    PEOPLE,
+    GQ_PEOPLE,
+    LABELS,
+    NUMBER_OF_SECTIONS
+  };
+
+  // a place reference in a person record
+  enum {
+    NO_PLACE = -1,		// "X" in the text file
+    FIRST_LABEL = -2		// -2-k is entry k of the label table
+  };
+
+  typedef struct {
+    char label[POPULATION_CACHE_LABEL_SIZE];
+    long long int admin_code;
+    double lat;
+    double lon;
+    double elevation;
+    int race;
+    int income;
+  } household_record_t;
+
+  typedef struct {
+    char label[POPULATION_CACHE_LABEL_SIZE];
+    long long int admin_code;
+    double lat;
+    double lon;
+    double elevation;
+  } school_record_t;
+
+  typedef struct {
+    char label[POPULATION_CACHE_LABEL_SIZE];
+    double lat;
+    double lon;
+    double elevation;
+  } workplace_record_t;
+
+  typedef struct {
+    char label[POPULATION_CACHE_LABEL_SIZE];
+    double lat;
+    double lon;
+    double elevation;
+    int workers;
+    int physicians;
+    int beds;
+  } hospital_record_t;
+
+  typedef struct {
+    char label[POPULATION_CACHE_LABEL_SIZE];
+    long long int admin_code;
+    double lat;
+    double lon;
+    double elevation;
+    int capacity;
+    char gq_type;
+  } gq_record_t;
+
+  typedef struct {
+    long long int sp_id;
+    int age;
+    int race;
+    int relationship;
+    int house;
+    int school;
+    int work;
+    char sex;
+  } person_record_t;
+
+  typedef struct {
+    long long int sp_id;
+    int age;
+    int gq;
+    char sex;
+  } gq_person_record_t;
+
+  typedef struct {
+    char label[POPULATION_CACHE_LABEL_SIZE];
+  } label_record_t;
+
+  /**
+   * Convert the text files in pop_dir to pop_dir/population.bin.
+   * Returns false (after printing the reason) if the files can not
+   * be represented in the cache.
+   */
+  static bool convert(const char* pop_dir);
+
+  /**
+   * Map pop_dir/population.bin if it exists and matches the text files.
+   * Returns NULL otherwise.  The cache stays open for the rest of the
+   * run and can be found again with get_cache().
+   */
+  static Population_Cache* open(const char* pop_dir);
+  static Population_Cache* get_cache(const char* pop_dir);
+
+  int get_count(int section) {
+    return this->count[section];
+  }
+  const household_record_t* get_household(int i) {
+    return static_cast<const household_record_t*>(get_record(HOUSEHOLDS, i));
+  }
+  const school_record_t* get_school(int i) {
+    return static_cast<const school_record_t*>(get_record(SCHOOLS, i));
+  }
+  const workplace_record_t* get_workplace(int i) {
+    return static_cast<const workplace_record_t*>(get_record(WORKPLACES, i));
+  }
+  const hospital_record_t* get_hospital(int i) {
+    return static_cast<const hospital_record_t*>(get_record(HOSPITALS, i));
+  }
+  const gq_record_t* get_gq(int i) {
+    return static_cast<const gq_record_t*>(get_record(GROUP_QUARTERS, i));
+  }
+  const person_record_t* get_person(int i) {
+    return static_cast<const person_record_t*>(get_record(PEOPLE, i));
+  }
+  const gq_person_record_t* get_gq_person(int i) {
+    return static_cast<const gq_person_record_t*>(get_record(GQ_PEOPLE, i));
+  }
+
+  // the text label of a place reference that is not NO_PLACE
+  const char* get_reference_label(int section, int ref);
+
+  // places created from each row, filled in by the place readers
+  std::vector<Place*> household_place;
+  std::vector<Place*> school_place;
+  std::vector<Place*> workplace_place;
+  std::vector<Place*> gq_household_place;
+  std::vector<Place*> gq_workplace_place;
+
+private:
+  Population_Cache() {}
+
+  const void* get_record(int section, int i) {
+    return this->data + this->offset[section] + (size_t) i * this->record_size[section];
+  }
+
+  const char* data;
+  size_t size;
+  int count[NUMBER_OF_SECTIONS];
+  int record_size[NUMBER_OF_SECTIONS];
+  size_t offset[NUMBER_OF_SECTIONS];
+
+  static std::map<std::string, Population_Cache*> cache_map;
+};
+
+#endif // _FRED_POPULATION_CACHE_H
@@ -0,0 +1,348 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Population_Snapshot.cc
+//
+
+#include "Population_Snapshot.h"
+
+static const char snapshot_magic[8] = { 'F', 'R', 'E', 'D', 'P', 'O', 'P', '1' };
+
+Block_Writer Population_Snapshot::writer;
+bool Population_Snapshot::deltas = false;
+std::vector<int> Population_Snapshot::kinds;
+int Population_Snapshot::day = 0;
+string Population_Snapshot::date = "";
+int Population_Snapshot::people = 0;
+std::vector<int64_t> Population_Snapshot::table;
+int Population_Snapshot::new_labels = 0;
+string Population_Snapshot::label_data = "";
+std::vector<bool> Population_Snapshot::labeled;
+std::vector<std::vector<int64_t> > Population_Snapshot::base;
+std::vector<int> Population_Snapshot::seen;
+int Population_Snapshot::snapshots = 0;
+
+namespace {
+
+  bool read_data(FILE* fp, void* data, size_t size) {
+    return size == 0 || fread(data, size, 1, fp) == 1;
+  }
+
+  bool get_data(const unsigned char* & p, const unsigned char* end, void* data, size_t size) {
+    if(end - p < size) {
+      return false;
+    }
+    memcpy(data, p, size);
+    p += size;
+    return true;
+  }
+
+  bool get_name(const unsigned char* & p, const unsigned char* end, string* name) {
+    uint32_t length;
+    if(get_data(p, end, &length, sizeof(length)) == false || end - p < length) {
+      return false;
+    }
+    name->assign(reinterpret_cast<const char*>(p), length);
+    p += length;
+    return true;
+  }
+
+  // combine a stored difference with the base value of a column
+  int64_t apply_difference(int kind, int64_t base, int64_t difference) {
+    if(kind == Population_Snapshot::REAL) {
+      return base ^ difference;
+    }
+    return base + difference;
+  }
+}
+
+bool Population_Snapshot::open(const char* filename, const std::vector<string> & names,
+			       const std::vector<int> & kinds, bool deltas) {
+  close();
+  if(Population_Snapshot::writer.open(filename) == false) {
+    return false;
+  }
+  Population_Snapshot::deltas = deltas;
+  Population_Snapshot::kinds = kinds;
+  Population_Snapshot::labeled.clear();
+  Population_Snapshot::base.clear();
+  Population_Snapshot::base.resize(kinds.size());
+  Population_Snapshot::seen.clear();
+  Population_Snapshot::snapshots = 0;
+
+  string* block = Population_Snapshot::writer.get_block(1024);
+  block->append(snapshot_magic, sizeof(snapshot_magic));
+  put_u32(block, names.size());
+  for(int c = 0; c < names.size(); ++c) {
+    put_u32(block, kinds[c]);
+    put_name(block, names[c]);
+  }
+  Population_Snapshot::writer.write(block);
+  return true;
+}
+
+void Population_Snapshot::close() {
+  Population_Snapshot::writer.close();
+}
+
+int64_t* Population_Snapshot::start(int day, const string & date, int people) {
+  Population_Snapshot::day = day;
+  Population_Snapshot::date = date;
+  Population_Snapshot::people = people;
+  Population_Snapshot::table.resize(Population_Snapshot::kinds.size() * people);
+  Population_Snapshot::new_labels = 0;
+  Population_Snapshot::label_data.clear();
+  return Population_Snapshot::table.data();
+}
+
+void Population_Snapshot::set_label(int place_id, const char* label) {
+  if(Population_Snapshot::labeled.size() <= place_id) {
+    Population_Snapshot::labeled.resize(place_id + 1, false);
+  }
+  Population_Snapshot::labeled[place_id] = true;
+  int32_t id = place_id;
+  Population_Snapshot::label_data.append(reinterpret_cast<const char*>(&id), sizeof(id));
+  put_name(&Population_Snapshot::label_data, label);
+  ++Population_Snapshot::new_labels;
+}
+
+void Population_Snapshot::finish() {
+  int columns = Population_Snapshot::kinds.size();
+  int people = Population_Snapshot::people;
+  const int64_t* table = Population_Snapshot::table.data();
+  bool delta = Population_Snapshot::deltas && Population_Snapshot::snapshots > 0;
+
+  string* block = Population_Snapshot::writer.get_block(people + Population_Snapshot::label_data.size() + 64);
+  put_u32(block, 0);
+  int32_t header[3] = { Population_Snapshot::day, delta, people };
+  block->append(reinterpret_cast<const char*>(header), sizeof(header));
+  put_name(block, Population_Snapshot::date);
+  put_u32(block, Population_Snapshot::new_labels);
+  block->append(Population_Snapshot::label_data);
+
+  // the largest id sizes the base values
+  int64_t previous = 0;
+  int max_id = -1;
+  for(int r = 0; r < people; ++r) {
+    Block_Writer::put_varint(block, table[r] - previous);
+    previous = table[r];
+    if(max_id < table[r]) {
+      max_id = table[r];
+    }
+  }
+  if(Population_Snapshot::deltas && Population_Snapshot::seen.size() <= max_id) {
+    Population_Snapshot::seen.resize(max_id + 1, -1);
+    for(int c = 1; c < columns; ++c) {
+      Population_Snapshot::base[c].resize(max_id + 1, 0);
+    }
+  }
+
+  for(int c = 1; c < columns; ++c) {
+    int kind = Population_Snapshot::kinds[c];
+    const int64_t* column = table + c * people;
+    int64_t* base = Population_Snapshot::base[c].data();
+    int skip = 0;
+    for(int r = 0; r < people; ++r) {
+      int64_t value = r > 0 ? column[r - 1] : 0;
+      if(delta) {
+	int id = table[r];
+	if(Population_Snapshot::seen[id] == Population_Snapshot::snapshots - 1) {
+	  value = base[id];
+	}
+      }
+      int64_t difference = kind == REAL ? column[r] ^ value : column[r] - value;
+      if(difference == 0) {
+	++skip;
+      }
+      else {
+	Block_Writer::put_varint(block, skip);
+	Block_Writer::put_varint(block, difference);
+	skip = 0;
+      }
+    }
+    if(skip > 0) {
+      Block_Writer::put_varint(block, skip);
+    }
+  }
+
+  // this snapshot is the base of the next
+  if(Population_Snapshot::deltas) {
+    for(int r = 0; r < people; ++r) {
+      int id = table[r];
+      Population_Snapshot::seen[id] = Population_Snapshot::snapshots;
+      for(int c = 1; c < columns; ++c) {
+	Population_Snapshot::base[c][id] = table[c * people + r];
+      }
+    }
+  }
+  ++Population_Snapshot::snapshots;
+
+  uint32_t length = block->size() - sizeof(uint32_t);
+  memcpy(&(*block)[0], &length, sizeof(length));
+  Population_Snapshot::writer.write(block);
+}
+
+bool Population_Snapshot::open_reader(const char* filename, reader_t* reader) {
+  reader->fp = fopen(filename, "rb");
+  if(reader->fp == NULL) {
+    return false;
+  }
+  char magic[sizeof(snapshot_magic)];
+  uint32_t columns;
+  if(read_data(reader->fp, magic, sizeof(magic)) == false
+     || memcmp(magic, snapshot_magic, sizeof(magic)) != 0
+     || read_data(reader->fp, &columns, sizeof(columns)) == false) {
+    close_reader(reader);
+    return false;
+  }
+  reader->names.clear();
+  reader->kinds.clear();
+  for(uint32_t c = 0; c < columns; ++c) {
+    uint32_t kind;
+    uint32_t length;
+    if(read_data(reader->fp, &kind, sizeof(kind)) == false
+       || read_data(reader->fp, &length, sizeof(length)) == false) {
+      close_reader(reader);
+      return false;
+    }
+    string name(length, '\0');
+    if(read_data(reader->fp, &name[0], length) == false) {
+      close_reader(reader);
+      return false;
+    }
+    reader->kinds.push_back(kind);
+    reader->names.push_back(name);
+  }
+  reader->labels.clear();
+  reader->base.clear();
+  reader->base.resize(columns);
+  reader->seen.clear();
+  reader->snapshots = 0;
+  return true;
+}
+
+bool Population_Snapshot::read(reader_t* reader) {
+  uint32_t length;
+  if(read_data(reader->fp, &length, sizeof(length)) == false) {
+    return false;
+  }
+  std::vector<unsigned char> data(length);
+  if(read_data(reader->fp, data.data(), length) == false) {
+    return false;
+  }
+  const unsigned char* p = data.data();
+  const unsigned char* end = p + data.size();
+
+  int32_t header[3];
+  uint32_t new_labels;
+  if(get_data(p, end, header, sizeof(header)) == false
+     || get_name(p, end, &reader->date) == false
+     || get_data(p, end, &new_labels, sizeof(new_labels)) == false) {
+    return false;
+  }
+  reader->day = header[0];
+  reader->delta = header[1];
+  reader->people = header[2];
+  for(uint32_t i = 0; i < new_labels; ++i) {
+    int32_t id;
+    string label;
+    if(get_data(p, end, &id, sizeof(id)) == false || get_name(p, end, &label) == false) {
+      return false;
+    }
+    if(reader->labels.size() <= id) {
+      reader->labels.resize(id + 1, "-1");
+    }
+    reader->labels[id] = label;
+  }
+
+  int columns = reader->kinds.size();
+  int people = reader->people;
+  reader->table.assign(columns * people, 0);
+  int64_t* table = reader->table.data();
+  int64_t value = 0;
+  int max_id = -1;
+  for(int r = 0; r < people; ++r) {
+    int64_t difference;
+    if(Block_Writer::get_varint(p, end, &difference) == false) {
+      return false;
+    }
+    value += difference;
+    table[r] = value;
+    if(max_id < value) {
+      max_id = value;
+    }
+  }
+  if(reader->seen.size() <= max_id) {
+    reader->seen.resize(max_id + 1, -1);
+    for(int c = 1; c < columns; ++c) {
+      reader->base[c].resize(max_id + 1, 0);
+    }
+  }
+
+  for(int c = 1; c < columns; ++c) {
+    int64_t* column = table + c * people;
+    int r = 0;
+    while(r < people) {
+      int64_t skip;
+      int64_t difference;
+      if(Block_Writer::get_varint(p, end, &skip) == false) {
+	return false;
+      }
+      r += skip;
+      if(r >= people) {
+	break;
+      }
+      if(Block_Writer::get_varint(p, end, &difference) == false) {
+	return false;
+      }
+      column[r] = difference;
+      ++r;
+    }
+    for(r = 0; r < people; ++r) {
+      int64_t value = r > 0 ? column[r - 1] : 0;
+      if(reader->delta) {
+	int id = table[r];
+	if(reader->seen[id] == reader->snapshots - 1) {
+	  value = reader->base[c][id];
+	}
+      }
+      column[r] = apply_difference(reader->kinds[c], value, column[r]);
+    }
+  }
+
+  for(int r = 0; r < people; ++r) {
+    int id = table[r];
+    reader->seen[id] = reader->snapshots;
+    for(int c = 1; c < columns; ++c) {
+      reader->base[c][id] = table[c * people + r];
+    }
+  }
+  ++reader->snapshots;
+  return true;
+}
+
+void Population_Snapshot::close_reader(reader_t* reader) {
+  if(reader->fp != NULL) {
+    fclose(reader->fp);
+    reader->fp = NULL;
+  }
+}
@@ -0,0 +1,158 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Population_Snapshot.h
+//
+
+#ifndef _FRED_POPULATION_SNAPSHOT_H
+#define _FRED_POPULATION_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "Block_Writer.h"
+
+using namespace std;
+
+/**
+ * Binary snapshots of the population, written to RUNn/<pop_outfile>.bin
+ * when output_population_binary is set, and read by the fred_population
+ * tool.
+ *
+ * A snapshot is a table with one row per person and one column for
+ * each field; the first column is the person id.  The file starts with
+ * the magic "FREDPOP1" and the columns (uint32 count, then uint32 kind
+ * and name for each).  Each snapshot is then a block:
+ *
+ *   uint32 length of the rest of the block
+ *   int32 day, int32 delta, int32 people, date
+ *   uint32 count, then int32 place id and label of each new place label
+ *   the columns, as zigzag varints
+ *
+ * The ids are stored as differences from the previous row.  In the other
+ * columns each value is compared to a base value: the person's value in
+ * the previous snapshot if delta is set and the person was in it, and
+ * otherwise the value in the previous row (people of a household are
+ * adjacent).  The difference (or, for REAL columns, the xor of the bits)
+ * is stored as the number of rows since the last nonzero difference
+ * followed by the difference, so unchanged values cost nothing.  Names
+ * are a uint32 length followed by the characters.
+ */
+class Population_Snapshot {
+public:
+
+  // kinds of columns
+  enum { INTEGER, CHARACTER, PLACE, REAL };
+
+  // open the file and write the columns; with deltas, each snapshot
+  // after the first is stored relative to the one before it
+  static bool open(const char* filename, const std::vector<string> & names,
+		   const std::vector<int> & kinds, bool deltas);
+  static void close();
+
+  static bool is_open() {
+    return Population_Snapshot::writer.is_open();
+  }
+
+  // the table of a new snapshot: column c of row r is at
+  // table[c * people + r]
+  static int64_t* start(int day, const string & date, int people);
+
+  // place labels are written once, before the first snapshot that uses them
+  static bool has_label(int place_id) {
+    return place_id < Population_Snapshot::labeled.size() && Population_Snapshot::labeled[place_id];
+  }
+  static void set_label(int place_id, const char* label);
+
+  // encode the snapshot and queue it for writing
+  static void finish();
+
+  static int64_t from_real(double value) {
+    int64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  static double to_real(int64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  // reading a snapshot file
+  typedef struct {
+    FILE* fp;
+    std::vector<string> names;
+    std::vector<int> kinds;
+    std::vector<string> labels;  // by place id
+    std::vector<std::vector<int64_t> > base;  // by column and person id
+    std::vector<int> seen;       // last snapshot that held each person id
+    int snapshots;
+
+    // the snapshot just read
+    int day;
+    string date;
+    bool delta;
+    int people;
+    std::vector<int64_t> table;
+  } reader_t;
+
+  // read the columns; returns false if the file is not a snapshot file
+  static bool open_reader(const char* filename, reader_t* reader);
+
+  // read the next snapshot; returns false at the end of the file
+  static bool read(reader_t* reader);
+
+  static void close_reader(reader_t* reader);
+
+private:
+  static void put_u32(string* block, uint32_t value) {
+    block->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  static void put_name(string* block, const string & name) {
+    put_u32(block, name.size());
+    block->append(name);
+  }
+
+  static Block_Writer writer;
+  static bool deltas;
+  static std::vector<int> kinds;
+
+  // the snapshot being written
+  static int day;
+  static string date;
+  static int people;
+  static std::vector<int64_t> table;
+  static int new_labels;
+  static string label_data;
+
+  // what earlier snapshots wrote
+  static std::vector<bool> labeled;
+  static std::vector<std::vector<int64_t> > base;
+  static std::vector<int> seen;
+  static int snapshots;
+};
+
+#endif // _FRED_POPULATION_SNAPSHOT_H
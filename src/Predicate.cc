@@ -159,6 +159,13 @@ bool Predicate::get_value(Person* person, Person* other) {
 }
   
 
+// true unless the value can be changed by other agents' actions, as
+// when a group is closed
+bool Predicate::is_local() {
+  return (this->func != &is_open && this->func != &is_at);
+}
+
+
 bool Predicate::parse() {
 
   // printf("RULE PREDICATE: parsing predicate |%s|\n", this->name.c_str()); fflush(stdout);
@@ -514,14 +521,14 @@ bool Predicate::is_open(Person* person, int condition_id, int group_type_id) {
 }
 
 bool Predicate::was_exposed_in(Person* person, int condition_id, int group_type_id) {
-  if (group_type_id == Group_Type::get_type_id("School")) {
-    return person->get_exposure_group_type_id(condition_id)==Group_Type::get_type_id("School")
-      || person->get_exposure_group_type_id(condition_id)==Group_Type::get_type_id("Classroom");
+  if (group_type_id == Place_Type::SCHOOL) {
+    return person->get_exposure_group_type_id(condition_id)==Place_Type::SCHOOL
+      || person->get_exposure_group_type_id(condition_id)==Place_Type::CLASSROOM;
   }
   else {
-    if (group_type_id == Group_Type::get_type_id("Workplace")) {
-      return person->get_exposure_group_type_id(condition_id)==Group_Type::get_type_id("Workplace")
-	|| person->get_exposure_group_type_id(condition_id)==Group_Type::get_type_id("Office");
+    if (group_type_id == Place_Type::WORKPLACE) {
+      return person->get_exposure_group_type_id(condition_id)==Place_Type::WORKPLACE
+	|| person->get_exposure_group_type_id(condition_id)==Place_Type::OFFICE;
     }
     else {
       return (group_type_id == person->get_exposure_group_type_id(condition_id));
@@ -35,6 +35,7 @@ typedef bool (*fptr) (Person*,int,int);
 
 
 class Predicate {
+  friend class Bytecode;
 public:
 
   Predicate(string s);
@@ -43,6 +44,7 @@ public:
   }
   bool get_value(Person* person1, Person* person2 = NULL);
   bool parse();
+  bool is_local();
   bool is_warning() {
     return this->warning;
   }
@@ -23,7 +23,7 @@
 // File: Preference.cc
 //
 
-#include <unordered_set>
+#include <algorithm>
 #include "Global.h"
 #include "Expression.h"
 #include "Preference.h"
@@ -32,6 +32,9 @@
 
 Preference::Preference() {
   this->expressions.clear();
+  this->weight_person = NULL;
+  this->weight_step = -1;
+  this->cdf_is_current = false;
 }
 
 Preference::~Preference() {
@@ -70,6 +73,29 @@ void Preference::add_preference_expressions(string expr_str) {
   }
 }
 
+/*
+ * Evaluate the preference for each candidate.  With
+ * enable_preference_weight_reuse, the weights are kept when the same
+ * person chooses again from the same pool in the same step.
+ */
+void Preference::compute_weights(Person* person, person_vector_t &people) {
+  if (Global::Enable_Preference_Weight_Reuse) {
+    if (person == this->weight_person && Global::Simulation_Step == this->weight_step
+	&& people == this->weight_people) {
+      return;
+    }
+    this->weight_person = person;
+    this->weight_step = Global::Simulation_Step;
+    this->weight_people = people;
+  }
+  int psize = people.size();
+  this->weight.resize(psize);
+  for (int i = 0; i < psize; i++) {
+    this->weight[i] = get_value(person, people[i]);
+  }
+  this->cdf_is_current = false;
+}
+
 Person* Preference::select_person(Person* person, person_vector_t &people) {
   
   FRED_VERBOSE(1, "select_person entered for person %d age %d sex %c people size %d\n",
@@ -81,46 +107,97 @@ Person* Preference::select_person(Person* person, person_vector_t &people) {
   }
 
   // create a cdf based on preference values
-  double cdf [ psize ];
+  compute_weights(person, people);
+  if (this->cdf_is_current == false) {
+    double total = 0.0;
+    for (int i = 0; i < psize; i++) {
+      total += this->weight[i];
+    }
+    this->cdf.resize(psize);
+    for (int i = 0; i < psize; i++) {
+      this->cdf[i] = (total > 0) ? this->weight[i] / total : 1.0 / psize;
+      if (i > 0) {
+	this->cdf[i] += this->cdf[i-1];
+      }
+    }
+    this->cdf_is_current = true;
+  }
+
+  // select the first entry with r <= cdf
+  double r = Random::draw_random();
+  int p = std::lower_bound(this->cdf.begin(), this->cdf.end(), r) - this->cdf.begin();
+  if (p == psize) {
+    p = psize-1;
+  }
+  return people[p];
+}
+
+/*
+ * Weighted sampling without replacement.  The remaining weights are kept
+ * in a Fenwick tree, so each draw and each removal takes O(log n).
+ */
+void Preference::select_people(Person* person, person_vector_t &people, int k, person_vector_t &selected) {
+  selected.clear();
+  int psize = people.size();
+  if (psize==0 || k <= 0) {
+    return;
+  }
+  compute_weights(person, people);
+
+  // tree[i] holds the sum of weights (i - lowbit(i), i]
+  this->tree.assign(psize + 1, 0.0);
   double total = 0.0;
-  for (int i = 0; i < psize; i++) {
-    cdf[i] = get_value(person, people[i]);
-    total += cdf[i];
+  for (int i = 1; i <= psize; i++) {
+    this->tree[i] += this->weight[i-1];
+    total += this->weight[i-1];
+    int parent = i + (i & -i);
+    if (parent <= psize) {
+      this->tree[parent] += this->tree[i];
+    }
+  }
+  int top = 1;
+  while (2 * top <= psize) {
+    top *= 2;
   }
 
-  // create a cumulative density distribution
-  for (int i = 0; i < psize; i++) {
-    if (total > 0) {
-      cdf[i] /= total;
+  int draws = std::min(k, psize);
+  for (int j = 0; j < draws; j++) {
+    // find the first entry whose cumulative weight exceeds r
+    double r = Random::draw_random() * total;
+    int pos = 0;
+    for (int step = top; step > 0; step /= 2) {
+      if (pos + step <= psize && this->tree[pos + step] <= r) {
+	pos += step;
+	r -= this->tree[pos];
+      }
     }
-    else {
-      cdf[i] = 1.0 / psize;
+    if (pos == psize) {
+      pos = psize - 1;
     }
-    if (i > 0) {
-      cdf[i] += cdf[i-1];
+    // rounding can land on an entry already drawn
+    while (0 < pos && this->weight[pos] == 0.0) {
+      pos--;
     }
-    // printf("cdf[%d] = %f\n", i, cdf[i]);
-  }
-
-  // select
-  double r = Random::draw_random();
-  int p;
-  for (p = 0; p < psize; p++) {
-    if (r <= cdf[p]) {
+    while (pos < psize && this->weight[pos] == 0.0) {
+      pos++;
+    }
+    if (pos == psize) {
       break;
     }
+    selected.push_back(people[pos]);
+
+    // remove the entry
+    double w = this->weight[pos];
+    total -= w;
+    for (int i = pos + 1; i <= psize; i += (i & -i)) {
+      this->tree[i] -= w;
+    }
+    this->weight[pos] = 0.0;
   }
-  if (p == psize) {
-    p = psize-1;
-  }
-  Person* other = people[p];
-  /*
-  printf("SELECT person %d age %f sex %c other person %d age %f sex %c value %f\n\n", 
-	 person->get_id(), person->get_real_age(), person->get_sex(),
-	 other->get_id(), other->get_real_age(), other->get_sex(), 
-	 p ? total*(cdf[p]-cdf[p-1]) : total*cdf[p]);
-  */
-  return other;
+
+  // the weights were used up
+  this->weight_person = NULL;
+  this->cdf_is_current = false;
 }
 
 double Preference::get_value(Person* person, Person* other) {
@@ -37,10 +37,26 @@ public:
   void add_preference_expressions(string expr_str);
   Person* select_person(Person* person, person_vector_t &people);
 
+  // draw up to k different people, in the order drawn
+  void select_people(Person* person, person_vector_t &people, int k, person_vector_t &selected);
+
 private:
   expression_vector_t expressions;
   double get_value(Person* person, Person* other);
+  void compute_weights(Person* person, person_vector_t &people);
   string get_name();
+
+  // scratch space kept between calls
+  std::vector<double> weight;
+  std::vector<double> cdf;
+  std::vector<double> tree;
+
+  // the chooser, step and pool the weights were computed for, when
+  // enable_preference_weight_reuse is set
+  Person* weight_person;
+  int weight_step;
+  person_vector_t weight_people;
+  bool cdf_is_current;
 };
 
 #endif // _FRED_PREFERENCE_H
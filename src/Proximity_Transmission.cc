@@ -199,3 +199,127 @@ void Proximity_Transmission::transmission(int day, int hour, int condition_id, G
 }
 
 
+
+
+/////////////////////////////////////////
+//
+// PARALLEL TRANSMISSION
+//
+/////////////////////////////////////////
+
+// hosts exposed earlier in this place are no longer susceptible
+static bool is_already_exposed(exposure_vector_t* exposures, Person* host, int condition_to_transmit) {
+  for(int i = 0; i < exposures->size(); ++i) {
+    if((*exposures)[i].host == host && (*exposures)[i].condition_to_transmit == condition_to_transmit) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// This follows the same contact process as transmission(), but draws
+// from the place's own random stream and only records the resulting
+// exposures, leaving shared state untouched so that many places can be
+// processed concurrently.  The caller commits the exposures afterwards
+// in a fixed order (see Epidemic::transmission_in_active_places()).
+
+void Proximity_Transmission::select_exposures(int day, int hour, int condition_id, Place* place, int time_block,
+					      person_vector_t* susceptibles, Stream_RNG* rng, exposure_vector_t* exposures) {
+
+  FRED_VERBOSE(1, "select_exposures day %d condition %d place %d %s\n",
+	       day, condition_id, place->get_id(), place->get_label());
+
+  Condition* condition = Condition::get_condition(condition_id);
+  double beta = condition->get_transmissibility();
+  if(beta == 0.0) {
+    return;
+  }
+
+  // have place record first and last day of possible transmission
+  place->record_transmissible_days(day, condition_id);
+
+  // need at least one susceptible present; the place's stream is its
+  // own, so skipping it leaves every other place's draws unchanged
+  if(susceptibles->empty()) {
+    return;
+  }
+
+  person_vector_t* transmissibles = place->get_transmissible_people(condition_id);
+  int number_of_transmissibles = transmissibles->size();
+
+  // place-specific contact rate, scaled by transmissibility and time_block
+  double contact_rate = place->get_proximity_contact_rate() * beta * time_block;
+
+  // randomize the order of processing the transmissible list
+  std::vector<int> shuffle_index;
+  shuffle_index.reserve(number_of_transmissibles);
+  for(int i = 0; i < number_of_transmissibles; ++i) {
+    shuffle_index.push_back(i);
+  }
+  for(int m = number_of_transmissibles; m > 0; ) {
+    int pos = (int) (rng->random() * number_of_transmissibles);
+    m--;
+    std::swap(shuffle_index[m], shuffle_index[pos]);
+  }
+
+  for(int n = 0; n < number_of_transmissibles; ++n) {
+    Person* source = (*transmissibles)[shuffle_index[n]];
+    if(source->is_transmissible(condition_id) == false) {
+      continue;
+    }
+
+    // get the actual number of contacts to attempt to infect
+    double real_contacts = contact_rate * source->get_transmissibility(condition_id);
+    int contact_count = real_contacts;
+    if(rng->random() < real_contacts - contact_count) {
+      contact_count++;
+    }
+    if (contact_count == 0) {
+      continue;
+    }
+
+    int condition_to_transmit = condition->get_condition_to_transmit(source->get_state(condition_id));
+
+    // get a target for each contact attempt (with replacement)
+    int count = 0;
+    while (count < contact_count) {
+      Person* host = place->get_member(rng->random_int(0, place->get_size() - 1));
+      if(source == host) {
+	if (place->get_size() > 1) {
+	  continue; // try again
+	}
+	else {
+	  break; // give up
+	}
+      }
+      count++;
+
+      // activities were updated by the caller before the parallel phase
+      if(!host->is_present(day, place)) {
+	continue;
+      }
+
+      double transmission_prob = 1.0;
+      if(Global::Enable_Transmission_Bias) {
+	double diff = fabs(host->get_real_age() - source->get_real_age());
+	transmission_prob = exp(-place->get_proximity_same_age_bias() * diff);
+      }
+
+      if(host->is_susceptible(condition_to_transmit)==false) {
+	continue;
+      }
+      if(is_already_exposed(exposures, host, condition_to_transmit)) {
+	continue;
+      }
+
+      double infection_prob = transmission_prob * host->get_susceptibility(condition_to_transmit);
+      if(rng->random() < infection_prob) {
+	exposure_t exposure = { source, host, condition_id, condition_to_transmit, place };
+	exposures->push_back(exposure);
+      }
+    } // end contact loop
+  } // end transmissible list loop
+
+  FRED_VERBOSE(1, "select_exposures finished day %d condition %d place %d %s exposures %d\n",
+	       day, condition_id, place->get_id(), place->get_label(), (int) exposures->size());
+}
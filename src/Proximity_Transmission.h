@@ -26,9 +26,11 @@
 #ifndef _FRED_PROXIMITY_TRANSMISSION_H
 #define _FRED_PROXIMITY_TRANSMISSION_H
 
+#include "Global.h"
 #include "Transmission.h"
 class Condition;
 class Group;
+class Stream_RNG;
 
 class Proximity_Transmission : public Transmission {
 
@@ -38,6 +40,8 @@ public:
   ~Proximity_Transmission();
   void setup(Condition* condition);
   void transmission(int day, int hour, int condition_id, Group* group, int time_block);
+  void select_exposures(int day, int hour, int condition_id, Place* place, int time_block,
+			person_vector_t* susceptibles, Stream_RNG* rng, exposure_vector_t* exposures);
 
 };
 
@@ -25,14 +25,17 @@
 #include "Random.h"
 #include <stdio.h>
 #include <float.h>
+#include <sstream>
 
 Thread_RNG Random::Random_Number_Generator;
 
 Thread_RNG::Thread_RNG() {
   thread_rng = new RNG [fred::omp_get_max_threads()];
+  seed = 0;
 }
 
 void Thread_RNG::set_seed(unsigned long metaseed) {
+  seed = metaseed;
   std::mt19937_64 seed_generator;
   seed_generator.seed(metaseed);
   for(int t = 0; t < fred::omp_get_max_threads(); ++t) {
@@ -46,6 +49,58 @@ void RNG::set_seed(unsigned long seed) {
   mt_engine.seed(seed);
 }
 
+// the normal distribution caches its second value, so it is saved too
+std::string RNG::get_state() {
+  std::ostringstream state;
+  state << mt_engine << " " << normal_dist;
+  return state.str();
+}
+
+bool RNG::set_state(const std::string & state) {
+  std::istringstream in(state);
+  in >> mt_engine >> normal_dist;
+  return !in.fail();
+}
+
+// one line with the seed and the number of threads, then one line per thread
+std::string Thread_RNG::get_state() {
+  std::ostringstream state;
+  state << seed << " " << fred::omp_get_max_threads() << "\n";
+  for(int t = 0; t < fred::omp_get_max_threads(); ++t) {
+    state << thread_rng[t].get_state() << "\n";
+  }
+  return state.str();
+}
+
+bool Thread_RNG::set_state(const std::string & state) {
+  std::istringstream in(state);
+  unsigned long saved_seed;
+  int threads;
+  in >> saved_seed >> threads;
+  if(in.fail() || threads != fred::omp_get_max_threads()) {
+    return false;
+  }
+  std::string line;
+  std::getline(in, line);
+  for(int t = 0; t < threads; ++t) {
+    if(!std::getline(in, line) || !thread_rng[t].set_state(line)) {
+      return false;
+    }
+  }
+  seed = saved_seed;
+  return true;
+}
+
+void Stream_RNG::set_key(unsigned long seed, int day, int hour, int condition_id, int group_id) {
+  uint64_t k = mix(seed + 0x9e3779b97f4a7c15ULL);
+  k = mix(k ^ (uint64_t) (uint32_t) day);
+  k = mix(k ^ (uint64_t) (uint32_t) hour);
+  k = mix(k ^ (uint64_t) (uint32_t) condition_id);
+  k = mix(k ^ (uint64_t) (uint32_t) group_id);
+  this->key = k;
+  this->counter = 0;
+}
+
 int RNG::draw_from_distribution(int n, double* dist) {
   double r = random();
   int i = 0;
@@ -178,4 +233,97 @@ void RNG::sample_range_without_replacement(int N, int s, int* result) {
   }
 }
 
+void Alias_Table::setup(const std::vector<double> & weights) {
+  int n = weights.size();
+  this->table.clear();
+  if(n == 0) {
+    return;
+  }
+  double total = 0.0;
+  for(int i = 0; i < n; ++i) {
+    total += weights[i];
+  }
+  assert(total > 0.0);
 
+  // scale so that the average column holds 1.0, then fill each short
+  // column with mass taken from a long one
+  std::vector<double> scaled(n);
+  std::vector<int> small;
+  std::vector<int> large;
+  for(int i = 0; i < n; ++i) {
+    scaled[i] = weights[i] * n / total;
+    if(scaled[i] < 1.0) {
+      small.push_back(i);
+    } else {
+      large.push_back(i);
+    }
+  }
+  this->table.resize(n);
+  while(!small.empty() && !large.empty()) {
+    int s = small.back();
+    small.pop_back();
+    int l = large.back();
+    this->table[s].prob = scaled[s];
+    this->table[s].alias = l;
+    scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+    if(scaled[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+
+  // anything left over is full up to rounding error
+  for(int k = 0; k < large.size(); ++k) {
+    this->table[large[k]].prob = 1.0;
+    this->table[large[k]].alias = large[k];
+  }
+  for(int k = 0; k < small.size(); ++k) {
+    this->table[small[k]].prob = 1.0;
+    this->table[small[k]].alias = small[k];
+  }
+}
+
+void Alias_Table::setup_from_cdf(const double* cdf, int n) {
+  std::vector<double> weights(n);
+  for(int i = 0; i < n; ++i) {
+    weights[i] = (i == 0) ? cdf[0] : cdf[i] - cdf[i - 1];
+  }
+  setup(weights);
+}
+
+double Alias_Table::get_probability(int i) const {
+  int n = this->table.size();
+  double mass = this->table[i].prob;
+  for(int k = 0; k < n; ++k) {
+    if(k != i && this->table[k].alias == i) {
+      mass += 1.0 - this->table[k].prob;
+    }
+  }
+  return mass / n;
+}
+
+void Alias_Table::get_table(std::vector<double> & prob, std::vector<int> & alias) const {
+  int n = this->table.size();
+  prob.resize(n);
+  alias.resize(n);
+  for(int i = 0; i < n; ++i) {
+    prob[i] = this->table[i].prob;
+    alias[i] = this->table[i].alias;
+  }
+}
+
+void Alias_Table::set_table(const std::vector<double> & prob, const std::vector<int> & alias) {
+  int n = prob.size();
+  assert(alias.size() == n);
+  this->table.resize(n);
+  for(int i = 0; i < n; ++i) {
+    this->table[i].prob = prob[i];
+    this->table[i].alias = alias[i];
+  }
+}
+
+void Alias_Table::draw(int count, int* result) const {
+  for(int k = 0; k < count; ++k) {
+    result[k] = draw(Random::draw_random());
+  }
+}
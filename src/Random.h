@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <random>
+#include <string>
 #include "Global.h"
 using namespace std;
 
@@ -49,10 +50,18 @@ public:
     std::geometric_distribution<int> geometric_dist(p);
     return geometric_dist(mt_engine);
   }
+  int poisson(double mean) {
+    std::poisson_distribution<int> poisson_dist(mean);
+    return poisson_dist(mt_engine);
+  }
   int draw_from_cdf(double *v, int size);
   int draw_from_cdf_vector(const std::vector <double>& v);
   void sample_range_without_replacement(int N, int s, int* result);
 
+  // the engine and distribution state, for checkpoints
+  std::string get_state();
+  bool set_state(const std::string & state);
+
 private:
   std::mt19937_64 mt_engine;
   std::uniform_real_distribution<double> unif_dist;
@@ -60,11 +69,49 @@ private:
 };
 
 
+/**
+ * A counter-based random number stream.  Every draw is a hash of the
+ * stream key and a draw counter, so a stream depends only on its key
+ * (seed, day, hour, condition, group id) and never on which thread
+ * draws from it or how many other streams were used before it.
+ */
+class Stream_RNG {
+public:
+  Stream_RNG(unsigned long seed, int day, int hour, int condition_id, int group_id) {
+    set_key(seed, day, hour, condition_id, group_id);
+  }
+  void set_key(unsigned long seed, int day, int hour, int condition_id, int group_id);
+  double random() {
+    // use the top 53 bits to form a double in [0,1)
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+  }
+  int random_int(int low, int high) {
+    return low + (int) ((high - low + 1) * random());
+  }
+
+private:
+  static uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+  uint64_t next() {
+    ++this->counter;
+    return mix(this->key + this->counter * 0x9e3779b97f4a7c15ULL);
+  }
+  uint64_t key;
+  uint64_t counter;
+};
+
+
 class Thread_RNG {
 public:
   Thread_RNG();
 
   void set_seed(unsigned long seed);
+  unsigned long get_seed() {
+    return this->seed;
+  }
   double get_random() {
     return thread_rng[fred::omp_get_thread_num()].random();
   }
@@ -95,12 +142,18 @@ public:
   int geometric(double p) {
     return thread_rng[fred::omp_get_thread_num()].geometric(p);
   }
+  int poisson(double mean) {
+    return thread_rng[fred::omp_get_thread_num()].poisson(mean);
+  }
   void sample_range_without_replacement(int N, int s, int* result) {
     thread_rng[fred::omp_get_thread_num()].sample_range_without_replacement(N, s, result);
   }
+  std::string get_state();
+  bool set_state(const std::string & state);
 
 private:
   RNG * thread_rng;
+  unsigned long seed;
 };
 
 class Random {
@@ -108,6 +161,9 @@ public:
   static void set_seed(unsigned long seed) { 
     Random_Number_Generator.set_seed(seed);
   }
+  static unsigned long get_seed() {
+    return Random_Number_Generator.get_seed();
+  }
   static double draw_random() { 
     return Random_Number_Generator.get_random();
   }
@@ -129,6 +185,9 @@ public:
   static int draw_geometric(double p) { 
     return Random_Number_Generator.geometric(p);
   }
+  static int draw_poisson(double mean) { 
+    return Random_Number_Generator.poisson(mean);
+  }
   static int draw_from_cdf(double *v, int size) { 
     return Random_Number_Generator.draw_from_cdf(v,size);
   }
@@ -141,12 +200,76 @@ public:
   static void sample_range_without_replacement(int N, int s, int *result) { 
     Random_Number_Generator.sample_range_without_replacement(N,s,result);
   }
+  static std::string get_state() {
+    return Random_Number_Generator.get_state();
+  }
+  static bool set_state(const std::string & state) {
+    return Random_Number_Generator.set_state(state);
+  }
 
 private:
   static Thread_RNG Random_Number_Generator;
 };
 
 
+/**
+ * Walker's alias method, using Vose's construction, for repeated draws
+ * from a fixed discrete distribution.  Setup is O(n) and each draw is
+ * O(1): a single uniform draw picks a column and decides between the
+ * column's own index and its alias.
+ */
+class Alias_Table {
+public:
+  Alias_Table() {}
+
+  // weights need not be normalized; zero weights are never drawn
+  void setup(const std::vector<double> & weights);
+
+  // from a cdf of n entries, as used by draw_from_cdf()
+  void setup_from_cdf(const double* cdf, int n);
+
+  void clear() {
+    this->table.clear();
+  }
+  int size() const {
+    return this->table.size();
+  }
+
+  // the probability of drawing index i (O(n), for reports)
+  double get_probability(int i) const;
+
+  // the columns of the table, to save and restore a table without
+  // rebuilding it
+  void get_table(std::vector<double> & prob, std::vector<int> & alias) const;
+  void set_table(const std::vector<double> & prob, const std::vector<int> & alias);
+
+  int draw() const {
+    return draw(Random::draw_random());
+  }
+
+  // draw using the given uniform value in [0,1)
+  int draw(double r) const {
+    int n = this->table.size();
+    double x = r * n;
+    int i = (int) x;
+    if(i >= n) {
+      i = n - 1;
+    }
+    return (x - i < this->table[i].prob) ? i : this->table[i].alias;
+  }
+
+  // fill result[0..count-1] with independent draws
+  void draw(int count, int* result) const;
+
+private:
+  typedef struct {
+    double prob;
+    int alias;
+  } alias_entry_t;
+  std::vector<alias_entry_t> table;
+};
+
+
 template <typename T> 
 void FYShuffle( std::vector <T> &array){
   int m,randIndx;
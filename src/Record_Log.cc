@@ -0,0 +1,498 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Record_Log.cc
+//
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Global.h"
+#include "Record_Log.h"
+
+// a thread's buffer is passed to the writer when it reaches this size
+#define RECORD_BLOCK_SIZE (1 << 20)
+
+// more arguments than this are written as text
+#define RECORD_MAX_ARGS 32
+
+static const char record_magic[8] = { 'F', 'R', 'E', 'D', 'R', 'E', 'C', '1' };
+
+Block_Writer Record_Log::writer;
+string Record_Log::filename = "";
+bool Record_Log::binary = false;
+std::vector<Record_Log::thread_buffer_t> Record_Log::buffers;
+
+namespace {
+
+  // a piece of a format: literal text followed by at most one conversion
+  typedef struct {
+    string literal;
+    string spec;
+    char type;	// 0 if there is no conversion
+  } segment_t;
+
+  /*
+   * Split a printf format into segments.  The argument types are 'i'
+   * (int), 'l' (long), 'L' (long long), 'z' (size_t), 'd' (double) and
+   * 's' (string).  Returns false for conversions that are not supported.
+   */
+  bool split_format(const char* format, std::vector<segment_t> & segments) {
+    segments.clear();
+    segment_t segment;
+    segment.type = 0;
+    for(const char* p = format; *p != '\0'; ++p) {
+      if(*p != '%') {
+        segment.literal += *p;
+        continue;
+      }
+      if(p[1] == '%') {
+        segment.literal += '%';
+        ++p;
+        continue;
+      }
+      const char* start = p++;
+      while(*p != '\0' && strchr("-+ #0", *p) != NULL) {
+        ++p;
+      }
+      if(*p == '*') {
+        return false;
+      }
+      while(isdigit(*p)) {
+        ++p;
+      }
+      if(*p == '.') {
+        ++p;
+        if(*p == '*') {
+          return false;
+        }
+        while(isdigit(*p)) {
+          ++p;
+        }
+      }
+      char type = 'i';
+      if(*p == 'h') {
+        ++p;
+        if(*p == 'h') {
+          ++p;
+        }
+      } else if(*p == 'l') {
+        ++p;
+        type = 'l';
+        if(*p == 'l') {
+          ++p;
+          type = 'L';
+        }
+      } else if(*p == 'z') {
+        ++p;
+        type = 'z';
+      }
+      if(*p == '\0') {
+        return false;
+      }
+      if(strchr("dicuxXo", *p) != NULL) {
+        // keep the integer type
+      } else if(strchr("fFeEgGaA", *p) != NULL) {
+        type = 'd';
+      } else if(*p == 's' && type == 'i') {
+        type = 's';
+      } else {
+        return false;
+      }
+      segment.spec = string(start, p + 1);
+      segment.type = type;
+      segments.push_back(segment);
+      segment.literal.clear();
+      segment.spec.clear();
+      segment.type = 0;
+    }
+    if(segment.literal.size() > 0) {
+      segments.push_back(segment);
+    }
+    return true;
+  }
+
+  void put_u32(string* block, uint32_t value) {
+    block->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  bool get_value(const char* & p, const char* end, T* value) {
+    if(end - p < static_cast<long>(sizeof(T))) {
+      return false;
+    }
+    memcpy(value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+  }
+}
+
+bool Record_Log::open(const char* filename, bool binary) {
+  close();
+  if(Record_Log::writer.open(filename) == false) {
+    return false;
+  }
+  Record_Log::filename = filename;
+  Record_Log::binary = binary;
+  if(binary) {
+    string* block = Record_Log::writer.get_block(sizeof(record_magic));
+    block->append(record_magic, sizeof(record_magic));
+    Record_Log::writer.write(block);
+  }
+  int threads = fred::omp_get_max_threads();
+  Record_Log::buffers.resize(threads);
+  for(int t = 0; t < threads; ++t) {
+    Record_Log::buffers[t].format.clear();
+    Record_Log::buffers[t].string_id.clear();
+    start_block(t);
+  }
+
+  // records still buffered when the program exits are written
+  static bool close_at_exit = false;
+  if(close_at_exit == false) {
+    atexit(Record_Log::close);
+    close_at_exit = true;
+  }
+  return true;
+}
+
+void Record_Log::close() {
+  if(Record_Log::writer.is_open() == false) {
+    return;
+  }
+  flush();
+  Record_Log::writer.close();
+  for(int t = 0; t < Record_Log::buffers.size(); ++t) {
+    delete Record_Log::buffers[t].block;
+  }
+  Record_Log::buffers.clear();
+}
+
+void Record_Log::print(const char* format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  if(Record_Log::writer.is_open() == false) {
+    vfprintf(stdout, format, ap);
+    va_end(ap);
+    return;
+  }
+  int thread = fred::omp_get_thread_num();
+  thread_buffer_t* buffer = &Record_Log::buffers[thread];
+  if(Record_Log::binary) {
+    vprint_binary(buffer, format, ap);
+  } else {
+    vprint_text(buffer->block, format, ap);
+  }
+  va_end(ap);
+
+  if(buffer->block->size() >= RECORD_BLOCK_SIZE) {
+    size_t length = strlen(format);
+    if(length > 0 && format[length - 1] == '\n') {
+      pass_block(thread);
+    }
+  }
+}
+
+void Record_Log::vprint_text(string* block, const char* format, va_list ap) {
+  size_t used = block->size();
+  size_t space = 256;
+  va_list ap2;
+  va_copy(ap2, ap);
+  block->resize(used + space);
+  int n = vsnprintf(&(*block)[used], space, format, ap);
+  if(n >= static_cast<int>(space)) {
+    block->resize(used + n + 1);
+    vsnprintf(&(*block)[used], n + 1, format, ap2);
+  }
+  va_end(ap2);
+  block->resize(used + (n < 0 ? 0 : n));
+}
+
+void Record_Log::vprint_binary(thread_buffer_t* buffer, const char* format, va_list ap) {
+  std::unordered_map<const char*, format_t>::iterator found = buffer->format.find(format);
+  if(found == buffer->format.end()) {
+    format_t new_format;
+    new_format.id = get_string_id(buffer, format);
+    new_format.types = parse_format(format);
+    found = buffer->format.insert(std::make_pair(format, new_format)).first;
+  }
+  const string & types = found->second.types;
+  string* block = buffer->block;
+
+  if(types == "?") {
+    string text;
+    vprint_text(&text, format, ap);
+    block->push_back('T');
+    put_u32(block, text.size());
+    block->append(text);
+    return;
+  }
+
+  // collect the arguments first, since a new string adds its definition
+  // to the block before the record
+  int64_t int_args[RECORD_MAX_ARGS];
+  double double_args[RECORD_MAX_ARGS];
+  int nargs = types.size();
+  for(int i = 0; i < nargs; ++i) {
+    switch(types[i]) {
+    case 'i':
+      int_args[i] = va_arg(ap, int);
+      break;
+    case 'l':
+      int_args[i] = va_arg(ap, long);
+      break;
+    case 'L':
+      int_args[i] = va_arg(ap, long long);
+      break;
+    case 'z':
+      int_args[i] = va_arg(ap, size_t);
+      break;
+    case 'd':
+      double_args[i] = va_arg(ap, double);
+      break;
+    case 's':
+      {
+        const char* str = va_arg(ap, const char*);
+        int_args[i] = get_string_id(buffer, str == NULL ? "(null)" : str);
+      }
+      break;
+    }
+  }
+
+  block->push_back('R');
+  put_u32(block, found->second.id);
+  for(int i = 0; i < nargs; ++i) {
+    switch(types[i]) {
+    case 'i':
+      {
+        int32_t value = int_args[i];
+        block->append(reinterpret_cast<const char*>(&value), sizeof(value));
+      }
+      break;
+    case 's':
+      put_u32(block, int_args[i]);
+      break;
+    case 'd':
+      block->append(reinterpret_cast<const char*>(&double_args[i]), sizeof(double));
+      break;
+    default:
+      block->append(reinterpret_cast<const char*>(&int_args[i]), sizeof(int64_t));
+      break;
+    }
+  }
+}
+
+int Record_Log::get_string_id(thread_buffer_t* buffer, const char* str) {
+  string key(str);
+  std::unordered_map<string, int>::iterator found = buffer->string_id.find(key);
+  if(found != buffer->string_id.end()) {
+    return found->second;
+  }
+  int id = buffer->string_id.size();
+  buffer->string_id[key] = id;
+  buffer->block->push_back('S');
+  put_u32(buffer->block, id);
+  put_u32(buffer->block, key.size());
+  buffer->block->append(key);
+  return id;
+}
+
+string Record_Log::parse_format(const char* format) {
+  std::vector<segment_t> segments;
+  if(split_format(format, segments) == false) {
+    return "?";
+  }
+  string types = "";
+  for(int i = 0; i < segments.size(); ++i) {
+    if(segments[i].type != 0) {
+      types += segments[i].type;
+    }
+  }
+  if(types.size() > RECORD_MAX_ARGS) {
+    return "?";
+  }
+  return types;
+}
+
+// in the binary form, each block starts with a header { thread, length }
+#define RECORD_BLOCK_HEADER_SIZE (2 * sizeof(uint32_t))
+
+void Record_Log::start_block(int thread) {
+  string* block = Record_Log::writer.get_block(RECORD_BLOCK_SIZE + FRED_STRING_SIZE);
+  if(Record_Log::binary) {
+    block->append(RECORD_BLOCK_HEADER_SIZE, '\0');
+  }
+  Record_Log::buffers[thread].block = block;
+}
+
+void Record_Log::flush() {
+  size_t empty_size = Record_Log::binary ? RECORD_BLOCK_HEADER_SIZE : 0;
+  for(int thread = 0; thread < Record_Log::buffers.size(); ++thread) {
+    if(Record_Log::buffers[thread].block->size() > empty_size) {
+      pass_block(thread);
+    }
+  }
+}
+
+void Record_Log::pass_block(int thread) {
+  string* block = Record_Log::buffers[thread].block;
+  if(Record_Log::binary) {
+    uint32_t header[2];
+    header[0] = thread;
+    header[1] = block->size() - RECORD_BLOCK_HEADER_SIZE;
+    memcpy(&(*block)[0], header, RECORD_BLOCK_HEADER_SIZE);
+  }
+  Record_Log::writer.write(block);
+  start_block(thread);
+}
+
+void Record_Log::write_prior_records(const string & contents) {
+  if(Record_Log::writer.is_open() == false) {
+    return;
+  }
+  size_t start = 0;
+  if(Record_Log::binary && contents.compare(0, sizeof(record_magic), record_magic, sizeof(record_magic)) == 0) {
+    start = sizeof(record_magic);
+  }
+  string* block = Record_Log::writer.get_block(contents.size());
+  block->append(contents, start, string::npos);
+  Record_Log::writer.write(block);
+}
+
+bool Record_Log::convert(const char* binary_file, FILE* out) {
+  FILE* fp = fopen(binary_file, "rb");
+  if(fp == NULL) {
+    return false;
+  }
+  char magic[sizeof(record_magic)];
+  if(fread(magic, 1, sizeof(magic), fp) != sizeof(magic) || memcmp(magic, record_magic, sizeof(magic)) != 0) {
+    fclose(fp);
+    return false;
+  }
+
+  // the strings of each thread, and the formats split into segments
+  std::vector<std::vector<string> > strings;
+  std::unordered_map<string, std::vector<segment_t> > formats;
+  std::vector<char> data;
+  bool ok = true;
+  uint32_t header[2];
+  while(ok && fread(header, sizeof(uint32_t), 2, fp) == 2) {
+    int thread = header[0];
+    data.resize(header[1]);
+    if(fread(data.data(), 1, data.size(), fp) != data.size()) {
+      ok = false;
+      break;
+    }
+    if(strings.size() <= thread) {
+      strings.resize(thread + 1);
+    }
+    std::vector<string> & thread_strings = strings[thread];
+    const char* p = data.data();
+    const char* end = p + data.size();
+    while(ok && p < end) {
+      char tag = *p++;
+      uint32_t id, length;
+      if(tag == 'S') {
+        ok = get_value(p, end, &id) && get_value(p, end, &length) && length <= end - p;
+        if(ok) {
+          if(thread_strings.size() <= id) {
+            thread_strings.resize(id + 1);
+          }
+          thread_strings[id].assign(p, length);
+          p += length;
+        }
+      } else if(tag == 'T') {
+        ok = get_value(p, end, &length) && length <= end - p;
+        if(ok) {
+          fwrite(p, 1, length, out);
+          p += length;
+        }
+      } else if(tag == 'R') {
+        ok = get_value(p, end, &id) && id < thread_strings.size();
+        if(ok == false) {
+          break;
+        }
+        const string & format = thread_strings[id];
+        std::unordered_map<string, std::vector<segment_t> >::iterator found = formats.find(format);
+        if(found == formats.end()) {
+          std::vector<segment_t> segments;
+          ok = split_format(format.c_str(), segments);
+          found = formats.insert(std::make_pair(format, segments)).first;
+        }
+        std::vector<segment_t> & segments = found->second;
+        for(int i = 0; ok && i < segments.size(); ++i) {
+          fputs(segments[i].literal.c_str(), out);
+          const char* spec = segments[i].spec.c_str();
+          int32_t int_value;
+          int64_t long_value;
+          double double_value;
+          switch(segments[i].type) {
+          case 0:
+            break;
+          case 'i':
+            ok = get_value(p, end, &int_value);
+            if(ok) {
+              fprintf(out, spec, int_value);
+            }
+            break;
+          case 's':
+            ok = get_value(p, end, &id) && id < thread_strings.size();
+            if(ok) {
+              fprintf(out, spec, thread_strings[id].c_str());
+            }
+            break;
+          case 'd':
+            ok = get_value(p, end, &double_value);
+            if(ok) {
+              fprintf(out, spec, double_value);
+            }
+            break;
+          case 'l':
+            ok = get_value(p, end, &long_value);
+            if(ok) {
+              fprintf(out, spec, static_cast<long>(long_value));
+            }
+            break;
+          case 'L':
+            ok = get_value(p, end, &long_value);
+            if(ok) {
+              fprintf(out, spec, static_cast<long long>(long_value));
+            }
+            break;
+          case 'z':
+            ok = get_value(p, end, &long_value);
+            if(ok) {
+              fprintf(out, spec, static_cast<size_t>(long_value));
+            }
+            break;
+          }
+        }
+      } else {
+        ok = false;
+      }
+    }
+  }
+  fclose(fp);
+  return ok;
+}
@@ -0,0 +1,118 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Record_Log.h
+//
+
+#ifndef _FRED_RECORD_LOG_H
+#define _FRED_RECORD_LOG_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Block_Writer.h"
+
+using namespace std;
+
+/**
+ * The health records file.  Records are formatted into a buffer for each
+ * thread, and full buffers are written by a background thread in large
+ * sequential writes, so writing a record does not make a system call.
+ *
+ * In the binary form, each record is written as the id of its format
+ * followed by its arguments in fixed-width fields, and strings are
+ * written once and referred to by id.  Record_Log::convert (used by the
+ * fred_records tool) turns a binary file back into the text form.
+ *
+ * Binary file layout: the 8-byte magic "FREDREC1", followed by blocks.
+ * Each block is a header { uint32 thread, uint32 length } and length
+ * bytes of entries, each starting with a tag byte:
+ *   'S' uint32 id, uint32 length, bytes: defines a string of this thread
+ *   'R' uint32 format id, arguments:    a record written with a format
+ *   'T' uint32 length, bytes:           literal text
+ * Arguments are int32 for %d and %c, int64 for %ld, %lld and %zd,
+ * double for %f, %e and %g, and a uint32 string id for %s.
+ */
+class Record_Log {
+public:
+
+  // open the file; returns false if it can't be opened
+  static bool open(const char* filename, bool binary);
+
+  // write everything buffered, stop the writer and close the file
+  static void close();
+
+  static bool is_open() {
+    return Record_Log::writer.is_open();
+  }
+
+  static const char* get_filename() {
+    return Record_Log::filename.c_str();
+  }
+
+  /**
+   * Add printf-style output to the calling thread's buffer.  A record
+   * may be written in several calls; a buffer is passed to the writer
+   * only after a call whose format ends in a newline.  Before the file
+   * is opened, records go to stdout.
+   */
+  static void print(const char* format, ...);
+
+  // write the contents of an earlier record file of the same form
+  static void write_prior_records(const string & contents);
+
+  // pass all buffers to the writer
+  static void flush();
+
+  // write the text form of a binary record file; returns false on error
+  static bool convert(const char* binary_file, FILE* out);
+
+private:
+
+  typedef struct {
+    int id;
+    string types;   // one type code for each argument, or "?" if unsupported
+  } format_t;
+
+  typedef struct {
+    string* block;
+    std::unordered_map<const char*, format_t> format;
+    std::unordered_map<string, int> string_id;
+  } thread_buffer_t;
+
+  static void vprint_text(string* block, const char* format, va_list ap);
+  static void vprint_binary(thread_buffer_t* buffer, const char* format, va_list ap);
+  static int get_string_id(thread_buffer_t* buffer, const char* str);
+  static string parse_format(const char* format);
+  static void start_block(int thread);
+  static void pass_block(int thread);
+
+  static Block_Writer writer;
+  static string filename;
+  static bool binary;
+  static std::vector<thread_buffer_t> buffers;
+};
+
+#endif // _FRED_RECORD_LOG_H
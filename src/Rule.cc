@@ -20,6 +20,7 @@
 
 #include "Rule.h"
 #include "Condition.h"
+#include "Bytecode.h"
 #include "Clause.h"
 #include "Expression.h"
 #include "Global.h"
@@ -114,10 +115,19 @@ void Rule::prepare_rules() {
     Rule::rules[i]->compile();
   }
 
+  if (Global::Enable_Rule_Bytecode) {
+    for (int i = 0; i < Rule::compiled_rules.size(); i++) {
+      Rule::compiled_rules[i]->compile_bytecode();
+    }
+  }
+
   printf("\nCOMPILED RULES size = %d:\n", (int) Rule::compiled_rules.size());
   for (int i = 0; i < Rule::compiled_rules.size(); i++) {
     printf("%d: ", i);
     Rule::compiled_rules[i]->print();
+    if (Global::Verbose > 0 && Rule::compiled_rules[i]->program != NULL) {
+      Rule::compiled_rules[i]->program->print();
+    }
     printf("\n");
   }
 
@@ -153,6 +163,8 @@ Rule::Rule(string s) {
   this->expression = NULL;
   this->expression_str2 = "";
   this->expression2 = NULL;
+  this->expression_str3 = "";
+  this->expression3 = NULL;
   this->var = "";
   this->var_id = -1;
   this->list_var = "";
@@ -169,6 +181,7 @@ Rule::Rule(string s) {
   this->group_type_id = -1;
   this->err = "";
   this->preference = NULL;
+  this->program = NULL;
   this->used = false;
   this->warning = false;
   this->global = false;
@@ -185,6 +198,11 @@ Rule::Rule(string s) {
 
 double Rule::get_value(Person* person, Person* other) {
 
+  if (this->program != NULL) {
+    // next_rules are evaluated for the person alone
+    return this->program->get_value(person, this->action_id == Rule_Action::SET ? other : NULL);
+  }
+
   if (this->action_id == Rule_Action::SET) {
     double value = 0.0;
     if (this->expression != NULL) {
@@ -217,6 +235,21 @@ double Rule::get_value(Person* person, Person* other) {
   return 0.0;
 }
   
+void Rule::get_values(Person** people, int n, double* values) {
+  if (this->program != NULL) {
+    this->program->get_values(people, n, values);
+  }
+  else {
+    for (int i = 0; i < n; i++) {
+      values[i] = get_value(people[i]);
+    }
+  }
+}
+
+bool Rule::is_local() {
+  return this->program != NULL && this->program->is_local();
+}
+  
 bool Rule::parse() {
 
   char line[FRED_STRING_SIZE];
@@ -422,6 +455,24 @@ bool Rule::compile() {
   return false;
 }
 
+void Rule::compile_bytecode() {
+  // lower the clause and expressions to flat programs, for callers that
+  // evaluate them directly as well as for get_value()
+  if (this->clause != NULL) {
+    this->clause->compile();
+  }
+  Expression* expressions[] = { this->expression, this->expression2, this->expression3 };
+  for (int i = 0; i < 3; i++) {
+    if (expressions[i] != NULL) {
+      expressions[i]->compile();
+    }
+  }
+  if (this->program == NULL) {
+    this->program = Bytecode::compile_rule(this);
+  }
+}
+
+
 void Rule::set_hidden_by_rule(Rule* rule) {
   this->hidden_by = rule;
   char msg[FRED_STRING_SIZE];
@@ -948,7 +999,7 @@ bool Rule::compile_action_rule() {
   case Rule_Action::RANDOMIZE_NETWORK :
     {
       string_vector_t args = Utils::get_top_level_parse(this->expression_str,',');
-      if (args.size() == 3) {
+      if (args.size() != 3) {
 	this->err = "Needs 3 arguments:\n  " + this->name;
 	Utils::print_error(get_err_msg().c_str());
 	return false;
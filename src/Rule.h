@@ -29,6 +29,7 @@
 
 using namespace std;
 
+class Bytecode;
 class Person;
 class Clause;
 class Expression;
@@ -258,6 +259,9 @@ public:
   void print();
 
   double get_value(Person* person, Person* other = NULL);
+  void get_values(Person** people, int n, double* values);
+
+  bool is_local();
 
   void mark_as_used() {
     this->used = true;
@@ -273,6 +277,7 @@ public:
 
   bool compile();
   bool compile_action_rule();
+  void compile_bytecode();
 
   void set_hidden_by_rule(Rule* rule);
 
@@ -357,6 +362,7 @@ private:
   bool schedule_rule;
 
   Preference* preference;
+  Bytecode* program;
 
   Rule* hidden_by;
 };
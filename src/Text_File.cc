@@ -0,0 +1,129 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Text_File.cc
+//
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Text_File.h"
+#include "Utils.h"
+
+Text_File::Text_File() {
+  this->data = NULL;
+  this->size = 0;
+  this->mapped_size = 0;
+}
+
+Text_File::~Text_File() {
+  close();
+}
+
+bool Text_File::open(const char* filename) {
+  close();
+  char name[FRED_STRING_SIZE];
+  strcpy(name, filename);
+  Utils::get_fred_file_name(name);
+
+  int fd = ::open(name, O_RDONLY);
+  if(fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+  this->size = st.st_size;
+
+  // the byte after the end of the file must read as NUL.  A mapping
+  // gives that for free unless the file fills its last page exactly.
+  long page_size = sysconf(_SC_PAGESIZE);
+  if(this->size > 0 && this->size % page_size != 0) {
+    void* map = mmap(NULL, this->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if(map != MAP_FAILED) {
+      ::close(fd);
+      this->data = static_cast<char*>(map);
+      this->mapped_size = this->size;
+      madvise(map, this->size, MADV_SEQUENTIAL);
+      return true;
+    }
+  }
+
+  this->buffer.assign(this->size + 1, '\0');
+  size_t done = 0;
+  while(done < this->size) {
+    ssize_t n = read(fd, &this->buffer[done], this->size - done);
+    if(n <= 0) {
+      ::close(fd);
+      this->buffer.clear();
+      return false;
+    }
+    done += n;
+  }
+  ::close(fd);
+  this->data = &this->buffer[0];
+  return true;
+}
+
+void Text_File::close() {
+  if(this->mapped_size > 0) {
+    munmap(this->data, this->mapped_size);
+  }
+  this->data = NULL;
+  this->size = 0;
+  this->mapped_size = 0;
+  this->buffer.clear();
+}
+
+void Text_File::get_chunks(size_t chunk_size, std::vector<chunk_t> & chunks) {
+  chunks.clear();
+  if(this->data == NULL) {
+    return;
+  }
+  char* end = this->data + this->size;
+
+  // skip the header line
+  char* cursor = this->data;
+  next_line(cursor, end);
+
+  if(chunk_size == 0) {
+    chunk_size = 1;
+  }
+  while(cursor < end) {
+    chunk_t chunk;
+    chunk.begin = cursor;
+    if((size_t) (end - cursor) <= chunk_size) {
+      cursor = end;
+    } else {
+      // extend the chunk to the end of its last line
+      char* newline = static_cast<char*>(memchr(cursor + chunk_size, '\n', end - (cursor + chunk_size)));
+      cursor = (newline == NULL) ? end : newline + 1;
+    }
+    chunk.end = cursor;
+    chunks.push_back(chunk);
+  }
+}
@@ -0,0 +1,224 @@
+/*
+ * This file is part of the FRED system.
+ *
+ * Copyright (c) 2010-2012, University of Pittsburgh, John Grefenstette, Shawn Brown,
+ * Roni Rosenfield, Alona Fyshe, David Galloway, Nathan Stone, Jay DePasse,
+ * Anuroop Sriram, and Donald Burke
+ * All rights reserved.
+ *
+ * Copyright (c) 2013-2019, University of Pittsburgh, John Grefenstette, Robert Frankeny,
+ * David Galloway, Mary Krauland, Michael Lann, David Sinclair, and Donald Burke
+ * All rights reserved.
+ *
+ * FRED is distributed on the condition that users fully understand and agree to all terms of the
+ * End User License Agreement.
+ *
+ * FRED is intended FOR NON-COMMERCIAL, EDUCATIONAL OR RESEARCH PURPOSES ONLY.
+ *
+ * See the file "LICENSE" for more information.
+ */
+
+//
+//
+// File: Text_File.h
+//
+
+#ifndef _FRED_TEXT_FILE_H
+#define _FRED_TEXT_FILE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "Global.h"
+
+using namespace std;
+
+/**
+ * A whitespace-separated text file read into memory in one piece, so
+ * that it can be parsed in chunks on several threads.  The file is
+ * mapped copy-on-write; lines and fields are terminated in place, so
+ * parsing does not allocate and parsed fields can point into the file
+ * for as long as the Text_File is open.
+ */
+class Text_File {
+public:
+
+  typedef struct {
+    char* begin;
+    char* end;
+  } chunk_t;
+
+  Text_File();
+  ~Text_File();
+
+  // returns false if the file can not be read
+  bool open(const char* filename);
+  void close();
+
+  /**
+   * Split the lines after the header line into about size/chunk_size
+   * chunks that start and end on line boundaries.
+   */
+  void get_chunks(size_t chunk_size, std::vector<chunk_t> & chunks);
+
+  // return the line at cursor, NUL-terminated, and advance cursor to the next line
+  static char* next_line(char* & cursor, char* end) {
+    char* line = cursor;
+    char* newline = static_cast<char*>(memchr(cursor, '\n', end - cursor));
+    if(newline == NULL) {
+      cursor = end;
+    } else {
+      *newline = '\0';
+      cursor = newline + 1;
+    }
+    return line;
+  }
+
+  /**
+   * Read the lines after the header of each file with a reader that has
+   *
+   *   bool parse(int file_index, char* line, T* record);   // false drops the line
+   *   void commit(int file_index, T & record);
+   *
+   * parse() is called on all threads, for chunks of lines of all the
+   * files at once.  commit() is called on the calling thread, for the
+   * files in order and the lines of each file in order, so committing
+   * has the same effect as reading the files one line at a time.
+   * Chunks are processed in waves to bound the memory used by records.
+   */
+  template <typename T, typename Reader>
+  static void read_files(std::vector<Text_File*> & files, Reader & reader) {
+    std::vector<chunk_t> chunks;
+    std::vector<int> chunk_file;
+    for(int i = 0; i < files.size(); ++i) {
+      std::vector<chunk_t> file_chunks;
+      files[i]->get_chunks(Text_File::CHUNK_SIZE, file_chunks);
+      chunks.insert(chunks.end(), file_chunks.begin(), file_chunks.end());
+      chunk_file.insert(chunk_file.end(), file_chunks.size(), i);
+    }
+    int number_of_chunks = chunks.size();
+    int wave_size = 4 * fred::omp_get_max_threads();
+    std::vector<std::vector<T> > records(wave_size);
+    for(int first = 0; first < number_of_chunks; first += wave_size) {
+      int last = std::min(first + wave_size, number_of_chunks);
+#pragma omp parallel for schedule(dynamic)
+      for(int c = first; c < last; ++c) {
+	std::vector<T> & chunk_records = records[c - first];
+	chunk_records.clear();
+	char* cursor = chunks[c].begin;
+	char* end = chunks[c].end;
+	T record;
+	while(cursor < end) {
+	  char* line = next_line(cursor, end);
+	  if(reader.parse(chunk_file[c], line, &record)) {
+	    chunk_records.push_back(record);
+	  }
+	}
+      }
+      for(int c = first; c < last; ++c) {
+	std::vector<T> & chunk_records = records[c - first];
+	for(int i = 0; i < chunk_records.size(); ++i) {
+	  reader.commit(chunk_file[c], chunk_records[i]);
+	}
+	std::vector<T>().swap(chunk_records);
+      }
+    }
+  }
+
+  static const size_t CHUNK_SIZE = 1 << 20;
+
+  // the next field of a line, NUL-terminated, or NULL at the end of the line
+  static char* next_field(char* & cursor) {
+    while(is_space(*cursor)) {
+      ++cursor;
+    }
+    if(*cursor == '\0') {
+      return NULL;
+    }
+    char* field = cursor;
+    while(*cursor != '\0' && is_space(*cursor) == false) {
+      ++cursor;
+    }
+    if(*cursor != '\0') {
+      *cursor = '\0';
+      ++cursor;
+    }
+    return field;
+  }
+
+  // each get_ function converts the next field and returns false if
+  // there is none or it is not a number, like the sscanf conversions
+  static bool get_string(char* & cursor, char** value) {
+    char* field = next_field(cursor);
+    if(field == NULL) {
+      return false;
+    }
+    *value = field;
+    return true;
+  }
+
+  static bool get_char(char* & cursor, char* value) {
+    char* field = next_field(cursor);
+    if(field == NULL) {
+      return false;
+    }
+    *value = field[0];
+    return true;
+  }
+
+  static bool get_int(char* & cursor, int* value) {
+    char* field = next_field(cursor);
+    if(field == NULL) {
+      return false;
+    }
+    char* end;
+    long int x = strtol(field, &end, 10);
+    if(end == field) {
+      return false;
+    }
+    *value = (int) x;
+    return true;
+  }
+
+  static bool get_long_long(char* & cursor, long long int* value) {
+    char* field = next_field(cursor);
+    if(field == NULL) {
+      return false;
+    }
+    char* end;
+    long long int x = strtoll(field, &end, 10);
+    if(end == field) {
+      return false;
+    }
+    *value = x;
+    return true;
+  }
+
+  static bool get_double(char* & cursor, double* value) {
+    char* field = next_field(cursor);
+    if(field == NULL) {
+      return false;
+    }
+    char* end;
+    double x = strtod(field, &end);
+    if(end == field) {
+      return false;
+    }
+    *value = x;
+    return true;
+  }
+
+private:
+  static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+  }
+
+  char* data;
+  size_t size;
+  size_t mapped_size;
+  std::vector<char> buffer;
+};
+
+#endif // _FRED_TEXT_FILE_H
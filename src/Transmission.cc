@@ -103,3 +103,19 @@ bool Transmission::attempt_transmission(double transmission_prob, Person* source
   }
 }
 
+
+
+bool Transmission::commit_exposure(const exposure_t & exposure, int day, int hour) {
+
+  // the host may have been exposed in another group during this step
+  if (exposure.host->is_susceptible(exposure.condition_to_transmit) == false) {
+    return false;
+  }
+
+  exposure.source->expose(exposure.host, exposure.condition_id, exposure.condition_to_transmit, exposure.group, day, hour);
+
+  // notify the epidemic
+  Condition::get_condition(exposure.condition_to_transmit)->get_epidemic()->become_exposed(exposure.host, day, hour);
+
+  return true;
+}
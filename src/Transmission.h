@@ -26,11 +26,24 @@
 #ifndef _FRED_TRANSMISSION_H
 #define _FRED_TRANSMISSION_H
 
+#include <vector>
+
 class Condition;
 class Group;
 class Person;
 class Place;
 
+// an exposure selected during parallel transmission, to be committed later
+typedef struct {
+  Person* source;
+  Person* host;
+  int condition_id;
+  int condition_to_transmit;
+  Group* group;
+} exposure_t;
+
+typedef std::vector<exposure_t> exposure_vector_t;
+
 
 class Transmission {
 
@@ -51,6 +64,7 @@ public:
   virtual void transmission(int day, int hour, int condition_id, Group* group, int time_block) = 0;
   bool attempt_transmission(double transmission_prob, Person* source, Person* host,
 			    int condition_id, int condition_to_transmit, int day, int hour, Group* group);
+  bool commit_exposure(const exposure_t & exposure, int day, int hour);
 
 protected:
 
@@ -27,6 +27,7 @@
 using namespace std;
 
 #include "Age_Map.h"
+#include "Checkpoint.h"
 #include "Global.h"
 #include "Events.h"
 #include "Property.h"
@@ -44,8 +45,7 @@ Events * Travel::return_queue = new Events;
 char trips_per_day_file[FRED_STRING_SIZE];
 char hub_file[FRED_STRING_SIZE];
 double mean_trip_duration = 0;			// mean days per trip
-double* Travel_Duration_Cdf = NULL;		// cdf for trip duration
-int max_Travel_Duration = 0;			// number of days in cdf
+Alias_Table travel_duration_sampler;		// distribution of days per trip
 Age_Map* travel_age_prob = NULL;
 std::vector<hub_t> hubs;
 int num_hubs = 0;
@@ -60,6 +60,12 @@ void Travel::get_properties() {
 
 void Travel::setup(char* directory) {
   assert(Global::Enable_Travel);
+  vector<double> travel_duration;
+  Property::get_property_vector((char*)"travel_duration", travel_duration);
+  if(travel_duration.size() == 0) {
+    Utils::fred_abort("Help! travel_duration must list the probability of each trip duration\n");
+  }
+  travel_duration_sampler.setup(travel_duration);
   read_hub_file();
   read_trips_per_day_file();
   setup_travelers_per_hub();
@@ -234,7 +240,7 @@ void Travel::update_travel(int day) {
 	  traveler->start_traveling(host);
 	  if(traveler->get_travel_status()) {
 	    // put traveler on list for given number of days to travel
-	    int duration = Random::draw_from_distribution(max_Travel_Duration, Travel_Duration_Cdf);
+	    int duration = travel_duration_sampler.draw();
 	    int return_sim_day = day + duration;
 	    Travel::add_return_event(return_sim_day, traveler);
 	    traveler->set_return_from_travel_sim_day(return_sim_day);
@@ -290,3 +296,11 @@ void Travel::delete_return_event(int day, Person* person) {
   Travel::return_queue->delete_event(24*day, person);
 }
 
+// pending returns from travel after the checkpoint day
+void Travel::save_checkpoint(Checkpoint* checkpoint, int day) {
+  return_queue->save_checkpoint(checkpoint, 24*(day+1));
+}
+
+void Travel::restore_checkpoint(Checkpoint* checkpoint) {
+  return_queue->restore_checkpoint(checkpoint, -1);
+}
@@ -39,6 +39,7 @@ typedef struct hub_record {
 } hub_t;
 
 
+class Checkpoint;
 class Events;
 class Person;
 class Age_Map;
@@ -59,6 +60,8 @@ public:
   static void terminate_person(Person* per);
   static void add_return_event(int day, Person* person);
   static void delete_return_event(int day, Person* person);
+  static void save_checkpoint(Checkpoint* checkpoint, int day);
+  static void restore_checkpoint(Checkpoint* checkpoint);
 
 private:
   static Events * return_queue;
@@ -27,6 +27,9 @@
 #include "Expression.h"
 #include "Global.h"
 #include "Person.h"
+#include "Exposure_Trace.h"
+#include "External_Update.h"
+#include "Record_Log.h"
 
 static high_resolution_clock::time_point start_timer;
 static high_resolution_clock::time_point fred_timer;
@@ -186,11 +189,14 @@ void Utils::fred_open_output_files(){
   Global::ErrorLogfp = NULL;
   sprintf(ErrorFilename, "%s/err.txt", directory);
 
-  Global::Recordsfp = NULL;
+  Record_Log::close();
   if(Global::Enable_Records > 0) {
-    sprintf(filename, "%s/health_records.txt", directory);
-    Global::Recordsfp = fopen(filename, "w");
-    if(Global::Recordsfp == NULL) {
+    if(Global::Enable_Binary_Records) {
+      sprintf(filename, "%s/health_records.bin", directory);
+    } else {
+      sprintf(filename, "%s/health_records.txt", directory);
+    }
+    if(Record_Log::open(filename, Global::Enable_Binary_Records) == false) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
   }
@@ -240,9 +246,9 @@ void Utils::fred_end(void) {
     fclose(Global::ErrorLogfp);
   }
 
-  if(Global::Recordsfp != NULL) {
-    fclose(Global::Recordsfp);
-  }
+  Record_Log::close();
+  Exposure_Trace::close();
+  External_Update::close();
 }
 
 void Utils::fred_print_wall_time(const char* format, ...) {